@@ -0,0 +1,106 @@
+import asyncio
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from yyjson import Document, ReaderFlags, aiter_ndjson
+
+LINES = [
+    {"id": i, "name": "x" * (i % 17), "vals": list(range(i % 5))}
+    for i in range(500)
+]
+CONTENT = b"".join(Document(line).dumps().encode() + b"\n" for line in LINES)
+
+
+def collect(stream, **kwargs):
+    async def main():
+        return [obj async for obj in aiter_ndjson(stream(), **kwargs)]
+
+    return asyncio.run(main())
+
+
+def reader_for(content, step):
+    def make():
+        reader = asyncio.StreamReader()
+        for i in range(0, len(content), step):
+            reader.feed_data(content[i : i + step])
+        reader.feed_eof()
+        return reader
+
+    return make
+
+
+def test_aiter_ndjson_stream_reader():
+    """
+    Ensure every line of a StreamReader is parsed, however it's chunked.
+    """
+    for step in (1, 7, 1000, len(CONTENT)):
+        assert collect(reader_for(CONTENT, step), chunk_size=512) == LINES
+    assert collect(reader_for(b"", 1)) == []
+
+
+def test_aiter_ndjson_async_iterable():
+    """
+    Ensure an async iterable of chunks can be used instead of a reader,
+    including a final line with no newline.
+    """
+
+    async def chunks():
+        yield b'{"a": 1}\n{"a"'
+        yield b": 2}\n3"
+
+    assert collect(chunks) == [{"a": 1}, {"a": 2}, 3]
+
+
+def test_aiter_ndjson_off_loop():
+    """
+    Ensure parsing happens on the given executor rather than the event
+    loop's thread.
+    """
+    threads = set()
+
+    class RecordingExecutor(ThreadPoolExecutor):
+        def submit(self, fn, *args):
+            def run():
+                threads.add(threading.get_ident())
+                return fn(*args)
+
+            return super().submit(run)
+
+    with RecordingExecutor(max_workers=1) as executor:
+        assert collect(reader_for(CONTENT, 4096), executor=executor) == LINES
+    assert threads and threading.get_ident() not in threads
+
+
+def test_aiter_ndjson_flags_and_errors():
+    """
+    Ensure flags apply to every line and invalid lines raise.
+    """
+    content = b"[1,]\n[2,]\n"
+    assert collect(
+        reader_for(content, 3), flags=ReaderFlags.ALLOW_TRAILING_COMMAS
+    ) == [[1], [2]]
+
+    with pytest.raises(ValueError, match="position"):
+        collect(reader_for(content, 3))
+
+    with pytest.raises(ValueError):
+        collect(reader_for(b'{"a": 1}\n{"b": ', 100))
+
+
+def test_aiter_ndjson_early_exit():
+    """
+    Ensure breaking out of the loop stops reading.
+    """
+
+    async def main():
+        reader = reader_for(CONTENT, 4096)()
+        result = []
+        async for obj in aiter_ndjson(reader, chunk_size=1024):
+            result.append(obj)
+            if len(result) == 3:
+                break
+        return result
+
+    assert asyncio.run(main()) == LINES[:3]
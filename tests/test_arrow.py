@@ -0,0 +1,190 @@
+"""
+Tests for exporting arrays with the Arrow C Data Interface.
+"""
+import pytest
+
+from yyjson import Document, ReaderFlags
+
+RECORDS = """[
+    {"id": 1, "name": "a", "tags": ["x", "y"], "pos": {"x": 1.5, "y": 2}},
+    {"id": 2, "name": null, "tags": [], "extra": true},
+    null,
+    {"id": 3, "name": "\\u00e9"}
+]"""
+
+
+@pytest.fixture(params=[False, True], ids=["frozen", "thawed"])
+def thawed(request):
+    return request.param
+
+
+def make_doc(content, thawed, **kwargs):
+    doc = Document(content, **kwargs)
+    if thawed:
+        doc.thaw()
+    return doc
+
+
+def test_to_arrow_capsules(thawed):
+    """
+    Ensure the PyCapsule interface is implemented, without needing pyarrow.
+    """
+    result = make_doc(RECORDS, thawed).to_arrow()
+    assert len(result) == 4
+
+    schema, array = result.__arrow_c_array__()
+    assert type(schema).__name__ == "PyCapsule"
+    assert "arrow_schema" in repr(schema)
+    assert "arrow_array" in repr(array)
+    assert "arrow_schema" in repr(result.__arrow_c_schema__())
+
+
+def test_to_arrow_errors(thawed):
+    """
+    Ensure values that can't be converted are rejected.
+    """
+    with pytest.raises(TypeError, match="int64 and string values at index 1"):
+        make_doc('[1, "a"]', thawed).to_arrow()
+    with pytest.raises(TypeError, match="at index 1"):
+        make_doc('[{"a": [1]}, {"a": {}}]', thawed).to_arrow()
+    with pytest.raises(TypeError):
+        make_doc('{"a": 1}', thawed).to_arrow()
+    with pytest.raises(ValueError):
+        make_doc("[]", thawed).to_arrow("/missing")
+
+
+def test_to_arrow_inferred(thawed):
+    """
+    Ensure types are inferred from the values.
+    """
+    pa = pytest.importorskip("pyarrow")
+
+    array = pa.array(make_doc(RECORDS, thawed).to_arrow())
+    array.validate(full=True)
+    assert array.type == pa.struct(
+        [
+            ("id", pa.int64()),
+            ("name", pa.string()),
+            ("tags", pa.list_(pa.string())),
+            ("pos", pa.struct([("x", pa.float64()), ("y", pa.int64())])),
+            ("extra", pa.bool_()),
+        ]
+    )
+    assert array.to_pylist() == [
+        {
+            "id": 1,
+            "name": "a",
+            "tags": ["x", "y"],
+            "pos": {"x": 1.5, "y": 2},
+            "extra": None,
+        },
+        {"id": 2, "name": None, "tags": [], "pos": None, "extra": True},
+        None,
+        {"id": 3, "name": "é", "tags": None, "pos": None, "extra": None},
+    ]
+
+    batch = pa.RecordBatch.from_struct_array(array)
+    assert batch.num_rows == 4
+
+    # Integers mixed with reals become doubles.
+    assert pa.array(make_doc("[1, 2.5]", thawed).to_arrow()).to_pylist() == [
+        1.0,
+        2.5,
+    ]
+    assert pa.array(make_doc("[null, null]", thawed).to_arrow()).type == (
+        pa.null()
+    )
+    assert len(pa.array(make_doc("[]", thawed).to_arrow())) == 0
+
+
+def test_to_arrow_schema(thawed):
+    """
+    Ensure a schema can be given, in which case only its fields are kept.
+    """
+    pa = pytest.importorskip("pyarrow")
+
+    doc = make_doc('{"rows": [{"id": 1, "name": "a"}, {"id": 2}]}', thawed)
+    schema = pa.schema([("id", pa.int32()), ("flag", pa.bool_())])
+    array = pa.array(doc.to_arrow("/rows", schema=schema))
+    assert array.type == pa.struct(schema)
+    assert array.to_pylist() == [
+        {"id": 1, "flag": None},
+        {"id": 2, "flag": None},
+    ]
+
+    doc = make_doc("[1, 255, null]", thawed)
+    assert pa.array(doc.to_arrow(schema=pa.uint8())).to_pylist() == [
+        1,
+        255,
+        None,
+    ]
+    assert pa.array(doc.to_arrow(schema=pa.float32())).to_pylist() == [
+        1.0,
+        255.0,
+        None,
+    ]
+
+    with pytest.raises(OverflowError, match="at index 1"):
+        doc.to_arrow(schema=pa.int8())
+    with pytest.raises(TypeError, match="got number at index 0"):
+        doc.to_arrow(schema=pa.string())
+    with pytest.raises(ValueError, match="Unsupported Arrow format"):
+        doc.to_arrow(schema=pa.date32())
+
+    doc = make_doc("[18446744073709551616]", thawed,
+                   flags=ReaderFlags.BIG_NUMBERS_AS_DECIMAL)
+    assert pa.array(doc.to_arrow(schema=pa.float64())).to_pylist() == [
+        18446744073709551616.0
+    ]
+
+
+def test_to_arrow_reexport(thawed):
+    """
+    Ensure the same result can be exported more than once.
+    """
+    pa = pytest.importorskip("pyarrow")
+
+    result = make_doc(RECORDS, thawed).to_arrow()
+    first = pa.array(result)
+    second = pa.array(result)
+    del result
+    assert first.equals(second)
+
+
+def test_to_arrow_schema_not_nullable(thawed):
+    """
+    Ensure fields a schema marks as not nullable are exported that way, and
+    nulls in them raise instead of being written.
+    """
+    pa = pytest.importorskip("pyarrow")
+
+    schema = pa.struct([pa.field("b", pa.string(), nullable=False)])
+    array = pa.array(make_doc('[{"b": "x"}, null]', thawed).to_arrow(
+        schema=schema
+    ))
+    assert array.type == schema
+    assert array.to_pylist() == [{"b": "x"}, None]
+
+    for content in ('[{"b": "x"}, {"b": null}]', '[{"b": "x"}, {}]'):
+        with pytest.raises(TypeError, match="got null at index 1"):
+            make_doc(content, thawed).to_arrow(schema=schema)
+
+
+@pytest.mark.parametrize("action", ["freeze", "thaw"])
+def test_to_arrow_schema_busy(action):
+    """
+    Ensure __arrow_c_schema__ can't free the Document while its array is
+    being converted.
+    """
+    doc = Document('[{"a": 1}]')
+    if action == "freeze":
+        doc.thaw()
+
+    class Schema:
+        def __arrow_c_schema__(self):
+            getattr(doc, action)()
+
+    with pytest.raises(BufferError):
+        doc.to_arrow(schema=Schema())
+
+    assert doc.as_obj == [{"a": 1}]
@@ -0,0 +1,126 @@
+"""
+Tests for writing canonical JSON (RFC 8785).
+"""
+import pytest
+
+from yyjson import Document, ReaderFlags, WriterFlags, dumps
+
+
+@pytest.fixture(params=["immutable", "mutable"])
+def make_doc(request):
+    def make_doc(content, **kwargs):
+        doc = Document(content, **kwargs)
+        if request.param == "immutable":
+            doc.freeze()
+        else:
+            doc.thaw()
+        return doc
+
+    return make_doc
+
+
+def test_canonical_rfc_example(make_doc):
+    """
+    Ensure the example from section 3.2.2 of RFC 8785 is canonicalized
+    exactly.
+    """
+    doc = make_doc(
+        r"""{
+          "numbers": [333333333.33333329, 1E30, 4.50,
+                      2e-3, 0.000000000000000000000000001],
+          "string": "\u20ac$\u000F\u000aA'\u0042\u0022\u005c\\\"\/",
+          "literals": [null, true, false]
+        }"""
+    )
+
+    assert doc.dumps(flags=WriterFlags.CANONICAL) == (
+        '{"literals":[null,true,false],'
+        '"numbers":[333333333.3333333,1e+30,4.5,0.002,1e-27],'
+        '"string":"€$\\u000f\\nA\'B\\"\\\\\\\\\\"/"}'
+    )
+
+
+def test_canonical_key_order(make_doc):
+    """
+    Ensure object members are sorted by the UTF-16 code units of their
+    keys, which differs from code point order above U+FFFF.
+    """
+    doc = make_doc(
+        {
+            "€": "Euro Sign",
+            "\r": "Carriage Return",
+            "דּ": "Hebrew Letter Dalet With Dagesh",
+            "1": "One",
+            "\U0001f600": "Emoji: Grinning Face",
+            "\u0080": "Control",
+            "ö": "Latin Small Letter O With Diaeresis",
+            "": "Empty",
+            "11": "Eleven",
+        }
+    )
+
+    keys = list(Document(doc.dumps(flags=WriterFlags.CANONICAL)).as_obj)
+    assert keys == [
+        "",
+        "\r",
+        "1",
+        "11",
+        "\u0080",
+        "ö",
+        "€",
+        "\U0001f600",
+        "דּ",
+    ]
+
+
+@pytest.mark.parametrize(
+    "value,expected",
+    [
+        (0.0, "0"),
+        (-0.0, "0"),
+        (1.0, "1"),
+        (-1.5, "-1.5"),
+        (1e-6, "0.000001"),
+        (1e-7, "1e-7"),
+        (1e20, "100000000000000000000"),
+        (1e21, "1e+21"),
+        (5e-324, "5e-324"),
+        (1.7976931348623157e308, "1.7976931348623157e+308"),
+        (1 / 3, "0.3333333333333333"),
+        (2**53, "9007199254740992"),
+        (2**53 + 1, "9007199254740992"),
+        (2**64 - 1, "18446744073709552000"),
+        (-(2**63), "-9223372036854776000"),
+    ],
+)
+def test_canonical_numbers(value, expected):
+    """
+    Ensure numbers are formatted like ECMAScript's Number.toString().
+    """
+    assert dumps([value], flags=WriterFlags.CANONICAL) == f"[{expected}]"
+
+
+def test_canonical_flags(make_doc):
+    """
+    Ensure other flags are ignored, apart from a trailing newline, and that
+    values with no canonical form are rejected.
+    """
+    doc = make_doc({"b": [1, 2], "a": "/"})
+    flags = WriterFlags.CANONICAL | WriterFlags.PRETTY | WriterFlags.ESCAPE_SLASHES
+
+    assert doc.dumps(flags=flags) == '{"a":"/","b":[1,2]}'
+    assert doc.dumps(
+        flags=WriterFlags.CANONICAL | WriterFlags.WRITE_NEWLINE_AT_END,
+        at_pointer="/b",
+    ) == "[1,2]\n"
+
+    raw = make_doc("[4.50, 1e2]", flags=ReaderFlags.NUMBERS_AS_RAW)
+    assert raw.dumps(flags=WriterFlags.CANONICAL) == "[4.5,100]"
+
+    with pytest.raises(ValueError):
+        dumps([float("nan")], flags=WriterFlags.CANONICAL)
+
+    with pytest.raises(ValueError):
+        make_doc("[1e400]", flags=ReaderFlags.NUMBERS_AS_RAW).dumps(
+            flags=WriterFlags.CANONICAL
+        )
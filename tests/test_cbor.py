@@ -0,0 +1,298 @@
+import json
+import random
+import struct
+from decimal import Decimal
+
+import pytest
+
+from yyjson import Document, ReaderFlags
+
+CONTENT = (
+    '{"a": [1, -2, 18446744073709551615, -9223372036854775808, 2.5,'
+    ' "s\\u00e9\\"\\n", true, false, null, {}, [], [[{"k": "☃"}]]],'
+    ' "": {"b": "c"}}'
+)
+
+
+def test_cbor():
+    """
+    Ensure a Document survives CBOR unchanged.
+    """
+    doc = Document(CONTENT)
+    encoded = doc.to_cbor()
+    assert isinstance(encoded, bytes)
+
+    loaded = Document.from_cbor(encoded)
+    assert loaded == doc
+    assert loaded.as_obj == doc.as_obj
+    assert loaded.dumps() == doc.dumps()
+    assert not loaded.is_thawed
+    assert loaded.get_pointer("/a/11/0/0/k") == "☃"
+
+    assert Document.from_cbor(bytearray(encoded)) == doc
+    assert Document.from_cbor(memoryview(encoded)) == doc
+
+    for content in ("1", '"s"', "[]", "{}", "null"):
+        doc = Document(content)
+        assert Document.from_cbor(doc.to_cbor()) == doc
+
+
+def test_cbor_thawed():
+    """
+    Ensure thawed Documents are written the same as frozen ones.
+    """
+    doc = Document(CONTENT)
+    thawed = Document(CONTENT)
+    thawed.thaw()
+    assert thawed.to_cbor() == doc.to_cbor()
+
+    thawed.set("/a/0", {"new": [1, 2]})
+    loaded = Document.from_cbor(thawed.to_cbor())
+    assert loaded.get_pointer("/a/0") == {"new": [1, 2]}
+    assert loaded == thawed
+
+
+@pytest.mark.parametrize(
+    "value,encoded",
+    [
+        (0, b"\x00"),
+        (23, b"\x17"),
+        (24, b"\x18\x18"),
+        (255, b"\x18\xff"),
+        (256, b"\x19\x01\x00"),
+        (65536, b"\x1a\x00\x01\x00\x00"),
+        (4294967296, b"\x1b\x00\x00\x00\x01\x00\x00\x00\x00"),
+        (18446744073709551615, b"\x1b" + b"\xff" * 8),
+        (-1, b"\x20"),
+        (-24, b"\x37"),
+        (-25, b"\x38\x18"),
+        (-9223372036854775808, b"\x3b\x7f" + b"\xff" * 7),
+        (2.5, b"\xfb" + struct.pack(">d", 2.5)),
+        (None, b"\xf6"),
+        (False, b"\xf4"),
+        (True, b"\xf5"),
+        ("", b"\x60"),
+        ("a" * 24, b"\x78\x18" + b"a" * 24),
+        ("ü", b"\x62\xc3\xbc"),
+        ([], b"\x80"),
+        ([1, [2]], b"\x82\x01\x81\x02"),
+        ({}, b"\xa0"),
+        ({"a": None}, b"\xa1\x61a\xf6"),
+    ],
+)
+def test_cbor_encodings(value, encoded):
+    """
+    Ensure values use the smallest CBOR encoding that holds them, and are
+    read back from it.
+    """
+    assert Document(json.dumps(value)).to_cbor() == encoded
+    assert Document.from_cbor(encoded).as_obj == value
+
+
+@pytest.mark.parametrize(
+    "encoded,value",
+    [
+        # Wider encodings than needed, and 16 and 32-bit floats.
+        (b"\x1b" + b"\x00" * 7 + b"\x01", 1),
+        (b"\xf9\x3e\x00", 1.5),
+        (b"\xf9\x00\x01", 2.0**-24),
+        (b"\xf9\xfc\x00", float("-inf")),
+        (b"\xfa" + struct.pack(">f", 0.5), 0.5),
+        # Indefinite lengths.
+        (b"\x9f\x01\x9f\xff\xff", [1, []]),
+        (b"\xbf\x61a\x01\x61b\xbf\xff\xff", {"a": 1, "b": {}}),
+        (b"\x7f\x62ab\x60\x61c\xff", "abc"),
+        (b"\x7f\xff", ""),
+        (b"\xa1\x7f\x61k\xff\x9f\xff", {"k": []}),
+        # Tags without a JSON equivalent keep their content.
+        (b"\xd9\xd9\xf7\x81\x01", [1]),
+        (b"\xc0\x74" + b"2013-03-21T20:04:00Z", "2013-03-21T20:04:00Z"),
+        (b"\xc1\xc1\x01", 1),
+        (b"\xf7", None),
+    ],
+)
+def test_cbor_read(encoded, value):
+    """
+    Ensure the encodings we don't write are read.
+    """
+    assert Document.from_cbor(encoded).as_obj == value
+
+
+@pytest.mark.parametrize(
+    "encoded,value",
+    [
+        (b"\xc2\x41\x01", 1),
+        (b"\xc2\x40", 0),
+        (b"\xc3\x40", -1),
+        (b"\xc2\x48" + b"\xff" * 8, 18446744073709551615),
+        (b"\xc3\x48\x7f" + b"\xff" * 7, -9223372036854775808),
+        (b"\xc3\x48\x80" + b"\x00" * 7, Decimal("-9223372036854775809")),
+        (b"\xc2\x49\x01" + b"\x00" * 8, Decimal(2**64)),
+        (b"\xc3\x49\x01" + b"\x00" * 8, Decimal(-(2**64) - 1)),
+        (b"\x3b" + b"\xff" * 8, Decimal(-(2**64))),
+        (b"\xc4\x82\x21\x19\x6a\xb3", Decimal("273.15")),
+        (b"\xc4\x82\x20\x24", Decimal("-0.5")),
+        (b"\xc4\x82\x02\x01", Decimal("1e2")),
+        (b"\xc4\x82\x00\x01", Decimal("1")),
+        (
+            b"\xc4\x82\x38\x1f\xc2\x49\x01" + b"\x00" * 8,
+            Decimal(2**64).scaleb(-32),
+        ),
+    ],
+)
+def test_cbor_big_numbers(encoded, value):
+    """
+    Ensure bignums and decimal fractions are read as numbers, and as
+    Decimals when they don't fit in 64 bits, like BIG_NUMBERS_AS_DECIMAL.
+    """
+    doc = Document.from_cbor(encoded)
+    assert doc.as_obj == value
+    assert type(doc.as_obj) is type(value)
+    assert Document.from_cbor(doc.to_cbor()).as_obj == value
+
+
+def test_cbor_raw_numbers():
+    """
+    Ensure raw numbers are written exactly, and survive CBOR as raw
+    numbers.
+    """
+    content = (
+        "[1, -1, 2.5, -0.001, 1e400, 1.50, 0.0, 12345678901234567890123,"
+        " -12345678901234567890123, 18446744073709551616, 1E-7, 5e+3]"
+    )
+    doc = Document(content, flags=ReaderFlags.NUMBERS_AS_DECIMAL)
+    loaded = Document.from_cbor(doc.to_cbor())
+    assert loaded.as_obj == doc.as_obj
+    assert [str(v) for v in loaded.as_obj[2:]] == [
+        str(v) for v in doc.as_obj[2:]
+    ]
+
+    doc = Document(content, flags=ReaderFlags.BIG_NUMBERS_AS_DECIMAL)
+    assert Document.from_cbor(doc.to_cbor()).as_obj == doc.as_obj
+
+    # Raw numbers that aren't decimal are written as reals.
+    doc = Document(
+        "[NaN, -Infinity]",
+        flags=ReaderFlags.NUMBERS_AS_RAW | ReaderFlags.ALLOW_INF_AND_NAN,
+    )
+    assert doc.to_cbor() == b"\x82\xfb\x7f\xf8" + b"\x00" * 6 + (
+        b"\xfb\xff\xf0" + b"\x00" * 6
+    )
+
+
+def test_cbor_large():
+    """
+    Ensure inputs large enough to be read without the GIL are read
+    correctly.
+    """
+    value = [
+        {"id": i, "name": f"item {i}", "tags": ["a", "b"]} for i in range(5000)
+    ]
+    doc = Document(value)
+    encoded = doc.to_cbor()
+    assert len(encoded) > 64 * 1024
+
+    loaded = Document.from_cbor(encoded)
+    assert loaded == doc
+    assert loaded.as_obj == value
+
+    with pytest.raises(ValueError, match="unexpected end of data"):
+        Document.from_cbor(encoded[:-1])
+
+
+@pytest.mark.parametrize(
+    "encoded,message",
+    [
+        (b"", "unexpected end of data at position 0"),
+        (b"\x82\x01", "unexpected end of data at position 2"),
+        (b"\x19\x01", "unexpected end of data at position 0"),
+        (b"\x62a", "unexpected end of data at position 0"),
+        (b"\x9f\x01", "unexpected end of data at position 2"),
+        (b"\x01\x02", "unexpected data after the value at position 1"),
+        (b"\xa1\x01\x02", "object keys must be strings at position 1"),
+        (b"\xbf\xf6\x01\xff", "object keys must be strings at position 1"),
+        (b"\xbf\x61a\xff", "object key without a value at position 3"),
+        (b"\xff", "unexpected break at position 0"),
+        (b"\x81\xff", "unexpected break at position 1"),
+        (b"\x61\xff", "string is not valid UTF-8 at position 0"),
+        (b"\x7f\x61\xc3\x61\xbc\xff", "string is not valid UTF-8"),
+        (b"\x7f\x41a\xff", "invalid string chunk"),
+        (b"\x7f\x7f\xff\xff", "invalid string chunk"),
+        (b"\x41a", "byte strings can't be represented as JSON"),
+        (b"\x5f\xff", "byte strings can't be represented as JSON"),
+        (b"\xf0", "simple values can't be represented as JSON"),
+        (b"\xf8\xff", "simple values can't be represented as JSON"),
+        (b"\x1c", "invalid additional information"),
+        (b"\x1f", "invalid additional information"),
+        (b"\xc2\x01", "bignums must be definite-length byte strings"),
+        (b"\xc2\x5f\xff", "bignums must be definite-length byte strings"),
+        (b"\xc2\x59\x10\x01" + b"\x01" * 4097, "bignum is too large"),
+        (b"\xc4\x01", "invalid decimal fraction"),
+        (b"\xc4\x83\x01\x01\x01", "invalid decimal fraction"),
+        (b"\xc4\x82\x01\x61a", "invalid decimal fraction"),
+        (b"\xc4\x82\xc2\x49" + b"\x01" * 9 + b"\x01", "exponent is too large"),
+    ],
+)
+def test_cbor_invalid(encoded, message):
+    """
+    Ensure invalid CBOR, and values that can't be represented as JSON, are
+    rejected.
+    """
+    with pytest.raises(ValueError, match=message):
+        Document.from_cbor(encoded)
+
+
+def test_cbor_too_large():
+    """
+    Ensure raw numbers too large to write are rejected rather than written
+    in quadratic time.
+    """
+    doc = Document("1" * 10000, flags=ReaderFlags.NUMBERS_AS_DECIMAL)
+    with pytest.raises(ValueError, match="too large for CBOR"):
+        doc.to_cbor()
+
+
+def test_cbor_truncated():
+    """
+    Ensure every truncation of a valid value is rejected cleanly.
+    """
+    encoded = Document(CONTENT).to_cbor()
+    for i in range(len(encoded)):
+        with pytest.raises(ValueError):
+            Document.from_cbor(encoded[:i])
+
+
+def test_cbor_fuzz():
+    """
+    Ensure corrupted CBOR either loads or raises a ValueError.
+    """
+    rng = random.Random(0)
+    encoded = bytearray(Document(CONTENT).to_cbor())
+    for _ in range(2000):
+        corrupt = bytearray(encoded)
+        for _ in range(rng.randint(1, 4)):
+            corrupt[rng.randrange(len(corrupt))] = rng.randrange(256)
+        try:
+            doc = Document.from_cbor(corrupt)
+        except ValueError:
+            continue
+        assert Document.from_cbor(doc.to_cbor()) == doc
+
+
+def test_cbor_compat():
+    """
+    Ensure the cbor2 package agrees with us, when it's installed.
+    """
+    cbor2 = pytest.importorskip("cbor2")
+
+    doc = Document(CONTENT)
+    assert cbor2.loads(doc.to_cbor()) == doc.as_obj
+    assert Document.from_cbor(cbor2.dumps(doc.as_obj)) == doc
+
+    values = [2**100, -(2**100), Decimal("-12.345"), Decimal("1e-30")]
+    assert Document.from_cbor(cbor2.dumps(values)).as_obj == values
+    doc = Document(
+        "[1267650600228229401496703205376, -12.345, 1e-30]",
+        flags=ReaderFlags.NUMBERS_AS_DECIMAL,
+    )
+    assert cbor2.loads(doc.to_cbor()) == doc.as_obj
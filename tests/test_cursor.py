@@ -0,0 +1,184 @@
+"""
+Tests for the on-demand Cursor API.
+"""
+import pytest
+
+from yyjson import Cursor, ReaderFlags
+
+
+DOC = b"""{
+    "kind": "batch",
+    "meta": {"skipped": [1, 2, {"deep": ["]", "}"]}], "count": 3},
+    "items": [
+        {"id": 1, "name": "a\\u00e9", "tags": ["x", "y"]},
+        {"id": 2, "name": "b", "score": 1.5},
+        {"name": "c", "id": 3}
+    ],
+    "ok": true,
+    "nothing": null
+}"""
+
+
+def test_cursor_find_field():
+    """
+    Ensure fields can be found in order, skipping everything before them.
+    """
+    cursor = Cursor(DOC)
+    assert cursor.find_field("kind").get_str() == "batch"
+    assert cursor.find_field("ok").get_bool() is True
+    assert cursor.find_field("nothing").is_null()
+
+    cursor = Cursor(DOC)
+    assert cursor.find_field("meta").find_field("count").get_int() == 3
+
+
+def test_cursor_find_field_missing():
+    """
+    Ensure a missing field raises a KeyError, leaving the object.
+    """
+    cursor = Cursor(DOC)
+    assert cursor.find_field("ok").get_bool() is True
+
+    # Fields must be found in the order they appear.
+    with pytest.raises(KeyError):
+        cursor.find_field("kind")
+    assert cursor.depth == 0
+
+    cursor = Cursor(b'{"a": 1}')
+    with pytest.raises(TypeError):
+        cursor.find_field("a").find_field("b")
+
+
+def test_cursor_iter_array():
+    """
+    Ensure arrays can be iterated, skipping what's left of each element.
+    """
+    cursor = Cursor(DOC)
+    ids = [
+        item.find_field("id").get_int()
+        for item in cursor.find_field("items").iter_array()
+    ]
+    assert ids == [1, 2, 3]
+
+    # The cursor is back in the root object.
+    assert cursor.find_field("ok").get_bool() is True
+
+    cursor = Cursor(b"[[1, 2], [], [3]]")
+    assert [
+        [v.get_int() for v in row.iter_array()]
+        for row in cursor.iter_array()
+    ] == [[1, 2], [], [3]]
+
+
+def test_cursor_skip():
+    """
+    Ensure skip() skips the value at the cursor, or the rest of a container.
+    """
+    cursor = Cursor(DOC)
+    cursor.find_field("meta").find_field("skipped")
+    assert cursor.type == "array"
+    cursor.skip()
+    assert cursor.type is None
+    assert cursor.find_field("count").get_int() == 3
+
+    cursor = Cursor(DOC)
+    cursor.find_field("meta").find_field("skipped").skip()
+    cursor.skip()
+    assert cursor.depth == 1
+    assert cursor.find_field("ok").get_bool() is True
+
+
+def test_cursor_getters():
+    """
+    Ensure scalars are read and type checked.
+    """
+    cursor = Cursor(DOC)
+    items = cursor.find_field("items").iter_array()
+
+    item = next(items)
+    item.find_field("id")
+    assert item.type == "number"
+    assert item.get_int() == 1
+    assert item.find_field("name").get_str() == "aé"
+    assert item.find_field("tags").get_value() == ["x", "y"]
+
+    item = next(items)
+    item.find_field("score")
+    with pytest.raises(TypeError):
+        item.get_int()
+    assert item.get_float() == 1.5
+
+    assert Cursor(b'{"n": 18446744073709551616}').find_field("n").get_int() == (
+        18446744073709551616
+    )
+    assert Cursor(b'"\\u00e9"').get_str() == "é"
+
+    cursor = Cursor(b'{"a": "1"}').find_field("a")
+    with pytest.raises(TypeError):
+        cursor.get_int()
+    with pytest.raises(TypeError):
+        cursor.get_bool()
+    assert not cursor.is_null()
+    assert cursor.get_str() == "1"
+
+    # A consumed value can't be read again.
+    with pytest.raises(ValueError):
+        cursor.get_str()
+
+
+def test_cursor_invalid():
+    """
+    Ensure malformed input is reported with its position.
+    """
+    with pytest.raises(ValueError, match="position"):
+        list(Cursor(b"[1, 2").iter_array())
+
+    with pytest.raises(ValueError, match="position"):
+        Cursor(b'{"a" 1}').find_field("a")
+
+    with pytest.raises(ValueError):
+        Cursor(b"  ")
+
+    with pytest.raises(TypeError):
+        Cursor(1)
+
+    with pytest.raises(ValueError):
+        list(Cursor(b"[1, 2,]").iter_array())
+
+    cursor = Cursor(
+        b"[1, /* two */ 2,]",
+        flags=ReaderFlags.ALLOW_TRAILING_COMMAS | ReaderFlags.ALLOW_COMMENTS,
+    )
+    assert [v.get_int() for v in cursor.iter_array()] == [1, 2]
+
+
+def test_cursor_invalid_scalars():
+    """
+    Ensure strings and literals a Document rejects aren't read as valid.
+    """
+    with pytest.raises(ValueError, match="control character.* position 2$"):
+        Cursor(b'"a\tb"').get_str()
+    with pytest.raises(ValueError, match="invalid UTF-8.* position 2$"):
+        Cursor(b'"a\xffb"').get_str()
+
+    with pytest.raises(TypeError):
+        Cursor(b"truex").get_bool()
+    with pytest.raises(TypeError):
+        Cursor(b"falsey").get_bool()
+    assert not Cursor(b"nullx").is_null()
+
+    assert Cursor(b"true").get_bool() is True
+    assert [v.is_null() for v in Cursor(b"[null,null ]").iter_array()] == [
+        True,
+        True,
+    ]
+
+
+def test_cursor_str_input():
+    """
+    Ensure str input is supported and kept alive by the cursor.
+    """
+    cursor = Cursor('{"' + "k" * 3 + '": ["é"]}')
+    assert [v.get_str() for v in cursor.find_field("kkk").iter_array()] == [
+        "é"
+    ]
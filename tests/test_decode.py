@@ -0,0 +1,180 @@
+"""
+Tests for decoding JSON directly into typed Python objects.
+"""
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple, TypedDict, Union
+
+import pytest
+
+from yyjson import Document, ReaderFlags, decode
+
+
+@dataclass
+class Point:
+    x: float
+    y: float
+    label: Optional[str] = None
+
+
+@dataclass
+class Node:
+    value: int
+    children: "List[Node]" = field(default_factory=list)
+
+
+class Movie(TypedDict):
+    title: str
+    year: int
+
+
+class PartialMovie(TypedDict, total=False):
+    title: str
+    year: int
+
+
+@pytest.mark.parametrize(
+    "content,tp,expected",
+    [
+        ("1", int, 1),
+        ("1", float, 1.0),
+        ("1.5", float, 1.5),
+        ('"a"', str, "a"),
+        ("true", bool, True),
+        ("null", None, None),
+        ('{"a": [1]}', Any, {"a": [1]}),
+        ("[1, 2]", List[int], [1, 2]),
+        ("[1, 2]", list, [1, 2]),
+        ("[1, 2]", Tuple[int, ...], (1, 2)),
+        ('[1, "a"]', Tuple[int, str], (1, "a")),
+        ('{"a": 1}', Dict[str, int], {"a": 1}),
+        ('[1, null, "a"]', List[Union[int, None, str]], [1, None, "a"]),
+    ],
+)
+def test_decode_types(content, tp, expected):
+    """
+    Ensure builtin and typing types are decoded.
+    """
+    result = decode(content, tp)
+    assert result == expected
+    assert type(result) is type(expected)
+
+
+def test_decode_dataclass():
+    """
+    Ensure dataclasses are built from objects, using their defaults and
+    ignoring unknown members.
+    """
+    assert decode(b'{"y": 2, "x": 1, "z": 3}', Point) == Point(1.0, 2.0)
+    assert decode('[{"x": 1, "y": 2, "label": "a"}]', List[Point]) == [
+        Point(1.0, 2.0, "a")
+    ]
+
+    # Recursive dataclasses.
+    assert decode('{"value": 1, "children": [{"value": 2}]}', Node) == Node(
+        1, [Node(2)]
+    )
+
+    with pytest.raises(ValueError, match="missing required field `y`"):
+        decode('{"x": 1}', Point)
+
+
+def test_decode_typeddict():
+    """
+    Ensure TypedDicts are built from objects, checking required keys.
+    """
+    assert decode('{"title": "a", "year": 1, "extra": 2}', Movie) == {
+        "title": "a",
+        "year": 1,
+    }
+    assert decode('{"year": 1}', PartialMovie) == {"year": 1}
+
+    with pytest.raises(ValueError, match="missing required field `title`"):
+        decode('{"year": 1}', Movie)
+
+
+@pytest.mark.parametrize(
+    "content,tp,message",
+    [
+        ('"1"', int, "expected integer, got string$"),
+        ("1.5", int, "expected integer, got number$"),
+        ("[1, 2, {}]", List[int], "expected integer, got object at /2$"),
+        (
+            '{"a/b": {"c~d": [true]}}',
+            Dict[str, Dict[str, List[str]]],
+            "expected string, got boolean at /a~1b/c~0d/0$",
+        ),
+        (
+            '{"value": 1, "children": [{"value": null}]}',
+            Node,
+            "expected integer, got null at /children/0/value$",
+        ),
+        ("[true]", List[Optional[int]], "expected integer or null, got boolean"),
+    ],
+)
+def test_decode_type_errors(content, tp, message):
+    """
+    Ensure type errors point at the offending value.
+    """
+    with pytest.raises(TypeError, match=message):
+        decode(content, tp)
+
+
+def test_decode_errors():
+    """
+    Ensure other errors are reported.
+    """
+    with pytest.raises(ValueError, match="length 2, got length 3"):
+        decode("[1, 2, 3]", Tuple[int, int])
+
+    with pytest.raises(ValueError, match="missing required field `x` at /1"):
+        decode('[{"x": 1, "y": 2}, {"y": 2}]', List[Point])
+
+    with pytest.raises(TypeError):
+        decode("{}", Dict[int, int])
+
+    with pytest.raises(TypeError):
+        decode("1", complex)
+
+    with pytest.raises(ValueError):
+        decode("[1", List[int])
+
+
+def test_decode_documents_and_flags():
+    """
+    Ensure Documents and reader flags are supported.
+    """
+    doc = Document('{"x": 1, "y": 2}')
+    assert decode(doc, Point) == Point(1.0, 2.0)
+    doc.thaw()
+    assert decode(doc, Point) == Point(1.0, 2.0)
+
+    big = "18446744073709551616"
+    assert decode(big, int, flags=ReaderFlags.BIG_NUMBERS_AS_DECIMAL) == int(
+        big
+    )
+    assert decode("[1,]", List[int], flags=ReaderFlags.ALLOW_TRAILING_COMMAS) == [
+        1
+    ]
+
+
+def test_decode_document_busy():
+    """
+    Ensure constructors can't thaw the Document being decoded from under
+    the decoder.
+    """
+    doc = Document('[{"x": 1, "y": 2}, {"x": 3, "y": 4}]')
+
+    @dataclass
+    class Thawing:
+        x: float
+        y: float
+
+        def __post_init__(self):
+            doc.thaw()
+
+    with pytest.raises(BufferError):
+        decode(doc, List[Thawing])
+
+    # Thawed Documents are decoded from a copy, which can't be freed.
+    doc.thaw()
+    assert decode(doc, List[Thawing]) == [Thawing(1, 2), Thawing(3, 4)]
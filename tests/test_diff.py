@@ -0,0 +1,109 @@
+"""
+Tests for generating JSON Patches (RFC 6902) with Document.diff.
+"""
+from pathlib import Path
+
+import pytest
+
+from yyjson import Document
+
+
+@pytest.fixture(params=[(False, False), (True, False), (False, True), (True, True)])
+def make_docs(request):
+    def make_docs(src, dst):
+        src, dst = Document(src), Document(dst)
+        if request.param[0]:
+            src.freeze()
+        if request.param[1]:
+            dst.freeze()
+        return src, dst
+
+    return make_docs
+
+
+@pytest.mark.parametrize(
+    "src,dst,expected",
+    [
+        ({"a": 1}, {"a": 1}, []),
+        ({"a": 1}, {"a": 1.0}, []),
+        ({"a": 1}, {"a": True}, [{"op": "replace", "path": "/a", "value": True}]),
+        ({"a": {"b": 1}}, [1], [{"op": "replace", "path": "", "value": [1]}]),
+        (
+            {"a": 1, "b": 2},
+            {"b": 3, "c": 4},
+            [
+                {"op": "remove", "path": "/a"},
+                {"op": "replace", "path": "/b", "value": 3},
+                {"op": "add", "path": "/c", "value": 4},
+            ],
+        ),
+        (
+            {"a/b": {"m~n": 1}},
+            {"a/b": {"m~n": 2}},
+            [{"op": "replace", "path": "/a~1b/m~0n", "value": 2}],
+        ),
+        (
+            [1, 2, 3, 4],
+            [1, 3, 4, 5],
+            [
+                {"op": "remove", "path": "/1"},
+                {"op": "add", "path": "/3", "value": 5},
+            ],
+        ),
+        (
+            [{"id": 1, "n": "a"}, {"id": 2, "n": "b"}],
+            [{"id": 1, "n": "a"}, {"id": 2, "n": "c"}],
+            [{"op": "replace", "path": "/1/n", "value": "c"}],
+        ),
+    ],
+)
+def test_diff(make_docs, src, dst, expected):
+    """
+    Ensure diffs are minimal for simple changes, and turn one Document into
+    the other.
+    """
+    src, dst = make_docs(src, dst)
+
+    patch = src.diff(dst)
+    assert patch.as_obj == expected
+    assert src.patch(patch).as_obj == dst.as_obj
+
+
+def test_diff_samples(make_docs):
+    """
+    Ensure the diff between each sample document and its patched result
+    recreates the result.
+    """
+    tests = Document(Path(__file__).parent / "tests.json").as_obj
+
+    for test in tests:
+        if test.get("disabled") or test.get("error"):
+            continue
+
+        src, dst = make_docs(test["doc"], test["expected"])
+        assert src.patch(src.diff(dst)).as_obj == test["expected"]
+        assert dst.patch(dst.diff(src)).as_obj == test["doc"]
+
+
+def test_diff_large_arrays():
+    """
+    Ensure arrays too large to align precisely still produce a valid patch.
+    """
+    src = list(range(5000))
+    dst = [n * 2 for n in reversed(src)]
+
+    patch = Document(src).diff(Document(dst))
+    assert Document(src).patch(patch).as_obj == dst
+
+    src = list(range(100000))
+    dst = src[:10] + ["new"] + src[10:]
+    patch = Document(src).diff(Document(dst))
+    assert patch.as_obj == [{"op": "add", "path": "/10", "value": "new"}]
+
+
+def test_diff_invalid():
+    """
+    Ensure only Documents can be diffed.
+    """
+    with pytest.raises(TypeError):
+        Document({"a": 1}).diff({"a": 2})
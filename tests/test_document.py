@@ -24,6 +24,9 @@ def test_document_from_str():
     doc = Document('{"hello": "world"}')
     assert doc.as_obj == {"hello": "world"}
 
+    doc = Document('{"héllo": "wörld 😀"}')
+    assert doc.as_obj == {"héllo": "wörld 😀"}
+
 
 def test_document_types():
     """Ensure each primitive type can be upcast (which does not have its own
@@ -240,3 +243,48 @@ def test_document_freeze():
 
     doc.freeze()
     assert doc.is_thawed is False
+
+
+def test_document_to_obj_object_hooks():
+    """
+    Ensure to_obj() calls object hooks on both immutable and mutable
+    documents, and passes errors raised by them through.
+    """
+    doc = Document('{"a": {"b": [1, {"c": null}]}, "d": "e"}')
+    for _ in range(2):
+        assert doc.to_obj(object_pairs_hook=list) == [
+            ("a", [("b", [1, [("c", None)]])]),
+            ("d", "e"),
+        ]
+        assert doc.to_obj(object_hook=len) == 2
+        doc.thaw()
+
+    def fail(value):
+        raise RuntimeError("hook failed")
+
+    with pytest.raises(RuntimeError, match="hook failed"):
+        doc.to_obj(object_hook=fail)
+
+    with pytest.raises(RuntimeError, match="hook failed"):
+        doc.to_obj(object_pairs_hook=fail)
+
+
+@pytest.mark.parametrize("hook", ["object_hook", "object_pairs_hook"])
+@pytest.mark.parametrize("action", ["freeze", "thaw"])
+def test_document_to_obj_object_hooks_busy(hook, action):
+    """
+    Ensure object hooks can't free the Document while it's being converted.
+    """
+    doc = Document('{"a": {"b": 1}, "c": [{"d": 2}], "e": 3}')
+    if action == "freeze":
+        doc.thaw()
+
+    def convert(value):
+        getattr(doc, action)()
+        return value
+
+    with pytest.raises(BufferError):
+        doc.to_obj(**{hook: convert})
+
+    getattr(doc, action)()
+    assert doc.as_obj == {"a": {"b": 1}, "c": [{"d": 2}], "e": 3}
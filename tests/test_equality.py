@@ -0,0 +1,121 @@
+"""
+Tests for Document equality and content hashing.
+"""
+from decimal import Decimal
+
+import pytest
+
+from yyjson import Document, ReaderFlags
+
+
+def make(content, frozen):
+    doc = Document(content)
+    if frozen:
+        doc.freeze()
+    return doc
+
+
+@pytest.mark.parametrize("lhs_frozen", [True, False])
+@pytest.mark.parametrize("rhs_frozen", [True, False])
+@pytest.mark.parametrize(
+    "lhs,rhs,equal",
+    [
+        ({"a": 1, "b": 2}, {"b": 2, "a": 1}, True),
+        ({"a": [1, {"x": "y"}]}, {"a": [1.0, {"x": "y"}]}, True),
+        ([1, 2], [2, 1], False),
+        ({"a": 1}, {"a": 1, "b": None}, False),
+        ({"a": True}, {"a": 1}, False),
+        ({"a": None}, {"a": False}, False),
+        ({"a": "b"}, {"a": "b "}, False),
+        ([-1], [18446744073709551615], False),
+        ([0.0], [-0.0], True),
+    ],
+)
+def test_equality(lhs, rhs, equal, lhs_frozen, rhs_frozen):
+    """
+    Ensure Documents compare by content regardless of object member order
+    or representation, and that equal Documents hash the same.
+    """
+    a = make(lhs, lhs_frozen)
+    b = make(rhs, rhs_frozen)
+
+    assert (a == b) is equal
+    assert (a != b) is not equal
+
+    if equal:
+        assert a.content_hash() == b.content_hash()
+        assert a.content_hash(bits=128) == b.content_hash(bits=128)
+    else:
+        assert a.content_hash(bits=128) != b.content_hash(bits=128)
+
+
+@pytest.mark.parametrize(
+    "lhs,rhs,equal",
+    [
+        ('{"a": 1.5}', '{"a": 1.5}', True),
+        ('{"a": 1.50}', '{"a": 1.5}', True),
+        ("[1, 2.0]", "[1.0, 2]", True),
+        ("[1e2]", "[100]", True),
+        ("[-0]", "[0.0]", True),
+        ("[123456789012345678901234567890]", "[1.2345678901234568e29]", True),
+        ("[1.5]", "[1.25]", False),
+    ],
+)
+@pytest.mark.parametrize(
+    "lhs_flags", [0, ReaderFlags.NUMBERS_AS_RAW, ReaderFlags.NUMBERS_AS_DECIMAL]
+)
+def test_equality_raw_numbers(lhs, rhs, equal, lhs_flags):
+    """
+    Ensure raw numbers compare and hash by value, both with each other and
+    with parsed numbers.
+    """
+    for rhs_flags in (0, ReaderFlags.NUMBERS_AS_RAW):
+        a = Document(lhs, flags=lhs_flags)
+        b = Document(rhs, flags=rhs_flags)
+
+        assert (a == b) is equal
+        assert (a.content_hash() == b.content_hash()) is equal
+
+    a = Document([Decimal("2.50")])
+    b = Document([2.5])
+    assert a == b
+    assert a.content_hash() == b.content_hash()
+
+
+def test_content_hash():
+    """
+    Ensure content hashes are stable, sized as requested and distinguish
+    containers and types.
+    """
+    doc = Document('{"a": [1, "x", null, true]}')
+
+    assert 0 <= doc.content_hash() < 2**64
+    assert 0 <= doc.content_hash(bits=128) < 2**128
+    assert doc.content_hash(bits=128) & (2**64 - 1) == doc.content_hash()
+    assert doc.content_hash() == Document(doc.dumps()).content_hash()
+
+    hashes = {
+        Document(content).content_hash()
+        for content in ([], {}, [[]], [{}], [None], [False], [0], [""], ["0"])
+    }
+    assert len(hashes) == 9
+
+    with pytest.raises(ValueError):
+        doc.content_hash(bits=32)
+
+
+def test_hashable():
+    """
+    Ensure only frozen Documents can be hashed, and can be used to dedupe.
+    """
+    frozen = [
+        make(content, True)
+        for content in ({"a": 1, "b": 2}, {"b": 2, "a": 1.0}, {"a": 2})
+    ]
+    assert len(set(frozen)) == 2
+    assert hash(frozen[0]) == hash(frozen[1])
+
+    with pytest.raises(TypeError):
+        hash(Document({"a": 1}))
+
+    assert Document({"a": 1}) != {"a": 1}
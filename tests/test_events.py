@@ -0,0 +1,188 @@
+import io
+import math
+from decimal import Decimal
+
+import pytest
+
+from yyjson import Document, ReaderFlags, iter_events
+
+CONTENT = (
+    '{"a": [1, -2.5, 1e3, "s\\u00e9\\"q", true, false, null],'
+    ' "b": {}, "c": [], "d": {"e": [[{"f": "héllo ☃"}]]}}'
+)
+
+
+def build(events):
+    """
+    Rebuild Python objects from events, to check them against as_obj.
+    """
+    stack = [[]]
+    keys = []
+    for event, value in events:
+        if event in ("start_map", "start_array"):
+            stack.append({} if event == "start_map" else [])
+            continue
+        if event == "map_key":
+            keys.append(value)
+            continue
+        if event in ("end_map", "end_array"):
+            value = stack.pop()
+        top = stack[-1]
+        if isinstance(top, dict):
+            top[keys.pop()] = value
+        else:
+            top.append(value)
+    return stack[0][0]
+
+
+def test_iter_events():
+    """
+    Ensure the events of a document describe it exactly.
+    """
+    events = list(iter_events('{"a": [1, "b"], "c": null}'))
+    assert events == [
+        ("start_map", None),
+        ("map_key", "a"),
+        ("start_array", None),
+        ("number", 1),
+        ("string", "b"),
+        ("end_array", None),
+        ("map_key", "c"),
+        ("null", None),
+        ("end_map", None),
+    ]
+
+    expected = Document(CONTENT).as_obj
+    assert build(iter_events(CONTENT)) == expected
+    assert build(iter_events(CONTENT.encode())) == expected
+    assert build(iter_events(memoryview(CONTENT.encode()))) == expected
+
+    assert list(iter_events("12")) == [("number", 12)]
+    assert list(iter_events(b' "x" ')) == [("string", "x")]
+
+
+def test_iter_events_files(tmp_path):
+    """
+    Ensure files are read in chunks, with tokens split across chunks, from
+    a Path or a file object in either mode.
+    """
+    expected = Document(CONTENT).as_obj
+    path = tmp_path / "test.json"
+    path.write_text(CONTENT, encoding="utf-8")
+
+    for chunk_size in (1, 2, 3, 7, 64, 65536):
+        assert build(iter_events(path, chunk_size=chunk_size)) == expected
+        with open(path, "rb") as fp:
+            assert build(iter_events(fp, chunk_size=chunk_size)) == expected
+        with open(path, encoding="utf-8") as fp:
+            assert build(iter_events(fp, chunk_size=chunk_size)) == expected
+
+
+def test_iter_events_bounded_memory():
+    """
+    Ensure a large document is streamed rather than read all at once.
+    """
+
+    class CountingReader(io.RawIOBase):
+        def __init__(self, data):
+            self.data = io.BytesIO(data)
+            self.largest = 0
+
+        def read(self, n):
+            self.largest = max(self.largest, n)
+            return self.data.read(n)
+
+    data = b"[" + b",".join(b'{"id": %d}' % i for i in range(10000)) + b"]"
+    reader = CountingReader(data)
+    events = iter_events(reader, chunk_size=1024)
+    count = sum(1 for event, _ in events if event == "number")
+    assert count == 10000
+    assert reader.largest == 1024
+
+
+def test_iter_events_flags():
+    """
+    Ensure reader flags apply.
+    """
+    content = '/* c */ [1, // d\n NaN, 1.5,] // e'
+    flags = (
+        ReaderFlags.ALLOW_COMMENTS
+        | ReaderFlags.ALLOW_INF_AND_NAN
+        | ReaderFlags.ALLOW_TRAILING_COMMAS
+    )
+    events = list(iter_events(content, flags=flags))
+    assert [event for event, _ in events] == [
+        "start_array",
+        "number",
+        "number",
+        "number",
+        "end_array",
+    ]
+    assert math.isnan(events[2][1])
+
+    events = list(
+        iter_events("[1.10, 2]", flags=ReaderFlags.NUMBERS_AS_DECIMAL)
+    )
+    assert events[1] == ("number", Decimal("1.10"))
+
+    events = iter_events('{"a": 1} {"b": 2}', flags=ReaderFlags.STOP_WHEN_DONE)
+    assert len(list(events)) == 4
+
+
+@pytest.mark.parametrize(
+    "content,position",
+    [
+        ('{"a" 1}', 5),
+        ("[1 2]", 3),
+        ("[1, 2", 5),
+        ('["a]', 1),
+        ("[tru]", 1),
+        ("[nul]", 1),
+        ("[truex]", 1),
+        ('["a\tb"]', 3),
+        ('{"\x01": 1}', 2),
+        ("[1.]", 3),
+        ("{1: 2}", 1),
+        ("[] []", 3),
+        ("", 0),
+    ],
+)
+def test_iter_events_errors(content, position):
+    """
+    Ensure invalid JSON raises when it's reached, with its position.
+    """
+    with pytest.raises(ValueError, match=f"at position {position}$"):
+        list(iter_events(content))
+
+    with pytest.raises(ValueError, match=f"at position {position}$"):
+        list(iter_events(io.BytesIO(content.encode()), chunk_size=1))
+
+
+def test_iter_events_invalid_strings():
+    """
+    Ensure strings and literals a Document rejects raise the same kind of
+    error, rather than a UnicodeDecodeError or a number's error.
+    """
+    with pytest.raises(ValueError, match="invalid UTF-8.* at position 3$"):
+        list(iter_events(b'["a\xffb"]'))
+
+    with pytest.raises(ValueError, match="control character"):
+        list(iter_events(b'{"a": "\n"}'))
+
+    with pytest.raises(ValueError, match="^invalid literal"):
+        list(iter_events(b"[truex]"))
+
+
+def test_iter_events_lazy():
+    """
+    Ensure events before an error are yielded first.
+    """
+    events = iter_events("[1, 2, x]")
+    assert next(events) == ("start_array", None)
+    assert next(events) == ("number", 1)
+    assert next(events) == ("number", 2)
+    with pytest.raises(ValueError):
+        next(events)
+
+    with pytest.raises(TypeError):
+        iter_events(12)
@@ -0,0 +1,102 @@
+"""
+Tests for packing arrays of numbers into array.array.
+"""
+import array
+
+import pytest
+
+from yyjson import Document, ReaderFlags
+
+
+@pytest.fixture(params=[False, True], ids=["frozen", "thawed"])
+def thawed(request):
+    return request.param
+
+
+def make_doc(content, thawed, **kwargs):
+    doc = Document(content, **kwargs)
+    if thawed:
+        doc.thaw()
+    return doc
+
+
+def test_get_array_floats(thawed):
+    """
+    Ensure any numbers can be packed as floats.
+    """
+    doc = make_doc('{"a": [1, -2, 2.5, 18446744073709551615]}', thawed)
+
+    result = doc.get_array("/a")
+    assert isinstance(result, array.array)
+    assert result.typecode == "d"
+    assert result.tolist() == [1.0, -2.0, 2.5, 18446744073709551615.0]
+
+    assert doc.get_array("/a", typecode="f").tolist() == pytest.approx(
+        [1.0, -2.0, 2.5, 18446744073709551615.0]
+    )
+
+
+@pytest.mark.parametrize(
+    "typecode,values",
+    [
+        ("b", [-128, 127]),
+        ("B", [0, 255]),
+        ("h", [-32768, 32767]),
+        ("H", [0, 65535]),
+        ("i", [-(2**31), 2**31 - 1]),
+        ("I", [0, 2**32 - 1]),
+        ("q", [-(2**63), 2**63 - 1]),
+        ("Q", [0, 2**64 - 1]),
+    ],
+)
+def test_get_array_integers(thawed, typecode, values):
+    """
+    Ensure integers are packed at the limits of each typecode, and rejected
+    just past them.
+    """
+    doc = make_doc(str(values), thawed)
+    assert doc.get_array("", typecode=typecode).tolist() == values
+
+    for out_of_range in (values[0] - 1, values[1] + 1):
+        if out_of_range < -(2**63) or out_of_range >= 2**64:
+            # Can't be read as an integer by yyjson at all.
+            continue
+        doc = make_doc(f"[0, {out_of_range}]", thawed)
+        with pytest.raises(OverflowError, match="at index 1"):
+            doc.get_array("", typecode=typecode)
+
+
+def test_get_array_raw_numbers(thawed):
+    """
+    Ensure numbers read as raw are packed.
+    """
+    doc = make_doc("[1, -2, 3]", thawed, flags=ReaderFlags.NUMBERS_AS_DECIMAL)
+    assert doc.get_array("", typecode="q").tolist() == [1, -2, 3]
+    assert doc.get_array("").tolist() == [1.0, -2.0, 3.0]
+
+    doc = make_doc(
+        "[1, 1e400]", thawed, flags=ReaderFlags.BIG_NUMBERS_AS_DECIMAL
+    )
+    assert doc.get_array("").tolist() == [1.0, float("inf")]
+    with pytest.raises(TypeError, match="at index 1"):
+        doc.get_array("", typecode="q")
+
+
+def test_get_array_errors(thawed):
+    """
+    Ensure values that can't be packed are rejected.
+    """
+    doc = make_doc('{"a": [1, 2.5], "b": [1, "2"], "c": {}, "d": []}', thawed)
+
+    with pytest.raises(TypeError, match="expected an integer at index 1"):
+        doc.get_array("/a", typecode="q")
+    with pytest.raises(TypeError, match="expected a number at index 1"):
+        doc.get_array("/b")
+    with pytest.raises(TypeError):
+        doc.get_array("/c")
+    with pytest.raises(ValueError):
+        doc.get_array("/z")
+    with pytest.raises(ValueError):
+        doc.get_array("/d", typecode="u")
+
+    assert doc.get_array("/d").tolist() == []
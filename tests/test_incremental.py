@@ -0,0 +1,136 @@
+import pytest
+
+from yyjson import Document, IncrementalParser, ReaderFlags
+
+CONTENT = (
+    '{"id": 1, "tags": ["a", "]}"]}\n'
+    '[1, 2.5, {"nested": [[]]}]\n'
+    '"string with \\" escaped quote"\n'
+    "-12.5e3 true\tnull"
+    '{"unicode": "héllo ☃"}'
+)
+EXPECTED = [
+    {"id": 1, "tags": ["a", "]}"]},
+    [1, 2.5, {"nested": [[]]}],
+    'string with " escaped quote',
+    -12.5e3,
+    True,
+    None,
+    {"unicode": "héllo ☃"},
+]
+
+
+def parse_chunks(chunks, **kwargs):
+    parser = IncrementalParser(**kwargs)
+    result = []
+    for chunk in chunks:
+        result.extend(doc.as_obj for doc in parser.feed(chunk))
+    result.extend(doc.as_obj for doc in parser.close())
+    return result
+
+
+def test_incremental_whole():
+    """
+    Ensure concatenated documents given at once are all returned.
+    """
+    assert parse_chunks([CONTENT]) == EXPECTED
+    assert parse_chunks([CONTENT.encode()]) == EXPECTED
+
+
+def test_incremental_split_anywhere():
+    """
+    Ensure documents are the same wherever the input is split, including
+    inside strings, escapes and multi-byte characters.
+    """
+    content = CONTENT.encode()
+    for i in range(len(content) + 1):
+        assert parse_chunks([content[:i], content[i:]]) == EXPECTED
+
+    assert parse_chunks([content[i : i + 1] for i in range(len(content))]) == (
+        EXPECTED
+    )
+
+
+def test_incremental_returns_when_complete():
+    """
+    Ensure each document is returned by the feed() that completes it.
+    """
+    parser = IncrementalParser()
+    assert parser.feed(b'{"a": ') == []
+    docs = parser.feed(bytearray(b'1}{"b"'))
+    assert [doc.as_obj for doc in docs] == [{"a": 1}]
+    assert isinstance(docs[0], Document)
+    assert [doc.as_obj for doc in parser.feed(memoryview(b": 2}"))] == [
+        {"b": 2}
+    ]
+
+    # Numbers can't be complete until something follows them.
+    assert parser.feed(b"12") == []
+    assert [doc.as_obj for doc in parser.feed(b"3\n")] == [123]
+    assert parser.close() == []
+
+
+def test_incremental_ndjson():
+    """
+    Ensure NDJSON can be parsed line by line or in arbitrary chunks.
+    """
+    lines = [{"n": i, "s": "x" * i} for i in range(50)]
+    content = "\n".join(Document(line).dumps() for line in lines) + "\n"
+    chunks = [content[i : i + 7] for i in range(0, len(content), 7)]
+    assert parse_chunks(chunks) == lines
+
+
+def test_incremental_comments():
+    """
+    Ensure comments are skipped when allowed, even when split.
+    """
+    content = b'/* a { */ [1, // ]\n 2] // c\n /** x */ {"a": "/*"}'
+    flags = ReaderFlags.ALLOW_COMMENTS
+    for i in range(len(content) + 1):
+        assert parse_chunks([content[:i], content[i:]], flags=flags) == [
+            [1, 2],
+            {"a": "/*"},
+        ]
+
+    parser = IncrementalParser(flags=flags)
+    parser.feed(b"1 /* unclosed")
+    with pytest.raises(ValueError, match="comment"):
+        parser.close()
+
+
+def test_incremental_flags():
+    """
+    Ensure reader flags apply to every document.
+    """
+    docs = parse_chunks(
+        [b"[NaN, 1]\n[Infin", b"ity]"], flags=ReaderFlags.ALLOW_INF_AND_NAN
+    )
+    assert docs[0][1] == 1 and docs[0][0] != docs[0][0]
+    with pytest.raises(ValueError):
+        parse_chunks([b"[Infinity]"])
+
+
+def test_incremental_errors():
+    """
+    Ensure invalid documents raise with their position in the whole input,
+    and that parsing can continue after them.
+    """
+    parser = IncrementalParser()
+    with pytest.raises(ValueError, match="position 14"):
+        parser.feed(b'{"a": 1}\n{"b" 2}\n[3')
+
+    # The document completed before the error isn't lost.
+    assert [doc.as_obj for doc in parser.feed(b"]")] == [{"a": 1}, [3]]
+
+    with pytest.raises(ValueError):
+        parser.feed(b"]")
+
+    parser.feed(b'{"unfinished": ')
+    with pytest.raises(ValueError):
+        parser.close()
+
+    with pytest.raises(ValueError, match="closed"):
+        parser.feed(b"{}")
+
+    with pytest.raises(TypeError):
+        IncrementalParser().feed(12)
@@ -0,0 +1,135 @@
+import io
+
+import pytest
+
+from yyjson import Document, Pointer, ReaderFlags, iter_array
+
+CONTENT = (
+    '{"meta": {"n": [1, "]"], "s": "a\\"}"}, "x/y": {"~z": [true]},'
+    ' "items": [{"id": 1, "tags": ["a", "b"]}, "s\\u00e9", 2.5, null,'
+    ' [[]], {}], "after": 1}'
+)
+
+
+def test_iter_array():
+    """
+    Ensure the elements of the array at a pointer are yielded in order.
+    """
+    expected = Document(CONTENT).get_pointer("/items")
+    assert list(iter_array(CONTENT, "/items")) == expected
+    assert list(iter_array(CONTENT.encode(), "/items")) == expected
+    assert list(iter_array(memoryview(CONTENT.encode()), "/items")) == expected
+    assert list(iter_array(CONTENT, Pointer("/items"))) == expected
+
+    assert list(iter_array("[1, [2], {}]")) == [1, [2], {}]
+    assert list(iter_array("[]")) == []
+    assert list(iter_array(CONTENT, "/x~1y/~0z")) == [True]
+    assert list(iter_array(CONTENT, "/meta/n")) == [1, "]"]
+    assert list(iter_array(CONTENT, "/items/4/0")) == []
+    assert list(iter_array('{"\\u0061": [1]}', "/a")) == [1]
+
+
+def test_iter_array_files(tmp_path):
+    """
+    Ensure files are read in chunks, with elements split across chunks,
+    from a Path or a file object in either mode.
+    """
+    expected = Document(CONTENT).get_pointer("/items")
+    path = tmp_path / "test.json"
+    path.write_text(CONTENT, encoding="utf-8")
+
+    for chunk_size in (1, 2, 3, 7, 64, 65536):
+        assert list(iter_array(path, "/items", chunk_size=chunk_size)) == (
+            expected
+        )
+        with open(path, "rb") as fp:
+            items = iter_array(fp, "/items", chunk_size=chunk_size)
+            assert list(items) == expected
+        with open(path, encoding="utf-8") as fp:
+            items = iter_array(fp, "/items", chunk_size=chunk_size)
+            assert list(items) == expected
+
+
+def test_iter_array_as_documents():
+    """
+    Ensure elements can be returned as Documents.
+    """
+    documents = list(iter_array(CONTENT, "/items", as_documents=True))
+    assert all(isinstance(document, Document) for document in documents)
+    assert documents[0].get_pointer("/tags/1") == "b"
+    assert documents[2].as_obj == 2.5
+
+
+def test_iter_array_bounded_memory():
+    """
+    Ensure a large array is streamed rather than read all at once.
+    """
+
+    class CountingReader(io.RawIOBase):
+        def __init__(self, data):
+            self.data = io.BytesIO(data)
+            self.largest = 0
+            self.total = 0
+
+        def read(self, n):
+            self.largest = max(self.largest, n)
+            chunk = self.data.read(n)
+            self.total += len(chunk)
+            return chunk
+
+    items = b",".join(b'{"id": %d}' % i for i in range(10000))
+    data = b'{"items": [' + items + b'], "rest": [' + items + b"]}"
+    reader = CountingReader(data)
+    count = 0
+    for item in iter_array(reader, "/items", chunk_size=1024):
+        assert item == {"id": count}
+        count += 1
+    assert count == 10000
+    assert reader.largest == 1024
+    # Nothing after the array is read.
+    assert reader.total < len(data) // 2 + 1024
+
+
+def test_iter_array_flags():
+    """
+    Ensure reader flags apply to both the skipped and parsed values.
+    """
+    content = '/* c */ {"a": // d\n [1, NaN, 2,],}'
+    flags = (
+        ReaderFlags.ALLOW_COMMENTS
+        | ReaderFlags.ALLOW_INF_AND_NAN
+        | ReaderFlags.ALLOW_TRAILING_COMMAS
+    )
+    items = list(iter_array(content, "/a", flags=flags))
+    assert items[0] == 1 and items[2] == 2 and items[1] != items[1]
+
+
+def test_iter_array_errors():
+    """
+    Ensure missing pointers, non-arrays, and invalid elements raise.
+    """
+    for pointer in ("/missing", "/items/10", "/meta/n/x", "/items/-"):
+        with pytest.raises(ValueError, match="no value found"):
+            list(iter_array(CONTENT, pointer))
+
+    for pointer in ("/meta", "/after"):
+        with pytest.raises(TypeError, match="not an array"):
+            list(iter_array(CONTENT, pointer))
+
+    with pytest.raises(ValueError, match="prefix"):
+        iter_array(CONTENT, "items")
+
+    with pytest.raises(TypeError):
+        iter_array(12)
+
+    items = iter_array("[1, 2, x]")
+    assert next(items) == 1
+    assert next(items) == 2
+    with pytest.raises(ValueError, match="at position 7$"):
+        next(items)
+    with pytest.raises(StopIteration):
+        next(items)
+
+    for content in ("[1 2]", "[1, 2", "[1,]", '{"a": [1'):
+        with pytest.raises(ValueError, match="at position"):
+            list(iter_array(content, "/a" if content[0] == "{" else ""))
@@ -0,0 +1,197 @@
+"""
+Tests for JSONPath (RFC 9535) queries.
+"""
+import pytest
+
+from yyjson import Document, JSONPath
+
+STORE = {
+    "store": {
+        "book": [
+            {
+                "category": "reference",
+                "author": "Nigel Rees",
+                "title": "Sayings of the Century",
+                "price": 8.95,
+            },
+            {
+                "category": "fiction",
+                "author": "Evelyn Waugh",
+                "title": "Sword of Honour",
+                "price": 12.99,
+            },
+            {
+                "category": "fiction",
+                "author": "Herman Melville",
+                "title": "Moby Dick",
+                "isbn": "0-553-21311-3",
+                "price": 8.99,
+            },
+            {
+                "category": "fiction",
+                "author": "J. R. R. Tolkien",
+                "title": "The Lord of the Rings",
+                "isbn": "0-395-19395-8",
+                "price": 22.99,
+            },
+        ],
+        "bicycle": {"color": "red", "price": 399},
+    }
+}
+
+
+@pytest.fixture(params=["immutable", "mutable"])
+def store(request):
+    doc = Document(STORE)
+    if request.param == "immutable":
+        doc.freeze()
+    return doc
+
+
+def test_jsonpath_compile():
+    """
+    Ensure queries are compiled up front and invalid queries are rejected.
+    """
+    path = JSONPath("$.store.book[*].author")
+    assert str(path) == "$.store.book[*].author"
+    assert repr(path) == "JSONPath('$.store.book[*].author')"
+
+    for invalid in (
+        "",
+        "store",
+        "$.",
+        "$[",
+        "$[1",
+        "$ ",
+        "$[01]",
+        "$[-0]",
+        "$['a]",
+        "$['\\x']",
+        "$[9007199254740992]",
+        "$[?@.a == 1 &&]",
+        "$[?@.* == 1]",
+        "$[?length(@.a)]",
+        "$[?count(1) == 1]",
+        "$[?nope(@)]",
+        "$[?1]",
+        "$[?@.a == [1, 2]]",
+    ):
+        with pytest.raises(ValueError):
+            JSONPath(invalid)
+
+    with pytest.raises(TypeError):
+        JSONPath(1)
+
+
+def test_jsonpath_basic(store):
+    """
+    Ensure the examples from RFC 9535 select the expected nodes.
+    """
+    assert store.query("$") == [STORE]
+    assert store.query("$.store.book[*].author") == [
+        "Nigel Rees",
+        "Evelyn Waugh",
+        "Herman Melville",
+        "J. R. R. Tolkien",
+    ]
+    assert store.query("$..author") == store.query("$.store.book[*].author")
+    assert store.query("$.store.*") == [
+        STORE["store"]["book"],
+        STORE["store"]["bicycle"],
+    ]
+    assert store.query("$.store..price") == [8.95, 12.99, 8.99, 22.99, 399]
+    assert store.query("$..book[2].author") == ["Herman Melville"]
+    assert store.query("$..book[-1].title") == ["The Lord of the Rings"]
+    assert store.query("$..book[0,1].title") == [
+        "Sayings of the Century",
+        "Sword of Honour",
+    ]
+    assert store.query("$..book[:2].price") == [8.95, 12.99]
+    assert store.query("$..book[?@.isbn].title") == [
+        "Moby Dick",
+        "The Lord of the Rings",
+    ]
+    assert store.query("$..book[?(@.price<10)].title") == [
+        "Sayings of the Century",
+        "Moby Dick",
+    ]
+    assert store.query("$..book[?@.price > $.store.bicycle.price]") == []
+    assert len(store.query("$..*")) == 27
+    assert store.query("$['store'][\"bicycle\"]['color']") == ["red"]
+    assert store.query("$.nope") == []
+
+
+def test_jsonpath_slices():
+    """
+    Ensure array slices follow the normalization rules of RFC 9535.
+    """
+    doc = Document([0, 1, 2, 3, 4, 5, 6])
+
+    assert doc.query("$[1:3]") == [1, 2]
+    assert doc.query("$[5:]") == [5, 6]
+    assert doc.query("$[1:5:2]") == [1, 3]
+    assert doc.query("$[5:1:-2]") == [5, 3]
+    assert doc.query("$[::-1]") == [6, 5, 4, 3, 2, 1, 0]
+    assert doc.query("$[-2:]") == [5, 6]
+    assert doc.query("$[:-5]") == [0, 1]
+    assert doc.query("$[0:100]") == [0, 1, 2, 3, 4, 5, 6]
+    assert doc.query("$[::0]") == []
+    assert doc.query("$[7]") == []
+    assert doc.query("$[-8]") == []
+
+
+def test_jsonpath_filters():
+    """
+    Ensure filter expressions, comparisons and functions behave as described
+    in RFC 9535.
+    """
+    doc = Document(
+        [
+            {"a": 1, "b": "j"},
+            {"a": 1.0, "b": "jj"},
+            {"a": [1, 2], "b": "kilo"},
+            {"a": {"x": 1}, "b": "été"},
+            {"a": None},
+            {"b": "z"},
+        ]
+    )
+
+    assert doc.query("$[?@.a == 1].b") == ["j", "jj"]
+    assert doc.query("$[?@.a != 1].b") == ["kilo", "été", "z"]
+    assert doc.query("$[?@.a == $[2].a].b") == ["kilo"]
+    assert doc.query("$[?@.a == null]") == [{"a": None}]
+    assert doc.query("$[?@.b >= 'k'].b") == ["kilo", "été", "z"]
+    assert doc.query("$[?@.b < 'k' && @.a].b") == ["j", "jj"]
+    assert doc.query("$[?@.a == 1 || @.b == 'z'].b") == ["j", "jj", "z"]
+    assert doc.query("$[?!@.a].b") == ["z"]
+    assert doc.query("$[?!(@.a && @.b)]") == [{"a": None}, {"b": "z"}]
+    assert doc.query("$[?length(@.b) == 3].b") == ["été"]
+    assert doc.query("$[?length(@.a) == 2].b") == ["kilo"]
+    assert doc.query("$[?count(@.*) == 1]") == [{"a": None}, {"b": "z"}]
+    assert doc.query("$[?value(@..x) == 1].b") == ["été"]
+    assert doc.query("$[?match(@.b, 'j+')].b") == ["j", "jj"]
+    assert doc.query("$[?search(@.b, 'il')].b") == ["kilo"]
+    assert doc.query("$[?match(@.b, '[')]") == []
+    assert doc.query("$[?@.a.x]") == [{"a": {"x": 1}, "b": "été"}]
+    assert doc.query("$..[?@.x]") == [{"x": 1}]
+
+
+def test_jsonpath_as_documents(store):
+    """
+    Ensure matches can be returned as new Documents.
+    """
+    cheap = JSONPath("$.store.book[?@.price < 10]")
+    books = store.query(cheap, as_documents=True)
+
+    assert [type(book) for book in books] == [Document, Document]
+    assert [book.get_pointer("/title") for book in books] == [
+        "Sayings of the Century",
+        "Moby Dick",
+    ]
+    assert books[1].dumps() == Document(STORE["store"]["book"][2]).dumps()
+
+    with pytest.raises(TypeError):
+        store.query(1)
+
+    with pytest.raises(ValueError):
+        store.query("$[")
@@ -56,3 +56,110 @@ def test_merge_patch(context):
     )
 
     assert modified.as_obj == context["modified"]
+
+
+@pytest.mark.parametrize(
+    "original,patch,modified",
+    [
+        ({"a": "b"}, {"a": "c"}, {"a": "c"}),
+        ({"a": "b"}, {"b": "c"}, {"a": "b", "b": "c"}),
+        ({"a": "b"}, {"a": None}, {}),
+        ({"a": "b", "b": "c"}, {"a": None}, {"b": "c"}),
+        ({"a": ["b"]}, {"a": "c"}, {"a": "c"}),
+        ({"a": "c"}, {"a": ["b"]}, {"a": ["b"]}),
+        ({"a": {"b": "c"}}, {"a": {"b": "d", "c": None}}, {"a": {"b": "d"}}),
+        ({"a": [{"b": "c"}]}, {"a": [1]}, {"a": [1]}),
+        (["a", "b"], ["c", "d"], ["c", "d"]),
+        ({"a": "b"}, ["c"], ["c"]),
+        ({"a": "foo"}, None, None),
+        ({"e": None}, {"a": 1}, {"e": None, "a": 1}),
+        ([1, 2], {"a": "b", "c": None}, {"a": "b"}),
+        ({}, {"a": {"bb": {"ccc": None}}}, {"a": {"bb": {}}}),
+    ],
+)
+def test_merge_patch_inplace(original, patch, modified):
+    """
+    Ensures the examples from RFC 7386 give the same results when applied in
+    place, with both mutable and immutable patches.
+    """
+    for frozen in (True, False):
+        doc = Document(original)
+        patch_doc = Document(patch)
+        if frozen:
+            patch_doc.freeze()
+
+        assert doc.patch(patch_doc, use_merge_patch=True).as_obj == modified
+        assert doc.as_obj == original
+
+        doc.patch(patch_doc, use_merge_patch=True, inplace=True)
+        assert doc.as_obj == modified
+        assert patch_doc.is_thawed is not frozen
+
+
+@pytest.mark.parametrize("frozen", [True, False])
+def test_merge_patch_inplace_self(frozen):
+    """
+    Ensures a Document can be merge-patched in place with itself.
+    """
+    doc = Document({"a": 1, "b": None, "c": {"d": None, "e": [2]}})
+    if frozen:
+        doc.freeze()
+
+    doc.patch(doc, use_merge_patch=True, inplace=True)
+    assert doc.as_obj == {"a": 1, "c": {"e": [2]}}
+
+
+@pytest.mark.parametrize(
+    "original,modified,patch",
+    [
+        ({"a": "b"}, {"a": "b"}, {}),
+        ({"a": "b"}, {"a": "c"}, {"a": "c"}),
+        ({"a": "b"}, {"a": "b", "b": "c"}, {"b": "c"}),
+        ({"a": "b", "b": "c"}, {"b": "c"}, {"a": None}),
+        ({"a": ["b"]}, {"a": "c"}, {"a": "c"}),
+        ({"a": {"b": "c", "c": 1}}, {"a": {"b": "d"}}, {"a": {"b": "d", "c": None}}),
+        ({"a": [{"b": "c"}]}, {"a": [{"b": None}]}, {"a": [{"b": None}]}),
+        (["a", "b"], ["c", "d"], ["c", "d"]),
+        ({"a": "b"}, ["c"], ["c"]),
+        ({"a": "foo"}, None, None),
+        ([1, 2], {"a": {"b": 1}}, {"a": {"b": 1}}),
+        ({"a": 1}, {"a": 1.0}, {}),
+        ({"a": None}, {"a": None}, {}),
+        ([1, 2], [1, 2], [1, 2]),
+        ([{"a": None}], [{"a": None}], [{"a": None}]),
+        (1, 1, 1),
+        (None, None, None),
+    ],
+)
+def test_merge_diff(original, modified, patch):
+    """
+    Ensures merge patches generated between two Documents are minimal and
+    recreate the modified Document.
+    """
+    for frozen in (True, False):
+        doc = Document(original)
+        other = Document(modified)
+        if frozen:
+            doc.freeze()
+            other.freeze()
+
+        result = doc.merge_diff(other)
+        assert result.as_obj == patch
+        assert doc.patch(result, use_merge_patch=True).as_obj == modified
+
+
+def test_merge_diff_unrepresentable():
+    """
+    Ensures changes a merge patch can't express are rejected.
+    """
+    for original, modified in (
+        ({"a": 1}, {"a": None}),
+        ({}, {"a": None}),
+        ({}, {"a": {"b": None}}),
+        ([], {"a": None}),
+    ):
+        with pytest.raises(ValueError):
+            Document(original).merge_diff(Document(modified))
+
+    with pytest.raises(TypeError):
+        Document({}).merge_diff({})
@@ -0,0 +1,187 @@
+import json
+import random
+import struct
+
+import pytest
+
+from yyjson import Document, ReaderFlags
+
+CONTENT = (
+    '{"a": [1, -2, 18446744073709551615, -9223372036854775808, 2.5,'
+    ' "s\\u00e9\\"\\n", true, false, null, {}, [], [[{"k": "☃"}]]],'
+    ' "": {"b": "c"}}'
+)
+
+
+def test_msgpack():
+    """
+    Ensure a Document survives MessagePack unchanged.
+    """
+    doc = Document(CONTENT)
+    packed = doc.to_msgpack()
+    assert isinstance(packed, bytes)
+
+    loaded = Document.from_msgpack(packed)
+    assert loaded == doc
+    assert loaded.as_obj == doc.as_obj
+    assert loaded.dumps() == doc.dumps()
+    assert not loaded.is_thawed
+    assert loaded.get_pointer("/a/11/0/0/k") == "☃"
+
+    assert Document.from_msgpack(bytearray(packed)) == doc
+    assert Document.from_msgpack(memoryview(packed)) == doc
+
+    for content in ("1", '"s"', "[]", "{}", "null"):
+        doc = Document(content)
+        assert Document.from_msgpack(doc.to_msgpack()) == doc
+
+
+def test_msgpack_thawed():
+    """
+    Ensure thawed Documents are written the same as frozen ones.
+    """
+    doc = Document(CONTENT)
+    thawed = Document(CONTENT)
+    thawed.thaw()
+    assert thawed.to_msgpack() == doc.to_msgpack()
+
+    thawed.set("/a/0", {"new": [1, 2]})
+    loaded = Document.from_msgpack(thawed.to_msgpack())
+    assert loaded.get_pointer("/a/0") == {"new": [1, 2]}
+    assert loaded == thawed
+
+
+@pytest.mark.parametrize(
+    "value,packed",
+    [
+        (0, b"\x00"),
+        (127, b"\x7f"),
+        (128, b"\xcc\x80"),
+        (255, b"\xcc\xff"),
+        (256, b"\xcd\x01\x00"),
+        (65535, b"\xcd\xff\xff"),
+        (65536, b"\xce\x00\x01\x00\x00"),
+        (4294967295, b"\xce\xff\xff\xff\xff"),
+        (4294967296, b"\xcf\x00\x00\x00\x01\x00\x00\x00\x00"),
+        (18446744073709551615, b"\xcf" + b"\xff" * 8),
+        (-1, b"\xff"),
+        (-32, b"\xe0"),
+        (-33, b"\xd0\xdf"),
+        (-128, b"\xd0\x80"),
+        (-129, b"\xd1\xff\x7f"),
+        (-32768, b"\xd1\x80\x00"),
+        (-32769, b"\xd2\xff\xff\x7f\xff"),
+        (-2147483648, b"\xd2\x80\x00\x00\x00"),
+        (-2147483649, b"\xd3\xff\xff\xff\xff\x7f\xff\xff\xff"),
+        (-9223372036854775808, b"\xd3\x80" + b"\x00" * 7),
+        (2.5, b"\xcb" + struct.pack(">d", 2.5)),
+        (None, b"\xc0"),
+        (False, b"\xc2"),
+        (True, b"\xc3"),
+        ("", b"\xa0"),
+        ("a" * 31, b"\xbf" + b"a" * 31),
+        ("a" * 32, b"\xd9\x20" + b"a" * 32),
+        ("a" * 256, b"\xda\x01\x00" + b"a" * 256),
+        ("a" * 65536, b"\xdb\x00\x01\x00\x00" + b"a" * 65536),
+        ([], b"\x90"),
+        ([None] * 15, b"\x9f" + b"\xc0" * 15),
+        ([None] * 16, b"\xdc\x00\x10" + b"\xc0" * 16),
+        ({}, b"\x80"),
+        ({"a": None}, b"\x81\xa1a\xc0"),
+    ],
+)
+def test_msgpack_encodings(value, packed):
+    """
+    Ensure values use the smallest MessagePack encoding that holds them,
+    and are read back from it.
+    """
+    assert Document(json.dumps(value)).to_msgpack() == packed
+    assert Document.from_msgpack(packed).as_obj == value
+
+
+def test_msgpack_read_wide():
+    """
+    Ensure values in wider encodings than needed, and 32-bit floats, are
+    read.
+    """
+    assert Document.from_msgpack(b"\xcf" + b"\x00" * 7 + b"\x01").as_obj == 1
+    assert Document.from_msgpack(b"\xd3" + b"\x00" * 7 + b"\x01").as_obj == 1
+    assert Document.from_msgpack(b"\xd0\x01").dumps() == "1"
+    assert Document.from_msgpack(b"\xca" + struct.pack(">f", 0.5)).as_obj == 0.5
+    assert Document.from_msgpack(b"\xdd\x00\x00\x00\x01\x01").as_obj == [1]
+    assert Document.from_msgpack(b"\xdf\x00\x00\x00\x00").as_obj == {}
+
+
+def test_msgpack_raw_numbers():
+    """
+    Ensure numbers read as raw are written as the numbers they'd have been
+    read as otherwise.
+    """
+    content = "[1, -1, 2.5, 100000000000000000000000]"
+    raw = Document(content, flags=ReaderFlags.NUMBERS_AS_RAW)
+    assert raw.to_msgpack() == Document(content).to_msgpack()
+
+
+@pytest.mark.parametrize(
+    "packed,message",
+    [
+        (b"", "unexpected end of data at position 0"),
+        (b"\x92\x01", "unexpected end of data at position 2"),
+        (b"\xcd\x01", "unexpected end of data at position 0"),
+        (b"\xa2a", "unexpected end of data at position 0"),
+        (b"\x01\x02", "unexpected data after the value at position 1"),
+        (b"\x91\x01\xc0", "unexpected data after the value at position 2"),
+        (b"\x81\x01\x02", "object keys must be strings at position 1"),
+        (b"\x81\xc0\x02", "object keys must be strings at position 1"),
+        (b"\xa1\xff", "string is not valid UTF-8 at position 0"),
+        (b"\xc1", "invalid type at position 0"),
+        (b"\x91\xc4\x01a", "binary data can't be represented"),
+        (b"\xd4\x01\x00", "extension types can't be represented"),
+        (b"\xc7\x01\x01a", "extension types can't be represented"),
+    ],
+)
+def test_msgpack_invalid(packed, message):
+    """
+    Ensure invalid MessagePack, and values that can't be represented as
+    JSON, are rejected.
+    """
+    with pytest.raises(ValueError, match=message):
+        Document.from_msgpack(packed)
+
+
+def test_msgpack_truncated():
+    """
+    Ensure every truncation of a valid value is rejected cleanly.
+    """
+    packed = Document(CONTENT).to_msgpack()
+    for i in range(len(packed)):
+        with pytest.raises(ValueError):
+            Document.from_msgpack(packed[:i])
+
+
+def test_msgpack_fuzz():
+    """
+    Ensure corrupted MessagePack either loads or raises a ValueError.
+    """
+    rng = random.Random(0)
+    packed = bytearray(Document(CONTENT).to_msgpack())
+    for _ in range(2000):
+        corrupt = bytearray(packed)
+        for _ in range(rng.randint(1, 4)):
+            corrupt[rng.randrange(len(corrupt))] = rng.randrange(256)
+        try:
+            doc = Document.from_msgpack(corrupt)
+        except ValueError:
+            continue
+        assert Document.from_msgpack(doc.to_msgpack()) == doc
+
+
+def test_msgpack_compat():
+    """
+    Ensure the msgpack package agrees with us, when it's installed.
+    """
+    msgpack = pytest.importorskip("msgpack")
+
+    doc = Document(CONTENT)
+    assert msgpack.unpackb(doc.to_msgpack()) == doc.as_obj
+    assert Document.from_msgpack(msgpack.packb(doc.as_obj)) == doc
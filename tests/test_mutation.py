@@ -0,0 +1,202 @@
+"""
+Tests for modifying a Document in place using JSON pointers.
+"""
+import pytest
+
+from yyjson import Document, Pointer
+
+
+@pytest.fixture(params=["immutable", "mutable"])
+def doc(request):
+    doc = Document({"user": {"name": "Harry", "tags": ["a", "c"]}, "n": 1})
+    if request.param == "immutable":
+        doc.freeze()
+    return doc
+
+
+@pytest.mark.parametrize("make_pointer", [str, Pointer])
+def test_set(doc, make_pointer):
+    """
+    Ensure values can be set, replacing existing values and creating missing
+    parents.
+    """
+    doc.set(make_pointer("/user/name"), "Ron")
+    doc.set(make_pointer("/user/pets/owl"), {"name": "Hedwig"})
+    doc.set(make_pointer("/n"), [1, 2])
+
+    assert doc.as_obj == {
+        "user": {
+            "name": "Ron",
+            "tags": ["a", "c"],
+            "pets": {"owl": {"name": "Hedwig"}},
+        },
+        "n": [1, 2],
+    }
+
+    with pytest.raises(ValueError):
+        doc.set(make_pointer("/x/y"), 1, create_parents=False)
+
+    with pytest.raises(ValueError):
+        doc.set(make_pointer("/user/tags/9"), 1)
+
+    doc.set(make_pointer(""), {"reset": True})
+    assert doc.as_obj == {"reset": True}
+
+
+@pytest.mark.parametrize("make_pointer", [str, Pointer])
+def test_add(doc, make_pointer):
+    """
+    Ensure values can be added following JSON Patch semantics.
+    """
+    doc.add(make_pointer("/user/tags/1"), "b")
+    doc.add(make_pointer("/user/tags/-"), "d")
+    doc.add(make_pointer("/user/age"), 17)
+
+    assert doc.as_obj == {
+        "user": {"name": "Harry", "tags": ["a", "b", "c", "d"], "age": 17},
+        "n": 1,
+    }
+
+    with pytest.raises(ValueError):
+        doc.add(make_pointer("/user/tags/9"), "z")
+
+    with pytest.raises(ValueError):
+        doc.add(make_pointer(""), 1)
+
+
+@pytest.mark.parametrize("make_pointer", [str, Pointer])
+def test_replace_and_remove(doc, make_pointer):
+    """
+    Ensure existing values can be replaced and removed, and that missing
+    values are an error.
+    """
+    doc.replace(make_pointer("/user/tags/0"), "z")
+    doc.remove(make_pointer("/user/name"))
+    doc.remove(make_pointer("/n"))
+
+    assert doc.as_obj == {"user": {"tags": ["z", "c"]}}
+
+    with pytest.raises(ValueError):
+        doc.replace(make_pointer("/user/name"), "Ron")
+
+    with pytest.raises(ValueError):
+        doc.remove(make_pointer("/user/name"))
+
+    with pytest.raises(ValueError):
+        doc.remove(make_pointer(""))
+
+
+@pytest.mark.parametrize("make_pointer", [str, Pointer])
+def test_extend(doc, make_pointer):
+    """
+    Ensure arrays can be extended from any iterable, and are left untouched
+    when a value can't be converted.
+    """
+    doc.extend(make_pointer("/user/tags"), ["d", "e"])
+    doc.extend(make_pointer("/user/tags"), (c for c in "fg"))
+
+    assert doc.get_pointer("/user/tags") == ["a", "c", "d", "e", "f", "g"]
+
+    with pytest.raises(TypeError):
+        doc.extend(make_pointer("/user/tags"), ["h", object()])
+
+    assert doc.get_pointer("/user/tags") == ["a", "c", "d", "e", "f", "g"]
+
+    with pytest.raises(ValueError):
+        doc.extend(make_pointer("/user"), [1])
+
+    with pytest.raises(ValueError):
+        doc.extend(make_pointer("/nope"), [1])
+
+
+def test_mutation_invalid_pointer():
+    """
+    Ensure invalid pointers are rejected.
+    """
+    doc = Document({"a": 1})
+
+    with pytest.raises(ValueError):
+        doc.set("a", 1)
+
+    with pytest.raises(TypeError):
+        doc.set(None, 1)
+
+    with pytest.raises(TypeError):
+        doc.remove(1)
+
+
+def test_extend_iterator_freezes():
+    """
+    Ensure an iterator that freezes or thaws the Document while it's being
+    extended doesn't leave it using freed values.
+    """
+    doc = Document({"tags": ["a"]})
+    doc.thaw()
+
+    def values():
+        yield "b"
+        doc.freeze()
+        yield "c"
+        doc.thaw()
+        yield "d"
+
+    doc.extend("/tags", values())
+    assert doc.get_pointer("/tags") == ["a", "b", "c", "d"]
+
+
+@pytest.mark.parametrize("method", ["set", "add", "replace", "extend"])
+def test_mutation_default_busy(method):
+    """
+    Ensure a default callback can't free the Document it's converting a
+    value for.
+    """
+
+    def default(obj):
+        doc.freeze()
+        return "x"
+
+    doc = Document({"tags": ["a"]}, default=default)
+
+    value = [object()] if method == "extend" else object()
+    pointer = "/tags" if method == "extend" else "/tags/0"
+    with pytest.raises(BufferError):
+        getattr(doc, method)(pointer, value)
+
+    # The Document is still usable, and unchanged.
+    assert doc.get_pointer("/tags") == ["a"]
+    doc.freeze()
+    doc.thaw()
+
+
+@pytest.mark.parametrize("make_pointer", [str, Pointer])
+@pytest.mark.parametrize(
+    "method,pointer,kwargs",
+    [
+        ("set", "/missing/x", {"create_parents": False}),
+        ("set", "/a/x", {}),
+        ("set", "/list/-", {}),
+        ("add", "/list/5", {}),
+        ("add", "/list/-/~2/x", {}),
+        ("add", "", {}),
+        ("replace", "/missing", {}),
+    ],
+)
+def test_mutation_invalid_pointer_skips_value(make_pointer, method, pointer, kwargs):
+    """
+    Ensure values aren't converted into the Document when the pointer they'd
+    be stored at can't be used, as converted values aren't freed until the
+    Document is.
+    """
+    converted = []
+
+    def default(obj):
+        converted.append(obj)
+        return "x"
+
+    doc = Document({"a": 1, "list": []}, default=default)
+
+    with pytest.raises(ValueError):
+        getattr(doc, method)(make_pointer(pointer), object(), **kwargs)
+
+    assert converted == []
+    assert doc.as_obj == {"a": 1, "list": []}
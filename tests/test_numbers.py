@@ -1,5 +1,7 @@
 import sys
 
+import pytest
+
 from yyjson import Document, ReaderFlags
 
 
@@ -30,3 +32,49 @@ def test_big_numbers():
 
         assert str(obj) == num
         assert Document(obj).dumps() == num
+
+
+def test_to_obj_number_hooks():
+    """
+    Ensure to_obj() calls number hooks for raw and natively read numbers.
+    """
+    from decimal import Decimal
+
+    doc = Document("[1, 1.10, -0]", flags=ReaderFlags.NUMBERS_AS_RAW)
+    assert doc.to_obj(parse_float=str) == [1, "1.10", 0]
+    assert doc.as_obj == [Decimal("1"), Decimal("1.10"), Decimal("-0")]
+    assert str(doc.as_obj[2]) == "-0"
+
+    doc = Document("[1, 2.5, 18446744073709551615]")
+    assert doc.to_obj(parse_int=str, parse_float=Decimal) == [
+        "1",
+        Decimal("2.5"),
+        "18446744073709551615",
+    ]
+    doc.thaw()
+    assert doc.to_obj(parse_int=float) == [1.0, 2.5, 18446744073709551615.0]
+
+    doc = Document("[NaN, -inf]", flags=ReaderFlags.ALLOW_INF_AND_NAN)
+    assert doc.to_obj(parse_constant=str) == ["NaN", "-Infinity"]
+
+
+@pytest.mark.parametrize("hook", ["parse_float", "parse_int", "parse_constant"])
+@pytest.mark.parametrize("action", ["freeze", "thaw"])
+def test_to_obj_number_hooks_busy(hook, action):
+    """
+    Ensure number hooks can't free the Document while it's being converted.
+    """
+    doc = Document("[1, 2.5, NaN, [3, 4.5]]", flags=ReaderFlags.ALLOW_INF_AND_NAN)
+    if action == "freeze":
+        doc.thaw()
+
+    def convert(value):
+        getattr(doc, action)()
+        return value
+
+    with pytest.raises(BufferError):
+        doc.to_obj(**{hook: convert})
+
+    # Once the conversion is over, the Document can be changed again.
+    getattr(doc, action)()
+    assert doc.is_thawed == (action == "thaw")
@@ -5,7 +5,7 @@ from pathlib import Path
 
 import pytest
 
-from yyjson import Document
+from yyjson import Document, Patch, Pointer
 
 
 @pytest.mark.parametrize(
@@ -68,3 +68,202 @@ def test_json_patch_samples():
 
         assert modified.as_obj == test["expected"]
 
+
+
+def test_json_patch_samples_inplace():
+    """
+    Ensures JSON Patch gives the same results when applied in place, and
+    that failures are reported.
+    """
+    tests = Document(Path(__file__).parent / "tests.json").as_obj
+
+    for test in tests:
+        if test.get("disabled"):
+            continue
+
+        original = Document(test["doc"])
+        patch = Document(test["patch"])
+
+        if test.get("error"):
+            with pytest.raises(ValueError):
+                original.patch(patch, inplace=True)
+            continue
+
+        assert original.patch(patch, inplace=True) is original
+        assert original.as_obj == test["expected"]
+
+
+@pytest.mark.parametrize("frozen", [True, False])
+def test_json_patch_leaves_patch_untouched(frozen):
+    """
+    Ensures the patch Document is never frozen or thawed by patching.
+    """
+    patch = Document([{"op": "add", "path": "/b", "value": {"c": 1}}])
+    if frozen:
+        patch.freeze()
+
+    for original in (Document({"a": 1}), Document('{"a": 1}')):
+        assert original.patch(patch).as_obj == {"a": 1, "b": {"c": 1}}
+        assert patch.is_thawed is not frozen
+
+        original.patch(patch, inplace=True)
+        assert original.as_obj == {"a": 1, "b": {"c": 1}}
+        assert patch.is_thawed is not frozen
+
+
+@pytest.mark.parametrize("frozen", [True, False])
+def test_json_patch_inplace_self(frozen):
+    """
+    Ensures a Document can be patched in place with itself.
+    """
+    ops = [
+        {"op": "add", "path": "/-", "value": 1},
+        {"op": "remove", "path": "/0"},
+        {"op": "add", "path": "/-", "value": 2},
+    ]
+    doc = Document(ops)
+    if frozen:
+        doc.freeze()
+
+    doc.patch(doc, inplace=True)
+    assert doc.as_obj == ops[1:] + [1, 2]
+
+
+def test_json_patch_inplace_at_pointer():
+    """
+    Ensures patching in place at a pointer only touches that value, even
+    when the whole value is replaced.
+    """
+    doc = Document({"config": {"a": 1}, "other": [1, 2]})
+
+    doc.patch(
+        Document([{"op": "test", "path": "/a", "value": 1.0}]),
+        at_pointer="/config",
+        inplace=True,
+    )
+    doc.patch(
+        Document([{"op": "replace", "path": "", "value": ["x"]}]),
+        at_pointer="/other",
+        inplace=True,
+    )
+    doc.patch(
+        Document([{"op": "add", "path": "/b", "value": 2}]),
+        at_pointer="/config",
+        inplace=True,
+    )
+
+    assert doc.as_obj == {"config": {"a": 1, "b": 2}, "other": ["x"]}
+
+    with pytest.raises(ValueError):
+        doc.patch(
+            Document([{"op": "move", "from": "/config", "path": "/config/x"}]),
+            inplace=True,
+        )
+
+
+@pytest.mark.parametrize("frozen", [True, False])
+def test_json_patch_move_to_itself(frozen):
+    """
+    Ensures moving a value onto itself is a no-op, but only if it exists,
+    whether the patch is compiled or not.
+    """
+    ops = [{"op": "move", "from": "/a", "path": "/a"}]
+
+    for patch in (Document(ops), Patch(ops)):
+        doc = Document({"a": [1]})
+        missing = Document({})
+        if frozen:
+            doc.freeze()
+            missing.freeze()
+
+        assert doc.patch(patch).as_obj == {"a": [1]}
+        with pytest.raises(ValueError, match="failed to remove `from`"):
+            missing.patch(patch)
+        with pytest.raises(ValueError, match="failed to remove `from`"):
+            missing.patch(patch, inplace=True)
+
+
+def test_compiled_patch_samples():
+    """
+    Ensures a compiled Patch gives the same results as patching with a
+    Document, rejecting invalid patches either when compiled or applied.
+    """
+    tests = Document(Path(__file__).parent / "tests.json").as_obj
+
+    for test in tests:
+        if test.get("disabled"):
+            continue
+
+        original = Document(test["doc"])
+
+        if test.get("error"):
+            with pytest.raises(ValueError):
+                Patch(test["patch"]).apply(original)
+            continue
+
+        patch = Patch(Document(test["patch"]))
+        assert len(patch) == len(test["patch"])
+        assert patch.apply(original).as_obj == test["expected"]
+        assert original.patch(patch).as_obj == test["expected"]
+
+
+def test_compiled_patch_invalid():
+    """
+    Ensures malformed patches are rejected when compiled.
+    """
+    for invalid in (
+        {"op": "add", "path": "/a", "value": 1},
+        [{"op": "nope", "path": "/a"}],
+        [{"op": "add", "path": "/a"}],
+        [{"op": "add", "path": "a", "value": 1}],
+        [{"op": "move", "path": "/a"}],
+        [{"path": "/a", "value": 1}],
+        [1],
+    ):
+        with pytest.raises(ValueError):
+            Patch(invalid)
+
+    with pytest.raises(ValueError):
+        Document({"a": 1}).patch(Patch([]), use_merge_patch=True)
+
+    with pytest.raises(TypeError):
+        Document({"a": 1}).patch([])
+
+
+@pytest.mark.parametrize("frozen", [True, False])
+def test_compiled_patch_reuse(frozen):
+    """
+    Ensures a compiled Patch can be applied many times, at a pointer and in
+    place.
+    """
+    patch = Patch(
+        [
+            {"op": "test", "path": "/n", "value": 1},
+            {"op": "copy", "from": "/n", "path": "/m"},
+            {"op": "add", "path": "/tags/-", "value": {"t": "x"}},
+        ]
+    )
+
+    docs = [Document({"n": 1, "tags": []}) for _ in range(3)]
+    if frozen:
+        for doc in docs:
+            doc.freeze()
+
+    patched = patch.patch_many(docs)
+    assert [doc.as_obj for doc in patched] == [
+        {"n": 1, "tags": [{"t": "x"}], "m": 1}
+    ] * 3
+    assert [doc.as_obj for doc in docs] == [{"n": 1, "tags": []}] * 3
+
+    doc = Document({"inner": {"n": 1, "tags": []}})
+    assert patch.apply(doc, at_pointer="/inner", inplace=True) is doc
+    patch.apply(doc, at_pointer=Pointer("/inner"), inplace=True)
+    assert doc.as_obj == {
+        "inner": {"n": 1, "tags": [{"t": "x"}, {"t": "x"}], "m": 1}
+    }
+
+    with pytest.raises(ValueError):
+        patch.patch_many([Document({"n": 2, "tags": []})])
+
+    with pytest.raises(TypeError):
+        patch.patch_many([{"n": 1}])
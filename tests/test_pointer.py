@@ -0,0 +1,145 @@
+"""
+Tests for compiled JSON Pointer (RFC 6901) objects.
+"""
+import pytest
+
+from yyjson import Document, Pointer
+
+
+def test_pointer_tokens():
+    """
+    Ensure pointers are split and unescaped when compiled.
+    """
+    assert Pointer("").tokens == ()
+    assert Pointer("/").tokens == ("",)
+    assert Pointer("/a/b/0").tokens == ("a", "b", "0")
+    assert Pointer("/a~1b/m~0n").tokens == ("a/b", "m~n")
+    assert len(Pointer("/a/b/0")) == 3
+
+    assert str(Pointer("/a~1b")) == "/a~1b"
+    assert repr(Pointer("/a")) == "Pointer('/a')"
+
+    assert Pointer("/a") == Pointer("/a")
+    assert Pointer("/a") != Pointer("/b")
+    assert hash(Pointer("/a")) == hash(Pointer("/a"))
+
+
+def test_pointer_invalid():
+    """
+    Ensure invalid pointers are rejected when compiled, not when used.
+    """
+    with pytest.raises(ValueError) as exc:
+        Pointer("bob")
+
+    assert "no prefix" in str(exc.value)
+
+    with pytest.raises(ValueError):
+        Pointer("/a~2")
+
+    with pytest.raises(ValueError):
+        Pointer("/a~")
+
+    with pytest.raises(TypeError):
+        Pointer(1)
+
+
+@pytest.mark.parametrize(
+    "content",
+    [
+        """{
+            "size": 3,
+            "a/b": {"m~n": true},
+            "users": [
+                {"id": 1, "name": "Harry"},
+                {"id": 2, "name": "Ron"},
+                {"id": 3, "name": "Hermione"}
+            ]
+        }""",
+        {
+            "size": 3,
+            "a/b": {"m~n": True},
+            "users": [
+                {"id": 1, "name": "Harry"},
+                {"id": 2, "name": "Ron"},
+                {"id": 3, "name": "Hermione"},
+            ],
+        },
+    ],
+)
+def test_pointer_get(content):
+    """
+    Ensure compiled pointers resolve the same way as str pointers on both
+    mutable and immutable documents.
+    """
+    doc = Document(content)
+
+    for pointer in ("/size", "/users/0", "/users/2/name", "/a~1b/m~0n", ""):
+        assert doc.get_pointer(Pointer(pointer)) == doc.get_pointer(pointer)
+
+    for pointer in ("/users/3", "/users/-", "/users/01", "/nope", "/size/0"):
+        with pytest.raises(ValueError):
+            doc.get_pointer(Pointer(pointer))
+
+    assert doc.dumps(at_pointer=Pointer("/users/1")) == '{"id":2,"name":"Ron"}'
+
+    with pytest.raises(TypeError):
+        doc.get_pointer(1)
+
+
+def test_pointer_patch():
+    """
+    Ensure compiled pointers can be used to patch part of a document.
+    """
+    for original in (
+        '{"content": {"hello": "earth", "goodbye": "moon"}}',
+        {"content": {"hello": "earth", "goodbye": "moon"}},
+    ):
+        modified = Document(original).patch(
+            Document({"hello": "mars"}),
+            at_pointer=Pointer("/content"),
+            use_merge_patch=True,
+        )
+        assert modified.as_obj == {"hello": "mars", "goodbye": "moon"}
+
+
+@pytest.mark.parametrize(
+    "content",
+    [
+        '{"user": {"id": 1, "name": "Harry", "tags": ["a", "b"]}, "n": 2}',
+        {"user": {"id": 1, "name": "Harry", "tags": ["a", "b"]}, "n": 2},
+    ],
+)
+def test_get_many(content):
+    """
+    Ensure many pointers can be resolved at once, on both mutable and
+    immutable documents.
+    """
+    doc = Document(content)
+
+    assert doc.get_many([]) == ()
+    assert doc.get_many(
+        ["/user/id", Pointer("/user/name"), "/user/tags/1", "/n", "/user/id"]
+    ) == (1, "Harry", "b", 2, 1)
+    assert doc.get_many(("", "/n")) == (doc.as_obj, 2)
+
+    assert doc.get_many({"id": "/user/id", "tag": Pointer("/user/tags/0")}) == {
+        "id": 1,
+        "tag": "a",
+    }
+
+    assert doc.get_many(["/user/id", "/user/age", "/x/y"], default=None) == (
+        1,
+        None,
+        None,
+    )
+
+    with pytest.raises(ValueError) as exc:
+        doc.get_many(["/user/id", "/user/age"])
+
+    assert "/user/age" in str(exc.value)
+
+    with pytest.raises(ValueError):
+        doc.get_many(["user"])
+
+    with pytest.raises(TypeError):
+        doc.get_many([1])
@@ -0,0 +1,106 @@
+"""
+Tests for parsing only selected values with Document(..., select=...).
+"""
+import pytest
+
+from yyjson import Document, Pointer, ReaderFlags
+
+CONTENT = """{
+    "id": 7,
+    "meta": {"name": "a\\"]}", "tags": ["x", "y"], "a/b": {"c": 1}},
+    "rows": [{"k": 0}, {"k": 1, "v": [1, 2]}, {"k": 2}],
+    "escaped\\u0020key": true,
+    "tail": null
+}"""
+
+
+@pytest.mark.parametrize("make_content", [str, str.encode])
+def test_select(make_content):
+    """
+    Ensure only selected values are kept, along with the structure leading
+    to them.
+    """
+    doc = Document(
+        make_content(CONTENT),
+        select=[
+            "/id",
+            Pointer("/meta/a~1b"),
+            "/rows/1/v",
+            "/escaped key",
+            "/missing/value",
+            "/tail",
+        ],
+    )
+
+    assert not doc.is_thawed
+    assert doc.as_obj == {
+        "id": 7,
+        "meta": {"a/b": {"c": 1}},
+        "rows": [None, {"v": [1, 2]}],
+        "escaped key": True,
+        "tail": None,
+    }
+    assert doc.get_pointer("/rows/1/v/1") == 2
+
+
+def test_select_everything_or_nothing():
+    """
+    Ensure selecting the root parses everything, and selecting nothing
+    leaves empty containers.
+    """
+    assert Document(CONTENT, select=[""]).as_obj == Document(CONTENT).as_obj
+    assert Document(CONTENT, select=[]).as_obj == {}
+    assert Document("[1, 2]", select=["/5"]).as_obj == []
+    assert Document("5", select=["/a"]).as_obj is None
+
+    # Containers leading to missing values are kept, scalars aren't.
+    assert Document(
+        CONTENT, select=["/meta/missing", "/rows/1/x", "/id/x"]
+    ).as_obj == {"meta": {}, "rows": [None, {}]}
+
+
+def test_select_flags(tmp_path):
+    """
+    Ensure reader flags apply to both skipped and selected values, and that
+    files can be read with a selection.
+    """
+    content = '{"a": [1, /* ] */ 2,], // }\n "b": 1e400}'
+    flags = (
+        ReaderFlags.ALLOW_COMMENTS
+        | ReaderFlags.ALLOW_TRAILING_COMMAS
+        | ReaderFlags.NUMBERS_AS_RAW
+    )
+
+    assert Document(content, flags=flags, select=["/a/1"]).as_obj == {
+        "a": [None, 2]
+    }
+
+    path = tmp_path / "select.json"
+    path.write_text(CONTENT)
+    assert Document(path, select=["/id"]).as_obj == {"id": 7}
+
+
+def test_select_invalid():
+    """
+    Ensure structural errors are reported, along with errors in selected
+    values.
+    """
+    for content in (
+        "",
+        '{"a": 1',
+        '{"a" 1}',
+        "[1 2]",
+        '{"a": [1, 2}',
+        '{"b": "x}',
+        '{"a": tru}',
+        "[1] x",
+        "[1,]",
+    ):
+        with pytest.raises(ValueError):
+            Document(content, select=["/a"])
+
+    with pytest.raises(ValueError):
+        Document("{}", select=["a"])
+
+    with pytest.raises(TypeError):
+        Document({"a": 1}, select=["/a"])
@@ -0,0 +1,117 @@
+import os
+import subprocess
+import sys
+from multiprocessing import get_context
+from multiprocessing.shared_memory import SharedMemory
+
+import pytest
+
+from yyjson import Document
+
+CONTENT = '{"a": [1, -2.5, "s\\u00e9"], "b": {"c": null, "d": [true]}}'
+
+
+@pytest.fixture
+def shared():
+    shm = Document(CONTENT).to_shared()
+    yield shm
+    try:
+        shm.close()
+    except BufferError:
+        pass
+    shm.unlink()
+
+
+def attach(name, queue):
+    doc = Document.attach_shared(name)
+    queue.put((doc.as_obj, doc.is_shared))
+
+
+def test_shared(shared):
+    """
+    Ensure a Document attached in the process that shared it is used in
+    place.
+    """
+    doc = Document.attach_shared(shared.name)
+    assert doc == Document(CONTENT)
+    assert doc.get_pointer("/b/d/0") is True
+    assert doc.is_shared
+    assert not doc.is_thawed
+    assert not Document(CONTENT).is_shared
+
+    # The segment can't be unmapped while the Document uses it.
+    with pytest.raises(BufferError):
+        shared.close()
+    assert doc.as_obj == Document(CONTENT).as_obj
+
+
+def test_shared_thawed():
+    """
+    Ensure thawed Documents can be shared, and attached ones thawed.
+    """
+    shm = Document({"a": [1, 2]}).to_shared()
+    try:
+        doc = Document.attach_shared(shm.name)
+        assert doc.as_obj == {"a": [1, 2]}
+        doc.set("/a", 3)
+        assert doc.as_obj == {"a": 3}
+        assert not doc.is_shared
+        del doc
+    finally:
+        shm.close()
+        shm.unlink()
+
+
+@pytest.mark.skipif(not hasattr(os, "fork"), reason="requires fork()")
+def test_shared_fork(shared):
+    """
+    Ensure forked children use the segment in place.
+    """
+    context = get_context("fork")
+    queue = context.Queue()
+    process = context.Process(target=attach, args=(shared.name, queue))
+    process.start()
+    assert queue.get(timeout=30) == (Document(CONTENT).as_obj, True)
+    process.join()
+
+
+def test_shared_other_process(shared):
+    """
+    Ensure unrelated processes can attach, whether or not they can use the
+    segment in place.
+    """
+    code = (
+        "import sys, yyjson\n"
+        "doc = yyjson.Document.attach_shared(sys.argv[1])\n"
+        "print(doc.dumps())\n"
+    )
+    result = subprocess.run(
+        [sys.executable, "-c", code, shared.name],
+        capture_output=True,
+        check=True,
+        text=True,
+    )
+    assert Document(result.stdout) == Document(CONTENT)
+
+    # The other process mustn't have unlinked the segment when it exited.
+    assert Document.attach_shared(shared.name) == Document(CONTENT)
+
+
+def test_shared_invalid():
+    """
+    Ensure missing and invalid segments raise.
+    """
+    with pytest.raises(FileNotFoundError):
+        Document.attach_shared("yyjson_missing_segment")
+
+    with pytest.raises(TypeError):
+        Document.attach_shared(12)
+
+    shm = SharedMemory(create=True, size=64)
+    try:
+        shm.buf[:8] = b"notsnap\0"
+        with pytest.raises(ValueError, match="not a snapshot"):
+            Document.attach_shared(shm.name)
+    finally:
+        shm.close()
+        shm.unlink()
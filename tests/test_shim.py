@@ -37,3 +37,51 @@ def test_loads():
     Ensure we can load a document from a string.
     """
     assert yyjson.loads('{"a":1,"b":2}') == {"a": 1, "b": 2}
+
+
+def test_loads_number_hooks():
+    """
+    Ensure the number hooks are called like they are by json.loads().
+    """
+    import json
+    from decimal import Decimal
+
+    content = '[1, -2, 1.10, -0, -0.0, 1e400, 123456789012345678901234, {"a": 2.50}]'
+    for hooks in (
+        {"parse_float": Decimal},
+        {"parse_int": Decimal},
+        {"parse_float": str, "parse_int": str},
+        {"parse_int": float},
+    ):
+        assert yyjson.loads(content, **hooks) == json.loads(content, **hooks)
+
+    content = "[NaN, Infinity, -Infinity]"
+    assert yyjson.loads(content, parse_constant=str) == json.loads(
+        content, parse_constant=str
+    )
+
+    with BytesIO(b"[1.5, 2]") as test:
+        assert yyjson.load(test, parse_float=str) == ["1.5", 2]
+
+
+def test_loads_object_hooks():
+    """
+    Ensure the object hooks are called like they are by json.loads().
+    """
+    import json
+    from collections import OrderedDict
+
+    content = '{"b": 1, "a": [{"c": 2.5}, {}], "b": 3}'
+    for hooks in (
+        {"object_hook": lambda d: sorted(d.items())},
+        {"object_pairs_hook": list},
+        {"object_pairs_hook": OrderedDict},
+        {"object_hook": len, "object_pairs_hook": tuple},
+        {"object_pairs_hook": list, "parse_float": str},
+    ):
+        assert yyjson.loads(content, **hooks) == json.loads(content, **hooks)
+
+    with BytesIO(b'{"a": {"b": null}}') as test:
+        assert yyjson.load(test, object_pairs_hook=list) == [
+            ("a", [("b", None)])
+        ]
@@ -0,0 +1,137 @@
+import pickle
+import random
+from decimal import Decimal
+
+import pytest
+
+from yyjson import Document, ReaderFlags
+
+CONTENT = (
+    '{"a": [1, -2, 18446744073709551615, 2.5, "s\\u00e9\\"\\n", true,'
+    ' false, null, {}, [], [[{"k": "☃"}]]], "": {"b": "c"}}'
+)
+
+
+def test_snapshot():
+    """
+    Ensure a Document survives a snapshot unchanged.
+    """
+    doc = Document(CONTENT)
+    snapshot = doc.to_snapshot()
+    assert isinstance(snapshot, bytes)
+
+    loaded = Document.from_snapshot(snapshot)
+    assert loaded == doc
+    assert loaded.as_obj == doc.as_obj
+    assert loaded.dumps() == doc.dumps()
+    assert not loaded.is_thawed
+    assert loaded.get_pointer("/a/10/0/0/k") == "☃"
+
+    assert Document.from_snapshot(bytearray(snapshot)) == doc
+    assert Document.from_snapshot(memoryview(snapshot)) == doc
+
+    for content in ("1", '"s"', "[]", "{}", "null"):
+        doc = Document(content)
+        assert Document.from_snapshot(doc.to_snapshot()) == doc
+
+
+def test_snapshot_thawed():
+    """
+    Ensure thawed Documents can be snapshotted, and the result can be
+    modified.
+    """
+    doc = Document({"a": [1, 2], "b": "c"})
+    assert doc.is_thawed
+
+    loaded = Document.from_snapshot(doc.to_snapshot())
+    assert loaded == doc
+    loaded.set("/b", 3)
+    assert loaded.as_obj == {"a": [1, 2], "b": 3}
+
+    doc = Document(None)
+    assert Document.from_snapshot(doc.to_snapshot()).as_obj is None
+
+
+def test_snapshot_raw():
+    """
+    Ensure raw numbers are kept as-is.
+    """
+    doc = Document(
+        "[1.10, 123456789012345678901234567890]",
+        flags=ReaderFlags.NUMBERS_AS_DECIMAL,
+    )
+    loaded = Document.from_snapshot(doc.to_snapshot())
+    assert loaded.as_obj == [
+        Decimal("1.10"),
+        Decimal("123456789012345678901234567890"),
+    ]
+
+
+def test_snapshot_raw_invalid():
+    """
+    Ensure raw values that aren't exactly one number are rejected, since
+    they'd be written out verbatim.
+    """
+    snapshot = Document("[123]", flags=ReaderFlags.NUMBERS_AS_RAW).to_snapshot()
+    for raw in (b"]}x", b" 12", b"12 ", b"1-2"):
+        with pytest.raises(ValueError, match="raw value is not a number"):
+            Document.from_snapshot(snapshot.replace(b"123", raw))
+
+
+def test_snapshot_pickle():
+    """
+    Ensure Documents can be pickled, keeping whether they're thawed.
+    """
+    doc = Document(CONTENT)
+    loaded = pickle.loads(pickle.dumps(doc))
+    assert loaded == doc
+    assert not loaded.is_thawed
+
+    doc = Document({"a": 1})
+    loaded = pickle.loads(pickle.dumps(doc))
+    assert loaded == doc
+    assert loaded.is_thawed
+
+    class BadState:
+        def __bool__(self):
+            raise RuntimeError("no truth value")
+
+    with pytest.raises(RuntimeError, match="no truth value"):
+        Document("{}").__setstate__(BadState())
+
+
+def test_snapshot_invalid():
+    """
+    Ensure invalid snapshots raise instead of producing broken Documents.
+    """
+    snapshot = Document(CONTENT).to_snapshot()
+
+    with pytest.raises(ValueError, match="not a snapshot"):
+        Document.from_snapshot(b"x" * 64)
+
+    for size in (0, 8, 31, 32, 48, len(snapshot) - 1):
+        with pytest.raises(ValueError):
+            Document.from_snapshot(snapshot[:size])
+
+    with pytest.raises(ValueError):
+        Document.from_snapshot(snapshot + b"\0")
+
+    with pytest.raises(TypeError):
+        Document.from_snapshot("snapshot")
+
+    # Corrupt bytes anywhere must be rejected, or load a Document that's
+    # safe to use even if its content is wrong.
+    rng = random.Random(0)
+    for _ in range(2000):
+        corrupt = bytearray(snapshot)
+        for _ in range(rng.randint(1, 3)):
+            corrupt[rng.randrange(len(corrupt))] = rng.randrange(256)
+        try:
+            loaded = Document.from_snapshot(corrupt)
+        except ValueError:
+            continue
+        try:
+            loaded.as_obj
+            loaded.dumps()
+        except (ValueError, ArithmeticError):
+            pass
@@ -1,8 +1,34 @@
-__all__ = ["Document", "ReaderFlags", "WriterFlags"]
+__all__ = [
+    "Cursor",
+    "Document",
+    "IncrementalParser",
+    "JSONPath",
+    "Patch",
+    "Pointer",
+    "ReaderFlags",
+    "WriterFlags",
+    "aiter_ndjson",
+    "decode",
+    "iter_array",
+    "iter_events",
+]
 
+import dataclasses
 import enum
+import os
+import types
+import typing
 
-from cyyjson import Document
+from cyyjson import (
+    ArrayStream,
+    Cursor,
+    Document,
+    EventIter,
+    IncrementalParser,
+    JSONPath,
+    Patch,
+    Pointer,
+)
 
 
 class ReaderFlags(enum.IntFlag):
@@ -57,19 +83,416 @@ class WriterFlags(enum.IntFlag):
     INF_AND_NAN_AS_NULL = 0x10
     #: Write a newline at the end of the JSON string.
     WRITE_NEWLINE_AT_END = 0x80
+    #: Write canonical JSON following RFC 8785 (JCS), with object members
+    #: sorted by key, numbers formatted like ECMAScript and minimal string
+    #: escaping. All other flags except `WRITE_NEWLINE_AT_END` are ignored.
+    CANONICAL = 0x10000
 
 
-def load(fp):
-    return Document(fp.read()).as_obj
+# Kinds of steps in a decode plan, which must match DecodeKind in decode.h.
+_ANY = 0
+_NONE = 1
+_BOOL = 2
+_INT = 3
+_FLOAT = 4
+_STR = 5
+_LIST = 6
+_TUPLE = 7
+_FIXED_TUPLE = 8
+_DICT = 9
+_DATACLASS = 10
+_TYPEDDICT = 11
+_UNION = 12
+_REF = 13
 
+_SCALAR_PLANS = {
+    typing.Any: (_ANY,),
+    object: (_ANY,),
+    None: (_NONE,),
+    type(None): (_NONE,),
+    bool: (_BOOL,),
+    int: (_INT,),
+    float: (_FLOAT,),
+    str: (_STR,),
+}
 
-def loads(s):
-    return Document(s).as_obj
+_UNION_TYPES = (typing.Union,)
+if hasattr(types, "UnionType"):
+    # X | Y unions, on Python 3.10+.
+    _UNION_TYPES += (types.UnionType,)
 
+_decode_plans = {}
 
-def dumps(obj, *, default=None):
-    return Document(obj, default=default).dumps()
 
+def _is_typeddict(tp):
+    return (
+        isinstance(tp, type)
+        and issubclass(tp, dict)
+        and hasattr(tp, "__required_keys__")
+    )
 
-def dump(obj, fp, *, default=None):
-    fp.write(Document(obj, default=default).dumps())
+
+def _compile_fields(tp, names, hints, required, building):
+    # Recursive types refer back to themselves through a cell that's
+    # filled in once their plan is complete.
+    cell = [None]
+    building[tp] = cell
+    try:
+        plans = tuple(_compile_plan(hints[name], building) for name in names)
+    finally:
+        del building[tp]
+
+    if dataclasses.is_dataclass(tp):
+        plan = (_DATACLASS, tp, tuple(names), plans, tuple(required))
+    else:
+        plan = (_TYPEDDICT, tuple(names), plans, tuple(required))
+    cell[0] = plan
+    return plan
+
+
+def _compile_plan(tp, building):
+    try:
+        return _SCALAR_PLANS[tp]
+    except (KeyError, TypeError):
+        pass
+
+    if tp in building:
+        return (_REF, building[tp])
+
+    origin = typing.get_origin(tp)
+    args = typing.get_args(tp)
+
+    if origin is typing.Annotated:
+        return _compile_plan(args[0], building)
+
+    if origin in _UNION_TYPES:
+        return (_UNION, tuple(_compile_plan(arg, building) for arg in args))
+
+    if tp is list or origin is list:
+        return (_LIST, _compile_plan(args[0] if args else typing.Any, building))
+
+    if tp is tuple or origin is tuple:
+        if not args or (len(args) == 2 and args[1] is Ellipsis):
+            return (
+                _TUPLE,
+                _compile_plan(args[0] if args else typing.Any, building),
+            )
+        if args == ((),):
+            return (_FIXED_TUPLE, ())
+        return (
+            _FIXED_TUPLE,
+            tuple(_compile_plan(arg, building) for arg in args),
+        )
+
+    if tp is dict or origin is dict:
+        if args and args[0] not in (str, typing.Any):
+            raise TypeError(f"JSON object keys are str, not {args[0]!r}")
+        return (_DICT, _compile_plan(args[1] if args else typing.Any, building))
+
+    if isinstance(tp, type) and dataclasses.is_dataclass(tp):
+        hints = typing.get_type_hints(tp)
+        fields = [f for f in dataclasses.fields(tp) if f.init]
+        return _compile_fields(
+            tp,
+            [f.name for f in fields],
+            hints,
+            [
+                f.default is dataclasses.MISSING
+                and f.default_factory is dataclasses.MISSING
+                for f in fields
+            ],
+            building,
+        )
+
+    if _is_typeddict(tp):
+        hints = typing.get_type_hints(tp)
+        return _compile_fields(
+            tp,
+            list(hints),
+            hints,
+            [name in tp.__required_keys__ for name in hints],
+            building,
+        )
+
+    raise TypeError(f"Can't decode JSON into {tp!r}")
+
+
+def _decode_plan(tp):
+    try:
+        return _decode_plans[tp]
+    except KeyError:
+        plan = _decode_plans[tp] = _compile_plan(tp, {})
+        return plan
+    except TypeError:
+        # Unhashable types can't be cached.
+        return _compile_plan(tp, {})
+
+
+def decode(content, type=typing.Any, *, flags=0):
+    """
+    Parse JSON directly into instances of the given type, validating it as
+    it goes.
+
+    Supported types are ``int``, ``float``, ``str``, ``bool``, ``None``,
+    ``typing.Any``, ``list[...]``, ``tuple[...]``, ``dict[str, ...]``,
+    dataclasses, ``TypedDict``'s and unions of them, such as
+    ``Optional[...]``. Members of objects that aren't fields of the
+    dataclass or ``TypedDict`` are ignored, and unions pick the first type
+    that accepts the JSON type of the value. The plan for converting each
+    type is compiled once and cached. Ex:
+
+    .. doctest::
+
+        >>> from dataclasses import dataclass
+        >>> @dataclass
+        ... class Event:
+        ...     id: int
+        ...     tags: list[str]
+        >>> decode(b'[{"id": 1, "tags": ["a"]}]', list[Event])
+        [Event(id=1, tags=['a'])]
+        >>> decode(b'[{"id": 1, "tags": [2]}]', list[Event])
+        Traceback (most recent call last):
+        ...
+        TypeError: expected string, got integer at /0/tags/0
+
+    :param content: The JSON to decode, as accepted by :class:`Document`.
+    :param type: The type to decode into.
+    :param flags: Flags that modify the parsing behaviour.
+    :type flags: :class:`ReaderFlags`, optional
+    :raises TypeError: If a value has the wrong JSON type, with the JSON
+                       Pointer to it.
+    :raises ValueError: If a required field is missing, or the JSON is
+                        invalid.
+    """
+    if not isinstance(content, Document):
+        content = Document(content, flags=flags)
+    return content._decode(_decode_plan(type))
+
+
+async def aiter_ndjson(stream, *, flags=0, chunk_size=65536, executor=None):
+    """
+    Asynchronously iterate over the documents in an NDJSON (or concatenated
+    JSON) stream, such as an :class:`asyncio.StreamReader`, as Python
+    objects.
+
+    The stream is read in chunks of up to ``chunk_size`` bytes, each holding
+    a batch of lines, which are parsed by an :class:`IncrementalParser` on a
+    worker thread from ``executor`` so the event loop isn't blocked. Large
+    chunks are parsed without holding the GIL. The next chunk is read and
+    parsed while the current batch is consumed, but never more than one, so
+    a slow consumer slows down reading. Ex:
+
+    .. doctest::
+
+        >>> import asyncio
+        >>> async def main():
+        ...     reader = asyncio.StreamReader()
+        ...     reader.feed_data(b'{"id": 1}\\n{"id"')
+        ...     reader.feed_data(b': 2}\\n')
+        ...     reader.feed_eof()
+        ...     return [obj async for obj in aiter_ndjson(reader)]
+        >>> asyncio.run(main())
+        [{'id': 1}, {'id': 2}]
+
+    :param stream: An object with an async ``read(n)`` method, or an async
+                   iterable of ``bytes`` chunks.
+    :param flags: Flags that modify the parsing behaviour.
+    :type flags: :class:`ReaderFlags`, optional
+    :param chunk_size: The most bytes to read from ``stream`` at once.
+    :param executor: The :class:`concurrent.futures.Executor` to parse on,
+                     or ``None`` for the event loop's default.
+    :raises ValueError: If a document is invalid.
+    """
+    import asyncio
+
+    loop = asyncio.get_running_loop()
+    parser = IncrementalParser(flags=flags)
+
+    if hasattr(stream, "read"):
+
+        async def read_chunks():
+            while True:
+                chunk = await stream.read(chunk_size)
+                if not chunk:
+                    return
+                yield chunk
+
+        chunks = read_chunks()
+    else:
+        chunks = stream.__aiter__()
+
+    def parse(chunk):
+        docs = parser.close() if chunk is None else parser.feed(chunk)
+        return [doc.as_obj for doc in docs]
+
+    async def next_batch():
+        try:
+            chunk = await chunks.__anext__()
+        except StopAsyncIteration:
+            chunk = None
+        return chunk is None, await loop.run_in_executor(executor, parse, chunk)
+
+    pending = asyncio.ensure_future(next_batch())
+    try:
+        while pending is not None:
+            done, batch = await pending
+            pending = None if done else asyncio.ensure_future(next_batch())
+            for obj in batch:
+                yield obj
+    finally:
+        if pending is not None:
+            pending.cancel()
+
+
+def iter_events(source, *, flags=0, chunk_size=65536):
+    """
+    Iterate over the ``(event, value)`` tuples of a JSON document, without
+    building it, for documents too large to hold in memory.
+
+    Events are ``start_map``, ``map_key``, ``end_map``, ``start_array``,
+    ``end_array``, ``string``, ``number``, ``boolean`` and ``null``, the
+    same names used by ijson. Values are ``None`` for the start and end of
+    containers. Files are read ``chunk_size`` bytes at a time, so memory
+    use only grows with nesting depth and the longest string or number,
+    not the size of the document. Strings and numbers are read with
+    yyjson's own readers. Ex:
+
+    .. doctest::
+
+        >>> for event, value in iter_events(b'{"a": [1, "b", null]}'):
+        ...     print(event, value)
+        start_map None
+        map_key a
+        start_array None
+        number 1
+        string b
+        null None
+        end_array None
+        end_map None
+
+    :param source: The JSON to read, as a ``Path``, a file object opened in
+                   either mode, or a ``str`` or bytes-like object.
+    :param flags: Flags that modify the parsing behaviour.
+    :type flags: :class:`ReaderFlags`, optional
+    :param chunk_size: The number of bytes to read from files at a time.
+    :raises ValueError: If the JSON is invalid, when the parser reaches the
+                        problem.
+    """
+    if isinstance(source, os.PathLike):
+        return _iter_path_events(source, flags, chunk_size)
+    return EventIter(source, flags=flags, chunk_size=chunk_size)
+
+
+def _iter_path_events(path, flags, chunk_size):
+    with open(path, "rb") as fp:
+        yield from EventIter(fp, flags=flags, chunk_size=chunk_size)
+
+
+def iter_array(
+    source, pointer="", *, flags=0, chunk_size=65536, as_documents=False
+):
+    """
+    Iterate over the elements of the array at the given JSON pointer
+    (RFC 6901), reading the source once and parsing each element on its
+    own.
+
+    Only one element is held in memory at a time, so a document like
+    ``{"meta": ..., "items": [...millions...]}`` needs no more memory than
+    its largest item. Everything before the array is skipped without being
+    parsed, and nothing after it is read. Ex:
+
+    .. doctest::
+
+        >>> content = b'{"meta": {"n": 2}, "items": [{"id": 1}, {"id": 2}]}'
+        >>> list(iter_array(content, "/items"))
+        [{'id': 1}, {'id': 2}]
+
+    .. note::
+
+        Values skipped before the array are only checked for matching
+        brackets and quotes, and must each fit in memory.
+
+    :param source: The JSON to read, as a ``Path``, a file object opened in
+                   either mode, or a ``str`` or bytes-like object.
+    :param pointer: JSON Pointer to the array, the root by default.
+    :type pointer: ``str`` or :class:`Pointer`, optional
+    :param flags: Flags that modify the parsing behaviour.
+    :type flags: :class:`ReaderFlags`, optional
+    :param chunk_size: The number of bytes to read from files at a time.
+    :param as_documents: If ``True``, each element is returned as a
+                         :class:`Document` rather than converted.
+    :raises ValueError: If nothing is at the pointer, or the JSON is
+                        invalid.
+    :raises TypeError: If the value at the pointer isn't an array.
+    """
+    kwargs = {
+        "flags": flags,
+        "chunk_size": chunk_size,
+        "as_documents": as_documents,
+    }
+    if isinstance(source, os.PathLike):
+        return _iter_path_array(source, pointer, kwargs)
+    return ArrayStream(source, pointer, **kwargs)
+
+
+def _iter_path_array(path, pointer, kwargs):
+    with open(path, "rb") as fp:
+        yield from ArrayStream(fp, pointer, **kwargs)
+
+
+def load(
+    fp,
+    *,
+    object_hook=None,
+    parse_float=None,
+    parse_int=None,
+    parse_constant=None,
+    object_pairs_hook=None,
+):
+    return loads(
+        fp.read(),
+        object_hook=object_hook,
+        parse_float=parse_float,
+        parse_int=parse_int,
+        parse_constant=parse_constant,
+        object_pairs_hook=object_pairs_hook,
+    )
+
+
+def loads(
+    s,
+    *,
+    object_hook=None,
+    parse_float=None,
+    parse_int=None,
+    parse_constant=None,
+    object_pairs_hook=None,
+):
+    number_hooks = (parse_float, parse_int, parse_constant)
+    if all(hook is None for hook in number_hooks):
+        if object_hook is None and object_pairs_hook is None:
+            return Document(s).as_obj
+        return Document(s).to_obj(
+            object_hook=object_hook, object_pairs_hook=object_pairs_hook
+        )
+
+    # Hooks are given the original text of numbers, which needs them read
+    # as raw.
+    flags = ReaderFlags.NUMBERS_AS_RAW
+    if parse_constant is not None:
+        flags |= ReaderFlags.ALLOW_INF_AND_NAN
+    return Document(s, flags=flags).to_obj(
+        object_hook=object_hook,
+        parse_float=parse_float,
+        parse_int=parse_int,
+        parse_constant=parse_constant,
+        object_pairs_hook=object_pairs_hook,
+    )
+
+
+def dumps(obj, *, default=None, flags=0):
+    return Document(obj, default=default).dumps(flags=flags)
+
+
+def dump(obj, fp, *, default=None, flags=0):
+    fp.write(Document(obj, default=default).dumps(flags=flags))
@@ -1,6 +1,26 @@
+import array
 import enum
+from concurrent.futures import Executor
+from multiprocessing.shared_memory import SharedMemory
 from pathlib import Path
-from typing import Any, Optional, List, Dict, Union, Callable
+from typing import (
+    Any,
+    AsyncIterator,
+    Optional,
+    List,
+    Dict,
+    Iterable,
+    Iterator,
+    Tuple,
+    Union,
+    Callable,
+    overload,
+    Literal,
+    Type,
+    TypeVar,
+)
+
+T = TypeVar("T")
 
 class ReaderFlags(enum.IntFlag):
     STOP_WHEN_DONE = 0x02
@@ -19,9 +39,74 @@ class WriterFlags(enum.IntFlag):
     ALLOW_INF_AND_NAN = 0x08
     INF_AND_NAN_AS_NULL = 0x10
     WRITE_NEWLINE_AT_END = 0x80
+    CANONICAL = 0x10000
 
 Content = Union[str, bytes, List, Dict, Path]
 
+class Pointer:
+    def __init__(self, pointer: str): ...
+    def __len__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    @property
+    def tokens(self) -> Tuple[str, ...]: ...
+
+PointerLike = Union[str, Pointer]
+
+class JSONPath:
+    def __init__(self, query: str): ...
+
+class Patch:
+    def __init__(self, patch: Union["Document", List[Dict[str, Any]]]): ...
+    def __len__(self) -> int: ...
+    def apply(
+        self,
+        document: "Document",
+        *,
+        at_pointer: Optional[PointerLike] = None,
+        inplace: bool = False
+    ) -> "Document": ...
+    def patch_many(
+        self,
+        documents: Iterable["Document"],
+        *,
+        at_pointer: Optional[PointerLike] = None,
+        inplace: bool = False
+    ) -> List["Document"]: ...
+
+class Cursor:
+    def __init__(
+        self, content: Union[str, bytes], *, flags: Optional[ReaderFlags] = ...
+    ): ...
+    def find_field(self, key: str) -> "Cursor": ...
+    def iter_array(self) -> Iterator["Cursor"]: ...
+    def skip(self) -> None: ...
+    def get_str(self) -> str: ...
+    def get_int(self) -> int: ...
+    def get_float(self) -> float: ...
+    def get_bool(self) -> bool: ...
+    def is_null(self) -> bool: ...
+    def get_value(self) -> Any: ...
+    @property
+    def type(self) -> Optional[str]: ...
+    @property
+    def depth(self) -> int: ...
+    @property
+    def position(self) -> int: ...
+
+class IncrementalParser:
+    def __init__(self, *, flags: Optional[ReaderFlags] = ...): ...
+    def feed(
+        self, chunk: Union[str, bytes, bytearray, memoryview]
+    ) -> List["Document"]: ...
+    def close(self) -> List["Document"]: ...
+
+class ArrowExport:
+    def __len__(self) -> int: ...
+    def __arrow_c_schema__(self) -> Any: ...
+    def __arrow_c_array__(
+        self, requested_schema: Optional[Any] = None
+    ) -> Tuple[Any, Any]: ...
+
 class Document:
     as_obj: Any
     def __init__(
@@ -29,26 +114,132 @@ class Document:
         content: Content,
         flags: Optional[ReaderFlags] = ...,
         default: Callable[[Any], Any] = ...,
+        select: Optional[Iterable[PointerLike]] = ...,
     ): ...
     def __len__(self) -> int: ...
-    def get_pointer(self, pointer: str) -> Any: ...
+    def to_obj(
+        self,
+        *,
+        parse_float: Optional[Callable[[str], Any]] = None,
+        parse_int: Optional[Callable[[str], Any]] = None,
+        parse_constant: Optional[Callable[[str], Any]] = None,
+        object_hook: Optional[Callable[[Dict[str, Any]], Any]] = None,
+        object_pairs_hook: Optional[
+            Callable[[List[Tuple[str, Any]]], Any]
+        ] = None,
+    ) -> Any: ...
+    def get_pointer(self, pointer: PointerLike) -> Any: ...
+    def get_array(
+        self, pointer: PointerLike, *, typecode: str = "d"
+    ) -> array.array: ...
+    def to_arrow(
+        self, pointer: Optional[PointerLike] = None, schema: Optional[Any] = None
+    ) -> ArrowExport: ...
+    @overload
+    def get_many(
+        self, pointers: Dict[Any, PointerLike], *, default: Any = ...
+    ) -> Dict[Any, Any]: ...
+    @overload
+    def get_many(
+        self, pointers: Iterable[PointerLike], *, default: Any = ...
+    ) -> Tuple[Any, ...]: ...
+    @overload
+    def query(
+        self, path: Union[str, JSONPath], *, as_documents: Literal[False] = ...
+    ) -> List[Any]: ...
+    @overload
+    def query(
+        self, path: Union[str, JSONPath], *, as_documents: Literal[True]
+    ) -> List["Document"]: ...
+    def set(
+        self, pointer: PointerLike, value: Any, *, create_parents: bool = True
+    ) -> None: ...
+    def add(
+        self, pointer: PointerLike, value: Any, *, create_parents: bool = True
+    ) -> None: ...
+    def replace(self, pointer: PointerLike, value: Any) -> None: ...
+    def remove(self, pointer: PointerLike) -> None: ...
+    def extend(self, pointer: PointerLike, values: Iterable[Any]) -> None: ...
     def dumps(
         self,
         flags: Optional[WriterFlags] = ...,
-        at_pointer: Optional[str] = ...,
+        at_pointer: Optional[PointerLike] = ...,
     ) -> str: ...
     def patch(
         self,
-        patch: "Document",
+        patch: Union["Document", Patch],
         *,
-        at_pointer: Optional[str] = None,
-        use_merge_patch: bool = False
+        at_pointer: Optional[PointerLike] = None,
+        use_merge_patch: bool = False,
+        inplace: bool = False
     ) -> "Document": ...
+    def diff(self, other: "Document") -> "Document": ...
+    def merge_diff(self, other: "Document") -> "Document": ...
+    def content_hash(self, *, bits: Literal[64, 128] = 64) -> int: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __hash__(self) -> int: ...
     @property
     def is_thawed(self) -> bool: ...
+    @property
+    def is_shared(self) -> bool: ...
     def freeze(self) -> None: ...
     def thaw(self) -> None: ...
+    def to_snapshot(self) -> bytes: ...
+    @classmethod
+    def from_snapshot(
+        cls, buf: Union[bytes, bytearray, memoryview]
+    ) -> "Document": ...
+    def to_msgpack(self) -> bytes: ...
+    @classmethod
+    def from_msgpack(
+        cls, buf: Union[bytes, bytearray, memoryview]
+    ) -> "Document": ...
+    def to_cbor(self) -> bytes: ...
+    @classmethod
+    def from_cbor(
+        cls, buf: Union[bytes, bytearray, memoryview]
+    ) -> "Document": ...
+    def to_shared(self, name: Optional[str] = None) -> SharedMemory: ...
+    @classmethod
+    def attach_shared(cls, name: str) -> "Document": ...
 
+def aiter_ndjson(
+    stream: Any,
+    *,
+    flags: Optional[ReaderFlags] = ...,
+    chunk_size: int = ...,
+    executor: Optional[Executor] = ...,
+) -> AsyncIterator[Any]: ...
+def decode(
+    content: Union[Content, Document],
+    type: Type[T] = ...,
+    *,
+    flags: Optional[ReaderFlags] = ...,
+) -> T: ...
+@overload
+def iter_array(
+    source: Union[Path, str, bytes, bytearray, memoryview, Any],
+    pointer: PointerLike = ...,
+    *,
+    flags: Optional[ReaderFlags] = ...,
+    chunk_size: int = ...,
+    as_documents: Literal[False] = ...,
+) -> Iterator[Any]: ...
+@overload
+def iter_array(
+    source: Union[Path, str, bytes, bytearray, memoryview, Any],
+    pointer: PointerLike = ...,
+    *,
+    flags: Optional[ReaderFlags] = ...,
+    chunk_size: int = ...,
+    as_documents: Literal[True],
+) -> Iterator[Document]: ...
+def iter_events(
+    source: Union[Path, str, bytes, bytearray, memoryview, Any],
+    *,
+    flags: Optional[ReaderFlags] = ...,
+    chunk_size: int = ...,
+) -> Iterator[Tuple[str, Any]]: ...
 def load(
     fp,
     *,
@@ -83,6 +274,7 @@ def dumps(
     separators=None,
     default=None,
     sort_keys=False,
+    flags: WriterFlags = ...,
     **kw
 ): ...
 def dump(
@@ -98,5 +290,6 @@ def dump(
     separators=None,
     default=None,
     sort_keys=False,
+    flags: WriterFlags = ...,
     **kw
 ): ...
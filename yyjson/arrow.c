@@ -0,0 +1,1015 @@
+#include "arrow.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "value.h"
+
+/*============================================================================
+ * Types
+ *==========================================================================*/
+
+static const struct {
+  const char *format;
+  const char *name;
+  /** The size of a value in the data buffer, for fixed width types. */
+  size_t width;
+  int64_t min;
+  uint64_t max;
+} arrow_kinds[] = {
+    [ARROW_NA] = {"n", "null", 0, 0, 0},
+    [ARROW_BOOL] = {"b", "bool", 0, 0, 0},
+    [ARROW_INT8] = {"c", "int8", 1, INT8_MIN, INT8_MAX},
+    [ARROW_INT16] = {"s", "int16", 2, INT16_MIN, INT16_MAX},
+    [ARROW_INT32] = {"i", "int32", 4, INT32_MIN, INT32_MAX},
+    [ARROW_INT64] = {"l", "int64", 8, INT64_MIN, INT64_MAX},
+    [ARROW_UINT8] = {"C", "uint8", 1, 0, UINT8_MAX},
+    [ARROW_UINT16] = {"S", "uint16", 2, 0, UINT16_MAX},
+    [ARROW_UINT32] = {"I", "uint32", 4, 0, UINT32_MAX},
+    [ARROW_UINT64] = {"L", "uint64", 8, 0, UINT64_MAX},
+    [ARROW_FLOAT32] = {"f", "float", 4, 0, 0},
+    [ARROW_FLOAT64] = {"g", "double", 8, 0, 0},
+    [ARROW_UTF8] = {"u", "string", 0, 0, 0},
+    [ARROW_LIST] = {"+l", "list", 0, 0, 0},
+    [ARROW_STRUCT] = {"+s", "struct", 0, 0, 0},
+};
+
+static inline bool arrow_is_int(ArrowKind kind) {
+  return kind >= ARROW_INT8 && kind <= ARROW_UINT64;
+}
+
+static void arrow_type_clear(ArrowType *type) {
+  for (Py_ssize_t i = 0; i < type->n_children; i++) {
+    arrow_type_clear(&type->children[i]);
+  }
+  PyMem_Free(type->children);
+  PyMem_Free(type->name);
+  memset(type, 0, sizeof(ArrowType));
+}
+
+/**
+ * Add a child to a list or struct type, returning its index or -1.
+ */
+static Py_ssize_t arrow_type_add_child(
+    ArrowType *type, const char *name, size_t name_len
+) {
+  if (type->n_children == type->children_cap) {
+    Py_ssize_t cap = type->children_cap ? type->children_cap * 2 : 4;
+    ArrowType *children =
+        PyMem_Realloc(type->children, sizeof(ArrowType) * cap);
+    if (!children) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    type->children = children;
+    type->children_cap = cap;
+  }
+
+  ArrowType *child = &type->children[type->n_children];
+  memset(child, 0, sizeof(ArrowType));
+  child->name = PyMem_Malloc(name_len + 1);
+  if (!child->name) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  memcpy(child->name, name, name_len);
+  child->name[name_len] = '\0';
+  child->name_len = name_len;
+  child->nullable = true;
+
+  return type->n_children++;
+}
+
+/**
+ * Returns the name of a value's JSON type, for error messages.
+ */
+static const char *arrow_val_name(void *val) {
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return "null";
+    case YYJSON_TYPE_BOOL:
+      return "boolean";
+    case YYJSON_TYPE_NUM:
+    case YYJSON_TYPE_RAW:
+      return "number";
+    case YYJSON_TYPE_STR:
+      return "string";
+    case YYJSON_TYPE_ARR:
+      return "array";
+    default:
+      return "object";
+  }
+}
+
+static bool arrow_infer_conflict(ArrowType *type, void *val) {
+  PyErr_Format(
+      PyExc_TypeError,
+      "can't infer one Arrow type for both %s and %s values",
+      arrow_kinds[type->kind].name, arrow_val_name(val)
+  );
+  return false;
+}
+
+/**
+ * Widen type to also fit val.
+ */
+static bool arrow_infer(ArrowType *type, void *val, bool mut) {
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return true;
+    case YYJSON_TYPE_BOOL:
+      if (type->kind == ARROW_NA) type->kind = ARROW_BOOL;
+      return type->kind == ARROW_BOOL || arrow_infer_conflict(type, val);
+    case YYJSON_TYPE_NUM:
+    case YYJSON_TYPE_RAW: {
+      bool is_int = unsafe_yyjson_is_sint(val) ||
+                    (unsafe_yyjson_is_uint(val) &&
+                     unsafe_yyjson_get_uint(val) <= INT64_MAX);
+      if (type->kind == ARROW_NA) {
+        type->kind = is_int ? ARROW_INT64 : ARROW_FLOAT64;
+      } else if (type->kind == ARROW_INT64 && !is_int) {
+        type->kind = ARROW_FLOAT64;
+      }
+      return type->kind == ARROW_INT64 || type->kind == ARROW_FLOAT64 ||
+             arrow_infer_conflict(type, val);
+    }
+    case YYJSON_TYPE_STR:
+      if (type->kind == ARROW_NA) type->kind = ARROW_UTF8;
+      return type->kind == ARROW_UTF8 || arrow_infer_conflict(type, val);
+    default:
+      break;
+  }
+
+  bool is_obj = val_is_obj(val);
+  if (type->kind == ARROW_NA) {
+    type->kind = is_obj ? ARROW_STRUCT : ARROW_LIST;
+    if (!is_obj && arrow_type_add_child(type, "item", 4) < 0) return false;
+  }
+  if (type->kind != (is_obj ? ARROW_STRUCT : ARROW_LIST)) {
+    return arrow_infer_conflict(type, val);
+  }
+
+  if (Py_EnterRecursiveCall(" while inferring an Arrow type")) {
+    return false;
+  }
+
+  ValIter iter;
+  void *item;
+  Py_ssize_t hint = 0;
+  bool ok = true;
+  val_iter_init(&iter, val, mut);
+  while (ok && (item = val_iter_next(&iter))) {
+    if (!is_obj) {
+      ok = arrow_infer(&type->children[0], item, mut);
+      continue;
+    }
+
+    // Records usually share the order of their fields, so the search for
+    // each starts after the previous match.
+    const char *key = unsafe_yyjson_get_str(item);
+    size_t key_len = unsafe_yyjson_get_len(item);
+    Py_ssize_t field = -1;
+    for (Py_ssize_t n = 0; n < type->n_children; n++) {
+      Py_ssize_t i = (hint + n) % type->n_children;
+      if (type->children[i].name_len == key_len &&
+          memcmp(type->children[i].name, key, key_len) == 0) {
+        field = i;
+        break;
+      }
+    }
+    if (field == -1) {
+      field = arrow_type_add_child(type, key, key_len);
+      if (field < 0) {
+        ok = false;
+        break;
+      }
+    }
+    hint = field + 1;
+
+    ok = arrow_infer(&type->children[field], val_key_value(item, mut), mut);
+  }
+
+  Py_LeaveRecursiveCall();
+  return ok;
+}
+
+/**
+ * Read the type described by an ArrowSchema.
+ */
+static bool arrow_type_from_schema(
+    ArrowType *type, struct ArrowSchema *schema
+) {
+  type->kind = ARROW_NA;
+  type->nullable = (schema->flags & ARROW_FLAG_NULLABLE) != 0;
+  for (size_t k = 0; k < sizeof(arrow_kinds) / sizeof(arrow_kinds[0]); k++) {
+    if (strcmp(schema->format, arrow_kinds[k].format) == 0) {
+      type->kind = (ArrowKind)k;
+      break;
+    }
+  }
+
+  if (type->kind == ARROW_NA && strcmp(schema->format, "n") != 0) {
+    PyErr_Format(
+        PyExc_ValueError, "Unsupported Arrow format '%s' in schema.",
+        schema->format
+    );
+    return false;
+  }
+
+  if (type->kind != ARROW_LIST && type->kind != ARROW_STRUCT) {
+    return true;
+  }
+
+  if (type->kind == ARROW_LIST && schema->n_children != 1) {
+    PyErr_SetString(PyExc_ValueError, "An Arrow list must have one child.");
+    return false;
+  }
+
+  for (int64_t i = 0; i < schema->n_children; i++) {
+    struct ArrowSchema *child = schema->children[i];
+    const char *name = child->name ? child->name : "";
+    Py_ssize_t idx = arrow_type_add_child(type, name, strlen(name));
+    if (idx < 0 || !arrow_type_from_schema(&type->children[idx], child)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*============================================================================
+ * Exported arrays and schemas
+ *==========================================================================*/
+
+/**
+ * The producer data of an exported ArrowArray. Exported memory is
+ * allocated with malloc() since consumers may release it from any thread,
+ * without holding the GIL.
+ */
+typedef struct {
+  void *buffers[3];
+  /** The size of each buffer in bytes, for copying. */
+  size_t sizes[3];
+  const void *buffer_ptrs[3];
+  struct ArrowArray *children;
+  struct ArrowArray **child_ptrs;
+} ArrowArrayPrivate;
+
+static void arrow_array_release(struct ArrowArray *array) {
+  ArrowArrayPrivate *priv = array->private_data;
+
+  if (priv) {
+    for (int64_t i = 0; priv->child_ptrs && i < array->n_children; i++) {
+      // Children may have been moved out by the consumer.
+      if (priv->child_ptrs[i]->release) {
+        priv->child_ptrs[i]->release(priv->child_ptrs[i]);
+      }
+    }
+    free(priv->children);
+    free(priv->child_ptrs);
+    for (int i = 0; i < 3; i++) free(priv->buffers[i]);
+    free(priv);
+  }
+
+  array->release = NULL;
+}
+
+/**
+ * Set up an empty ArrowArray with n_children, which is released properly
+ * however far filling it in gets.
+ */
+static ArrowArrayPrivate *arrow_array_init(
+    struct ArrowArray *array, int64_t n_buffers, int64_t n_children
+) {
+  memset(array, 0, sizeof(struct ArrowArray));
+  array->release = arrow_array_release;
+  array->n_buffers = n_buffers;
+
+  ArrowArrayPrivate *priv = calloc(1, sizeof(ArrowArrayPrivate));
+  if (!priv) return NULL;
+  array->private_data = priv;
+  array->buffers = priv->buffer_ptrs;
+
+  if (n_children) {
+    priv->children = calloc(n_children, sizeof(struct ArrowArray));
+    priv->child_ptrs = calloc(n_children, sizeof(struct ArrowArray *));
+    if (!priv->children || !priv->child_ptrs) return NULL;
+    for (int64_t i = 0; i < n_children; i++) {
+      priv->child_ptrs[i] = &priv->children[i];
+    }
+    array->children = priv->child_ptrs;
+    array->n_children = n_children;
+  }
+
+  return priv;
+}
+
+/**
+ * Deep copy an array built by this module, so it can be exported again.
+ */
+static bool arrow_array_copy(
+    const struct ArrowArray *src, struct ArrowArray *dst
+) {
+  const ArrowArrayPrivate *src_priv = src->private_data;
+  ArrowArrayPrivate *priv =
+      arrow_array_init(dst, src->n_buffers, src->n_children);
+  if (!priv) goto fail;
+
+  dst->length = src->length;
+  dst->null_count = src->null_count;
+
+  for (int i = 0; i < 3; i++) {
+    if (!src_priv->buffers[i]) continue;
+    priv->buffers[i] = malloc(src_priv->sizes[i] ? src_priv->sizes[i] : 1);
+    if (!priv->buffers[i]) goto fail;
+    memcpy(priv->buffers[i], src_priv->buffers[i], src_priv->sizes[i]);
+    priv->sizes[i] = src_priv->sizes[i];
+    if (src_priv->buffer_ptrs[i]) priv->buffer_ptrs[i] = priv->buffers[i];
+  }
+
+  for (int64_t i = 0; i < src->n_children; i++) {
+    if (!arrow_array_copy(src->children[i], dst->children[i])) goto fail;
+  }
+  return true;
+
+fail:
+  dst->release(dst);
+  PyErr_NoMemory();
+  return false;
+}
+
+typedef struct {
+  char *name;
+  struct ArrowSchema *children;
+  struct ArrowSchema **child_ptrs;
+} ArrowSchemaPrivate;
+
+static void arrow_schema_release(struct ArrowSchema *schema) {
+  ArrowSchemaPrivate *priv = schema->private_data;
+
+  if (priv) {
+    for (int64_t i = 0; priv->child_ptrs && i < schema->n_children; i++) {
+      if (priv->child_ptrs[i]->release) {
+        priv->child_ptrs[i]->release(priv->child_ptrs[i]);
+      }
+    }
+    free(priv->children);
+    free(priv->child_ptrs);
+    free(priv->name);
+    free(priv);
+  }
+
+  schema->release = NULL;
+}
+
+static bool arrow_schema_export(
+    const ArrowType *type, const char *name, struct ArrowSchema *schema
+) {
+  memset(schema, 0, sizeof(struct ArrowSchema));
+  schema->release = arrow_schema_release;
+  schema->format = arrow_kinds[type->kind].format;
+  schema->flags = type->nullable ? ARROW_FLAG_NULLABLE : 0;
+
+  ArrowSchemaPrivate *priv = calloc(1, sizeof(ArrowSchemaPrivate));
+  if (!priv) goto fail;
+  schema->private_data = priv;
+
+  priv->name = malloc(strlen(name) + 1);
+  if (!priv->name) goto fail;
+  strcpy(priv->name, name);
+  schema->name = priv->name;
+
+  if (type->n_children) {
+    priv->children = calloc(type->n_children, sizeof(struct ArrowSchema));
+    priv->child_ptrs = calloc(type->n_children, sizeof(struct ArrowSchema *));
+    if (!priv->children || !priv->child_ptrs) goto fail;
+    schema->children = priv->child_ptrs;
+    schema->n_children = type->n_children;
+
+    for (Py_ssize_t i = 0; i < type->n_children; i++) {
+      priv->child_ptrs[i] = &priv->children[i];
+      if (!arrow_schema_export(
+              &type->children[i], type->children[i].name, &priv->children[i]
+          )) {
+        goto fail;
+      }
+    }
+  }
+  return true;
+
+fail:
+  schema->release(schema);
+  if (!PyErr_Occurred()) PyErr_NoMemory();
+  return false;
+}
+
+/*============================================================================
+ * Building arrays
+ *==========================================================================*/
+
+typedef struct {
+  char *data;
+  size_t len;
+  size_t cap;
+} ArrowBuffer;
+
+static bool buffer_reserve(ArrowBuffer *buf, size_t extra) {
+  if (buf->len + extra <= buf->cap) return true;
+
+  size_t cap = buf->cap ? buf->cap * 2 : 64;
+  if (cap < buf->len + extra) cap = buf->len + extra;
+
+  char *data = realloc(buf->data, cap);
+  if (!data) {
+    PyErr_NoMemory();
+    return false;
+  }
+  buf->data = data;
+  buf->cap = cap;
+  return true;
+}
+
+static bool buffer_append(ArrowBuffer *buf, const void *src, size_t len) {
+  if (!buffer_reserve(buf, len)) return false;
+  if (src) {
+    memcpy(buf->data + buf->len, src, len);
+  } else {
+    memset(buf->data + buf->len, 0, len);
+  }
+  buf->len += len;
+  return true;
+}
+
+static bool buffer_append_bit(ArrowBuffer *buf, int64_t idx, bool bit) {
+  size_t bytes = (size_t)(idx / 8) + 1;
+  if (bytes > buf->len && !buffer_append(buf, NULL, bytes - buf->len)) {
+    return false;
+  }
+  if (bit) buf->data[idx / 8] |= (char)(1 << (idx % 8));
+  return true;
+}
+
+/**
+ * Accumulates the buffers of one array in the tree of an Arrow type.
+ */
+typedef struct ArrowBuilder {
+  const ArrowType *type;
+  int64_t length;
+  int64_t null_count;
+  ArrowBuffer validity;
+  /** The values, or offsets for strings and lists. */
+  ArrowBuffer values;
+  /** The UTF-8 data of strings. */
+  ArrowBuffer chars;
+  struct ArrowBuilder *children;
+} ArrowBuilder;
+
+static void builder_clear(ArrowBuilder *b) {
+  for (Py_ssize_t i = 0; b->children && i < b->type->n_children; i++) {
+    builder_clear(&b->children[i]);
+  }
+  PyMem_Free(b->children);
+  free(b->validity.data);
+  free(b->values.data);
+  free(b->chars.data);
+  memset(b, 0, sizeof(ArrowBuilder));
+}
+
+static bool builder_init(ArrowBuilder *b, const ArrowType *type) {
+  memset(b, 0, sizeof(ArrowBuilder));
+  b->type = type;
+
+  if (type->kind == ARROW_UTF8 || type->kind == ARROW_LIST) {
+    int32_t zero = 0;
+    if (!buffer_append(&b->values, &zero, sizeof(zero))) return false;
+  }
+
+  if (type->n_children) {
+    b->children = PyMem_Calloc(type->n_children, sizeof(ArrowBuilder));
+    if (!b->children) {
+      PyErr_NoMemory();
+      return false;
+    }
+    for (Py_ssize_t i = 0; i < type->n_children; i++) {
+      if (!builder_init(&b->children[i], &type->children[i])) return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Append an offset for strings and lists, which Arrow limits to 32 bits.
+ */
+static bool builder_append_offset(ArrowBuilder *b, size_t offset) {
+  if (offset > INT32_MAX) {
+    PyErr_SetString(
+        PyExc_OverflowError, "The data is too large for an Arrow array."
+    );
+    return false;
+  }
+  int32_t value = (int32_t)offset;
+  return buffer_append(&b->values, &value, sizeof(value));
+}
+
+static bool builder_append_null(ArrowBuilder *b) {
+  const ArrowType *type = b->type;
+
+  if (!buffer_append_bit(&b->validity, b->length, false)) return false;
+
+  switch (type->kind) {
+    case ARROW_NA:
+      break;
+    case ARROW_BOOL:
+      if (!buffer_append_bit(&b->values, b->length, false)) return false;
+      break;
+    case ARROW_UTF8:
+      if (!builder_append_offset(b, b->chars.len)) return false;
+      break;
+    case ARROW_LIST:
+      if (!builder_append_offset(b, (size_t)b->children[0].length)) {
+        return false;
+      }
+      break;
+    case ARROW_STRUCT:
+      // The fields of a null struct are masked by it, so they're null even
+      // when they aren't nullable.
+      for (Py_ssize_t i = 0; i < type->n_children; i++) {
+        if (!builder_append_null(&b->children[i])) return false;
+      }
+      break;
+    default:
+      if (!buffer_append(&b->values, NULL, arrow_kinds[type->kind].width)) {
+        return false;
+      }
+      break;
+  }
+
+  b->null_count++;
+  b->length++;
+  return true;
+}
+
+static bool builder_mismatch(ArrowBuilder *b, void *val) {
+  PyErr_Format(
+      PyExc_TypeError, "expected a value for Arrow type %s, got %s",
+      arrow_kinds[b->type->kind].name, arrow_val_name(val)
+  );
+  return false;
+}
+
+/**
+ * Read a raw number, from NUMBERS_AS_RAW or BIGNUM_AS_RAW, into a Python
+ * int or float.
+ */
+static PyObject *arrow_raw_number(void *val, bool as_int) {
+  PyObject *str = PyUnicode_FromStringAndSize(
+      unsafe_yyjson_get_raw(val), unsafe_yyjson_get_len(val)
+  );
+  if (!str) return NULL;
+
+  PyObject *num =
+      as_int ? PyLong_FromUnicodeObject(str, 10) : PyFloat_FromString(str);
+  Py_DECREF(str);
+  return num;
+}
+
+static bool builder_append_int(ArrowBuilder *b, void *val) {
+  ArrowKind kind = b->type->kind;
+  bool negative = false;
+  int64_t s = 0;
+  uint64_t u = 0;
+
+  if (unsafe_yyjson_is_uint(val)) {
+    u = unsafe_yyjson_get_uint(val);
+  } else if (unsafe_yyjson_is_sint(val)) {
+    s = unsafe_yyjson_get_sint(val);
+    negative = s < 0;
+    u = (uint64_t)s;
+  } else if (unsafe_yyjson_is_raw(val)) {
+    PyObject *num = arrow_raw_number(val, true);
+    if (!num) {
+      PyErr_Clear();
+      return builder_mismatch(b, val);
+    }
+    s = PyLong_AsLongLong(num);
+    if (s == -1 && PyErr_Occurred()) {
+      PyErr_Clear();
+      u = PyLong_AsUnsignedLongLong(num);
+    } else {
+      negative = s < 0;
+      u = (uint64_t)s;
+    }
+    Py_DECREF(num);
+    if (PyErr_Occurred()) return false;
+  } else {
+    return builder_mismatch(b, val);
+  }
+
+  if (negative ? s < arrow_kinds[kind].min : u > arrow_kinds[kind].max) {
+    PyErr_Format(
+        PyExc_OverflowError, "integer out of range for Arrow type %s",
+        arrow_kinds[kind].name
+    );
+    return false;
+  }
+
+  // Two's complement truncation leaves exactly the value in range.
+  switch (arrow_kinds[kind].width) {
+    case 1: {
+      uint8_t v = (uint8_t)u;
+      return buffer_append(&b->values, &v, 1);
+    }
+    case 2: {
+      uint16_t v = (uint16_t)u;
+      return buffer_append(&b->values, &v, 2);
+    }
+    case 4: {
+      uint32_t v = (uint32_t)u;
+      return buffer_append(&b->values, &v, 4);
+    }
+    default:
+      return buffer_append(&b->values, &u, 8);
+  }
+}
+
+static bool builder_append_float(ArrowBuilder *b, void *val) {
+  double d;
+
+  if (unsafe_yyjson_is_num(val)) {
+    switch (unsafe_yyjson_get_subtype(val)) {
+      case YYJSON_SUBTYPE_UINT:
+        d = (double)unsafe_yyjson_get_uint(val);
+        break;
+      case YYJSON_SUBTYPE_SINT:
+        d = (double)unsafe_yyjson_get_sint(val);
+        break;
+      default:
+        d = unsafe_yyjson_get_real(val);
+        break;
+    }
+  } else if (unsafe_yyjson_is_raw(val)) {
+    PyObject *num = arrow_raw_number(val, false);
+    if (!num) return false;
+    d = PyFloat_AsDouble(num);
+    Py_DECREF(num);
+  } else {
+    return builder_mismatch(b, val);
+  }
+
+  if (b->type->kind == ARROW_FLOAT32) {
+    float f = (float)d;
+    return buffer_append(&b->values, &f, sizeof(f));
+  }
+  return buffer_append(&b->values, &d, sizeof(d));
+}
+
+static bool builder_append(ArrowBuilder *b, void *val, bool mut) {
+  const ArrowType *type = b->type;
+  bool ok = true;
+
+  if (!val || unsafe_yyjson_is_null(val)) {
+    if (!type->nullable) {
+      PyErr_Format(
+          PyExc_TypeError,
+          "expected a value for non-nullable Arrow type %s, got null",
+          arrow_kinds[type->kind].name
+      );
+      return false;
+    }
+    return builder_append_null(b);
+  }
+
+  switch (type->kind) {
+    case ARROW_NA:
+      return builder_mismatch(b, val);
+    case ARROW_BOOL:
+      if (!unsafe_yyjson_is_bool(val)) return builder_mismatch(b, val);
+      ok = buffer_append_bit(
+          &b->values, b->length, unsafe_yyjson_get_bool(val)
+      );
+      break;
+    case ARROW_UTF8:
+      if (!unsafe_yyjson_is_str(val)) return builder_mismatch(b, val);
+      ok = buffer_append(
+               &b->chars, unsafe_yyjson_get_str(val),
+               unsafe_yyjson_get_len(val)
+           ) &&
+           builder_append_offset(b, b->chars.len);
+      break;
+    case ARROW_LIST:
+    case ARROW_STRUCT: {
+      if (type->kind == ARROW_LIST
+              ? unsafe_yyjson_get_type(val) != YYJSON_TYPE_ARR
+              : !val_is_obj(val)) {
+        return builder_mismatch(b, val);
+      }
+
+      if (Py_EnterRecursiveCall(" while converting to Arrow")) {
+        return false;
+      }
+
+      if (type->kind == ARROW_LIST) {
+        ValIter iter;
+        void *item;
+        val_iter_init(&iter, val, mut);
+        while (ok && (item = val_iter_next(&iter))) {
+          ok = builder_append(&b->children[0], item, mut);
+        }
+        ok = ok && builder_append_offset(b, (size_t)b->children[0].length);
+      } else {
+        for (Py_ssize_t i = 0; ok && i < type->n_children; i++) {
+          void *member = val_obj_getn(
+              val, mut, type->children[i].name, type->children[i].name_len
+          );
+          ok = builder_append(&b->children[i], member, mut);
+        }
+      }
+
+      Py_LeaveRecursiveCall();
+      break;
+    }
+    default:
+      ok = arrow_is_int(type->kind) ? builder_append_int(b, val)
+                                    : builder_append_float(b, val);
+      break;
+  }
+
+  if (!ok || !buffer_append_bit(&b->validity, b->length, true)) {
+    return false;
+  }
+  b->length++;
+  return true;
+}
+
+/**
+ * Move the buffers of a builder into an exported ArrowArray.
+ */
+static bool builder_finish(ArrowBuilder *b, struct ArrowArray *array) {
+  const ArrowType *type = b->type;
+  int64_t n_buffers;
+
+  switch (type->kind) {
+    case ARROW_NA:
+      n_buffers = 0;
+      break;
+    case ARROW_STRUCT:
+      n_buffers = 1;
+      break;
+    case ARROW_UTF8:
+      n_buffers = 3;
+      break;
+    default:
+      n_buffers = 2;
+      break;
+  }
+
+  ArrowArrayPrivate *priv =
+      arrow_array_init(array, n_buffers, type->n_children);
+  if (!priv) {
+    array->release(array);
+    PyErr_NoMemory();
+    return false;
+  }
+
+  array->length = b->length;
+  array->null_count = type->kind == ARROW_NA ? b->length : b->null_count;
+
+  ArrowBuffer *buffers[3] = {&b->validity, &b->values, &b->chars};
+  for (int64_t i = 0; i < n_buffers; i++) {
+    // Buffers other than the validity bitmap must exist, even if empty.
+    if (!buffers[i]->data && !buffer_reserve(buffers[i], 1)) {
+      array->release(array);
+      return false;
+    }
+    priv->buffers[i] = buffers[i]->data;
+    priv->sizes[i] = buffers[i]->len;
+    buffers[i]->data = NULL;
+    buffers[i]->len = buffers[i]->cap = 0;
+    priv->buffer_ptrs[i] = priv->buffers[i];
+  }
+  if (n_buffers && !b->null_count) {
+    priv->buffer_ptrs[0] = NULL;
+  }
+
+  for (Py_ssize_t i = 0; i < type->n_children; i++) {
+    if (!builder_finish(&b->children[i], array->children[i])) {
+      array->release(array);
+      return false;
+    }
+  }
+  return true;
+}
+
+/*============================================================================
+ * ArrowExport
+ *==========================================================================*/
+
+/**
+ * Add the index of the failed item to the message of a conversion error.
+ */
+static void arrow_annotate(size_t idx) {
+  if (!PyErr_ExceptionMatches(PyExc_TypeError) &&
+      !PyErr_ExceptionMatches(PyExc_OverflowError)) {
+    return;
+  }
+
+  PyObject *type, *value, *tb;
+  PyErr_Fetch(&type, &value, &tb);
+  PyErr_NormalizeException(&type, &value, &tb);
+  PyErr_Format(type, "%S at index %zu", value, idx);
+  Py_DECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(tb);
+}
+
+PyObject *arrow_export(void *arr, bool mut, PyObject *schema) {
+  ValIter iter;
+  void *item;
+  size_t idx;
+
+  if (!arr || unsafe_yyjson_get_type(arr) != YYJSON_TYPE_ARR) {
+    PyErr_SetString(PyExc_TypeError, "The value is not an array.");
+    return NULL;
+  }
+
+  ArrowExportObject *self =
+      (ArrowExportObject *)ArrowExportType.tp_alloc(&ArrowExportType, 0);
+  if (!self) return NULL;
+  self->type.nullable = true;
+
+  if (schema && schema != Py_None) {
+    PyObject *capsule =
+        PyObject_CallMethod(schema, "__arrow_c_schema__", NULL);
+    if (!capsule) goto fail;
+
+    struct ArrowSchema *c_schema = PyCapsule_GetPointer(capsule, "arrow_schema");
+    bool ok = c_schema && arrow_type_from_schema(&self->type, c_schema);
+    Py_DECREF(capsule);
+    if (!ok) goto fail;
+  } else {
+    idx = 0;
+    val_iter_init(&iter, arr, mut);
+    while ((item = val_iter_next(&iter))) {
+      if (!arrow_infer(&self->type, item, mut)) {
+        arrow_annotate(idx);
+        goto fail;
+      }
+      idx++;
+    }
+  }
+
+  ArrowBuilder builder;
+  if (!builder_init(&builder, &self->type)) {
+    builder_clear(&builder);
+    goto fail;
+  }
+
+  idx = 0;
+  val_iter_init(&iter, arr, mut);
+  while ((item = val_iter_next(&iter))) {
+    if (!builder_append(&builder, item, mut)) {
+      arrow_annotate(idx);
+      builder_clear(&builder);
+      goto fail;
+    }
+    idx++;
+  }
+
+  bool ok = builder_finish(&builder, &self->array);
+  builder_clear(&builder);
+  if (!ok) goto fail;
+
+  return (PyObject *)self;
+
+fail:
+  Py_DECREF(self);
+  return NULL;
+}
+
+static void ArrowExport_dealloc(ArrowExportObject *self) {
+  if (self->array.release) self->array.release(&self->array);
+  arrow_type_clear(&self->type);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static void arrow_schema_capsule_free(PyObject *capsule) {
+  struct ArrowSchema *schema = PyCapsule_GetPointer(capsule, "arrow_schema");
+  if (!schema) return;
+  if (schema->release) schema->release(schema);
+  free(schema);
+}
+
+static void arrow_array_capsule_free(PyObject *capsule) {
+  struct ArrowArray *array = PyCapsule_GetPointer(capsule, "arrow_array");
+  if (!array) return;
+  if (array->release) array->release(array);
+  free(array);
+}
+
+static PyObject *ArrowExport_schema_capsule(ArrowExportObject *self) {
+  struct ArrowSchema *schema = malloc(sizeof(struct ArrowSchema));
+  if (!schema) return PyErr_NoMemory();
+
+  if (!arrow_schema_export(&self->type, "", schema)) {
+    free(schema);
+    return NULL;
+  }
+
+  PyObject *capsule =
+      PyCapsule_New(schema, "arrow_schema", arrow_schema_capsule_free);
+  if (!capsule) {
+    schema->release(schema);
+    free(schema);
+  }
+  return capsule;
+}
+
+PyDoc_STRVAR(
+    ArrowExport_arrow_c_schema_doc,
+    "Export the type of the array as an ``arrow_schema`` PyCapsule.\n"
+);
+static PyObject *ArrowExport_arrow_c_schema(
+    ArrowExportObject *self, PyObject *unused
+) {
+  return ArrowExport_schema_capsule(self);
+}
+
+PyDoc_STRVAR(
+    ArrowExport_arrow_c_array_doc,
+    "Export the array as a pair of ``arrow_schema`` and ``arrow_array``\n"
+    "PyCapsules. Each export is a separate copy, so it may be called any\n"
+    "number of times. ``requested_schema`` is ignored, as the Arrow\n"
+    "PyCapsule interface allows.\n"
+);
+static PyObject *ArrowExport_arrow_c_array(
+    ArrowExportObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"requested_schema", NULL};
+  PyObject *requested_schema = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "|O", kwlist, &requested_schema
+      )) {
+    return NULL;
+  }
+
+  PyObject *schema = ArrowExport_schema_capsule(self);
+  if (!schema) return NULL;
+
+  struct ArrowArray *array = malloc(sizeof(struct ArrowArray));
+  if (!array) {
+    Py_DECREF(schema);
+    return PyErr_NoMemory();
+  }
+  if (!arrow_array_copy(&self->array, array)) {
+    free(array);
+    Py_DECREF(schema);
+    return NULL;
+  }
+
+  PyObject *capsule =
+      PyCapsule_New(array, "arrow_array", arrow_array_capsule_free);
+  if (!capsule) {
+    array->release(array);
+    free(array);
+    Py_DECREF(schema);
+    return NULL;
+  }
+
+  PyObject *result = PyTuple_Pack(2, schema, capsule);
+  Py_DECREF(schema);
+  Py_DECREF(capsule);
+  return result;
+}
+
+static Py_ssize_t ArrowExport_length(ArrowExportObject *self) {
+  return (Py_ssize_t)self->array.length;
+}
+
+static PyMethodDef ArrowExport_methods[] = {
+    {"__arrow_c_schema__", (PyCFunction)ArrowExport_arrow_c_schema,
+     METH_NOARGS, ArrowExport_arrow_c_schema_doc},
+    {"__arrow_c_array__",
+     (PyCFunction)(void (*)(void))ArrowExport_arrow_c_array,
+     METH_VARARGS | METH_KEYWORDS, ArrowExport_arrow_c_array_doc},
+    {NULL} /* Sentinel */
+};
+
+static PySequenceMethods ArrowExport_sequence_methods = {
+    .sq_length = (lenfunc)ArrowExport_length};
+
+PyDoc_STRVAR(
+    ArrowExport_doc,
+    "An array converted by :meth:`Document.to_arrow`, which can be passed\n"
+    "to any library supporting the Arrow PyCapsule interface, such as\n"
+    "``pyarrow.array()``.\n"
+);
+
+PyTypeObject ArrowExportType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.ArrowExport",
+    .tp_doc = ArrowExport_doc,
+    .tp_basicsize = sizeof(ArrowExportObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)ArrowExport_dealloc,
+    .tp_as_sequence = &ArrowExport_sequence_methods,
+    .tp_methods = ArrowExport_methods};
@@ -0,0 +1,118 @@
+#ifndef PY_YYJSON_ARROW_H
+#define PY_YYJSON_ARROW_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yyjson.h"
+
+/*
+ * The Arrow C Data Interface, verbatim from
+ * https://arrow.apache.org/docs/format/CDataInterface.html so that no
+ * Arrow headers are needed to build.
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+/**
+ * The Arrow types values can be converted into.
+ */
+typedef enum {
+  ARROW_NA,
+  ARROW_BOOL,
+  ARROW_INT8,
+  ARROW_INT16,
+  ARROW_INT32,
+  ARROW_INT64,
+  ARROW_UINT8,
+  ARROW_UINT16,
+  ARROW_UINT32,
+  ARROW_UINT64,
+  ARROW_FLOAT32,
+  ARROW_FLOAT64,
+  ARROW_UTF8,
+  ARROW_LIST,
+  ARROW_STRUCT,
+} ArrowKind;
+
+/**
+ * A node in the tree describing an Arrow type, either inferred from values
+ * or read from an ArrowSchema.
+ */
+typedef struct ArrowType {
+  ArrowKind kind;
+  /** The name of the field, for children of a struct. */
+  char* name;
+  size_t name_len;
+  /** Whether the values may be null, which is always true when inferred. */
+  bool nullable;
+  /** The item type of a list, or the fields of a struct. */
+  struct ArrowType* children;
+  Py_ssize_t n_children;
+  Py_ssize_t children_cap;
+} ArrowType;
+
+/**
+ * An array converted to Arrow, which can be exported any number of times
+ * with the PyCapsule interface.
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The type of the array. */
+      ArrowType type;
+  /** The converted array, which is copied on each export. */
+  struct ArrowArray array;
+} ArrowExportObject;
+
+extern PyTypeObject ArrowExportType;
+
+/**
+ * Convert arr, an array of either representation, into a new
+ * ArrowExportObject. If schema isn't NULL, it's an object implementing
+ * __arrow_c_schema__ describing the items of the array, otherwise the
+ * type is inferred from the values.
+ */
+PyObject* arrow_export(void* arr, bool mut, PyObject* schema);
+
+#endif
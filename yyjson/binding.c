@@ -2,6 +2,13 @@
 #include <Python.h>
 
 #include "document.h"
+#include "pointer.h"
+#include "jsonpath.h"
+#include "patch.h"
+#include "cursor.h"
+#include "arrow.h"
+#include "incremental.h"
+#include "events.h"
 #include "memory.h"
 #include "decimal.h"
 #include "yyjson.h"
@@ -20,6 +27,42 @@ PyMODINIT_FUNC PyInit_cyyjson(void) {
     return NULL;
   }
 
+  if (PyType_Ready(&PointerType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&JSONPathType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&PatchType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&CursorType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&CursorArrayIterType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&ArrowExportType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&IncrementalParserType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&EventIterType) < 0) {
+    return NULL;
+  }
+
+  if (PyType_Ready(&ArrayStreamType) < 0) {
+    return NULL;
+  }
+
   m = PyModule_Create(&yymodule);
   if (m == NULL) {
     return NULL;
@@ -32,6 +75,57 @@ PyMODINIT_FUNC PyInit_cyyjson(void) {
     return NULL;
   }
 
+  Py_INCREF(&PointerType);
+  if (PyModule_AddObject(m, "Pointer", (PyObject*)&PointerType) < 0) {
+    Py_DECREF(&PointerType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  Py_INCREF(&JSONPathType);
+  if (PyModule_AddObject(m, "JSONPath", (PyObject*)&JSONPathType) < 0) {
+    Py_DECREF(&JSONPathType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  Py_INCREF(&PatchType);
+  if (PyModule_AddObject(m, "Patch", (PyObject*)&PatchType) < 0) {
+    Py_DECREF(&PatchType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  Py_INCREF(&CursorType);
+  if (PyModule_AddObject(m, "Cursor", (PyObject*)&CursorType) < 0) {
+    Py_DECREF(&CursorType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  Py_INCREF(&IncrementalParserType);
+  if (PyModule_AddObject(
+          m, "IncrementalParser", (PyObject*)&IncrementalParserType
+      ) < 0) {
+    Py_DECREF(&IncrementalParserType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  Py_INCREF(&EventIterType);
+  if (PyModule_AddObject(m, "EventIter", (PyObject*)&EventIterType) < 0) {
+    Py_DECREF(&EventIterType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  Py_INCREF(&ArrayStreamType);
+  if (PyModule_AddObject(m, "ArrayStream", (PyObject*)&ArrayStreamType) < 0) {
+    Py_DECREF(&ArrayStreamType);
+    Py_DECREF(m);
+    return NULL;
+  }
+
   // We need to pre-import the Decimal module to have it available globally.
   YY_DecimalModule = PyImport_ImportModule("decimal");
   if (YY_DecimalModule == NULL) {
@@ -0,0 +1,382 @@
+#include "canonical.h"
+
+#include <string.h>
+
+#include "value.h"
+
+/**
+ * A growable output buffer.
+ */
+typedef struct {
+  char *buf;
+  size_t len;
+  size_t cap;
+  const char *err;
+} CanonicalWriter;
+
+static bool cw_reserve(CanonicalWriter *w, size_t extra) {
+  if (w->len + extra <= w->cap) {
+    return true;
+  }
+
+  size_t cap = w->cap ? w->cap : 256;
+  while (cap < w->len + extra) cap *= 2;
+
+  char *buf = PyMem_Realloc(w->buf, cap);
+  if (!buf) return false;
+  w->buf = buf;
+  w->cap = cap;
+  return true;
+}
+
+static inline bool cw_write(CanonicalWriter *w, const char *str, size_t len) {
+  if (!cw_reserve(w, len)) return false;
+  memcpy(w->buf + w->len, str, len);
+  w->len += len;
+  return true;
+}
+
+static inline bool cw_putc(CanonicalWriter *w, char c) {
+  if (!cw_reserve(w, 1)) return false;
+  w->buf[w->len++] = c;
+  return true;
+}
+
+/**
+ * Write a string, escaping only what RFC 8785 requires: the quote, the
+ * backslash and control characters.
+ */
+static bool cw_write_str(CanonicalWriter *w, const char *str, size_t len) {
+  static const char hex[] = "0123456789abcdef";
+  size_t start = 0;
+
+  if (!cw_putc(w, '"')) return false;
+
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = (unsigned char)str[i];
+    char short_esc = 0;
+
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+    if (!cw_write(w, str + start, i - start)) return false;
+    start = i + 1;
+
+    switch (c) {
+      case '"': short_esc = '"'; break;
+      case '\\': short_esc = '\\'; break;
+      case '\b': short_esc = 'b'; break;
+      case '\t': short_esc = 't'; break;
+      case '\n': short_esc = 'n'; break;
+      case '\f': short_esc = 'f'; break;
+      case '\r': short_esc = 'r'; break;
+    }
+
+    if (short_esc) {
+      char esc[2] = {'\\', short_esc};
+      if (!cw_write(w, esc, 2)) return false;
+    } else {
+      char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+      if (!cw_write(w, esc, 6)) return false;
+    }
+  }
+
+  return cw_write(w, str + start, len - start) && cw_putc(w, '"');
+}
+
+/**
+ * Write a double the way ECMAScript's Number.prototype.toString() does,
+ * using the shortest digits that round-trip.
+ */
+static bool cw_write_double(CanonicalWriter *w, double d) {
+  if (d != d || d - d != 0) {
+    w->err = "nan or inf number is not allowed in canonical JSON";
+    return false;
+  }
+
+  if (d == 0) {
+    return cw_putc(w, '0');
+  }
+
+  char *repr = PyOS_double_to_string(d, 'r', 0, 0, NULL);
+  if (!repr) return false;
+
+  // Split the repr into its significant digits and the position of the
+  // decimal point relative to them, so value = 0.<digits> * 10^point.
+  char digits[32];
+  int num_digits = 0, point = 0, exp = 0;
+  bool seen_point = false, negative = false;
+  const char *p = repr;
+
+  if (*p == '-') {
+    negative = true;
+    p++;
+  }
+
+  for (; *p && *p != 'e'; p++) {
+    if (*p == '.') {
+      seen_point = true;
+    } else if (num_digits == 0 && *p == '0') {
+      // Leading zeros move the point instead of adding digits.
+      if (seen_point) point--;
+    } else if (num_digits < (int)sizeof(digits)) {
+      digits[num_digits++] = *p;
+      if (!seen_point) point++;
+    }
+  }
+
+  if (*p == 'e') {
+    exp = atoi(p + 1);
+  }
+
+  PyMem_Free(repr);
+
+  while (num_digits > 1 && digits[num_digits - 1] == '0') num_digits--;
+  point += exp;
+
+  char out[64];
+  int len = 0;
+
+  if (negative) out[len++] = '-';
+
+  if (num_digits <= point && point <= 21) {
+    memcpy(out + len, digits, num_digits);
+    len += num_digits;
+    for (int i = num_digits; i < point; i++) out[len++] = '0';
+  } else if (0 < point && point <= 21) {
+    memcpy(out + len, digits, point);
+    len += point;
+    out[len++] = '.';
+    memcpy(out + len, digits + point, num_digits - point);
+    len += num_digits - point;
+  } else if (-6 < point && point <= 0) {
+    out[len++] = '0';
+    out[len++] = '.';
+    for (int i = point; i < 0; i++) out[len++] = '0';
+    memcpy(out + len, digits, num_digits);
+    len += num_digits;
+  } else {
+    out[len++] = digits[0];
+    if (num_digits > 1) {
+      out[len++] = '.';
+      memcpy(out + len, digits + 1, num_digits - 1);
+      len += num_digits - 1;
+    }
+    len += snprintf(out + len, sizeof(out) - len, "e%+d", point - 1);
+  }
+
+  return cw_write(w, out, len);
+}
+
+/** Integers with a magnitude below this are exactly representable. */
+#define CANONICAL_MAX_SAFE_INT ((uint64_t)1 << 53)
+
+static bool cw_write_num(CanonicalWriter *w, void *val) {
+  char buf[24];
+  int len;
+
+  switch (unsafe_yyjson_get_subtype(val)) {
+    case YYJSON_SUBTYPE_UINT: {
+      uint64_t u = unsafe_yyjson_get_uint(val);
+      if (u >= CANONICAL_MAX_SAFE_INT) return cw_write_double(w, (double)u);
+      len = snprintf(buf, sizeof(buf), "%llu", (unsigned long long)u);
+      return cw_write(w, buf, len);
+    }
+    case YYJSON_SUBTYPE_SINT: {
+      int64_t s = unsafe_yyjson_get_sint(val);
+      if (s <= -(int64_t)CANONICAL_MAX_SAFE_INT ||
+          s >= (int64_t)CANONICAL_MAX_SAFE_INT) {
+        return cw_write_double(w, (double)s);
+      }
+      len = snprintf(buf, sizeof(buf), "%lld", (long long)s);
+      return cw_write(w, buf, len);
+    }
+    default:
+      return cw_write_double(w, unsafe_yyjson_get_real(val));
+  }
+}
+
+/**
+ * Raw numbers (such as those read with NUMBERS_AS_RAW) are parsed as
+ * doubles, since RFC 8785 numbers are IEEE 754 doubles.
+ */
+static bool cw_write_raw(CanonicalWriter *w, void *val) {
+  size_t len = unsafe_yyjson_get_len(val);
+  char *raw = PyMem_Malloc(len + 1);
+  if (!raw) return false;
+
+  memcpy(raw, unsafe_yyjson_get_str(val), len);
+  raw[len] = '\0';
+
+  char *end;
+  double d = PyOS_string_to_double(raw, &end, NULL);
+  bool valid = !PyErr_Occurred() && end == raw + len;
+  PyMem_Free(raw);
+
+  if (!valid) {
+    PyErr_Clear();
+    w->err = "raw value is not a valid number";
+    return false;
+  }
+
+  return cw_write_double(w, d);
+}
+
+/**
+ * Decode the code point starting at str, returning its first UTF-16 code
+ * unit and setting cp to the full code point.
+ */
+static uint32_t utf8_decode_utf16(const unsigned char *str, uint32_t *cp) {
+  if (str[0] < 0x80) {
+    *cp = str[0];
+  } else if (str[0] < 0xE0) {
+    *cp = ((uint32_t)(str[0] & 0x1F) << 6) | (str[1] & 0x3F);
+  } else if (str[0] < 0xF0) {
+    *cp = ((uint32_t)(str[0] & 0x0F) << 12) |
+          ((uint32_t)(str[1] & 0x3F) << 6) | (str[2] & 0x3F);
+  } else {
+    *cp = ((uint32_t)(str[0] & 0x07) << 18) |
+          ((uint32_t)(str[1] & 0x3F) << 12) |
+          ((uint32_t)(str[2] & 0x3F) << 6) | (str[3] & 0x3F);
+  }
+
+  if (*cp >= 0x10000) {
+    return 0xD800 + ((*cp - 0x10000) >> 10);
+  }
+  return *cp;
+}
+
+typedef struct {
+  void *key;
+  void *val;
+} CanonicalMember;
+
+/**
+ * Order object members by the UTF-16 code units of their keys. UTF-8 byte
+ * order matches code point order, which only differs from UTF-16 order
+ * for characters above U+FFFF, so only the first differing character
+ * needs decoding.
+ */
+static int canonical_member_cmp(const void *lhs, const void *rhs) {
+  const CanonicalMember *a = lhs, *b = rhs;
+  const unsigned char *as = (const unsigned char *)unsafe_yyjson_get_str(a->key);
+  const unsigned char *bs = (const unsigned char *)unsafe_yyjson_get_str(b->key);
+  size_t alen = unsafe_yyjson_get_len(a->key);
+  size_t blen = unsafe_yyjson_get_len(b->key);
+  size_t i = 0;
+
+  while (i < alen && i < blen && as[i] == bs[i]) i++;
+
+  if (i == alen || i == blen) {
+    return (alen > blen) - (alen < blen);
+  }
+
+  // Back up to the start of the character that differs.
+  while (i > 0 && (as[i] & 0xC0) == 0x80) i--;
+
+  uint32_t acp, bcp;
+  uint32_t au = utf8_decode_utf16(as + i, &acp);
+  uint32_t bu = utf8_decode_utf16(bs + i, &bcp);
+
+  if (au != bu) return au < bu ? -1 : 1;
+  return (acp > bcp) - (acp < bcp);
+}
+
+static bool cw_write_val(CanonicalWriter *w, void *val, bool mut);
+
+static bool cw_write_obj(CanonicalWriter *w, void *val, bool mut) {
+  size_t len = unsafe_yyjson_get_len(val);
+  CanonicalMember *members;
+  ValIter iter;
+  void *key;
+  size_t i = 0;
+  bool ok = true;
+
+  if (len == 0) {
+    return cw_write(w, "{}", 2);
+  }
+
+  members = PyMem_Malloc(sizeof(CanonicalMember) * len);
+  if (!members) return false;
+
+  val_iter_init(&iter, val, mut);
+  while ((key = val_iter_next(&iter))) {
+    members[i].key = key;
+    members[i].val = val_key_value(key, mut);
+    i++;
+  }
+
+  qsort(members, len, sizeof(CanonicalMember), canonical_member_cmp);
+
+  ok = cw_putc(w, '{');
+  for (i = 0; ok && i < len; i++) {
+    ok = (i == 0 || cw_putc(w, ',')) &&
+         cw_write_str(
+             w, unsafe_yyjson_get_str(members[i].key),
+             unsafe_yyjson_get_len(members[i].key)
+         ) &&
+         cw_putc(w, ':') && cw_write_val(w, members[i].val, mut);
+  }
+
+  PyMem_Free(members);
+  return ok && cw_putc(w, '}');
+}
+
+static bool cw_write_val(CanonicalWriter *w, void *val, bool mut) {
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return cw_write(w, "null", 4);
+    case YYJSON_TYPE_BOOL:
+      return unsafe_yyjson_get_bool(val) ? cw_write(w, "true", 4)
+                                         : cw_write(w, "false", 5);
+    case YYJSON_TYPE_NUM:
+      return cw_write_num(w, val);
+    case YYJSON_TYPE_RAW:
+      return cw_write_raw(w, val);
+    case YYJSON_TYPE_STR:
+      return cw_write_str(
+          w, unsafe_yyjson_get_str(val), unsafe_yyjson_get_len(val)
+      );
+    case YYJSON_TYPE_ARR: {
+      ValIter iter;
+      void *item;
+      bool first = true;
+
+      if (!cw_putc(w, '[')) return false;
+      val_iter_init(&iter, val, mut);
+      while ((item = val_iter_next(&iter))) {
+        if (!first && !cw_putc(w, ',')) return false;
+        if (!cw_write_val(w, item, mut)) return false;
+        first = false;
+      }
+      return cw_putc(w, ']');
+    }
+    case YYJSON_TYPE_OBJ:
+      return cw_write_obj(w, val, mut);
+    default:
+      w->err = "invalid JSON value type";
+      return false;
+  }
+}
+
+char *canonical_write(
+    void *val, bool mut, bool newline_at_end, size_t *len, const char **err
+) {
+  CanonicalWriter w = {0};
+
+  *err = NULL;
+
+  if (!val) {
+    *err = "input JSON is NULL";
+    return NULL;
+  }
+
+  if (!cw_write_val(&w, val, mut) ||
+      (newline_at_end && !cw_putc(&w, '\n'))) {
+    *err = w.err;
+    PyMem_Free(w.buf);
+    return NULL;
+  }
+
+  *len = w.len;
+  return w.buf;
+}
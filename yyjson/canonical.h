@@ -0,0 +1,30 @@
+#ifndef PY_YYJSON_CANONICAL_H
+#define PY_YYJSON_CANONICAL_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+/**
+ * Write flag selecting the RFC 8785 (JCS) canonical writer. This isn't a
+ * yyjson flag, so it uses a bit yyjson leaves unused and is handled before
+ * anything is passed to yyjson.
+ */
+#define WRITE_CANONICAL ((yyjson_write_flag)1 << 16)
+
+/**
+ * Serialize a yyjson_val or yyjson_mut_val (if mut is true) as canonical
+ * JSON following RFC 8785: no insignificant whitespace, object members
+ * sorted by the UTF-16 code units of their keys, numbers formatted like
+ * ECMAScript and strings with minimal escaping.
+ *
+ * Returns a buffer allocated with PyMem_Malloc and sets len, or returns
+ * NULL and sets err. A NULL return with err unset means allocation failed.
+ */
+char* canonical_write(
+    void* val, bool mut, bool newline_at_end, size_t* len, const char** err
+);
+
+#endif
@@ -0,0 +1,679 @@
+#include "cursor.h"
+
+#include "document.h"
+#include "memory.h"
+#include "value.h"
+
+/**
+ * Raise a ValueError for the scanner's error.
+ */
+static PyObject *cursor_error(CursorObject *self) {
+  PyErr_Format(
+      PyExc_ValueError, "%s at position %zu",
+      self->sc.err ? self->sc.err : "invalid JSON", self->sc.err_pos
+  );
+  return NULL;
+}
+
+static PyObject *cursor_type_error(CursorObject *self, const char *expected) {
+  PyErr_Format(
+      PyExc_TypeError, "expected %s at position %zu", expected,
+      (size_t)(self->sc.cur - self->sc.start)
+  );
+  return NULL;
+}
+
+static bool cursor_ensure_pending(CursorObject *self) {
+  if (!self->pending) {
+    PyErr_SetString(
+        PyExc_ValueError, "The cursor is not at a value, it was consumed."
+    );
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Enter the container at the cursor.
+ */
+static bool cursor_enter(CursorObject *self, char open) {
+  if (self->depth == self->frames_cap) {
+    Py_ssize_t cap = self->frames_cap ? self->frames_cap * 2 : 8;
+    CursorFrame *frames =
+        PyMem_Realloc(self->frames, sizeof(CursorFrame) * cap);
+    if (!frames) {
+      PyErr_NoMemory();
+      return false;
+    }
+    self->frames = frames;
+    self->frames_cap = cap;
+  }
+
+  if (!scan_container_begin(&self->sc, open)) {
+    cursor_error(self);
+    return false;
+  }
+
+  self->frames[self->depth++] =
+      (CursorFrame){open == '[' ? ']' : '}', true};
+  self->pending = false;
+  return true;
+}
+
+/**
+ * Move to the next item of the innermost container, leaving the
+ * container if there are none left. Returns 1 if there is another item,
+ * 0 if not, or -1 with an exception set.
+ */
+static int cursor_next_item(CursorObject *self) {
+  CursorFrame *frame = &self->frames[self->depth - 1];
+  int r = scan_container_next(&self->sc, frame->close, &frame->first);
+
+  if (r < 0) {
+    cursor_error(self);
+  } else if (r == 0) {
+    self->depth--;
+    self->pending = false;
+  }
+  return r;
+}
+
+/**
+ * Skip the value at the cursor, if it hasn't been consumed.
+ */
+static bool cursor_skip_pending(CursorObject *self) {
+  if (!self->pending) return true;
+
+  if (!scan_skip(&self->sc)) {
+    cursor_error(self);
+    return false;
+  }
+  self->pending = false;
+  return true;
+}
+
+/**
+ * Skip everything left in the innermost container, and leave it.
+ */
+static bool cursor_finish_container(CursorObject *self) {
+  Py_ssize_t depth = self->depth;
+  int r;
+
+  if (!cursor_skip_pending(self)) return false;
+
+  while ((r = cursor_next_item(self)) == 1) {
+    if (self->frames[depth - 1].close == '}' &&
+        !scan_key(&self->sc, NULL, NULL, NULL)) {
+      cursor_error(self);
+      return false;
+    }
+    if (!scan_skip(&self->sc)) {
+      cursor_error(self);
+      return false;
+    }
+  }
+
+  return r == 0;
+}
+
+/**
+ * Consume the value at the cursor, once it has been read up to end.
+ */
+static inline void cursor_consumed(CursorObject *self, const char *end) {
+  self->sc.cur = end;
+  self->pending = false;
+}
+
+/**
+ * Whether the cursor is at the literal lit, ending where scan_skip() would
+ * stop skipping it, so that a prefix like the true of truex doesn't count.
+ */
+static bool cursor_at_literal(
+    CursorObject *self, const char *lit, size_t len
+) {
+  const char *p = self->sc.cur;
+
+  if ((size_t)(self->sc.end - p) < len || memcmp(p, lit, len) != 0) {
+    return false;
+  }
+  if (p + len == self->sc.end) return true;
+
+  switch (p[len]) {
+    case ',':
+    case ']':
+    case '}':
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case '/':
+    case ':':
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Read a number at the cursor into val.
+ */
+static bool cursor_read_number(
+    CursorObject *self, yyjson_val *val, yyjson_read_flag extra
+) {
+  yyjson_read_err err;
+  char c = scan_peek(&self->sc);
+
+  if (c != '-' && (c < '0' || c > '9') &&
+      !(self->sc.flags & YYJSON_READ_ALLOW_INF_AND_NAN)) {
+    cursor_type_error(self, "a number");
+    return false;
+  }
+
+  const char *end = yyjson_read_number(
+      self->sc.cur, val, self->sc.flags | extra, &PyMem_Allocator, &err
+  );
+  if (!end) {
+    if (c != '-' && (c < '0' || c > '9')) {
+      cursor_type_error(self, "a number");
+    } else {
+      PyErr_Format(
+          PyExc_ValueError, "%s at position %zu", err.msg,
+          (size_t)(self->sc.cur - self->sc.start) + err.pos
+      );
+    }
+    return false;
+  }
+
+  cursor_consumed(self, end);
+  return true;
+}
+
+static int Cursor_init(CursorObject *self, PyObject *args, PyObject *kwds) {
+  static char *kwlist[] = {"content", "flags", NULL};
+  PyObject *content;
+  yyjson_read_flag r_flag = 0;
+  const char *buf;
+  Py_ssize_t len;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O|$I", kwlist, &content, &r_flag
+      )) {
+    return -1;
+  }
+
+  if (PyBytes_Check(content)) {
+    if (PyBytes_AsStringAndSize(content, (char **)&buf, &len) < 0) return -1;
+  } else if (PyUnicode_Check(content)) {
+    buf = PyUnicode_AsUTF8AndSize(content, &len);
+    if (!buf) return -1;
+  } else {
+    PyErr_SetString(PyExc_TypeError, "content must be a str or bytes.");
+    return -1;
+  }
+
+  Py_INCREF(content);
+  Py_XSETREF(self->source, content);
+  self->depth = 0;
+
+  // Python guarantees a NUL after the data, which yyjson_read_number()
+  // relies on.
+  scanner_init(&self->sc, buf, len, r_flag);
+  if (!scan_ws(&self->sc)) {
+    cursor_error(self);
+    return -1;
+  }
+  if (self->sc.cur == self->sc.end) {
+    PyErr_SetString(PyExc_ValueError, "input data is empty");
+    return -1;
+  }
+
+  self->pending = true;
+  return 0;
+}
+
+static void Cursor_dealloc(CursorObject *self) {
+  PyMem_Free(self->frames);
+  Py_XDECREF(self->source);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyDoc_STRVAR(
+    Cursor_find_field_doc,
+    "Move the cursor to the value of the given member of an object.\n"
+    "\n"
+    "If the cursor is at an object, it enters it. If it's inside an object\n"
+    "(after consuming one of its members), the search continues from\n"
+    "there, so fields must be found in the order they appear. Members\n"
+    "before the one found are skipped without being parsed.\n"
+    "\n"
+    ":param key: The key of the member to find.\n"
+    ":type key: ``str``\n"
+    ":raises KeyError: If there are no more members with that key, in\n"
+    "                  which case the cursor is left after the object.\n"
+    ":returns: This cursor, for chaining.\n"
+);
+static PyObject *Cursor_find_field(CursorObject *self, PyObject *args) {
+  const char *key;
+  Py_ssize_t key_len;
+  int r;
+
+  if (!PyArg_ParseTuple(args, "s#", &key, &key_len)) {
+    return NULL;
+  }
+
+  if (self->pending) {
+    if (scan_peek(&self->sc) != '{') {
+      return cursor_type_error(self, "an object");
+    }
+    if (!cursor_enter(self, '{')) return NULL;
+  } else if (self->depth == 0 || self->frames[self->depth - 1].close != '}') {
+    PyErr_SetString(PyExc_ValueError, "The cursor is not in an object.");
+    return NULL;
+  }
+
+  while ((r = cursor_next_item(self)) == 1) {
+    const char *str;
+    size_t len;
+    bool escaped;
+    const char *key_start = self->sc.cur;
+
+    if (!scan_key(&self->sc, &str, &len, &escaped)) {
+      return cursor_error(self);
+    }
+
+    bool match = (size_t)key_len == len && memcmp(str, key, len) == 0;
+    if (escaped) {
+      // Keys rarely contain escapes, so let yyjson handle them.
+      yyjson_doc *unescaped = yyjson_read_opts(
+          (char *)key_start, len + 2, 0, &PyMem_Allocator, NULL
+      );
+      if (!unescaped) {
+        self->sc.cur = key_start;
+        scan_fail(&self->sc, "invalid string escape");
+        return cursor_error(self);
+      }
+      yyjson_val *root = yyjson_doc_get_root(unescaped);
+      match = yyjson_get_len(root) == (size_t)key_len &&
+              memcmp(yyjson_get_str(root), key, key_len) == 0;
+      yyjson_doc_free(unescaped);
+    }
+
+    if (match) {
+      self->pending = true;
+      Py_INCREF(self);
+      return (PyObject *)self;
+    }
+
+    if (!scan_skip(&self->sc)) {
+      return cursor_error(self);
+    }
+  }
+
+  if (r == 0) {
+    PyErr_SetObject(PyExc_KeyError, PyTuple_GetItem(args, 0));
+  }
+  return NULL;
+}
+
+PyDoc_STRVAR(
+    Cursor_iter_array_doc,
+    "Iterate over the elements of the array at the cursor.\n"
+    "\n"
+    "Each step leaves the cursor at the next element and yields the cursor\n"
+    "itself. Whatever is left of an element that wasn't consumed is skipped\n"
+    "before moving to the next one.\n"
+);
+static PyObject *Cursor_iter_array(CursorObject *self, PyObject *unused) {
+  if (!cursor_ensure_pending(self)) return NULL;
+
+  if (scan_peek(&self->sc) != '[') {
+    return cursor_type_error(self, "an array");
+  }
+
+  CursorArrayIterObject *iter =
+      PyObject_New(CursorArrayIterObject, &CursorArrayIterType);
+  if (!iter) return NULL;
+
+  iter->cursor = NULL;
+  if (!cursor_enter(self, '[')) {
+    Py_DECREF(iter);
+    return NULL;
+  }
+
+  Py_INCREF(self);
+  iter->cursor = self;
+  iter->depth = self->depth;
+  return (PyObject *)iter;
+}
+
+PyDoc_STRVAR(
+    Cursor_skip_doc,
+    "Skip the value at the cursor without parsing it. If the value was\n"
+    "already consumed, skip the rest of the container the cursor is in\n"
+    "instead.\n"
+);
+static PyObject *Cursor_skip(CursorObject *self, PyObject *unused) {
+  if (self->pending) {
+    if (!cursor_skip_pending(self)) return NULL;
+  } else if (self->depth > 0) {
+    if (!cursor_finish_container(self)) return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Cursor_get_str_doc,
+    "Consume the string at the cursor.\n"
+    "\n"
+    ":raises TypeError: If the value at the cursor isn't a string.\n"
+);
+static PyObject *Cursor_get_str(CursorObject *self, PyObject *unused) {
+  const char *str;
+  size_t len;
+  bool escaped, plain;
+
+  if (!cursor_ensure_pending(self)) return NULL;
+
+  const char *start = self->sc.cur;
+  if (scan_peek(&self->sc) != '"') {
+    return cursor_type_error(self, "a string");
+  }
+  if (!scan_string(&self->sc, &str, &len, &escaped)) {
+    return cursor_error(self);
+  }
+  self->pending = false;
+
+  // Control characters and invalid UTF-8 are left to yyjson's reader too,
+  // so they raise the same errors as in a Document.
+  if (!escaped && str_check(str, len, &plain) && plain) {
+    return PyUnicode_DecodeUTF8(str, len, NULL);
+  }
+
+  yyjson_read_err err;
+  yyjson_doc *unescaped = yyjson_read_opts(
+      (char *)start, len + 2, self->sc.flags, &PyMem_Allocator, &err
+  );
+  if (!unescaped) {
+    PyErr_Format(
+        PyExc_ValueError, "%s at position %zu", err.msg,
+        (size_t)(start - self->sc.start) + err.pos
+    );
+    return NULL;
+  }
+
+  yyjson_val *root = yyjson_doc_get_root(unescaped);
+  PyObject *result =
+      PyUnicode_DecodeUTF8(yyjson_get_str(root), yyjson_get_len(root), NULL);
+  yyjson_doc_free(unescaped);
+  return result;
+}
+
+PyDoc_STRVAR(
+    Cursor_get_int_doc,
+    "Consume the integer at the cursor.\n"
+    "\n"
+    ":raises TypeError: If the value at the cursor isn't an integer.\n"
+);
+static PyObject *Cursor_get_int(CursorObject *self, PyObject *unused) {
+  yyjson_val val;
+  const char *start = self->sc.cur;
+
+  // Integers too big for 64 bits are read as raw so they aren't truncated.
+  if (!cursor_ensure_pending(self) ||
+      !cursor_read_number(self, &val, YYJSON_READ_BIGNUM_AS_RAW)) {
+    return NULL;
+  }
+
+  if (yyjson_is_raw(&val)) {
+    const char *raw = yyjson_get_raw(&val);
+    size_t len = yyjson_get_len(&val);
+    if (!memchr(raw, '.', len) && !memchr(raw, 'e', len) &&
+        !memchr(raw, 'E', len) && raw[len - 1] >= '0' && raw[len - 1] <= '9') {
+      PyObject *str = PyUnicode_FromStringAndSize(raw, len);
+      PyObject *result = str ? PyLong_FromUnicodeObject(str, 10) : NULL;
+      Py_XDECREF(str);
+      return result;
+    }
+  } else if (!yyjson_is_real(&val)) {
+    return element_to_primitive(&val);
+  }
+
+  cursor_consumed(self, start);
+  self->pending = true;
+  return cursor_type_error(self, "an integer");
+}
+
+PyDoc_STRVAR(
+    Cursor_get_float_doc,
+    "Consume the number at the cursor, as a ``float``.\n"
+    "\n"
+    ":raises TypeError: If the value at the cursor isn't a number.\n"
+);
+static PyObject *Cursor_get_float(CursorObject *self, PyObject *unused) {
+  yyjson_val val;
+
+  if (!cursor_ensure_pending(self) || !cursor_read_number(self, &val, 0)) {
+    return NULL;
+  }
+
+  if (yyjson_is_raw(&val)) {
+    PyObject *str =
+        PyUnicode_FromStringAndSize(yyjson_get_raw(&val), yyjson_get_len(&val));
+    PyObject *result = str ? PyFloat_FromString(str) : NULL;
+    Py_XDECREF(str);
+    return result;
+  }
+
+  return PyFloat_FromDouble(yyjson_get_num(&val));
+}
+
+PyDoc_STRVAR(
+    Cursor_get_bool_doc,
+    "Consume the boolean at the cursor.\n"
+    "\n"
+    ":raises TypeError: If the value at the cursor isn't ``true`` or\n"
+    "                   ``false``.\n"
+);
+static PyObject *Cursor_get_bool(CursorObject *self, PyObject *unused) {
+  if (!cursor_ensure_pending(self)) return NULL;
+
+  if (cursor_at_literal(self, "true", 4)) {
+    cursor_consumed(self, self->sc.cur + 4);
+    Py_RETURN_TRUE;
+  }
+  if (cursor_at_literal(self, "false", 5)) {
+    cursor_consumed(self, self->sc.cur + 5);
+    Py_RETURN_FALSE;
+  }
+
+  return cursor_type_error(self, "a boolean");
+}
+
+PyDoc_STRVAR(
+    Cursor_is_null_doc,
+    "Returns whether the value at the cursor is ``null``, consuming it if\n"
+    "it is.\n"
+);
+static PyObject *Cursor_is_null(CursorObject *self, PyObject *unused) {
+  if (!cursor_ensure_pending(self)) return NULL;
+
+  if (cursor_at_literal(self, "null", 4)) {
+    cursor_consumed(self, self->sc.cur + 4);
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+}
+
+PyDoc_STRVAR(
+    Cursor_get_value_doc,
+    "Consume the value at the cursor, whatever it is, and convert it into\n"
+    "the equivalent Python object. Only that value is parsed.\n"
+);
+static PyObject *Cursor_get_value(CursorObject *self, PyObject *unused) {
+  yyjson_read_err err;
+
+  if (!cursor_ensure_pending(self)) return NULL;
+
+  const char *start = self->sc.cur;
+  if (!scan_skip(&self->sc)) {
+    return cursor_error(self);
+  }
+
+  yyjson_doc *doc = yyjson_read_opts(
+      (char *)start, (size_t)(self->sc.cur - start),
+      self->sc.flags & ~YYJSON_READ_STOP_WHEN_DONE, &PyMem_Allocator, &err
+  );
+  if (!doc) {
+    self->sc.cur = start;
+    PyErr_Format(
+        PyExc_ValueError, "%s at position %zu", err.msg,
+        (size_t)(start - self->sc.start) + err.pos
+    );
+    return NULL;
+  }
+
+  self->pending = false;
+  PyObject *result = element_to_primitive(yyjson_doc_get_root(doc));
+  yyjson_doc_free(doc);
+  return result;
+}
+
+static PyObject *Cursor_get_type(CursorObject *self, void *closure) {
+  if (!self->pending) Py_RETURN_NONE;
+
+  switch (scan_peek(&self->sc)) {
+    case '{':
+      return PyUnicode_FromString("object");
+    case '[':
+      return PyUnicode_FromString("array");
+    case '"':
+      return PyUnicode_FromString("string");
+    case 't':
+    case 'f':
+      return PyUnicode_FromString("boolean");
+    case 'n':
+      return PyUnicode_FromString("null");
+    default:
+      return PyUnicode_FromString("number");
+  }
+}
+
+static PyObject *Cursor_get_depth(CursorObject *self, void *closure) {
+  return PyLong_FromSsize_t(self->depth);
+}
+
+static PyObject *Cursor_get_position(CursorObject *self, void *closure) {
+  return PyLong_FromSize_t((size_t)(self->sc.cur - self->sc.start));
+}
+
+static PyMethodDef Cursor_methods[] = {
+    {"find_field", (PyCFunction)Cursor_find_field, METH_VARARGS,
+     Cursor_find_field_doc},
+    {"iter_array", (PyCFunction)Cursor_iter_array, METH_NOARGS,
+     Cursor_iter_array_doc},
+    {"skip", (PyCFunction)Cursor_skip, METH_NOARGS, Cursor_skip_doc},
+    {"get_str", (PyCFunction)Cursor_get_str, METH_NOARGS, Cursor_get_str_doc},
+    {"get_int", (PyCFunction)Cursor_get_int, METH_NOARGS, Cursor_get_int_doc},
+    {"get_float", (PyCFunction)Cursor_get_float, METH_NOARGS,
+     Cursor_get_float_doc},
+    {"get_bool", (PyCFunction)Cursor_get_bool, METH_NOARGS,
+     Cursor_get_bool_doc},
+    {"is_null", (PyCFunction)Cursor_is_null, METH_NOARGS, Cursor_is_null_doc},
+    {"get_value", (PyCFunction)Cursor_get_value, METH_NOARGS,
+     Cursor_get_value_doc},
+    {NULL} /* Sentinel */
+};
+
+static PyGetSetDef Cursor_members[] = {
+    {"type", (getter)Cursor_get_type, NULL,
+     "The type of the value at the cursor (``'object'``, ``'array'``,\n"
+     "``'string'``, ``'number'``, ``'boolean'`` or ``'null'``), or ``None``\n"
+     "if it was consumed.",
+     NULL},
+    {"depth", (getter)Cursor_get_depth, NULL,
+     "The number of containers the cursor is inside of.", NULL},
+    {"position", (getter)Cursor_get_position, NULL,
+     "The byte offset of the cursor in the input.", NULL},
+    {NULL} /* Sentinel */
+};
+
+PyDoc_STRVAR(
+    Cursor_doc,
+    "A forward-only cursor over JSON text, which parses values on demand.\n"
+    "\n"
+    "No document is built. Values are only parsed when they're read, and\n"
+    "everything in between is skipped by matching brackets and quotes, so\n"
+    "memory use only grows with nesting depth. This suits reading a few\n"
+    "fields from the start of a document, or streaming over a large array.\n"
+    "Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> cursor = Cursor(b'{\"kind\": \"batch\", \"items\": [{\"id\": 1},'\n"
+    "    ...                 b' {\"id\": 2}]}')\n"
+    "    >>> cursor.find_field('kind').get_str()\n"
+    "    'batch'\n"
+    "    >>> [item.find_field('id').get_int()\n"
+    "    ...  for item in cursor.find_field('items').iter_array()]\n"
+    "    [1, 2]\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    Skipped values are only checked for matching brackets and quotes,\n"
+    "    and nothing after the first value in the input is checked.\n"
+    "\n"
+    ":param content: The JSON text to read.\n"
+    ":type content: ``str`` or ``bytes``\n"
+    ":param flags: Flags that modify the parsing behaviour.\n"
+    ":type flags: :class:`ReaderFlags`, optional\n"
+);
+
+PyTypeObject CursorType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.Cursor",
+    .tp_doc = Cursor_doc,
+    .tp_basicsize = sizeof(CursorObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Cursor_init,
+    .tp_dealloc = (destructor)Cursor_dealloc,
+    .tp_methods = Cursor_methods,
+    .tp_getset = Cursor_members};
+
+static void CursorArrayIter_dealloc(CursorArrayIterObject *self) {
+  Py_XDECREF(self->cursor);
+  PyObject_Del(self);
+}
+
+static PyObject *CursorArrayIter_next(CursorArrayIterObject *self) {
+  CursorObject *cursor = self->cursor;
+
+  // The array was already left, such as by skip().
+  if (cursor->depth < self->depth) {
+    return NULL;
+  }
+
+  // Skip anything left of the previous element.
+  while (cursor->depth > self->depth) {
+    if (!cursor_finish_container(cursor)) return NULL;
+  }
+  if (!cursor_skip_pending(cursor)) return NULL;
+
+  int r = cursor_next_item(cursor);
+  if (r != 1) {
+    return NULL;
+  }
+
+  cursor->pending = true;
+  Py_INCREF(cursor);
+  return (PyObject *)cursor;
+}
+
+PyTypeObject CursorArrayIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.CursorArrayIter",
+    .tp_basicsize = sizeof(CursorArrayIterObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)CursorArrayIter_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)CursorArrayIter_next};
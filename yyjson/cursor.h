@@ -0,0 +1,54 @@
+#ifndef PY_YYJSON_CURSOR_H
+#define PY_YYJSON_CURSOR_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "scan.h"
+#include "yyjson.h"
+
+/**
+ * A container the cursor is currently inside of.
+ */
+typedef struct {
+  /** The closing bracket of the container, ']' or '}'. */
+  char close;
+  /** Whether no items of the container have been visited yet. */
+  bool first;
+} CursorFrame;
+
+/**
+ * Represents a forward-only, on-demand cursor over JSON text.
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The object owning the input, kept alive while we point into it. */
+      PyObject* source;
+  /** The scanner over the input. */
+  Scanner sc;
+  /** The containers the cursor is inside of, innermost last. */
+  CursorFrame* frames;
+  /** The number of containers the cursor is inside of. */
+  Py_ssize_t depth;
+  /** The allocated size of frames. */
+  Py_ssize_t frames_cap;
+  /** Whether the cursor is at a value that hasn't been consumed yet. */
+  bool pending;
+} CursorObject;
+
+/**
+ * Iterates over the elements of an array, leaving the cursor at each one.
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The cursor being iterated. */
+      CursorObject* cursor;
+  /** The depth of the cursor while inside the array. */
+  Py_ssize_t depth;
+} CursorArrayIterObject;
+
+extern PyTypeObject CursorType;
+extern PyTypeObject CursorArrayIterType;
+
+#endif
@@ -0,0 +1,505 @@
+#include "decode.h"
+
+#include <string.h>
+
+#include "document.h"
+
+/**
+ * One step of the path to a value that failed to decode.
+ */
+typedef struct {
+  /** The object key, or NULL for an array index. */
+  const char *key;
+  /** The length of the key, or the array index. */
+  size_t len;
+} DecodeToken;
+
+typedef struct {
+  /** The path to the failed value, innermost first. */
+  DecodeToken *path;
+  size_t depth;
+  size_t cap;
+} DecodeCtx;
+
+static PyObject *decode_val(DecodeCtx *ctx, yyjson_val *val, PyObject *plan);
+
+/**
+ * Record that decoding failed inside the given member or element, as the
+ * error unwinds.
+ */
+static void decode_push(DecodeCtx *ctx, const char *key, size_t len) {
+  if (ctx->depth == ctx->cap) {
+    size_t cap = ctx->cap ? ctx->cap * 2 : 8;
+    DecodeToken *path = PyMem_Realloc(ctx->path, sizeof(DecodeToken) * cap);
+    // The path is only used to improve the error message, so an
+    // incomplete one is better than replacing the error.
+    if (!path) return;
+    ctx->path = path;
+    ctx->cap = cap;
+  }
+  ctx->path[ctx->depth++] = (DecodeToken){key, len};
+}
+
+/**
+ * Append the JSON Pointer to the failed value to the message of a
+ * TypeError or ValueError.
+ */
+static void decode_annotate(DecodeCtx *ctx) {
+  PyObject *type, *value, *tb;
+  size_t len = 1;
+
+  PyErr_Fetch(&type, &value, &tb);
+  if (type != PyExc_TypeError && type != PyExc_ValueError) {
+    PyErr_Restore(type, value, tb);
+    return;
+  }
+
+  for (size_t i = 0; i < ctx->depth; i++) {
+    // Every character could need escaping, and indexes fit in 20 digits.
+    len += 1 + (ctx->path[i].key ? ctx->path[i].len * 2 : 20);
+  }
+
+  char *ptr = PyMem_Malloc(len);
+  if (!ptr) {
+    PyErr_Restore(type, value, tb);
+    return;
+  }
+
+  char *p = ptr;
+  for (size_t i = ctx->depth; i-- > 0;) {
+    DecodeToken *tok = &ctx->path[i];
+    *p++ = '/';
+    if (!tok->key) {
+      p += sprintf(p, "%zu", tok->len);
+      continue;
+    }
+    for (size_t c = 0; c < tok->len; c++) {
+      if (tok->key[c] == '~') {
+        *p++ = '~';
+        *p++ = '0';
+      } else if (tok->key[c] == '/') {
+        *p++ = '~';
+        *p++ = '1';
+      } else {
+        *p++ = tok->key[c];
+      }
+    }
+  }
+  *p = '\0';
+
+  PyErr_NormalizeException(&type, &value, &tb);
+  PyErr_Format(type, "%S at %s", value, ptr);
+  PyMem_Free(ptr);
+  Py_DECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(tb);
+}
+
+static inline DecodeKind decode_kind(PyObject *plan) {
+  return (DecodeKind)PyLong_AsLong(PyTuple_GET_ITEM(plan, 0));
+}
+
+/**
+ * Returns the name of a value's JSON type, for error messages.
+ */
+static const char *decode_type_name(yyjson_val *val) {
+  switch (yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return "null";
+    case YYJSON_TYPE_BOOL:
+      return "boolean";
+    case YYJSON_TYPE_NUM:
+      return yyjson_is_real(val) ? "number" : "integer";
+    case YYJSON_TYPE_RAW:
+      return "number";
+    case YYJSON_TYPE_STR:
+      return "string";
+    case YYJSON_TYPE_ARR:
+      return "array";
+    case YYJSON_TYPE_OBJ:
+      return "object";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * Returns the name of the JSON type a plan expects, for error messages.
+ */
+static const char *decode_kind_name(DecodeKind kind) {
+  switch (kind) {
+    case DECODE_NONE:
+      return "null";
+    case DECODE_BOOL:
+      return "boolean";
+    case DECODE_INT:
+      return "integer";
+    case DECODE_FLOAT:
+      return "number";
+    case DECODE_STR:
+      return "string";
+    case DECODE_LIST:
+    case DECODE_TUPLE:
+    case DECODE_FIXED_TUPLE:
+      return "array";
+    case DECODE_DICT:
+    case DECODE_DATACLASS:
+    case DECODE_TYPEDDICT:
+      return "object";
+    default:
+      return "any value";
+  }
+}
+
+static PyObject *decode_mismatch(const char *expected, yyjson_val *val) {
+  PyErr_Format(
+      PyExc_TypeError, "expected %s, got %s", expected, decode_type_name(val)
+  );
+  return NULL;
+}
+
+/**
+ * Returns whether a raw number, read with NUMBERS_AS_RAW or BIGNUM_AS_RAW,
+ * is an integer.
+ */
+static bool decode_raw_is_int(yyjson_val *val) {
+  const char *raw = yyjson_get_raw(val);
+  size_t len = yyjson_get_len(val);
+
+  return len && !memchr(raw, '.', len) && !memchr(raw, 'e', len) &&
+         !memchr(raw, 'E', len) && raw[len - 1] >= '0' && raw[len - 1] <= '9';
+}
+
+static PyObject *decode_raw(yyjson_val *val, bool as_int) {
+  PyObject *str =
+      PyUnicode_FromStringAndSize(yyjson_get_raw(val), yyjson_get_len(val));
+  if (!str) return NULL;
+
+  PyObject *result =
+      as_int ? PyLong_FromUnicodeObject(str, 10) : PyFloat_FromString(str);
+  Py_DECREF(str);
+  return result;
+}
+
+/**
+ * Returns whether plan accepts values of val's JSON type, which is how a
+ * member of a union is picked.
+ */
+static bool decode_accepts(PyObject *plan, yyjson_val *val) {
+  switch (decode_kind(plan)) {
+    case DECODE_ANY:
+      return true;
+    case DECODE_NONE:
+      return yyjson_is_null(val);
+    case DECODE_BOOL:
+      return yyjson_is_bool(val);
+    case DECODE_INT:
+      return yyjson_is_int(val) || (yyjson_is_raw(val) && decode_raw_is_int(val));
+    case DECODE_FLOAT:
+      return yyjson_is_num(val) || yyjson_is_raw(val);
+    case DECODE_STR:
+      return yyjson_is_str(val);
+    case DECODE_LIST:
+    case DECODE_TUPLE:
+    case DECODE_FIXED_TUPLE:
+      return yyjson_is_arr(val);
+    case DECODE_DICT:
+    case DECODE_DATACLASS:
+    case DECODE_TYPEDDICT:
+      return yyjson_is_obj(val);
+    case DECODE_UNION: {
+      PyObject *plans = PyTuple_GET_ITEM(plan, 1);
+      for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(plans); i++) {
+        if (decode_accepts(PyTuple_GET_ITEM(plans, i), val)) return true;
+      }
+      return false;
+    }
+    case DECODE_REF:
+      return decode_accepts(PyList_GET_ITEM(PyTuple_GET_ITEM(plan, 1), 0), val);
+  }
+  return false;
+}
+
+static PyObject *decode_union(DecodeCtx *ctx, yyjson_val *val, PyObject *plan) {
+  PyObject *plans = PyTuple_GET_ITEM(plan, 1);
+  char expected[128] = "";
+
+  for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(plans); i++) {
+    PyObject *option = PyTuple_GET_ITEM(plans, i);
+    if (decode_accepts(option, val)) {
+      return decode_val(ctx, val, option);
+    }
+
+    const char *name = decode_kind_name(decode_kind(option));
+    if (strlen(expected) + strlen(name) + 5 < sizeof(expected)) {
+      if (i) strcat(expected, " or ");
+      strcat(expected, name);
+    }
+  }
+
+  return decode_mismatch(expected, val);
+}
+
+static PyObject *decode_array(DecodeCtx *ctx, yyjson_val *val, PyObject *plan) {
+  DecodeKind kind = decode_kind(plan);
+  size_t len = yyjson_arr_size(val);
+
+  if (!yyjson_is_arr(val)) {
+    return decode_mismatch("array", val);
+  }
+
+  if (kind == DECODE_FIXED_TUPLE &&
+      (size_t)PyTuple_GET_SIZE(PyTuple_GET_ITEM(plan, 1)) != len) {
+    PyErr_Format(
+        PyExc_ValueError, "expected an array of length %zd, got length %zu",
+        PyTuple_GET_SIZE(PyTuple_GET_ITEM(plan, 1)), len
+    );
+    return NULL;
+  }
+
+  PyObject *result =
+      kind == DECODE_LIST ? PyList_New(len) : PyTuple_New(len);
+  if (!result) return NULL;
+
+  yyjson_val *item;
+  yyjson_arr_iter iter = {0};
+  yyjson_arr_iter_init(val, &iter);
+
+  for (size_t idx = 0; (item = yyjson_arr_iter_next(&iter)); idx++) {
+    PyObject *item_plan = kind == DECODE_FIXED_TUPLE
+                              ? PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, 1), idx)
+                              : PyTuple_GET_ITEM(plan, 1);
+    PyObject *py_item = decode_val(ctx, item, item_plan);
+    if (!py_item) {
+      decode_push(ctx, NULL, idx);
+      Py_DECREF(result);
+      return NULL;
+    }
+
+    if (kind == DECODE_LIST) {
+      PyList_SET_ITEM(result, idx, py_item);
+    } else {
+      PyTuple_SET_ITEM(result, idx, py_item);
+    }
+  }
+
+  return result;
+}
+
+static PyObject *decode_dict(DecodeCtx *ctx, yyjson_val *val, PyObject *plan) {
+  if (!yyjson_is_obj(val)) {
+    return decode_mismatch("object", val);
+  }
+
+  PyObject *value_plan = PyTuple_GET_ITEM(plan, 1);
+  PyObject *dict = PyDict_New();
+  if (!dict) return NULL;
+
+  yyjson_val *key;
+  yyjson_obj_iter iter = {0};
+  yyjson_obj_iter_init(val, &iter);
+
+  while ((key = yyjson_obj_iter_next(&iter))) {
+    PyObject *py_val =
+        decode_val(ctx, yyjson_obj_iter_get_val(key), value_plan);
+    if (!py_val) {
+      decode_push(ctx, yyjson_get_str(key), yyjson_get_len(key));
+      Py_DECREF(dict);
+      return NULL;
+    }
+
+    PyObject *py_key = unicode_from_str(yyjson_get_str(key), yyjson_get_len(key));
+    if (!py_key || PyDict_SetItem(dict, py_key, py_val) < 0) {
+      Py_XDECREF(py_key);
+      Py_DECREF(py_val);
+      Py_DECREF(dict);
+      return NULL;
+    }
+    Py_DECREF(py_key);
+    Py_DECREF(py_val);
+  }
+
+  return dict;
+}
+
+/**
+ * Decode an object into a dataclass or TypedDict. Only members named by
+ * the plan are decoded, the rest are ignored.
+ */
+static PyObject *decode_fields(DecodeCtx *ctx, yyjson_val *val, PyObject *plan) {
+  bool is_dataclass = decode_kind(plan) == DECODE_DATACLASS;
+  Py_ssize_t base = is_dataclass ? 2 : 1;
+  PyObject *names = PyTuple_GET_ITEM(plan, base);
+  PyObject *plans = PyTuple_GET_ITEM(plan, base + 1);
+  PyObject *required = PyTuple_GET_ITEM(plan, base + 2);
+  Py_ssize_t num_fields = PyTuple_GET_SIZE(names);
+  PyObject *result = NULL;
+
+  if (!yyjson_is_obj(val)) {
+    return decode_mismatch("object", val);
+  }
+
+  PyObject **values = PyMem_Calloc(num_fields ? num_fields : 1, sizeof(PyObject *));
+  if (!values) return PyErr_NoMemory();
+
+  yyjson_val *key;
+  yyjson_obj_iter iter = {0};
+  yyjson_obj_iter_init(val, &iter);
+
+  // Members usually come in the order the fields are declared, so the
+  // search for each starts after the previous match.
+  Py_ssize_t hint = 0;
+  while ((key = yyjson_obj_iter_next(&iter))) {
+    const char *key_str = yyjson_get_str(key);
+    size_t key_len = yyjson_get_len(key);
+
+    Py_ssize_t field = -1;
+    for (Py_ssize_t n = 0; n < num_fields; n++) {
+      Py_ssize_t i = (hint + n) % num_fields;
+      Py_ssize_t name_len;
+      const char *name =
+          PyUnicode_AsUTF8AndSize(PyTuple_GET_ITEM(names, i), &name_len);
+      if (!name) goto done;
+
+      if ((size_t)name_len == key_len && memcmp(name, key_str, key_len) == 0) {
+        field = i;
+        break;
+      }
+    }
+    if (field == -1) continue;
+    hint = field + 1;
+
+    PyObject *py_val = decode_val(
+        ctx, yyjson_obj_iter_get_val(key), PyTuple_GET_ITEM(plans, field)
+    );
+    if (!py_val) {
+      decode_push(ctx, key_str, key_len);
+      goto done;
+    }
+    Py_XSETREF(values[field], py_val);
+  }
+
+  PyObject *kwargs = PyDict_New();
+  if (!kwargs) goto done;
+
+  for (Py_ssize_t i = 0; i < num_fields; i++) {
+    if (!values[i]) {
+      if (PyObject_IsTrue(PyTuple_GET_ITEM(required, i))) {
+        PyErr_Format(
+            PyExc_ValueError, "missing required field `%U`",
+            PyTuple_GET_ITEM(names, i)
+        );
+        Py_DECREF(kwargs);
+        goto done;
+      }
+      continue;
+    }
+
+    if (PyDict_SetItem(kwargs, PyTuple_GET_ITEM(names, i), values[i]) < 0) {
+      Py_DECREF(kwargs);
+      goto done;
+    }
+  }
+
+  if (!is_dataclass) {
+    result = kwargs;
+    goto done;
+  }
+
+  PyObject *args = PyTuple_New(0);
+  if (args) {
+    result = PyObject_Call(PyTuple_GET_ITEM(plan, 1), args, kwargs);
+    Py_DECREF(args);
+  }
+  Py_DECREF(kwargs);
+
+done:
+  for (Py_ssize_t i = 0; i < num_fields; i++) {
+    Py_XDECREF(values[i]);
+  }
+  PyMem_Free(values);
+  return result;
+}
+
+static PyObject *decode_val(DecodeCtx *ctx, yyjson_val *val, PyObject *plan) {
+  PyObject *result = NULL;
+
+  switch (decode_kind(plan)) {
+    case DECODE_ANY:
+      return element_to_primitive(val);
+    case DECODE_NONE:
+      if (!yyjson_is_null(val)) return decode_mismatch("null", val);
+      Py_RETURN_NONE;
+    case DECODE_BOOL:
+      if (!yyjson_is_bool(val)) return decode_mismatch("boolean", val);
+      return PyBool_FromLong(yyjson_get_bool(val));
+    case DECODE_INT:
+      if (yyjson_is_uint(val)) {
+        return PyLong_FromUnsignedLongLong(yyjson_get_uint(val));
+      }
+      if (yyjson_is_sint(val)) {
+        return PyLong_FromLongLong(yyjson_get_sint(val));
+      }
+      if (yyjson_is_raw(val) && decode_raw_is_int(val)) {
+        return decode_raw(val, true);
+      }
+      return decode_mismatch("integer", val);
+    case DECODE_FLOAT:
+      if (yyjson_is_num(val)) {
+        return PyFloat_FromDouble(yyjson_get_num(val));
+      }
+      if (yyjson_is_raw(val)) {
+        return decode_raw(val, false);
+      }
+      return decode_mismatch("number", val);
+    case DECODE_STR:
+      if (!yyjson_is_str(val)) return decode_mismatch("string", val);
+      return unicode_from_str(yyjson_get_str(val), yyjson_get_len(val));
+    case DECODE_UNION:
+      return decode_union(ctx, val, plan);
+    case DECODE_REF:
+      return decode_val(
+          ctx, val, PyList_GET_ITEM(PyTuple_GET_ITEM(plan, 1), 0)
+      );
+    default:
+      break;
+  }
+
+  // Only containers can recurse, so only they need to guard the C stack.
+  if (Py_EnterRecursiveCall(" while decoding JSON")) {
+    return NULL;
+  }
+
+  switch (decode_kind(plan)) {
+    case DECODE_LIST:
+    case DECODE_TUPLE:
+    case DECODE_FIXED_TUPLE:
+      result = decode_array(ctx, val, plan);
+      break;
+    case DECODE_DICT:
+      result = decode_dict(ctx, val, plan);
+      break;
+    case DECODE_DATACLASS:
+    case DECODE_TYPEDDICT:
+      result = decode_fields(ctx, val, plan);
+      break;
+    default:
+      PyErr_SetString(PyExc_ValueError, "Invalid decode plan.");
+      break;
+  }
+
+  Py_LeaveRecursiveCall();
+  return result;
+}
+
+PyObject *decode_value(yyjson_val *val, PyObject *plan) {
+  DecodeCtx ctx = {0};
+
+  PyObject *result = decode_val(&ctx, val, plan);
+  if (!result && ctx.depth) {
+    decode_annotate(&ctx);
+  }
+
+  PyMem_Free(ctx.path);
+  return result;
+}
@@ -0,0 +1,58 @@
+#ifndef PY_YYJSON_DECODE_H
+#define PY_YYJSON_DECODE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+/**
+ * The kinds of steps in a decode plan. A plan is a tuple whose first item
+ * is one of these, compiled from a type by yyjson._decode_plan(), which
+ * must be kept in sync.
+ */
+typedef enum {
+  /** (ANY,): any value, converted as Document.as_obj would. */
+  DECODE_ANY = 0,
+  /** (NONE,): null. */
+  DECODE_NONE = 1,
+  /** (BOOL,): true or false. */
+  DECODE_BOOL = 2,
+  /** (INT,): an integer. */
+  DECODE_INT = 3,
+  /** (FLOAT,): any number, as a float. */
+  DECODE_FLOAT = 4,
+  /** (STR,): a string. */
+  DECODE_STR = 5,
+  /** (LIST, item): an array, as a list. */
+  DECODE_LIST = 6,
+  /** (TUPLE, item): an array, as a tuple. */
+  DECODE_TUPLE = 7,
+  /** (FIXED_TUPLE, (item, ...)): an array with exactly these items. */
+  DECODE_FIXED_TUPLE = 8,
+  /** (DICT, value): an object, as a dict. */
+  DECODE_DICT = 9,
+  /**
+   * (DATACLASS, cls, (name, ...), (plan, ...), (required, ...)): an object,
+   * whose known members are passed to cls as keyword arguments.
+   */
+  DECODE_DATACLASS = 10,
+  /**
+   * (TYPEDDICT, (name, ...), (plan, ...), (required, ...)): an object, as a
+   * dict of only its known members.
+   */
+  DECODE_TYPEDDICT = 11,
+  /** (UNION, (plan, ...)): the first plan that accepts the value's type. */
+  DECODE_UNION = 12,
+  /** (REF, [plan]): a plan that refers to itself, such as a tree. */
+  DECODE_REF = 13,
+} DecodeKind;
+
+/**
+ * Convert val into Python objects following plan. On failure, the message
+ * of the exception includes the JSON Pointer to the offending value.
+ */
+PyObject* decode_value(yyjson_val* val, PyObject* plan);
+
+#endif
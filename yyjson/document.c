@@ -2,16 +2,66 @@
 
 #include "memory.h"
 #include "decimal.h"
+#include "arrow.h"
+#include "canonical.h"
+#include "decode.h"
+#include "pointer.h"
+#include "jsonpath.h"
+#include "numarray.h"
+#include "patch.h"
+#include "scan.h"
+#include "shared.h"
+#include "snapshot.h"
+#include "transcode.h"
+#include "value.h"
 
 #define ENSURE_MUTABLE(self)                                   \
   if (self->i_doc) {                                           \
+    if (document_check_idle(self) < 0) return NULL;            \
     self->m_doc = yyjson_doc_mut_copy(self->i_doc, self->alc); \
     yyjson_doc_free(self->i_doc);                              \
     self->i_doc = NULL;                                        \
   }
 
-static PyObject *mut_element_to_primitive(yyjson_mut_val *val);
-static PyObject *element_to_primitive(yyjson_val *val);
+/**
+ * Mark the document as busy while pointers into it are held across calls
+ * into Python code, which could otherwise free them by freezing or thawing
+ * it.
+ */
+static inline void document_pin(DocumentObject *self) { self->busy++; }
+
+static inline void document_unpin(DocumentObject *self) { self->busy--; }
+
+/**
+ * Returns -1 and raises a BufferError if the document is busy.
+ */
+static int document_check_idle(DocumentObject *self) {
+  if (self->busy) {
+    PyErr_SetString(
+        PyExc_BufferError,
+        "Document can't be frozen or thawed while it's being used"
+    );
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Python callables that customize converting values into Python objects,
+ * as with the hooks of json.loads().
+ */
+typedef struct {
+  PyObject *parse_float;
+  PyObject *parse_int;
+  PyObject *parse_constant;
+  PyObject *object_hook;
+  PyObject *object_pairs_hook;
+} ConvertHooks;
+
+static PyObject *element_to_obj(yyjson_val *val, const ConvertHooks *hooks);
+static PyObject *mut_element_to_obj(
+    yyjson_mut_val *val, const ConvertHooks *hooks
+);
 
 static PyObject *pathlib = NULL;
 static PyObject *path = NULL;
@@ -22,7 +72,7 @@ static PyObject *path = NULL;
 static inline size_t num_utf8_chars(const char *src, size_t len) {
   size_t count = 0;
   for (size_t i = 0; i < len; i++) {
-    if (yyjson_likely(src[i] >> 6 != 2)) {
+    if (yyjson_likely((unsigned char)src[i] >> 6 != 2)) {
       count++;
     }
   }
@@ -32,7 +82,7 @@ static inline size_t num_utf8_chars(const char *src, size_t len) {
 /**
  * Convert the given UTF-8 string into a Python unicode object.
  */
-static inline PyObject *unicode_from_str(const char *src, size_t len) {
+PyObject *unicode_from_str(const char *src, size_t len) {
 #ifndef PYPY_VERSION
   // Exploit the internals of CPython's unicode implementation to
   // implement a fast-path for ASCII data, which is by far the
@@ -55,11 +105,233 @@ static inline PyObject *unicode_from_str(const char *src, size_t len) {
   return PyUnicode_DecodeUTF8(src, len, NULL);
 }
 
+/**
+ * Parse a JSON integer of at most 18 digits, which always fits in a long
+ * long. Returns false for anything else.
+ */
+static inline bool parse_small_int(
+    const char *str, size_t len, long long *result
+) {
+  bool negative = len && str[0] == '-';
+  size_t i = negative;
+
+  if (len - i == 0 || len - i > 18) return false;
+
+  long long value = 0;
+  for (; i < len; i++) {
+    if (str[i] < '0' || str[i] > '9') return false;
+    value = value * 10 + (str[i] - '0');
+  }
+
+  // Keep the sign of -0, which only Decimal can represent.
+  if (negative && value == 0) return false;
+
+  *result = negative ? -value : value;
+  return true;
+}
+
+/**
+ * Convert a raw number into a Decimal. Integers of up to 18 digits are
+ * created from an int, which skips the Decimal string parser. Reals are
+ * always parsed from their text: building one from its coefficient and
+ * exponent needs a second call to scaleb(), with a context wide enough to
+ * keep it exact, which costs more than the parse it saves.
+ */
+static PyObject *decimal_from_raw(const char *str, size_t len) {
+  long long small;
+  PyObject *arg = parse_small_int(str, len, &small)
+                      ? PyLong_FromLongLong(small)
+                      : unicode_from_str(str, len);
+  if (!arg) return NULL;
+
+  PyObject *result = PyObject_CallOneArg(YY_DecimalClass, arg);
+  Py_DECREF(arg);
+  return result;
+}
+
+/**
+ * Call a number hook with the text of the number. Decimal goes through
+ * decimal_from_raw(), so small integers skip the string parser.
+ */
+static PyObject *call_number_hook(
+    PyObject *hook, const char *str, size_t len
+) {
+  if (hook == YY_DecimalClass) {
+    return decimal_from_raw(str, len);
+  }
+
+  PyObject *text = unicode_from_str(str, len);
+  if (!text) return NULL;
+
+  PyObject *result = PyObject_CallOneArg(hook, text);
+  Py_DECREF(text);
+  return result;
+}
+
+/**
+ * Convert a raw number, as read with NUMBERS_AS_RAW, with the hooks. Numbers
+ * without a hook become an int or float, like json.loads().
+ */
+static PyObject *raw_to_obj(
+    const char *str, size_t len, const ConvertHooks *hooks
+) {
+  const char *digits = len && str[0] == '-' ? str + 1 : str;
+
+  if (!hooks) {
+    return decimal_from_raw(str, len);
+  }
+
+  // NaN and Infinity, which json.loads() passes to parse_constant()
+  // spelled exactly like this whatever the input was.
+  if (digits < str + len && (*digits == 'n' || *digits == 'N' ||
+                             *digits == 'i' || *digits == 'I')) {
+    const char *name = *digits == 'n' || *digits == 'N'
+                           ? "NaN"
+                           : (digits == str ? "Infinity" : "-Infinity");
+    if (hooks->parse_constant) {
+      return call_number_hook(hooks->parse_constant, name, strlen(name));
+    }
+    return PyFloat_FromDouble(
+        name[0] == 'N' ? Py_NAN : (name[0] == '-' ? -Py_HUGE_VAL : Py_HUGE_VAL)
+    );
+  }
+
+  bool is_int = !memchr(str, '.', len) && !memchr(str, 'e', len) &&
+                !memchr(str, 'E', len);
+
+  if (is_int) {
+    long long small;
+    if (hooks->parse_int) {
+      return call_number_hook(hooks->parse_int, str, len);
+    }
+    if (parse_small_int(str, len, &small)) {
+      return PyLong_FromLongLong(small);
+    }
+  } else if (hooks->parse_float) {
+    return call_number_hook(hooks->parse_float, str, len);
+  } else if (len < 64) {
+    char buf[64];
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+    double d = PyOS_string_to_double(buf, NULL, NULL);
+    if (d == -1.0 && PyErr_Occurred()) return NULL;
+    return PyFloat_FromDouble(d);
+  }
+
+  PyObject *text = unicode_from_str(str, len);
+  if (!text) return NULL;
+  PyObject *result =
+      is_int ? PyLong_FromUnicodeObject(text, 10) : PyFloat_FromString(text);
+  Py_DECREF(text);
+  return result;
+}
+
+/**
+ * Convert a number that wasn't read as raw. If it has a hook, the hook is
+ * called with the shortest text that reads back as the same number.
+ */
+static PyObject *num_to_obj(
+    yyjson_subtype subtype, yyjson_val_uni uni, const ConvertHooks *hooks
+) {
+  char buf[32];
+
+  switch (subtype) {
+    case YYJSON_SUBTYPE_UINT:
+      if (hooks && hooks->parse_int) {
+        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)uni.u64);
+        return call_number_hook(hooks->parse_int, buf, strlen(buf));
+      }
+      return PyLong_FromUnsignedLongLong(uni.u64);
+    case YYJSON_SUBTYPE_SINT:
+      if (hooks && hooks->parse_int) {
+        snprintf(buf, sizeof(buf), "%lld", (long long)uni.i64);
+        return call_number_hook(hooks->parse_int, buf, strlen(buf));
+      }
+      return PyLong_FromLongLong(uni.i64);
+    default:
+      break;
+  }
+
+  if (hooks && !isfinite(uni.f64)) {
+    const char *name =
+        isnan(uni.f64) ? "NaN" : (uni.f64 < 0 ? "-Infinity" : "Infinity");
+    return raw_to_obj(name, strlen(name), hooks);
+  }
+
+  if (hooks && hooks->parse_float) {
+    char *text = PyOS_double_to_string(uni.f64, 'r', 0, 0, NULL);
+    if (!text) return NULL;
+    PyObject *result = call_number_hook(hooks->parse_float, text, strlen(text));
+    PyMem_Free(text);
+    return result;
+  }
+
+  return PyFloat_FromDouble(uni.f64);
+}
+
+/**
+ * Convert an object of either representation into the list of (key, value)
+ * tuples given to object_pairs_hook, without building a dict first, and
+ * call the hook with it.
+ */
+static PyObject *obj_to_pairs(void *obj, bool mut, const ConvertHooks *hooks) {
+  PyObject *pairs = PyList_New(unsafe_yyjson_get_len(obj));
+  if (!pairs) return NULL;
+
+  ValIter iter;
+  void *key;
+  Py_ssize_t idx = 0;
+  val_iter_init(&iter, obj, mut);
+  while ((key = val_iter_next(&iter))) {
+    void *val = val_key_value(key, mut);
+    PyObject *py_key = unicode_from_str(
+        unsafe_yyjson_get_str(key), unsafe_yyjson_get_len(key)
+    );
+    PyObject *py_val = NULL;
+    if (py_key) {
+      py_val = mut ? mut_element_to_obj(val, hooks) : element_to_obj(val, hooks);
+    }
+    PyObject *pair = py_val ? PyTuple_New(2) : NULL;
+    if (!pair) {
+      Py_XDECREF(py_key);
+      Py_XDECREF(py_val);
+      Py_DECREF(pairs);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(pair, 0, py_key);
+    PyTuple_SET_ITEM(pair, 1, py_val);
+    PyList_SET_ITEM(pairs, idx++, pair);
+  }
+
+  PyObject *result = PyObject_CallOneArg(hooks->object_pairs_hook, pairs);
+  Py_DECREF(pairs);
+  return result;
+}
+
+/**
+ * Pass a converted object to object_hook, if there is one, stealing the
+ * reference to dict.
+ */
+static PyObject *call_object_hook(PyObject *dict, const ConvertHooks *hooks) {
+  if (!dict || !hooks || !hooks->object_hook) return dict;
+  PyObject *result = PyObject_CallOneArg(hooks->object_hook, dict);
+  Py_DECREF(dict);
+  return result;
+}
+
 /**
  * Recursively convert the given value into an equivalent high-level Python
  * object.
  **/
-static PyObject *element_to_primitive(yyjson_val *val) {
+PyObject *element_to_primitive(yyjson_val *val) {
+  return element_to_obj(val, NULL);
+}
+
+/**
+ * Recursively convert the given value into an equivalent high-level Python
+ * object, customized by hooks if they aren't NULL.
+ **/
+static PyObject *element_to_obj(yyjson_val *val, const ConvertHooks *hooks) {
   yyjson_type type = yyjson_get_type(val);
 
   switch (type) {
@@ -71,16 +343,8 @@ static PyObject *element_to_primitive(yyjson_val *val) {
       } else {
         Py_RETURN_FALSE;
       }
-    case YYJSON_TYPE_NUM: {
-      switch (yyjson_get_subtype(val)) {
-        case YYJSON_SUBTYPE_UINT:
-          return PyLong_FromUnsignedLongLong(yyjson_get_uint(val));
-        case YYJSON_SUBTYPE_SINT:
-          return PyLong_FromLongLong(yyjson_get_sint(val));
-        case YYJSON_SUBTYPE_REAL:
-          return PyFloat_FromDouble(yyjson_get_real(val));
-      }
-    }
+    case YYJSON_TYPE_NUM:
+      return num_to_obj(yyjson_get_subtype(val), val->uni, hooks);
     case YYJSON_TYPE_STR: {
       size_t str_len = yyjson_get_len(val);
       const char *str = yyjson_get_str(val);
@@ -100,8 +364,9 @@ static PyObject *element_to_primitive(yyjson_val *val) {
 
       size_t idx = 0;
       while ((obj_val = yyjson_arr_iter_next(&iter))) {
-        py_val = element_to_primitive(obj_val);
+        py_val = element_to_obj(obj_val, hooks);
         if (!py_val) {
+          Py_DECREF(arr);
           return NULL;
         }
 
@@ -111,6 +376,10 @@ static PyObject *element_to_primitive(yyjson_val *val) {
       return arr;
     }
     case YYJSON_TYPE_OBJ: {
+      if (hooks && hooks->object_pairs_hook) {
+        return obj_to_pairs(val, false, hooks);
+      }
+
       PyObject *dict = PyDict_New();
       if (!dict) {
         return NULL;
@@ -131,34 +400,23 @@ static PyObject *element_to_primitive(yyjson_val *val) {
         str = yyjson_get_str(obj_key);
 
         py_key = unicode_from_str(str, str_len);
-        py_val = element_to_primitive(obj_val);
-
-        if (!py_key) {
-          return NULL;
-        }
-
-        if (!py_val) {
-          Py_DECREF(py_key);
-          return NULL;
-        }
+        py_val = element_to_obj(obj_val, hooks);
 
-        if (PyDict_SetItem(dict, py_key, py_val) == -1) {
+        if (!py_key || !py_val ||
+            PyDict_SetItem(dict, py_key, py_val) == -1) {
+          Py_XDECREF(py_key);
+          Py_XDECREF(py_val);
+          Py_DECREF(dict);
           return NULL;
         }
 
         Py_DECREF(py_key);
         Py_DECREF(py_val);
       }
-      return dict;
-    }
-    case YYJSON_TYPE_RAW: {
-      size_t str_len = yyjson_get_len(val);
-      const char *str = yyjson_get_raw(val);
-      PyObject *uni = unicode_from_str(str, str_len);
-      PyObject *result = PyObject_CallOneArg(YY_DecimalClass, uni);
-      Py_DECREF(uni);
-      return result;
+      return call_object_hook(dict, hooks);
     }
+    case YYJSON_TYPE_RAW:
+      return raw_to_obj(yyjson_get_raw(val), yyjson_get_len(val), hooks);
     case YYJSON_TYPE_NONE:
     default:
       PyErr_SetString(PyExc_TypeError, "Unknown tape type encountered.");
@@ -168,9 +426,11 @@ static PyObject *element_to_primitive(yyjson_val *val) {
 
 /**
  * Recursively convert the given value into an equivalent high-level Python
- * object.
+ * object, customized by hooks if they aren't NULL.
  **/
-static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
+static PyObject *mut_element_to_obj(
+    yyjson_mut_val *val, const ConvertHooks *hooks
+) {
   yyjson_type type = yyjson_mut_get_type(val);
 
   switch (type) {
@@ -182,16 +442,8 @@ static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
       } else {
         Py_RETURN_FALSE;
       }
-    case YYJSON_TYPE_NUM: {
-      switch (yyjson_mut_get_subtype(val)) {
-        case YYJSON_SUBTYPE_UINT:
-          return PyLong_FromUnsignedLongLong(yyjson_mut_get_uint(val));
-        case YYJSON_SUBTYPE_SINT:
-          return PyLong_FromLongLong(yyjson_mut_get_sint(val));
-        case YYJSON_SUBTYPE_REAL:
-          return PyFloat_FromDouble(yyjson_mut_get_real(val));
-      }
-    }
+    case YYJSON_TYPE_NUM:
+      return num_to_obj(yyjson_mut_get_subtype(val), val->uni, hooks);
     case YYJSON_TYPE_STR: {
       size_t str_len = yyjson_mut_get_len(val);
       const char *str = yyjson_mut_get_str(val);
@@ -212,8 +464,9 @@ static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
 
       size_t idx = 0;
       while ((obj_val = yyjson_mut_arr_iter_next(&iter))) {
-        py_val = mut_element_to_primitive(obj_val);
+        py_val = mut_element_to_obj(obj_val, hooks);
         if (!py_val) {
+          Py_DECREF(arr);
           return NULL;
         }
 
@@ -223,6 +476,10 @@ static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
       return arr;
     }
     case YYJSON_TYPE_OBJ: {
+      if (hooks && hooks->object_pairs_hook) {
+        return obj_to_pairs(val, true, hooks);
+      }
+
       PyObject *dict = PyDict_New();
       if (!dict) {
         return NULL;
@@ -237,35 +494,26 @@ static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
       while ((obj_key = yyjson_mut_obj_iter_next(&iter))) {
         obj_val = yyjson_mut_obj_iter_get_val(obj_key);
 
-        py_key = mut_element_to_primitive(obj_key);
-        py_val = mut_element_to_primitive(obj_val);
-
-        if (!py_key) {
-          return NULL;
-        }
-
-        if (!py_val) {
-          Py_DECREF(py_key);
-          return NULL;
-        }
+        py_key = mut_element_to_obj(obj_key, hooks);
+        py_val = mut_element_to_obj(obj_val, hooks);
 
-        if (PyDict_SetItem(dict, py_key, py_val) == -1) {
+        if (!py_key || !py_val ||
+            PyDict_SetItem(dict, py_key, py_val) == -1) {
+          Py_XDECREF(py_key);
+          Py_XDECREF(py_val);
+          Py_DECREF(dict);
           return NULL;
         }
 
         Py_DECREF(py_key);
         Py_DECREF(py_val);
       }
-      return dict;
-    }
-    case YYJSON_TYPE_RAW: {
-      size_t str_len = yyjson_mut_get_len(val);
-      const char *str = yyjson_mut_get_raw(val);
-      PyObject *uni = unicode_from_str(str, str_len);
-      PyObject *result = PyObject_CallOneArg(YY_DecimalClass, uni);
-      Py_DECREF(uni);
-      return result;
+      return call_object_hook(dict, hooks);
     }
+    case YYJSON_TYPE_RAW:
+      return raw_to_obj(
+          yyjson_mut_get_raw(val), yyjson_mut_get_len(val), hooks
+      );
     case YYJSON_TYPE_NONE:
     default:
       PyErr_SetString(PyExc_TypeError, "Unknown tape type encountered.");
@@ -273,6 +521,14 @@ static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
   }
 }
 
+/**
+ * Recursively convert the given value into an equivalent high-level Python
+ * object.
+ **/
+static PyObject *mut_element_to_primitive(yyjson_mut_val *val) {
+  return mut_element_to_obj(val, NULL);
+}
+
 PyTypeObject *type_for_conversion(PyObject *obj) {
   if (obj->ob_type == &PyUnicode_Type) {
     return &PyUnicode_Type;
@@ -399,10 +655,56 @@ static inline yyjson_mut_val *mut_primitive_to_element(
   }
 }
 
+/**
+ * Resolve a JSON pointer, given as either a str or a compiled Pointer,
+ * against an immutable document.
+ */
+static yyjson_val *doc_ptr_get(
+    yyjson_doc *doc, PyObject *pointer, yyjson_ptr_err *err
+) {
+  if (Pointer_Check(pointer)) {
+    return pointer_get(
+        (PointerObject *)pointer, yyjson_doc_get_root(doc), err
+    );
+  }
+
+  Py_ssize_t pointer_len;
+  const char *str = PyUnicode_AsUTF8AndSize(pointer, &pointer_len);
+  if (!str) {
+    return NULL;
+  }
+
+  return yyjson_doc_ptr_getx(doc, str, pointer_len, err);
+}
+
+/**
+ * Resolve a JSON pointer, given as either a str or a compiled Pointer,
+ * against a mutable document.
+ */
+static yyjson_mut_val *mut_doc_ptr_get(
+    yyjson_mut_doc *doc, PyObject *pointer, yyjson_ptr_ctx *ctx,
+    yyjson_ptr_err *err
+) {
+  if (Pointer_Check(pointer)) {
+    return pointer_mut_get(
+        (PointerObject *)pointer, yyjson_mut_doc_get_root(doc), ctx, err
+    );
+  }
+
+  Py_ssize_t pointer_len;
+  const char *str = PyUnicode_AsUTF8AndSize(pointer, &pointer_len);
+  if (!str) {
+    return NULL;
+  }
+
+  return yyjson_mut_doc_ptr_getx(doc, str, pointer_len, ctx, err);
+}
+
 static void Document_dealloc(DocumentObject *self) {
   if (self->i_doc != NULL) yyjson_doc_free(self->i_doc);
   if (self->m_doc != NULL) yyjson_mut_doc_free(self->m_doc);
   Py_XDECREF(self->default_func);
+  Py_XDECREF(self->shared);
   Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -416,11 +718,79 @@ static PyObject *Document_new(
     self->m_doc = NULL;
     self->i_doc = NULL;
     self->alc = &PyMem_Allocator;
+    self->busy = 0;
+  }
+
+  return (PyObject *)self;
+}
+
+PyObject *document_from_doc(yyjson_doc *doc) {
+  DocumentObject *self =
+      (DocumentObject *)Document_new(&DocumentType, NULL, NULL);
+  if (!self) {
+    yyjson_doc_free(doc);
+    return NULL;
   }
 
+  self->i_doc = doc;
   return (PyObject *)self;
 }
 
+/**
+ * Parse only the parts of buf selected by the pointers in select, skipping
+ * everything else without building it.
+ */
+static int document_read_select(
+    DocumentObject *self, const char *buf, size_t len, yyjson_read_flag r_flag,
+    PyObject *select
+) {
+  PointerTrie trie;
+  Scanner sc;
+  yyjson_mut_val *root = NULL;
+
+  if (pointer_trie_build(&trie, select) < 0) {
+    return -1;
+  }
+
+  yyjson_mut_doc *m_doc = yyjson_mut_doc_new(self->alc);
+  if (!m_doc) {
+    pointer_trie_free(&trie);
+    PyErr_NoMemory();
+    return -1;
+  }
+
+  scanner_init(&sc, buf, len, r_flag);
+  bool ok = scan_ws(&sc) && scan_select(&sc, &trie, 0, m_doc, &root) &&
+            scan_ws(&sc);
+  if (ok && sc.cur != sc.end && !(r_flag & YYJSON_READ_STOP_WHEN_DONE)) {
+    ok = scan_fail(&sc, "unexpected content after document");
+  }
+  if (ok && sc.cur == sc.start) {
+    ok = scan_fail(&sc, "input data is empty");
+  }
+  pointer_trie_free(&trie);
+
+  if (!ok) {
+    yyjson_mut_doc_free(m_doc);
+    PyErr_Format(
+        PyExc_ValueError, "%s at position %zu", sc.err, sc.err_pos
+    );
+    return -1;
+  }
+
+  // Nothing below a scalar root can be selected, which leaves it null.
+  yyjson_mut_doc_set_root(m_doc, root ? root : yyjson_mut_null(m_doc));
+
+  self->i_doc = yyjson_mut_doc_imut_copy(m_doc, self->alc);
+  yyjson_mut_doc_free(m_doc);
+  if (!self->i_doc) {
+    PyErr_NoMemory();
+    return -1;
+  }
+
+  return 0;
+}
+
 PyDoc_STRVAR(
     Document_init_doc,
     "A single JSON document.\n"
@@ -447,6 +817,25 @@ PyDoc_STRVAR(
     "   ...     \"a\": 1\n"
     "   ... }''', flags=ReaderFlags.ALLOW_COMMENTS)\n"
     "\n"
+    "If only a few values are needed from a large document, pass the JSON\n"
+    "pointers to them as ``select``. Everything else is skipped over without\n"
+    "being parsed, so the time and memory needed scales with what was\n"
+    "selected. The result keeps the structure leading to each selected\n"
+    "value, with unselected array elements before a selected one replaced by\n"
+    "``null`` so indexes still match. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "   >>> doc = Document('{\"id\": 1, \"rows\": [1, 2, 3], \"name\": \"x\"}',\n"
+    "   ...                select=['/id', '/rows/1'])\n"
+    "   >>> doc.as_obj\n"
+    "   {'id': 1, 'rows': [None, 2]}\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "   Skipped values are only checked for matching brackets and quotes,\n"
+    "   so some invalid JSON in them may go unnoticed.\n"
+    "\n"
     ".. note::\n"
     "\n"
     "   yyjson has distinct APIs and data structures for mutable and "
@@ -461,21 +850,32 @@ PyDoc_STRVAR(
     ":param default: A function called to convert objects that are not\n"
     "                JSON serializable. Should return a JSON serializable version\n"
     "                of the object or raise a TypeError.\n"
-    ":type default: callable, optional"
+    ":type default: callable, optional\n"
+    ":param select: JSON pointers (RFC 6901) to the only values to parse,\n"
+    "               when parsing JSON. Objects and arrays on the way to a\n"
+    "               missing value are kept, empty if nothing else in\n"
+    "               them was selected.\n"
+    ":type select: list of ``str`` or :class:`Pointer`, optional"
 );
 static int Document_init(DocumentObject *self, PyObject *args, PyObject *kwds) {
-  static char *kwlist[] = {"content", "flags", "default", NULL};
+  static char *kwlist[] = {"content", "flags", "default", "select", NULL};
   PyObject *content;
   PyObject *default_func = NULL;
+  PyObject *select = NULL;
   yyjson_read_err err;
   yyjson_read_flag r_flag = 0;
 
   if (!PyArg_ParseTupleAndKeywords(
-          args, kwds, "O|$IO", kwlist, &content, &r_flag, &default_func
+          args, kwds, "O|$IOO", kwlist, &content, &r_flag, &default_func,
+          &select
       )) {
     return -1;
   }
 
+  if (select == Py_None) {
+    select = NULL;
+  }
+
   if (default_func && default_func != Py_None && !PyCallable_Check(default_func)) {
     PyErr_SetString(PyExc_TypeError, "default must be callable");
     return -1;
@@ -501,6 +901,12 @@ static int Document_init(DocumentObject *self, PyObject *args, PyObject *kwds) {
 
     PyBytes_AsStringAndSize(content, (char **)&content_as_utf8, &content_len);
 
+    if (select) {
+      return document_read_select(
+          self, content_as_utf8, content_len, r_flag, select
+      );
+    }
+
     self->i_doc = yyjson_read_opts(
         // As long as we don't expose the insitu reader flag, it's safe to
         // discard the const here.
@@ -519,6 +925,15 @@ static int Document_init(DocumentObject *self, PyObject *args, PyObject *kwds) {
     const char *content_as_utf8 = NULL;
 
     content_as_utf8 = PyUnicode_AsUTF8AndSize(content, &content_len);
+    if (!content_as_utf8) {
+      return -1;
+    }
+
+    if (select) {
+      return document_read_select(
+          self, content_as_utf8, content_len, r_flag, select
+      );
+    }
 
     self->i_doc = yyjson_read_opts(
         // As long as we don't expose the insitu reader flag, it's safe to
@@ -534,6 +949,19 @@ static int Document_init(DocumentObject *self, PyObject *args, PyObject *kwds) {
     return 0;
   } else if (yyjson_unlikely(PyObject_IsInstance(content, path))) {
     // We were given a Path object to a location on disk.
+    if (select) {
+      PyObject *data = PyObject_CallMethod(content, "read_bytes", NULL);
+      char *data_buf;
+      Py_ssize_t data_len;
+      if (!data || PyBytes_AsStringAndSize(data, &data_buf, &data_len) < 0) {
+        Py_XDECREF(data);
+        return -1;
+      }
+      int r = document_read_select(self, data_buf, data_len, r_flag, select);
+      Py_DECREF(data);
+      return r;
+    }
+
     PyObject *as_str = PyObject_Str(content);
     if (!as_str) {
       return -1;
@@ -558,6 +986,13 @@ static int Document_init(DocumentObject *self, PyObject *args, PyObject *kwds) {
 
     return 0;
   } else {
+    if (select) {
+      PyErr_SetString(
+          PyExc_TypeError, "select can only be used when parsing JSON."
+      );
+      return -1;
+    }
+
     self->m_doc = yyjson_mut_doc_new(self->alc);
 
     if (!self->m_doc) {
@@ -590,6 +1025,70 @@ static PyObject *Document_as_obj(DocumentObject *self, void *closure) {
   }
 }
 
+PyDoc_STRVAR(
+    Document_to_obj_doc,
+    "Convert the Document into Python objects like :attr:`as_obj`, with the\n"
+    "same hooks as :func:`json.loads` to customize how numbers and objects\n"
+    "are converted.\n"
+    "\n"
+    "Hooks are called with the text of each number. That's the original\n"
+    "text if the Document was read with :attr:`ReaderFlags.NUMBERS_AS_RAW`\n"
+    "(which :func:`yyjson.loads` does when given a hook), otherwise the\n"
+    "shortest text that reads back as the same number. Raw numbers without\n"
+    "a hook become an ``int`` or ``float``, rather than a ``Decimal``. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> from decimal import Decimal\n"
+    "    >>> doc = Document('[1, 1.10]', flags=ReaderFlags.NUMBERS_AS_RAW)\n"
+    "    >>> doc.to_obj(parse_float=Decimal)\n"
+    "    [1, Decimal('1.10')]\n"
+    "\n"
+    ":param parse_float: Called with the text of every real number.\n"
+    ":param parse_int: Called with the text of every integer.\n"
+    ":param parse_constant: Called with ``'NaN'``, ``'Infinity'`` or\n"
+    "                       ``'-Infinity'``, when read with\n"
+    "                       :attr:`ReaderFlags.ALLOW_INF_AND_NAN`.\n"
+    ":param object_hook: Called with the ``dict`` of every object, returning\n"
+    "                    the value to use in its place.\n"
+    ":param object_pairs_hook: Called with a ``list`` of the ``(key, value)``\n"
+    "                          pairs of every object, in document order,\n"
+    "                          instead of building a ``dict``. Takes\n"
+    "                          priority over ``object_hook``.\n"
+);
+static PyObject *Document_to_obj(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {
+      "parse_float", "parse_int", "parse_constant", "object_hook",
+      "object_pairs_hook", NULL};
+  ConvertHooks hooks = {NULL, NULL, NULL, NULL, NULL};
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "|$OOOOO", kwlist, &hooks.parse_float, &hooks.parse_int,
+          &hooks.parse_constant, &hooks.object_hook, &hooks.object_pairs_hook
+      )) {
+    return NULL;
+  }
+
+  if (hooks.parse_float == Py_None) hooks.parse_float = NULL;
+  if (hooks.parse_int == Py_None) hooks.parse_int = NULL;
+  if (hooks.parse_constant == Py_None) hooks.parse_constant = NULL;
+  if (hooks.object_hook == Py_None) hooks.object_hook = NULL;
+  if (hooks.object_pairs_hook == Py_None) hooks.object_pairs_hook = NULL;
+
+  // The hooks are called part way through walking the document.
+  PyObject *result;
+  document_pin(self);
+  if (self->i_doc) {
+    result = element_to_obj(yyjson_doc_get_root(self->i_doc), &hooks);
+  } else {
+    result = mut_element_to_obj(yyjson_mut_doc_get_root(self->m_doc), &hooks);
+  }
+  document_unpin(self);
+  return result;
+}
+
 /**
  * Is the document mutable?
  */
@@ -597,6 +1096,34 @@ static PyObject *Document_is_thawed(DocumentObject *self, void *closure) {
   return PyBool_FromLong(self->m_doc != NULL);
 }
 
+/**
+ * Serialize a value with the RFC 8785 canonical writer. Other than
+ * WRITE_NEWLINE_AT_END, the rest of the write flags are ignored since the
+ * canonical form doesn't allow for any variation.
+ */
+static PyObject *document_dumps_canonical(
+    void *val, bool mut, yyjson_write_flag w_flag
+) {
+  const char *err;
+  size_t w_len;
+  char *result = canonical_write(
+      val, mut, w_flag & YYJSON_WRITE_NEWLINE_AT_END, &w_len, &err
+  );
+
+  if (yyjson_unlikely(!result)) {
+    if (err) {
+      PyErr_SetString(PyExc_ValueError, err);
+    } else if (!PyErr_Occurred()) {
+      PyErr_NoMemory();
+    }
+    return NULL;
+  }
+
+  PyObject *obj_result = PyUnicode_FromStringAndSize(result, w_len);
+  PyMem_Free(result);
+  return obj_result;
+}
+
 PyDoc_STRVAR(
     Document_dumps_doc,
     "Dumps the document to a string and returns it.\n"
@@ -629,12 +1156,21 @@ PyDoc_STRVAR(
     "    >>> print(doc.dumps(at_pointer='/results/rows'))\n"
     "    [55,66,77]\n"
     "\n"
+    "Passing :attr:`WriterFlags.CANONICAL` writes canonical JSON following\n"
+    "RFC 8785, suitable for signing or hashing. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'b': 1e21, 'a': [1.50, 'é']})\n"
+    "    >>> print(doc.dumps(flags=WriterFlags.CANONICAL))\n"
+    "    {\"a\":[1.5,\"é\"],\"b\":1e+21}\n"
+    "\n"
     ":param flags: Flags that control JSON writing behaviour.\n"
     ":type flags: :class:`yyjson.WriterFlags`, optional\n"
     ":param at_pointer: An optional JSON pointer specifying what part of the\n"
     "                   document should be dumped. If not specified, defaults\n"
     "                   to the entire ``Document``.\n"
-    ":type at_pointer: str, optional\n"
+    ":type at_pointer: ``str`` or :class:`Pointer`, optional\n"
     ":returns: The serialized ``Document``.\n"
     ":rtype: ``str``"
 );
@@ -643,11 +1179,10 @@ static PyObject *Document_dumps(
 ) {
   static char *kwlist[] = {"flags", "at_pointer", NULL};
   yyjson_write_flag w_flag = 0;
-  const char *pointer = NULL;
-  Py_ssize_t pointer_size;
+  PyObject *pointer = NULL;
 
   if (!PyArg_ParseTupleAndKeywords(
-          args, kwds, "|$Is#", kwlist, &w_flag, &pointer, &pointer_size
+          args, kwds, "|$IO&", kwlist, &w_flag, pointer_converter, &pointer
       )) {
     return NULL;
   }
@@ -661,12 +1196,19 @@ static PyObject *Document_dumps(
     yyjson_val *val_to_serialize = NULL;
 
     if (pointer) {
-      val_to_serialize =
-          yyjson_doc_ptr_getn(self->i_doc, pointer, pointer_size);
+      val_to_serialize = doc_ptr_get(self->i_doc, pointer, NULL);
     } else {
       val_to_serialize = yyjson_doc_get_root(self->i_doc);
     }
 
+    if (yyjson_unlikely(PyErr_Occurred())) {
+      return NULL;
+    }
+
+    if (w_flag & WRITE_CANONICAL) {
+      return document_dumps_canonical(val_to_serialize, false, w_flag);
+    }
+
     result = yyjson_val_write_opts(
         val_to_serialize, w_flag, self->alc, &w_len, &w_err
     );
@@ -675,11 +1217,19 @@ static PyObject *Document_dumps(
 
     if (pointer) {
       mut_val_to_serialize =
-          yyjson_mut_doc_ptr_getn(self->m_doc, pointer, pointer_size);
+          mut_doc_ptr_get(self->m_doc, pointer, NULL, NULL);
     } else {
       mut_val_to_serialize = yyjson_mut_doc_get_root(self->m_doc);
     }
 
+    if (yyjson_unlikely(PyErr_Occurred())) {
+      return NULL;
+    }
+
+    if (w_flag & WRITE_CANONICAL) {
+      return document_dumps_canonical(mut_val_to_serialize, true, w_flag);
+    }
+
     result = yyjson_mut_val_write_opts(
         mut_val_to_serialize, w_flag, self->alc, &w_len, &w_err
     );
@@ -701,283 +1251,1886 @@ PyDoc_STRVAR(
     "Returns the JSON element at the given JSON pointer (RFC 6901).\n"
     "\n"
     ":param pointer: JSON Pointer to search for.\n"
-    ":type pointer: ``str``"
+    ":type pointer: ``str`` or :class:`Pointer`"
 );
 static PyObject *Document_get_pointer(DocumentObject *self, PyObject *args) {
-  char *pointer = NULL;
-  Py_ssize_t pointer_len;
+  PyObject *pointer = NULL;
+  yyjson_ptr_err err;
 
-  if (!PyArg_ParseTuple(args, "s#", &pointer, &pointer_len)) {
+  if (!PyArg_ParseTuple(args, "O&", pointer_converter, &pointer)) {
+    return NULL;
+  }
+
+  if (!pointer) {
+    PyErr_SetString(PyExc_TypeError, "JSON pointer must be a str or Pointer");
+    return NULL;
+  }
+
+  if (self->i_doc) {
+    yyjson_val *result = doc_ptr_get(self->i_doc, pointer, &err);
+
+    if (!result) {
+      if (!PyErr_Occurred()) {
+        PyErr_SetString(
+            PyExc_ValueError, err.msg ? err.msg : "Not a valid JSON Pointer"
+        );
+      }
+      return NULL;
+    }
+
+    return element_to_primitive(result);
+  } else {
+    yyjson_mut_val *result = mut_doc_ptr_get(self->m_doc, pointer, NULL, &err);
+
+    if (!result) {
+      if (!PyErr_Occurred()) {
+        PyErr_SetString(
+            PyExc_ValueError, err.msg ? err.msg : "Not a valid JSON Pointer"
+        );
+      }
+      return NULL;
+    }
+
+    return mut_element_to_primitive(result);
+  }
+}
+
+PyDoc_STRVAR(
+    Document_get_array_doc,
+    "Returns the array of numbers at the given JSON pointer (RFC 6901) as\n"
+    "an :class:`array.array`, packed without creating a Python object for\n"
+    "each element.\n"
+    "\n"
+    "This is much faster and smaller than :meth:`get_pointer` for large\n"
+    "arrays of numbers, such as coordinates or samples, and the result\n"
+    "supports the buffer protocol for use with ``numpy.frombuffer()``. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document('{\"samples\": [1, 2.5, -3]}')\n"
+    "    >>> doc.get_array('/samples')\n"
+    "    array('d', [1.0, 2.5, -3.0])\n"
+    "    >>> doc.get_array('/samples', typecode='q')\n"
+    "    Traceback (most recent call last):\n"
+    "    ...\n"
+    "    TypeError: expected an integer at index 1\n"
+    "\n"
+    ":param pointer: JSON Pointer to the array.\n"
+    ":type pointer: ``str`` or :class:`Pointer`\n"
+    ":param typecode: The :mod:`array` typecode to pack into. Integer\n"
+    "                 typecodes only accept integers that fit, and floating\n"
+    "                 point typecodes accept any number.\n"
+    ":type typecode: ``str``, optional\n"
+    ":raises TypeError: If the value isn't an array, or an element isn't a\n"
+    "                   number the typecode accepts.\n"
+    ":raises OverflowError: If an integer doesn't fit the typecode.\n"
+);
+static PyObject *Document_get_array(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", "typecode", NULL};
+  PyObject *pointer = NULL;
+  int typecode = 'd';
+  yyjson_ptr_err err;
+  void *arr;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O&|$C", kwlist, pointer_converter, &pointer, &typecode
+      )) {
+    return NULL;
+  }
+
+  if (!pointer) {
+    PyErr_SetString(PyExc_TypeError, "JSON pointer must be a str or Pointer");
+    return NULL;
+  }
+
+  if (self->i_doc) {
+    arr = doc_ptr_get(self->i_doc, pointer, &err);
+  } else {
+    arr = mut_doc_ptr_get(self->m_doc, pointer, NULL, &err);
+  }
+
+  if (!arr) {
+    if (!PyErr_Occurred()) {
+      PyErr_SetString(
+          PyExc_ValueError, err.msg ? err.msg : "Not a valid JSON Pointer"
+      );
+    }
+    return NULL;
+  }
+
+  return numarray_pack(arr, self->m_doc != NULL, typecode);
+}
+
+PyDoc_STRVAR(
+    Document_to_arrow_doc,
+    "Convert the array at the given JSON pointer (RFC 6901) into an Arrow\n"
+    "array, without creating Python objects for its elements.\n"
+    "\n"
+    "The result implements the Arrow PyCapsule interface\n"
+    "(``__arrow_c_array__``), so it can be passed to ``pyarrow.array()``,\n"
+    "``polars``, ``duckdb`` and other Arrow consumers without this library\n"
+    "depending on any of them. An array of objects becomes an array of\n"
+    "structs, which ``pyarrow.RecordBatch.from_struct_array()`` turns into\n"
+    "a table.\n"
+    "\n"
+    "Without a schema, the type is inferred from the values: ``bool``,\n"
+    "``int64``, ``double`` (for any real, or integers mixed with reals),\n"
+    "``string``, ``list`` and ``struct``, with every field nullable and\n"
+    "fields in the order they're first seen. Values of different JSON\n"
+    "types in the same place can't be inferred and raise a ``TypeError``.\n"
+    "\n"
+    ":param pointer: JSON Pointer to the array, the root by default.\n"
+    ":type pointer: ``str`` or :class:`Pointer`, optional\n"
+    ":param schema: The type of the array's items, as any object\n"
+    "               implementing ``__arrow_c_schema__``, such as a\n"
+    "               ``pyarrow.DataType`` or ``pyarrow.Schema``. Missing\n"
+    "               object members become nulls, and members not in the\n"
+    "               schema are ignored. Fields the schema marks as not\n"
+    "               nullable stay that way, and raise on nulls.\n"
+    ":raises TypeError: If the value isn't an array, or a value doesn't\n"
+    "                   match the type.\n"
+    ":raises BufferError: If ``__arrow_c_schema__`` freezes or thaws the\n"
+    "                     Document.\n"
+);
+static PyObject *Document_to_arrow(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", "schema", NULL};
+  PyObject *pointer = NULL;
+  PyObject *schema = NULL;
+  yyjson_ptr_err err = {0};
+  void *arr;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "|O&O", kwlist, pointer_converter, &pointer, &schema
+      )) {
+    return NULL;
+  }
+
+  if (!pointer) {
+    arr = self->i_doc ? (void *)yyjson_doc_get_root(self->i_doc)
+                      : (void *)yyjson_mut_doc_get_root(self->m_doc);
+  } else if (self->i_doc) {
+    arr = doc_ptr_get(self->i_doc, pointer, &err);
+  } else {
+    arr = mut_doc_ptr_get(self->m_doc, pointer, NULL, &err);
+  }
+
+  if (!arr) {
+    if (!PyErr_Occurred()) {
+      PyErr_SetString(
+          PyExc_ValueError, err.msg ? err.msg : "Not a valid JSON Pointer"
+      );
+    }
+    return NULL;
+  }
+
+  // __arrow_c_schema__ may run any Python, which mustn't free arr.
+  document_pin(self);
+  PyObject *result = arrow_export(arr, self->m_doc != NULL, schema);
+  document_unpin(self);
+  return result;
+}
+
+/**
+ * Walk a PointerTrie over an immutable value, converting every value that is
+ * the target of a pointer into results.
+ */
+static int get_many_walk(
+    PointerTrie *trie, Py_ssize_t node, yyjson_val *val, PyObject **results
+) {
+  for (Py_ssize_t t = trie->nodes[node].target; t != -1;
+       t = trie->next_target[t]) {
+    results[t] = element_to_primitive(val);
+    if (!results[t]) return -1;
+  }
+
+  for (Py_ssize_t c = trie->nodes[node].child; c != -1;
+       c = trie->nodes[c].sibling) {
+    yyjson_val *child = pointer_token_get(trie->nodes[c].token, val);
+    if (child && get_many_walk(trie, c, child, results) < 0) return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * Walk a PointerTrie over a mutable value, converting every value that is
+ * the target of a pointer into results.
+ */
+static int mut_get_many_walk(
+    PointerTrie *trie, Py_ssize_t node, yyjson_mut_val *val, PyObject **results
+) {
+  for (Py_ssize_t t = trie->nodes[node].target; t != -1;
+       t = trie->next_target[t]) {
+    results[t] = mut_element_to_primitive(val);
+    if (!results[t]) return -1;
+  }
+
+  for (Py_ssize_t c = trie->nodes[node].child; c != -1;
+       c = trie->nodes[c].sibling) {
+    yyjson_mut_val *child = pointer_token_mut_get(trie->nodes[c].token, val);
+    if (child && mut_get_many_walk(trie, c, child, results) < 0) return -1;
+  }
+
+  return 0;
+}
+
+PyDoc_STRVAR(
+    Document_get_many_doc,
+    "Returns the JSON elements at each of the given JSON pointers (RFC 6901)\n"
+    "in a single call.\n"
+    "\n"
+    "The pointers are merged into a prefix tree, so shared prefixes are only\n"
+    "walked once. Given a ``dict`` mapping names to pointers, a ``dict``\n"
+    "with the same keys is returned, otherwise a ``tuple`` in the same order\n"
+    "as ``pointers``. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'user': {'id': 1, 'name': 'Harry'}})\n"
+    "    >>> doc.get_many(['/user/id', '/user/name'])\n"
+    "    (1, 'Harry')\n"
+    "    >>> doc.get_many({'name': '/user/name', 'age': '/user/age'}, default=None)\n"
+    "    {'name': 'Harry', 'age': None}\n"
+    "\n"
+    ":param pointers: The JSON pointers to search for.\n"
+    ":type pointers: iterable or ``dict`` of ``str`` or :class:`Pointer`\n"
+    ":param default: Returned for pointers that cannot be resolved. If not\n"
+    "                given, a ``ValueError`` is raised instead.\n"
+    ":returns: The value at each pointer.\n"
+    ":rtype: ``tuple`` or ``dict``"
+);
+static PyObject *Document_get_many(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointers", "default", NULL};
+  PyObject *pointers = NULL;
+  PyObject *default_value = NULL;
+  PyObject *keys = NULL;
+  PyObject *results = NULL;
+  PyObject *result = NULL;
+  PointerTrie trie;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O|$O", kwlist, &pointers, &default_value
+      )) {
+    return NULL;
+  }
+
+  if (PyDict_Check(pointers)) {
+    keys = PyDict_Keys(pointers);
+    PyObject *values = PyDict_Values(pointers);
+    if (!keys || !values) {
+      Py_XDECREF(keys);
+      Py_XDECREF(values);
+      return NULL;
+    }
+    int r = pointer_trie_build(&trie, values);
+    Py_DECREF(values);
+    if (r < 0) {
+      Py_DECREF(keys);
+      return NULL;
+    }
+  } else if (pointer_trie_build(&trie, pointers) < 0) {
+    return NULL;
+  }
+
+  results = PyTuple_New(trie.num_pointers);
+  if (!results) {
+    goto done;
+  }
+
+  PyObject **items = &PyTuple_GET_ITEM(results, 0);
+  int r;
+
+  if (self->i_doc) {
+    r = get_many_walk(&trie, 0, yyjson_doc_get_root(self->i_doc), items);
+  } else {
+    r = mut_get_many_walk(&trie, 0, yyjson_mut_doc_get_root(self->m_doc), items);
+  }
+
+  if (r < 0) {
+    goto done;
+  }
+
+  for (Py_ssize_t i = 0; i < trie.num_pointers; i++) {
+    if (items[i]) continue;
+
+    if (!default_value) {
+      PyErr_Format(
+          PyExc_ValueError, "JSON pointer cannot be resolved: %R",
+          trie.pointers[i]->source
+      );
+      goto done;
+    }
+
+    Py_INCREF(default_value);
+    items[i] = default_value;
+  }
+
+  if (keys) {
+    result = PyDict_New();
+    if (!result) {
+      goto done;
+    }
+
+    for (Py_ssize_t i = 0; i < trie.num_pointers; i++) {
+      if (PyDict_SetItem(result, PyList_GET_ITEM(keys, i), items[i]) < 0) {
+        Py_CLEAR(result);
+        goto done;
+      }
+    }
+  } else {
+    Py_INCREF(results);
+    result = results;
+  }
+
+done:
+  pointer_trie_free(&trie);
+  Py_XDECREF(results);
+  Py_XDECREF(keys);
+  return result;
+}
+
+/**
+ * Copy a single value (from either kind of document) into a new, mutable
+ * Document of its own.
+ */
+static PyObject *document_from_node(void *val, bool mut) {
+  DocumentObject *obj = (DocumentObject *)PyObject_CallFunction(
+      (PyObject *)&DocumentType, "(O)", Py_None
+  );
+  if (!obj) {
+    return NULL;
+  }
+
+  yyjson_mut_val *copy = mut ? yyjson_mut_val_mut_copy(obj->m_doc, val)
+                             : yyjson_val_mut_copy(obj->m_doc, val);
+  if (!copy) {
+    Py_DECREF(obj);
+    return PyErr_NoMemory();
+  }
+
+  yyjson_mut_doc_set_root(obj->m_doc, copy);
+  return (PyObject *)obj;
+}
+
+PyDoc_STRVAR(
+    Document_query_doc,
+    "Returns every JSON element selected by the given JSONPath query\n"
+    "(RFC 9535), in document order.\n"
+    "\n"
+    "Queries given as a ``str`` are compiled on each call, so compile a\n"
+    ":class:`JSONPath` once when running the same query repeatedly. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'users': [\n"
+    "    ...     {'name': 'Harry', 'age': 17},\n"
+    "    ...     {'name': 'Albus', 'age': 115},\n"
+    "    ... ]})\n"
+    "    >>> doc.query('$.users[?@.age > 100].name')\n"
+    "    ['Albus']\n"
+    "    >>> doc.query('$..name')\n"
+    "    ['Harry', 'Albus']\n"
+    "\n"
+    ":param path: The JSONPath query to evaluate.\n"
+    ":type path: ``str`` or :class:`JSONPath`\n"
+    ":param as_documents: If ``True``, each match is copied into a new\n"
+    "                     :class:`Document` instead of being converted into\n"
+    "                     a Python object.\n"
+    ":type as_documents: ``bool``\n"
+    ":returns: The selected elements.\n"
+    ":rtype: ``list``"
+);
+static PyObject *Document_query(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"path", "as_documents", NULL};
+  PyObject *path = NULL;
+  int as_documents = false;
+  JSONPathObject *query;
+  JPNodeList nodes = {0};
+  PyObject *result = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O|$p", kwlist, &path, &as_documents
+      )) {
+    return NULL;
+  }
+
+  if (JSONPath_Check(path)) {
+    Py_INCREF(path);
+    query = (JSONPathObject *)path;
+  } else if (PyUnicode_Check(path)) {
+    query = jsonpath_compile(path);
+    if (!query) {
+      return NULL;
+    }
+  } else {
+    PyErr_SetString(PyExc_TypeError, "JSONPath must be a str or JSONPath");
+    return NULL;
+  }
+
+  bool mut = self->i_doc == NULL;
+  void *root = mut ? (void *)yyjson_mut_doc_get_root(self->m_doc)
+                   : (void *)yyjson_doc_get_root(self->i_doc);
+
+  if (jsonpath_eval(query, root, mut, &nodes) < 0) {
+    goto done;
+  }
+
+  result = PyList_New(nodes.len);
+  if (!result) {
+    goto done;
+  }
+
+  for (Py_ssize_t i = 0; i < nodes.len; i++) {
+    PyObject *item;
+
+    if (as_documents) {
+      item = document_from_node(nodes.items[i], mut);
+    } else if (mut) {
+      item = mut_element_to_primitive(nodes.items[i]);
+    } else {
+      item = element_to_primitive(nodes.items[i]);
+    }
+
+    if (!item) {
+      Py_CLEAR(result);
+      goto done;
+    }
+
+    PyList_SET_ITEM(result, i, item);
+  }
+
+done:
+  jsonpath_nodelist_free(&nodes);
+  Py_DECREF(query);
+  return result;
+}
+
+/**
+ * Split a JSON pointer, given as either a str or a compiled Pointer, into
+ * the value it should be applied to and the escaped remainder, for use with
+ * the yyjson_mut_ptr_*x() functions. A compiled pointer has its parent
+ * resolved up front, so only its last token is parsed again. If *base is
+ * left NULL, the pointer must be applied to the document itself.
+ */
+static bool mut_doc_ptr_split(
+    yyjson_mut_doc *doc, PyObject *pointer, yyjson_mut_val **base,
+    const char **ptr, size_t *len
+) {
+  *base = NULL;
+
+  if (!pointer) {
+    PyErr_SetString(PyExc_TypeError, "JSON pointer must be a str or Pointer");
+    return false;
+  }
+
+  if (!Pointer_Check(pointer)) {
+    Py_ssize_t pointer_len;
+    *ptr = PyUnicode_AsUTF8AndSize(pointer, &pointer_len);
+    *len = (size_t)pointer_len;
+    return *ptr != NULL;
+  }
+
+  PointerObject *compiled = (PointerObject *)pointer;
+  *ptr = compiled->buffer;
+  *len = compiled->raw_len;
+
+  if (compiled->num_tokens < 2) {
+    return true;
+  }
+
+  // Missing parents are left to yyjson, which may need to create them.
+  yyjson_mut_val *parent =
+      pointer_mut_get_parent(compiled, yyjson_mut_doc_get_root(doc));
+  if (parent) {
+    PointerToken *last = &compiled->tokens[compiled->num_tokens - 1];
+    *base = parent;
+    *ptr = last->raw;
+    *len = last->raw_len;
+  }
+
+  return true;
+}
+
+/**
+ * Check that putting a value at ptr, relative to base or the root if base
+ * is NULL, will succeed, before the value is converted. Converted values
+ * can't be freed from the document's pool, so failing afterwards would
+ * leak them until the Document is freed. Mirrors the rules of
+ * yyjson_mut_ptr_setx() and, if insert_new is true, yyjson_mut_ptr_addx().
+ */
+static bool mut_doc_ptr_check_put(
+    yyjson_mut_doc *doc, yyjson_mut_val *base, const char *ptr, size_t len,
+    bool create_parents, bool insert_new, yyjson_ptr_err *err
+) {
+  yyjson_mut_val *val = base ? base : yyjson_mut_doc_get_root(doc);
+  yyjson_ptr_ctx ctx;
+
+  memset(err, 0, sizeof(*err));
+
+  if (len == 0) {
+    if (!insert_new) return true;
+    err->code = YYJSON_PTR_ERR_SET_ROOT;
+    err->msg = "cannot set document's root";
+    return false;
+  }
+
+  // Resolve one more token each time, until the first that's missing.
+  size_t end = 0;
+  do {
+    size_t start = end;
+    end = start + 1;
+    while (end < len && ptr[end] != '/') end++;
+
+    if (yyjson_mut_ptr_getx(val, ptr, end, &ctx, err)) continue;
+    if (err->code != YYJSON_PTR_ERR_RESOLVE) return false;
+
+    // Missing members can be added to an object, but only appended to an
+    // array, and only when inserting.
+    if (!ctx.ctn || (yyjson_mut_is_arr(ctx.ctn) && !insert_new)) {
+      return false;
+    }
+    if (end < len && !create_parents) return false;
+
+    // The remaining tokens name parents that will be created, which only
+    // needs their escapes to be valid. yyjson reports a bad first token
+    // under an array as unresolved rather than a syntax error.
+    bool in_arr = yyjson_mut_is_arr(ctx.ctn);
+    for (size_t i = end; i < len; i++) {
+      if (i > end && ptr[i] == '/') in_arr = false;
+      if (ptr[i] == '~' && (i + 1 == len || (ptr[i + 1] != '0' &&
+                                             ptr[i + 1] != '1'))) {
+        err->code = in_arr ? YYJSON_PTR_ERR_RESOLVE : YYJSON_PTR_ERR_SYNTAX;
+        err->msg = in_arr ? "JSON pointer cannot be resolved"
+                          : "invalid escaped character";
+        err->pos = i;
+        return false;
+      }
+    }
+    memset(err, 0, sizeof(*err));
+    return true;
+  } while (end < len);
+
+  return true;
+}
+
+static PyObject *ptr_error(yyjson_ptr_err *err) {
+  PyErr_SetString(
+      PyExc_ValueError, err->msg ? err->msg : "Not a valid JSON Pointer"
+  );
+  return NULL;
+}
+
+PyDoc_STRVAR(
+    Document_set_doc,
+    "Sets the JSON element at the given JSON pointer (RFC 6901), replacing\n"
+    "it if it already exists.\n"
+    "\n"
+    "The document is modified in place and only ``value`` is converted, so\n"
+    "the cost depends on the length of the pointer rather than the size of\n"
+    "the document. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'user': {'name': 'Harry'}})\n"
+    "    >>> doc.set('/user/name', 'Ron')\n"
+    "    >>> doc.set('/user/pets/owl', 'Hedwig')\n"
+    "    >>> doc.as_obj\n"
+    "    {'user': {'name': 'Ron', 'pets': {'owl': 'Hedwig'}}}\n"
+    "\n"
+    ":param pointer: JSON Pointer to set.\n"
+    ":type pointer: ``str`` or :class:`Pointer`\n"
+    ":param value: The new value.\n"
+    ":param create_parents: Create any missing parent objects.\n"
+    ":type create_parents: ``bool``"
+);
+static PyObject *Document_set(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", "value", "create_parents", NULL};
+  PyObject *pointer = NULL;
+  PyObject *value = NULL;
+  int create_parents = true;
+  yyjson_mut_val *base;
+  const char *ptr;
+  size_t len;
+  yyjson_ptr_err err;
+  bool ok;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O&O|$p", kwlist, pointer_converter, &pointer, &value,
+          &create_parents
+      )) {
+    return NULL;
+  }
+
+  ENSURE_MUTABLE(self);
+
+  if (!mut_doc_ptr_split(self->m_doc, pointer, &base, &ptr, &len)) {
+    return NULL;
+  }
+  if (!mut_doc_ptr_check_put(
+          self->m_doc, base, ptr, len, create_parents, false, &err
+      )) {
+    return ptr_error(&err);
+  }
+
+  // default can be called while value is converted.
+  document_pin(self);
+  yyjson_mut_val *val = mut_primitive_to_element(self, self->m_doc, value);
+  document_unpin(self);
+  if (!val) {
+    return NULL;
+  }
+
+  if (base) {
+    ok = yyjson_mut_ptr_setx(
+        base, ptr, len, val, self->m_doc, create_parents, NULL, &err
+    );
+  } else {
+    ok = yyjson_mut_doc_ptr_setx(
+        self->m_doc, ptr, len, val, create_parents, NULL, &err
+    );
+  }
+
+  if (!ok) {
+    return ptr_error(&err);
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Document_add_doc,
+    "Adds a JSON element at the given JSON pointer (RFC 6901), following\n"
+    "the rules of the JSON Patch (RFC 6902) ``add`` operation.\n"
+    "\n"
+    "Values added to an array are inserted before the given index, and\n"
+    "``-`` appends to the end of the array. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'tags': ['a', 'c']})\n"
+    "    >>> doc.add('/tags/1', 'b')\n"
+    "    >>> doc.add('/tags/-', 'd')\n"
+    "    >>> doc.as_obj\n"
+    "    {'tags': ['a', 'b', 'c', 'd']}\n"
+    "\n"
+    ":param pointer: JSON Pointer to add to.\n"
+    ":type pointer: ``str`` or :class:`Pointer`\n"
+    ":param value: The new value.\n"
+    ":param create_parents: Create any missing parent objects.\n"
+    ":type create_parents: ``bool``"
+);
+static PyObject *Document_add(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", "value", "create_parents", NULL};
+  PyObject *pointer = NULL;
+  PyObject *value = NULL;
+  int create_parents = true;
+  yyjson_mut_val *base;
+  const char *ptr;
+  size_t len;
+  yyjson_ptr_err err;
+  bool ok;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O&O|$p", kwlist, pointer_converter, &pointer, &value,
+          &create_parents
+      )) {
+    return NULL;
+  }
+
+  ENSURE_MUTABLE(self);
+
+  if (!mut_doc_ptr_split(self->m_doc, pointer, &base, &ptr, &len)) {
+    return NULL;
+  }
+  if (!mut_doc_ptr_check_put(
+          self->m_doc, base, ptr, len, create_parents, true, &err
+      )) {
+    return ptr_error(&err);
+  }
+
+  // default can be called while value is converted.
+  document_pin(self);
+  yyjson_mut_val *val = mut_primitive_to_element(self, self->m_doc, value);
+  document_unpin(self);
+  if (!val) {
+    return NULL;
+  }
+
+  if (base) {
+    ok = yyjson_mut_ptr_addx(
+        base, ptr, len, val, self->m_doc, create_parents, NULL, &err
+    );
+  } else {
+    ok = yyjson_mut_doc_ptr_addx(
+        self->m_doc, ptr, len, val, create_parents, NULL, &err
+    );
+  }
+
+  if (!ok) {
+    return ptr_error(&err);
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Document_replace_doc,
+    "Replaces the existing JSON element at the given JSON pointer\n"
+    "(RFC 6901).\n"
+    "\n"
+    "Unlike :meth:`set`, a ``ValueError`` is raised if there is nothing to\n"
+    "replace.\n"
+    "\n"
+    ":param pointer: JSON Pointer to replace.\n"
+    ":type pointer: ``str`` or :class:`Pointer`\n"
+    ":param value: The new value."
+);
+static PyObject *Document_replace(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", "value", NULL};
+  PyObject *pointer = NULL;
+  PyObject *value = NULL;
+  yyjson_mut_val *base;
+  const char *ptr;
+  size_t len;
+  yyjson_ptr_err err;
+  yyjson_mut_val *old;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O&O", kwlist, pointer_converter, &pointer, &value
+      )) {
+    return NULL;
+  }
+
+  ENSURE_MUTABLE(self);
+
+  if (!mut_doc_ptr_split(self->m_doc, pointer, &base, &ptr, &len)) {
+    return NULL;
+  }
+  // Check there's something to replace first, as converted values can't be
+  // freed if it fails.
+  if (!yyjson_mut_ptr_getx(
+          base ? base : yyjson_mut_doc_get_root(self->m_doc), ptr, len, NULL,
+          &err
+      )) {
+    return ptr_error(&err);
+  }
+
+  // default can be called while value is converted.
+  document_pin(self);
+  yyjson_mut_val *val = mut_primitive_to_element(self, self->m_doc, value);
+  document_unpin(self);
+  if (!val) {
+    return NULL;
+  }
+
+  if (base) {
+    old = yyjson_mut_ptr_replacex(base, ptr, len, val, NULL, &err);
+  } else {
+    old = yyjson_mut_doc_ptr_replacex(self->m_doc, ptr, len, val, NULL, &err);
+  }
+
+  if (!old) {
+    return ptr_error(&err);
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Document_remove_doc,
+    "Removes the JSON element at the given JSON pointer (RFC 6901).\n"
+    "\n"
+    "A ``ValueError`` is raised if there is nothing to remove. The root of\n"
+    "the document cannot be removed.\n"
+    "\n"
+    ":param pointer: JSON Pointer to remove.\n"
+    ":type pointer: ``str`` or :class:`Pointer`"
+);
+static PyObject *Document_remove(DocumentObject *self, PyObject *args) {
+  PyObject *pointer = NULL;
+  yyjson_mut_val *base;
+  const char *ptr;
+  size_t len;
+  yyjson_ptr_err err;
+  yyjson_mut_val *old;
+
+  if (!PyArg_ParseTuple(args, "O&", pointer_converter, &pointer)) {
+    return NULL;
+  }
+
+  ENSURE_MUTABLE(self);
+
+  if (!mut_doc_ptr_split(self->m_doc, pointer, &base, &ptr, &len)) {
+    return NULL;
+  }
+
+  if (len == 0) {
+    PyErr_SetString(PyExc_ValueError, "cannot remove document's root");
+    return NULL;
+  }
+
+  if (base) {
+    old = yyjson_mut_ptr_removex(base, ptr, len, NULL, &err);
+  } else {
+    old = yyjson_mut_doc_ptr_removex(self->m_doc, ptr, len, NULL, &err);
+  }
+
+  if (!old) {
+    return ptr_error(&err);
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Document_extend_doc,
+    "Appends every value in ``values`` to the JSON array at the given JSON\n"
+    "pointer (RFC 6901).\n"
+    "\n"
+    "If any value cannot be converted, the array is left unchanged. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'tags': ['a']})\n"
+    "    >>> doc.extend('/tags', ['b', 'c'])\n"
+    "    >>> doc.as_obj\n"
+    "    {'tags': ['a', 'b', 'c']}\n"
+    "\n"
+    ":param pointer: JSON Pointer to an array.\n"
+    ":type pointer: ``str`` or :class:`Pointer`\n"
+    ":param values: The values to append.\n"
+    ":type values: iterable"
+);
+static PyObject *Document_extend(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", "values", NULL};
+  PyObject *pointer = NULL;
+  PyObject *values = NULL;
+  yyjson_ptr_err err;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O&O", kwlist, pointer_converter, &pointer, &values
+      )) {
+    return NULL;
+  }
+
+  if (!pointer) {
+    PyErr_SetString(PyExc_TypeError, "JSON pointer must be a str or Pointer");
+    return NULL;
+  }
+
+  // Iterating can run arbitrary code, so do it before holding on to any
+  // values.
+  PyObject *seq = PySequence_Fast(values, "values must be iterable");
+  if (!seq) {
+    return NULL;
+  }
+
+  if (self->i_doc && document_check_idle(self) < 0) {
+    Py_DECREF(seq);
+    return NULL;
+  }
+  ENSURE_MUTABLE(self);
+
+  yyjson_mut_val *arr = mut_doc_ptr_get(self->m_doc, pointer, NULL, &err);
+  if (!arr) {
+    Py_DECREF(seq);
+    return PyErr_Occurred() ? NULL : ptr_error(&err);
+  }
+
+  if (!yyjson_mut_is_arr(arr)) {
+    Py_DECREF(seq);
+    PyErr_SetString(PyExc_ValueError, "JSON pointer does not refer to an array");
+    return NULL;
+  }
+
+  // Convert everything into a detached array first, so a failure part way
+  // through doesn't leave the document half-extended. default can be
+  // called while converting.
+  yyjson_mut_val *pending = yyjson_mut_arr(self->m_doc);
+  Py_ssize_t num_items = PySequence_Fast_GET_SIZE(seq);
+  bool ok = pending != NULL;
+
+  document_pin(self);
+  for (Py_ssize_t i = 0; ok && i < num_items; i++) {
+    yyjson_mut_val *val = mut_primitive_to_element(
+        self, self->m_doc, PySequence_Fast_GET_ITEM(seq, i)
+    );
+    ok = val && yyjson_mut_arr_append(pending, val);
+  }
+  document_unpin(self);
+
+  Py_DECREF(seq);
+  if (!ok) {
+    return PyErr_Occurred() ? NULL : PyErr_NoMemory();
+  }
+
+  yyjson_mut_val *val;
+  while ((val = yyjson_mut_arr_remove_first(pending))) {
+    yyjson_mut_arr_append(arr, val);
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Document_freeze_doc,
+    "Freezes the document, copying it into yyjson's read-only internal "
+    "object.\n"
+    "\n"
+    "This object can be used as a normal ``Document`` object, but uses less\n"
+    "memory after creation, and offers slightly improved performance.\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    If a ``Document`` method that requires mutation is called on a "
+    "frozen\n"
+    "    ``Document``, such as :func:`patch()`, it will be automatically "
+    "thawed.\n"
+    "    This is an advanced function and can usually be ignored.\n"
+);
+static PyObject *Document_freeze(DocumentObject *self) {
+  if (self->m_doc) {
+    if (document_check_idle(self) < 0) return NULL;
+    self->i_doc = yyjson_mut_doc_imut_copy(self->m_doc, self->alc);
+    yyjson_mut_doc_free(self->m_doc);
+    self->m_doc = NULL;
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Document_thaw_doc,
+    "Thaws the document, copying it into yyjson's mutable internal object.\n"
+    "\n"
+    "This object can be used as a normal ``Document`` object, but will use\n"
+    "slightly more memory after creation, and offers slightly worse\n"
+    "performance.\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    This is an advanced function and can usually be ignored.\n"
+);
+static PyObject *Document_thaw(DocumentObject *self) {
+  if (self->i_doc) {
+    if (document_check_idle(self) < 0) return NULL;
+    self->m_doc = yyjson_doc_mut_copy(self->i_doc, self->alc);
+    yyjson_doc_free(self->i_doc);
+    self->i_doc = NULL;
+  }
+
+  Py_RETURN_NONE;
+}
+
+/**
+ * Apply patch, or patch_val if it isn't a compiled Patch, as
+ * document_patch() does.
+ */
+static PyObject *document_patch_apply(
+    DocumentObject *self, PyObject *patch, void *patch_val, bool patch_mut,
+    PyObject *pointer, bool use_merge_patch, bool inplace
+) {
+  yyjson_ptr_err ptr_err;
+  DocumentObject *result;
+  PatchTarget target = {0};
+  bool compiled = Patch_Check(patch);
+
+  if (inplace) {
+    ENSURE_MUTABLE(self);
+    Py_INCREF(self);
+    result = self;
+
+    // If a pointer was provided, that's the value we're going to be
+    // patching, otherwise we use the root of the document.
+    if (pointer != NULL) {
+      target.val = mut_doc_ptr_get(self->m_doc, pointer, &target.ctx, &ptr_err);
+    } else {
+      target.val = yyjson_mut_doc_get_root(self->m_doc);
+    }
+  } else {
+    // Create a new, essentially empty Document which will serve as the
+    // container for the patch result, and copy what we're patching into it.
+    result = (DocumentObject *)PyObject_CallFunction(
+        (PyObject *)&DocumentType, "(O)", Py_None
+    );
+    if (!result) {
+      return NULL;
+    }
+
+    if (self->i_doc) {
+      yyjson_val *original = pointer != NULL
+                                 ? doc_ptr_get(self->i_doc, pointer, &ptr_err)
+                                 : yyjson_doc_get_root(self->i_doc);
+      if (original) {
+        target.val = yyjson_val_mut_copy(result->m_doc, original);
+      }
+    } else {
+      yyjson_mut_val *original =
+          pointer != NULL
+              ? mut_doc_ptr_get(self->m_doc, pointer, NULL, &ptr_err)
+              : yyjson_mut_doc_get_root(self->m_doc);
+      if (original) {
+        target.val = yyjson_mut_val_mut_copy(result->m_doc, original);
+      }
+    }
+
+    if (target.val) {
+      yyjson_mut_doc_set_root(result->m_doc, target.val);
+    }
+  }
+
+  if (!target.val) {
+    if (!PyErr_Occurred()) {
+      if (pointer != NULL) {
+        PyErr_SetString(
+            PyExc_ValueError,
+            ptr_err.msg ? ptr_err.msg : "Not a valid JSON Pointer"
+        );
+      } else {
+        PyErr_SetString(PyExc_ValueError, "Document has no root.");
+      }
+    }
+    Py_DECREF(result);
+    return NULL;
+  }
+
+  if (use_merge_patch) {
+    if (!merge_patch_apply(result->m_doc, &target, patch_val, patch_mut)) {
+      PyErr_SetString(PyExc_ValueError, "Unable to apply patch to document.");
+      Py_DECREF(result);
+      return NULL;
+    }
+  } else {
+    yyjson_patch_err patch_err;
+    bool ok = compiled ? patch_program_apply(
+                             (PatchObject *)patch, result->m_doc, &target,
+                             &patch_err
+                         )
+                       : patch_apply(
+                             result->m_doc, &target, patch_val, patch_mut,
+                             &patch_err
+                         );
+
+    if (!ok) {
+      PyErr_SetString(
+          PyExc_ValueError,
+          patch_err.msg ? patch_err.msg : "Unable to apply patch to document."
+      );
+      Py_DECREF(result);
+      return NULL;
+    }
+  }
+
+  return (PyObject *)result;
+}
+
+PyObject *document_patch(
+    DocumentObject *self, PyObject *patch, PyObject *pointer,
+    bool use_merge_patch, bool inplace
+) {
+  bool compiled = Patch_Check(patch);
+  bool patch_mut = false;
+  void *patch_val = NULL;
+  yyjson_mut_doc *patch_copy = NULL;
+
+  if (compiled) {
+    if (use_merge_patch) {
+      PyErr_SetString(
+          PyExc_ValueError, "A compiled Patch cannot be used as a merge-patch."
+      );
+      return NULL;
+    }
+  } else if (!PyObject_IsInstance(patch, (PyObject *)&DocumentType)) {
+    PyErr_SetString(PyExc_TypeError, "Patch must be a Document or Patch.");
+    return NULL;
+  } else {
+    // The patch is read in whichever form it's already in, it's never
+    // frozen or thawed.
+    DocumentObject *patch_doc = (DocumentObject *)patch;
+    patch_mut = patch_doc->m_doc != NULL;
+    patch_val = patch_mut ? (void *)yyjson_mut_doc_get_root(patch_doc->m_doc)
+                          : (void *)yyjson_doc_get_root(patch_doc->i_doc);
+    if (!patch_val) {
+      PyErr_SetString(PyExc_ValueError, "Patch document has no root value.");
+      return NULL;
+    }
+
+    // Patching a Document in place with itself would thaw or change the
+    // patch while it's being applied, so apply a copy of it instead.
+    if (inplace && patch_doc == self) {
+      patch_copy = patch_mut ? yyjson_mut_doc_mut_copy(self->m_doc, self->alc)
+                             : yyjson_doc_mut_copy(self->i_doc, self->alc);
+      if (!patch_copy) return PyErr_NoMemory();
+      patch_val = yyjson_mut_doc_get_root(patch_copy);
+      patch_mut = true;
+    }
+  }
+
+  PyObject *result = document_patch_apply(
+      self, patch, patch_val, patch_mut, pointer, use_merge_patch, inplace
+  );
+  if (patch_copy) yyjson_mut_doc_free(patch_copy);
+  return result;
+}
+
+PyDoc_STRVAR(
+    Document_patch_doc,
+    "Patch a ``Document`` with another ``Document``, using either JSON Patch "
+    "(RFC 6902)\n"
+    "or JSON Merge-Patch (RFC 7386).\n"
+    "\n"
+    "By default, this will apply a JSON Patch. Specify "
+    "``use_merge_patch=True`` to\n"
+    "use JSON Merge-Patch instead.\n"
+    "\n"
+    "By default the result is a new ``Document``, and this one is left\n"
+    "unchanged. Specify ``inplace=True`` to modify this ``Document``\n"
+    "directly, which avoids copying it. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document({'a': 1})\n"
+    "    >>> doc.patch(Document({'b': 2}), use_merge_patch=True).as_obj\n"
+    "    {'a': 1, 'b': 2}\n"
+    "    >>> doc.patch(Document([{'op': 'add', 'path': '/c', 'value': 3}]),\n"
+    "    ...           inplace=True).as_obj\n"
+    "    {'a': 1, 'c': 3}\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    When patching in place, operations are applied one at a time. If\n"
+    "    one fails, the ones before it will have already been applied.\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    Patching in place will automatically thaw a frozen ``Document``.\n"
+    "    The patch ``Document`` is never modified.\n"
+    "\n"
+    ":param patch: The ``Document`` or compiled :class:`Patch` to patch with.\n"
+    ":type patch: ``Document`` or :class:`Patch`\n"
+    ":param at_pointer: The (optional) JSON Pointer (RFC 6901) to patch at,\n"
+    "                   instead of patching the entire document.\n"
+    ":type at_pointer: ``str`` or :class:`Pointer`\n"
+    ":param use_merge_patch: Whether to use JSON Merge-Patch (RFC 7386) "
+    "instead of\n"
+    "    JSON Patch (RFC 6902).\n"
+    ":param inplace: Whether to modify this ``Document`` instead of "
+    "returning a\n"
+    "    new one.\n"
+    ":returns: The patched ``Document``.\n"
+);
+static PyObject *Document_patch(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {
+      "patch", "at_pointer", "use_merge_patch", "inplace", NULL};
+
+  PyObject *pointer = NULL;
+  PyObject *patch = NULL;
+  int use_merge_patch = false;
+  int inplace = false;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds,
+          /* We can switch the "i" for "p" to be explicit with our bool
+           * flag, but only after we drop support for everything < 3.3. */
+          "O|$O&ii", kwlist, &patch, pointer_converter, &pointer,
+          &use_merge_patch, &inplace
+      )) {
+    return NULL;
+  }
+
+  return document_patch(self, patch, pointer, use_merge_patch, inplace);
+}
+
+/**
+ * Get the root of a document in whichever form it's currently in, setting
+ * mut to whether it's a yyjson_mut_val.
+ */
+static void *document_root(DocumentObject *self, bool *mut) {
+  *mut = self->m_doc != NULL;
+  if (*mut) return yyjson_mut_doc_get_root(self->m_doc);
+  return yyjson_doc_get_root(self->i_doc);
+}
+
+PyDoc_STRVAR(
+    Document_diff_doc,
+    "Generate the JSON Patch (RFC 6902) that turns this ``Document`` into\n"
+    "``other``.\n"
+    "\n"
+    "Identical values are skipped entirely, objects are compared key by\n"
+    "key, and arrays are aligned on their longest common subsequence so\n"
+    "that inserting or removing an element doesn't rewrite the rest of the\n"
+    "array. Neither ``Document`` is modified. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> old = Document({'a': 1, 'tags': ['x', 'z']})\n"
+    "    >>> new = Document({'a': 1, 'tags': ['x', 'y', 'z'], 'b': 2})\n"
+    "    >>> old.diff(new).as_obj\n"
+    "    [{'op': 'add', 'path': '/tags/1', 'value': 'y'}, "
+    "{'op': 'add', 'path': '/b', 'value': 2}]\n"
+    "    >>> old.patch(old.diff(new)).as_obj == new.as_obj\n"
+    "    True\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    Very large changed regions of arrays are compared position by\n"
+    "    position instead, which is still correct but may not be minimal.\n"
+    "\n"
+    ":param other: The ``Document`` to diff against.\n"
+    ":type other: ``Document``\n"
+    ":returns: A new ``Document`` containing the JSON Patch.\n"
+);
+static PyObject *Document_diff(DocumentObject *self, PyObject *args) {
+  DocumentObject *other;
+  bool src_mut, dst_mut;
+
+  if (!PyArg_ParseTuple(args, "O!", &DocumentType, &other)) {
+    return NULL;
+  }
+
+  void *src = document_root(self, &src_mut);
+  void *dst = document_root(other, &dst_mut);
+  if (!src || !dst) {
+    PyErr_SetString(PyExc_ValueError, "Document has no root.");
+    return NULL;
+  }
+
+  DocumentObject *result = (DocumentObject *)PyObject_CallFunction(
+      (PyObject *)&DocumentType, "(O)", Py_None
+  );
+  if (!result) {
+    return NULL;
+  }
+
+  yyjson_mut_val *ops = patch_diff(result->m_doc, src, src_mut, dst, dst_mut);
+  if (!ops) {
+    Py_DECREF(result);
+    return PyErr_NoMemory();
+  }
+
+  yyjson_mut_doc_set_root(result->m_doc, ops);
+  return (PyObject *)result;
+}
+
+PyDoc_STRVAR(
+    Document_merge_diff_doc,
+    "Generate the JSON Merge-Patch (RFC 7386) that turns this ``Document``\n"
+    "into ``other``.\n"
+    "\n"
+    "Identical values are left out of the patch, members missing from\n"
+    "``other`` are set to ``null``, and anything that isn't an object on\n"
+    "both sides is replaced as a whole. Neither ``Document`` is modified. "
+    "Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> old = Document({'a': 1, 'b': {'c': 2, 'd': 3}})\n"
+    "    >>> new = Document({'b': {'c': 2, 'd': 4}, 'e': [5]})\n"
+    "    >>> old.merge_diff(new).as_obj\n"
+    "    {'a': None, 'b': {'d': 4}, 'e': [5]}\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    Merge patches use ``null`` to remove members, so ``other`` can't\n"
+    "    have ``null`` object members where they differ from this\n"
+    "    ``Document``. A ``ValueError`` is raised if it does.\n"
+    "\n"
+    ":param other: The ``Document`` to diff against.\n"
+    ":type other: ``Document``\n"
+    ":returns: A new ``Document`` containing the JSON Merge-Patch.\n"
+);
+static PyObject *Document_merge_diff(DocumentObject *self, PyObject *args) {
+  DocumentObject *other;
+  bool src_mut, dst_mut;
+  const char *err;
+
+  if (!PyArg_ParseTuple(args, "O!", &DocumentType, &other)) {
+    return NULL;
+  }
+
+  void *src = document_root(self, &src_mut);
+  void *dst = document_root(other, &dst_mut);
+  if (!src || !dst) {
+    PyErr_SetString(PyExc_ValueError, "Document has no root.");
+    return NULL;
+  }
+
+  DocumentObject *result = (DocumentObject *)PyObject_CallFunction(
+      (PyObject *)&DocumentType, "(O)", Py_None
+  );
+  if (!result) {
+    return NULL;
+  }
+
+  yyjson_mut_val *patch =
+      merge_patch_diff(result->m_doc, src, src_mut, dst, dst_mut, &err);
+  if (!patch) {
+    Py_DECREF(result);
+    if (err) {
+      PyErr_SetString(PyExc_ValueError, err);
+      return NULL;
+    }
+    return PyErr_NoMemory();
+  }
+
+  yyjson_mut_doc_set_root(result->m_doc, patch);
+  return (PyObject *)result;
+}
+
+/** Seeds for the two independent halves of a 128-bit content hash. */
+#define CONTENT_HASH_SEED_LO 0ULL
+#define CONTENT_HASH_SEED_HI 0x9e3779b97f4a7c15ULL
+
+static uint64_t document_hash(DocumentObject *self, uint64_t seed) {
+  bool mut;
+  void *root = document_root(self, &mut);
+  if (!root) return 0;
+  return val_hash(root, mut, seed);
+}
+
+PyDoc_STRVAR(
+    Document_content_hash_doc,
+    "Returns a stable hash of the content of this ``Document``.\n"
+    "\n"
+    "The order of object members is ignored, and numbers are hashed by\n"
+    "value so ``1`` and ``1.0`` hash the same, even when read with\n"
+    "``NUMBERS_AS_RAW`` or as ``Decimal``. Two ``Document``'s that\n"
+    "compare equal always have the same content hash, and the hash is the\n"
+    "same across processes and platforms, so it's suitable for\n"
+    "deduplication and content-addressed caches. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> a = Document('{\"a\": 1, \"b\": [1, 2]}')\n"
+    "    >>> b = Document({'b': [1.0, 2], 'a': 1})\n"
+    "    >>> a == b\n"
+    "    True\n"
+    "    >>> a.content_hash() == b.content_hash()\n"
+    "    True\n"
+    "\n"
+    ":param bits: The size of the hash, either 64 or 128.\n"
+    ":type bits: ``int``\n"
+    ":returns: The hash, as a non-negative ``int``.\n"
+);
+static PyObject *Document_content_hash(
+    DocumentObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"bits", NULL};
+  int bits = 64;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$i", kwlist, &bits)) {
+    return NULL;
+  }
+
+  if (bits != 64 && bits != 128) {
+    PyErr_SetString(PyExc_ValueError, "bits must be 64 or 128.");
+    return NULL;
+  }
+
+  PyObject *lo = PyLong_FromUnsignedLongLong(
+      document_hash(self, CONTENT_HASH_SEED_LO)
+  );
+  if (bits == 64 || !lo) {
+    return lo;
+  }
+
+  PyObject *hi = PyLong_FromUnsignedLongLong(
+      document_hash(self, CONTENT_HASH_SEED_HI)
+  );
+  PyObject *shift = PyLong_FromLong(64);
+  PyObject *shifted = hi && shift ? PyNumber_Lshift(hi, shift) : NULL;
+  PyObject *result = shifted ? PyNumber_Or(shifted, lo) : NULL;
+
+  Py_XDECREF(lo);
+  Py_XDECREF(hi);
+  Py_XDECREF(shift);
+  Py_XDECREF(shifted);
+  return result;
+}
+
+PyDoc_STRVAR(
+    Document_decode_doc,
+    "Convert this ``Document`` following a plan compiled by\n"
+    ":func:`yyjson.decode`, which should be used instead.\n"
+);
+static PyObject *Document_decode(DocumentObject *self, PyObject *args) {
+  PyObject *plan;
+
+  if (!PyArg_ParseTuple(args, "O!", &PyTuple_Type, &plan)) {
     return NULL;
   }
 
-  yyjson_ptr_err err;
-
   if (self->i_doc) {
-    yyjson_val *result =
-        yyjson_doc_ptr_getx(self->i_doc, pointer, pointer_len, &err);
+    // Decoding calls constructors, which could thaw the document.
+    document_pin(self);
+    PyObject *result = decode_value(yyjson_doc_get_root(self->i_doc), plan);
+    document_unpin(self);
+    return result;
+  }
+
+  yyjson_doc *doc = yyjson_mut_doc_imut_copy(self->m_doc, self->alc);
+  if (!doc) return PyErr_NoMemory();
+
+  PyObject *result = decode_value(yyjson_doc_get_root(doc), plan);
+  yyjson_doc_free(doc);
+  return result;
+}
+
+/**
+ * Returns the frozen document, or a frozen copy of it if it's thawed which
+ * must be freed by the caller.
+ */
+static yyjson_doc *document_frozen(DocumentObject *self) {
+  if (self->i_doc) return self->i_doc;
+
+  if (!yyjson_mut_doc_get_root(self->m_doc)) {
+    PyErr_SetString(PyExc_ValueError, "Document has no root.");
+    return NULL;
+  }
+  yyjson_doc *doc = yyjson_mut_doc_imut_copy(self->m_doc, self->alc);
+  if (!doc) PyErr_NoMemory();
+  return doc;
+}
+
+/**
+ * Snapshot the document, freezing a copy of it first if it's thawed.
+ */
+static PyObject *document_snapshot(DocumentObject *self) {
+  yyjson_doc *doc = document_frozen(self);
+  if (!doc) return NULL;
+
+  PyObject *result =
+      PyBytes_FromStringAndSize(NULL, (Py_ssize_t)snapshot_size(doc));
+  if (result) {
+    snapshot_write(doc, PyBytes_AS_STRING(result), false);
+  }
+
+  if (doc != self->i_doc) yyjson_doc_free(doc);
+  return result;
+}
 
-    if (!result) {
-      PyErr_SetString(
-          PyExc_ValueError, err.msg ? err.msg : "Not a valid JSON Pointer"
-      );
-      return NULL;
+PyDoc_STRVAR(
+    Document_to_snapshot_doc,
+    "Returns a binary snapshot of this ``Document``, which\n"
+    ":meth:`from_snapshot` loads far faster than the JSON can be parsed.\n"
+    "\n"
+    "The snapshot is yyjson's own representation of the document, with\n"
+    "every pointer replaced by an offset, so loading it only has to copy\n"
+    "and check it. It's also what ``pickle`` uses, so a ``Document`` can be\n"
+    "sent to other processes without being serialized to JSON and parsed\n"
+    "again. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> doc = Document('{\"a\": [1, 2.5, \"b\"]}')\n"
+    "    >>> Document.from_snapshot(doc.to_snapshot()).as_obj\n"
+    "    {'a': [1, 2.5, 'b']}\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    Snapshots are meant for caches and for passing documents between\n"
+    "    processes, not for long-term storage. They can only be loaded by a\n"
+    "    machine with the same byte order, and by versions of this library\n"
+    "    using the same snapshot format.\n"
+    "\n"
+    ":returns: The snapshot, as ``bytes``.\n"
+);
+static PyObject *Document_to_snapshot(DocumentObject *self) {
+  return document_snapshot(self);
+}
+
+PyDoc_STRVAR(
+    Document_from_snapshot_doc,
+    "Load a ``Document`` from a snapshot taken by :meth:`to_snapshot`.\n"
+    "\n"
+    "The snapshot is checked before it's used, so a corrupt or truncated\n"
+    "snapshot raises a ``ValueError`` rather than producing an invalid\n"
+    "``Document``. The result is frozen.\n"
+    "\n"
+    ":param buf: The snapshot.\n"
+    ":type buf: A bytes-like object.\n"
+    ":raises ValueError: If the snapshot is invalid.\n"
+);
+static PyObject *Document_from_snapshot(PyTypeObject *type, PyObject *args) {
+  Py_buffer view;
+  const char *err;
+
+  if (!PyArg_ParseTuple(args, "y*", &view)) {
+    return NULL;
+  }
+
+  DocumentObject *self = (DocumentObject *)Document_new(type, NULL, NULL);
+  if (!self) {
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+
+  self->i_doc = snapshot_read(view.buf, (size_t)view.len, self->alc, &err);
+  PyBuffer_Release(&view);
+
+  if (!self->i_doc) {
+    Py_DECREF(self);
+    if (err) {
+      PyErr_SetString(PyExc_ValueError, err);
+    } else {
+      PyErr_NoMemory();
     }
+    return NULL;
+  }
+  return (PyObject *)self;
+}
 
-    return element_to_primitive(result);
-  } else {
-    yyjson_mut_val *result =
-        yyjson_mut_doc_ptr_getx(self->m_doc, pointer, pointer_len, NULL, &err);
+/**
+ * Serialize the document with one of the binary writers in transcode.h.
+ */
+static PyObject *document_transcode_write(
+    DocumentObject *self,
+    char *(*write)(void *, bool, size_t *, const char **)
+) {
+  bool mut;
+  size_t len;
+  const char *err;
 
-    if (!result) {
-      PyErr_SetString(
-          PyExc_ValueError, err.msg ? err.msg : "Not a valid JSON Pointer"
-      );
-      return NULL;
+  void *root = document_root(self, &mut);
+  if (!root) {
+    PyErr_SetString(PyExc_ValueError, "Document has no root.");
+    return NULL;
+  }
+
+  char *buf = write(root, mut, &len, &err);
+  if (!buf) {
+    if (err) {
+      PyErr_SetString(PyExc_ValueError, err);
+    } else {
+      PyErr_NoMemory();
     }
+    return NULL;
+  }
 
-    return mut_element_to_primitive(result);
+  PyObject *result = PyBytes_FromStringAndSize(buf, (Py_ssize_t)len);
+  PyMem_RawFree(buf);
+  return result;
+}
+
+/**
+ * Load a new document from the buffer in args with one of the binary
+ * readers in transcode.h.
+ */
+static PyObject *document_transcode_read(
+    PyTypeObject *type, PyObject *args,
+    yyjson_doc *(*read)(
+        const char *, size_t, const yyjson_alc *, const char **, size_t *
+    )
+) {
+  Py_buffer view;
+  const char *err;
+  size_t err_pos;
+
+  if (!PyArg_ParseTuple(args, "y*", &view)) {
+    return NULL;
+  }
+
+  DocumentObject *self = (DocumentObject *)Document_new(type, NULL, NULL);
+  if (!self) {
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+
+  if (view.len >= TRANSCODE_NOGIL_MIN) {
+    // Nothing else can see the new document yet, so it can be built
+    // without the GIL by an allocator that doesn't need it.
+    Py_BEGIN_ALLOW_THREADS
+    self->i_doc = read(
+        view.buf, (size_t)view.len, &PyMem_RawAllocator, &err, &err_pos
+    );
+    Py_END_ALLOW_THREADS
+  } else {
+    self->i_doc = read(view.buf, (size_t)view.len, self->alc, &err, &err_pos);
+  }
+  PyBuffer_Release(&view);
+
+  if (!self->i_doc) {
+    Py_DECREF(self);
+    if (err) {
+      PyErr_Format(PyExc_ValueError, "%s at position %zu", err, err_pos);
+    } else {
+      PyErr_NoMemory();
+    }
+    return NULL;
   }
+  return (PyObject *)self;
 }
 
 PyDoc_STRVAR(
-    Document_freeze_doc,
-    "Freezes the document, copying it into yyjson's read-only internal "
-    "object.\n"
+    Document_to_msgpack_doc,
+    "Serialize this ``Document`` as MessagePack, directly from its values\n"
+    "without creating any Python objects. Ex:\n"
     "\n"
-    "This object can be used as a normal ``Document`` object, but uses less\n"
-    "memory after creation, and offers slightly improved performance.\n"
+    ".. doctest::\n"
     "\n"
-    ".. note::\n"
+    "    >>> Document('[1, -1, \"a\"]').to_msgpack()\n"
+    "    b'\\x93\\x01\\xff\\xa1a'\n"
     "\n"
-    "    If a ``Document`` method that requires mutation is called on a "
-    "frozen\n"
-    "    ``Document``, such as :func:`patch()`, it will be automatically "
-    "thawed.\n"
-    "    This is an advanced function and can usually be ignored.\n"
+    "Integers use the smallest encoding that holds them, and reals are\n"
+    "always written as 64-bit floats. Numbers read with\n"
+    ":attr:`ReaderFlags.NUMBERS_AS_RAW` are written as the numbers they\n"
+    "would have been read as otherwise.\n"
+    "\n"
+    ":returns: The MessagePack, as ``bytes``.\n"
+    ":raises ValueError: If the ``Document`` has no root, or a string or\n"
+    "    container is too long for MessagePack.\n"
 );
-static PyObject *Document_freeze(DocumentObject *self) {
-  if (self->m_doc) {
-    self->i_doc = yyjson_mut_doc_imut_copy(self->m_doc, self->alc);
-    yyjson_mut_doc_free(self->m_doc);
-    self->m_doc = NULL;
-  }
+static PyObject *Document_to_msgpack(DocumentObject *self) {
+  return document_transcode_write(self, msgpack_write);
+}
 
-  Py_RETURN_NONE;
+PyDoc_STRVAR(
+    Document_from_msgpack_doc,
+    "Load a ``Document`` from a single MessagePack value, building the\n"
+    "document's values directly rather than going through Python objects.\n"
+    "The result is frozen. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> Document.from_msgpack(b'\\x81\\xa1a\\x92\\xc3\\xc0').as_obj\n"
+    "    {'a': [True, None]}\n"
+    "\n"
+    "Binary data, extension types and maps with keys that aren't strings\n"
+    "have no equivalent in JSON, and are rejected.\n"
+    "\n"
+    ":param buf: The MessagePack.\n"
+    ":type buf: A bytes-like object.\n"
+    ":raises ValueError: If ``buf`` isn't exactly one valid MessagePack\n"
+    "    value that can be represented as JSON.\n"
+);
+static PyObject *Document_from_msgpack(PyTypeObject *type, PyObject *args) {
+  return document_transcode_read(type, args, msgpack_read);
 }
 
 PyDoc_STRVAR(
-    Document_thaw_doc,
-    "Thaws the document, copying it into yyjson's mutable internal object.\n"
+    Document_to_cbor_doc,
+    "Serialize this ``Document`` as CBOR (RFC 8949), directly from its\n"
+    "values without creating any Python objects. Ex:\n"
     "\n"
-    "This object can be used as a normal ``Document`` object, but will use\n"
-    "slightly more memory after creation, and offers slightly worse\n"
-    "performance.\n"
+    ".. doctest::\n"
     "\n"
-    ".. note::\n"
+    "    >>> Document('{\"a\": [1, -1]}').to_cbor()\n"
+    "    b'\\xa1aa\\x82\\x01 '\n"
     "\n"
-    "    This is an advanced function and can usually be ignored.\n"
+    "Integers use the smallest encoding that holds them, and reals are\n"
+    "always written as 64-bit floats. Numbers read with\n"
+    ":attr:`ReaderFlags.NUMBERS_AS_DECIMAL` or\n"
+    ":attr:`ReaderFlags.BIG_NUMBERS_AS_DECIMAL` are written exactly, as\n"
+    "bignums and decimal fractions where they need to be.\n"
+    "\n"
+    ":returns: The CBOR, as ``bytes``.\n"
+    ":raises ValueError: If the ``Document`` has no root, or holds a\n"
+    "    number too large to write.\n"
 );
-static PyObject *Document_thaw(DocumentObject *self) {
-  if (self->i_doc) {
-    self->m_doc = yyjson_doc_mut_copy(self->i_doc, self->alc);
-    yyjson_doc_free(self->i_doc);
-    self->i_doc = NULL;
-  }
+static PyObject *Document_to_cbor(DocumentObject *self) {
+  return document_transcode_write(self, cbor_write);
+}
 
-  Py_RETURN_NONE;
+PyDoc_STRVAR(
+    Document_from_cbor_doc,
+    "Load a ``Document`` from a single CBOR (RFC 8949) data item, building\n"
+    "the document's values directly rather than going through Python\n"
+    "objects. The result is frozen. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> Document.from_cbor(b'\\xa1aa\\x82\\xf5\\xf6').as_obj\n"
+    "    {'a': [True, None]}\n"
+    "\n"
+    "Bignums (tags 2 and 3) too large for 64 bits and decimal fractions\n"
+    "(tag 4) are read as raw numbers, which become ``Decimal`` objects just\n"
+    "like big numbers read with :attr:`ReaderFlags.BIG_NUMBERS_AS_DECIMAL`.\n"
+    "Other tags are ignored, keeping only the value they tag, and\n"
+    "``undefined`` is read as ``null``. Byte strings, other simple values\n"
+    "and maps with keys that aren't strings have no equivalent in JSON, and\n"
+    "are rejected.\n"
+    "\n"
+    "Large inputs are read without holding the GIL.\n"
+    "\n"
+    ":param buf: The CBOR.\n"
+    ":type buf: A bytes-like object.\n"
+    ":raises ValueError: If ``buf`` isn't exactly one valid CBOR data item\n"
+    "    that can be represented as JSON.\n"
+);
+static PyObject *Document_from_cbor(PyTypeObject *type, PyObject *args) {
+  return document_transcode_read(type, args, cbor_read);
 }
 
 PyDoc_STRVAR(
-    Document_patch_doc,
-    "Patch a ``Document`` with another ``Document``, using either JSON Patch "
-    "(RFC 6902)\n"
-    "or JSON Merge-Patch (RFC 7386).\n"
+    Document_to_shared_doc,
+    "Copy this ``Document`` into a new shared memory segment, which\n"
+    ":meth:`attach_shared` can use from other processes without parsing it\n"
+    "or, in most cases, copying it.\n"
     "\n"
-    "By default, this will apply a JSON Patch. Specify "
-    "``use_merge_patch=True`` to\n"
-    "use JSON Merge-Patch instead.\n"
+    "The segment holds a snapshot (see :meth:`to_snapshot`) written for\n"
+    "the address it's mapped at. Processes that can map it at the same\n"
+    "address, which includes any forked from this one after this call and,\n"
+    "on POSIX systems, usually any other, use it directly and read-only,\n"
+    "so the memory is only needed once however many processes attach. Ex:\n"
     "\n"
-    ".. note::\n"
+    ".. doctest::\n"
     "\n"
-    "    This method will automatically thaw a frozen ``Document``.\n"
+    "    >>> shm = Document('{\"a\": [1, 2]}').to_shared()\n"
+    "    >>> Document.attach_shared(shm.name).get_pointer('/a/1')\n"
+    "    2\n"
+    "    >>> shm.close()\n"
+    "    >>> shm.unlink()\n"
     "\n"
-    ":param patch: The ``Document`` to patch with.\n"
-    ":type patch: ``Document``\n"
-    ":param at_pointer: The (optional) JSON Pointer (RFC 6901) to patch at,\n"
-    "                   instead of patching the entire document.\n"
-    ":type at_pointer: ``str``\n"
-    ":param use_merge_patch: Whether to use JSON Merge-Patch (RFC 7386) "
-    "instead of\n"
-    "    JSON Patch (RFC 6902).\n"
+    ".. note::\n"
     "\n"
+    "    The segment lives until it's unlinked, which is up to the caller,\n"
+    "    and must not be written to. ``close()`` raises a ``BufferError``\n"
+    "    while any ``Document`` in this process still uses the segment.\n"
+    "\n"
+    ":param name: The name of the segment, random by default.\n"
+    ":type name: ``str``, optional\n"
+    ":returns: The new ``multiprocessing.shared_memory.SharedMemory``.\n"
 );
-static PyObject *Document_patch(
+static PyObject *Document_to_shared(
     DocumentObject *self, PyObject *args, PyObject *kwds
 ) {
-  // Create a new, essentially empty Document which will serve as the
-  // container for the patch result.
-  DocumentObject *obj = (DocumentObject *)PyObject_CallFunction(
-      (PyObject *)&DocumentType, "(O)", Py_None
-  );
-  Py_INCREF(Py_None);
+  static char *kwlist[] = {"name", NULL};
+  PyObject *name = Py_None;
 
-  if (!obj) {
-    PyErr_SetString(
-        PyExc_ValueError,
-        "Unable to create container Document for results of merge-patch"
-    );
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &name)) {
     return NULL;
   }
 
-  static char *kwlist[] = {"patch", "at_pointer", "use_merge_patch", NULL};
+  yyjson_doc *doc = document_frozen(self);
+  if (!doc) return NULL;
 
-  const char *pointer = NULL;
-  Py_ssize_t pointer_size;
-  PyObject *patch = NULL;
-  int use_merge_patch = false;
+  PyObject *result = shared_create(doc, name);
+  if (doc != self->i_doc) yyjson_doc_free(doc);
+  return result;
+}
 
-  if (!PyArg_ParseTupleAndKeywords(
-          args, kwds,
-          /* We can switch the "i" for "p" to be explicit with our bool
-           * flag, but only after we drop support for everything < 3.3. */
-          "O|$z#i", kwlist, &patch, &pointer, &pointer_size, &use_merge_patch
-      )) {
+PyDoc_STRVAR(
+    Document_attach_shared_doc,
+    "Load a ``Document`` from a shared memory segment created by\n"
+    ":meth:`to_shared`, possibly in another process.\n"
+    "\n"
+    "The segment is used in place when this process can map it at the\n"
+    "address it was written for, and copied otherwise, which\n"
+    ":attr:`is_shared` tells apart. Either way the result is frozen, and\n"
+    "the segment is checked before it's used.\n"
+    "\n"
+    ":param name: The name of the segment.\n"
+    ":type name: ``str``\n"
+    ":raises FileNotFoundError: If there's no segment with that name.\n"
+    ":raises ValueError: If the segment doesn't hold a valid snapshot.\n"
+);
+static PyObject *Document_attach_shared(PyTypeObject *type, PyObject *args) {
+  PyObject *name;
+  PyObject *owner;
+
+  if (!PyArg_ParseTuple(args, "U", &name)) {
     return NULL;
   }
 
-  // If a pointer was provided, that's the value we're going to be patching,
-  // otherwise we use the root of the document.
-  if (self->i_doc) {
-    yyjson_val *original = NULL;
-
-    if (pointer != NULL) {
-      yyjson_ptr_err ptr_err;
-
-      original =
-          yyjson_doc_ptr_getx(self->i_doc, pointer, pointer_size, &ptr_err);
-      if (!original) {
-        PyErr_SetString(
-            PyExc_ValueError,
-            ptr_err.msg ? ptr_err.msg : "Not a valid JSON Pointer"
-        );
-        return NULL;
-      }
-    } else {
-      original = yyjson_doc_get_root(self->i_doc);
-      if (yyjson_unlikely(!original)) {
-        PyErr_SetString(PyExc_ValueError, "Document has no root.");
-        return NULL;
-      }
-    }
-
-    if (!PyObject_IsInstance(patch, (PyObject *)&DocumentType)) {
-      PyErr_SetString(PyExc_TypeError, "Patch must be a Document.");
-      return NULL;
-    }
-
-    DocumentObject *patch_doc = (DocumentObject *)patch;
-
-    // If the patch is a mutable document, we need to freeze it before we can
-    // use it with with the immutable merge_patch API.
-    if (patch_doc->m_doc) {
-      patch_doc->i_doc =
-          yyjson_mut_doc_imut_copy(patch_doc->m_doc, patch_doc->alc);
-      yyjson_mut_doc_free(patch_doc->m_doc);
-      patch_doc->m_doc = NULL;
-    }
-
-    yyjson_val *patch_val = yyjson_doc_get_root(patch_doc->i_doc);
-    if (!patch_val) {
-      PyErr_SetString(PyExc_ValueError, "Patch document has no root value.");
-      return NULL;
-    }
-
-    yyjson_mut_val *patched_val = NULL;
-
-    if (use_merge_patch) {
-      patched_val = yyjson_merge_patch(obj->m_doc, original, patch_val);
-    } else {
-      yyjson_patch_err patch_err;
-
-      patched_val = yyjson_patch(obj->m_doc, original, patch_val, &patch_err);
+  DocumentObject *self = (DocumentObject *)Document_new(type, NULL, NULL);
+  if (!self) return NULL;
 
-      if (!patched_val) {
-        PyErr_SetString(
-            PyExc_ValueError,
-            patch_err.msg ? patch_err.msg : "Unable to apply patch to document."
-        );
-        return NULL;
-      }
-    }
+  self->i_doc = shared_attach(name, self->alc, &owner);
+  if (!self->i_doc) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  self->shared = owner;
+  return (PyObject *)self;
+}
 
-    if (!patched_val) {
-      PyErr_SetString(PyExc_ValueError, "Unable to apply patch to document.");
-      return NULL;
-    }
+static PyObject *Document_is_shared(DocumentObject *self, void *closure) {
+  if (self->i_doc && self->shared) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+}
 
-    yyjson_mut_doc_set_root(obj->m_doc, patched_val);
-    return (PyObject *)obj;
-  } else {
-    yyjson_mut_val *original = NULL;
+static PyObject *Document_reduce(DocumentObject *self) {
+  PyObject *from_snapshot =
+      PyObject_GetAttrString((PyObject *)Py_TYPE(self), "from_snapshot");
+  if (!from_snapshot) return NULL;
 
-    if (pointer != NULL) {
-      yyjson_ptr_err ptr_err;
+  PyObject *snapshot = document_snapshot(self);
+  if (!snapshot) {
+    Py_DECREF(from_snapshot);
+    return NULL;
+  }
 
-      original = yyjson_mut_doc_ptr_getx(
-          self->m_doc, pointer, pointer_size, NULL, &ptr_err
-      );
-      if (!original) {
-        PyErr_SetString(
-            PyExc_ValueError,
-            ptr_err.msg ? ptr_err.msg : "Not a valid JSON Pointer"
-        );
-        return NULL;
-      }
-    } else {
-      original = yyjson_mut_doc_get_root(self->m_doc);
-      if (yyjson_unlikely(!original)) {
-        PyErr_SetString(PyExc_ValueError, "Document has no root.");
-        return NULL;
-      }
-    }
+  // Thawed documents are thawed again by __setstate__.
+  return Py_BuildValue(
+      "(N(N)O)", from_snapshot, snapshot, self->m_doc ? Py_True : Py_None
+  );
+}
 
-    DocumentObject *patch_doc = (DocumentObject *)patch;
-    ENSURE_MUTABLE(patch_doc);
+static PyObject *Document_setstate(DocumentObject *self, PyObject *state) {
+  int thawed = PyObject_IsTrue(state);
+  if (thawed < 0) return NULL;
 
-    yyjson_mut_val *patch_val = yyjson_mut_doc_get_root(patch_doc->m_doc);
-    if (!patch_val) {
-      PyErr_SetString(PyExc_ValueError, "Patch document has no root value.");
-      return NULL;
-    }
+  if (thawed && self->i_doc) {
+    ENSURE_MUTABLE(self);
+    if (!self->m_doc) return PyErr_NoMemory();
+  }
 
-    yyjson_mut_val *patched_val;
+  Py_RETURN_NONE;
+}
 
-    if (use_merge_patch) {
-      patched_val = yyjson_mut_merge_patch(obj->m_doc, original, patch_val);
-    } else {
-      yyjson_patch_err patch_err;
+static Py_hash_t Document_hash(DocumentObject *self) {
+  if (self->m_doc) {
+    PyErr_SetString(
+        PyExc_TypeError,
+        "unhashable type: 'Document' (thawed Documents are mutable, freeze() "
+        "it first)"
+    );
+    return -1;
+  }
 
-      patched_val =
-          yyjson_mut_patch(obj->m_doc, original, patch_val, &patch_err);
+  Py_hash_t hash = (Py_hash_t)document_hash(self, CONTENT_HASH_SEED_LO);
+  // -1 is reserved for errors.
+  return hash == -1 ? -2 : hash;
+}
 
-      if (!patched_val) {
-        PyErr_SetString(
-            PyExc_ValueError,
-            patch_err.msg ? patch_err.msg : "Unable to apply patch to document."
-        );
-        return NULL;
-      }
-    }
+static PyObject *Document_richcompare(
+    DocumentObject *self, PyObject *other, int op
+) {
+  if ((op != Py_EQ && op != Py_NE) ||
+      !PyObject_TypeCheck(other, &DocumentType)) {
+    Py_RETURN_NOTIMPLEMENTED;
+  }
 
-    if (!patched_val) {
-      PyErr_SetString(PyExc_ValueError, "Unable to apply patch to document.");
-      return NULL;
-    }
+  bool lhs_mut, rhs_mut;
+  void *lhs = document_root(self, &lhs_mut);
+  void *rhs = document_root((DocumentObject *)other, &rhs_mut);
+  bool equal = lhs && rhs ? val_equals(lhs, lhs_mut, rhs, rhs_mut)
+                          : lhs == rhs;
 
-    yyjson_mut_doc_set_root(obj->m_doc, patched_val);
-    return (PyObject *)obj;
+  if (equal == (op == Py_EQ)) {
+    Py_RETURN_TRUE;
   }
+  Py_RETURN_FALSE;
 }
 
 static Py_ssize_t Document_length(DocumentObject *self) {
@@ -991,14 +3144,62 @@ static Py_ssize_t Document_length(DocumentObject *self) {
 static PyMethodDef Document_methods[] = {
     {"patch", (PyCFunction)(void (*)(void))Document_patch,
      METH_VARARGS | METH_KEYWORDS, Document_patch_doc},
+    {"diff", (PyCFunction)(void (*)(void))Document_diff, METH_VARARGS,
+     Document_diff_doc},
+    {"merge_diff", (PyCFunction)(void (*)(void))Document_merge_diff,
+     METH_VARARGS, Document_merge_diff_doc},
+    {"content_hash", (PyCFunction)(void (*)(void))Document_content_hash,
+     METH_VARARGS | METH_KEYWORDS, Document_content_hash_doc},
+    {"_decode", (PyCFunction)(void (*)(void))Document_decode, METH_VARARGS,
+     Document_decode_doc},
     {"dumps", (PyCFunction)(void (*)(void))Document_dumps,
      METH_VARARGS | METH_KEYWORDS, Document_dumps_doc},
+    {"to_obj", (PyCFunction)(void (*)(void))Document_to_obj,
+     METH_VARARGS | METH_KEYWORDS, Document_to_obj_doc},
     {"get_pointer", (PyCFunction)(void (*)(void))Document_get_pointer,
      METH_VARARGS, Document_get_pointer_doc},
+    {"get_array", (PyCFunction)(void (*)(void))Document_get_array,
+     METH_VARARGS | METH_KEYWORDS, Document_get_array_doc},
+    {"to_arrow", (PyCFunction)(void (*)(void))Document_to_arrow,
+     METH_VARARGS | METH_KEYWORDS, Document_to_arrow_doc},
+    {"get_many", (PyCFunction)(void (*)(void))Document_get_many,
+     METH_VARARGS | METH_KEYWORDS, Document_get_many_doc},
+    {"query", (PyCFunction)(void (*)(void))Document_query,
+     METH_VARARGS | METH_KEYWORDS, Document_query_doc},
+    {"set", (PyCFunction)(void (*)(void))Document_set,
+     METH_VARARGS | METH_KEYWORDS, Document_set_doc},
+    {"add", (PyCFunction)(void (*)(void))Document_add,
+     METH_VARARGS | METH_KEYWORDS, Document_add_doc},
+    {"replace", (PyCFunction)(void (*)(void))Document_replace,
+     METH_VARARGS | METH_KEYWORDS, Document_replace_doc},
+    {"remove", (PyCFunction)(void (*)(void))Document_remove, METH_VARARGS,
+     Document_remove_doc},
+    {"extend", (PyCFunction)(void (*)(void))Document_extend,
+     METH_VARARGS | METH_KEYWORDS, Document_extend_doc},
     {"freeze", (PyCFunction)(void (*)(void))Document_freeze, METH_NOARGS,
      Document_freeze_doc},
     {"thaw", (PyCFunction)(void (*)(void))Document_thaw, METH_NOARGS,
      Document_thaw_doc},
+    {"to_snapshot", (PyCFunction)(void (*)(void))Document_to_snapshot,
+     METH_NOARGS, Document_to_snapshot_doc},
+    {"from_snapshot", (PyCFunction)(void (*)(void))Document_from_snapshot,
+     METH_VARARGS | METH_CLASS, Document_from_snapshot_doc},
+    {"to_msgpack", (PyCFunction)(void (*)(void))Document_to_msgpack,
+     METH_NOARGS, Document_to_msgpack_doc},
+    {"from_msgpack", (PyCFunction)(void (*)(void))Document_from_msgpack,
+     METH_VARARGS | METH_CLASS, Document_from_msgpack_doc},
+    {"to_cbor", (PyCFunction)(void (*)(void))Document_to_cbor, METH_NOARGS,
+     Document_to_cbor_doc},
+    {"from_cbor", (PyCFunction)(void (*)(void))Document_from_cbor,
+     METH_VARARGS | METH_CLASS, Document_from_cbor_doc},
+    {"to_shared", (PyCFunction)(void (*)(void))Document_to_shared,
+     METH_VARARGS | METH_KEYWORDS, Document_to_shared_doc},
+    {"attach_shared", (PyCFunction)(void (*)(void))Document_attach_shared,
+     METH_VARARGS | METH_CLASS, Document_attach_shared_doc},
+    {"__reduce__", (PyCFunction)(void (*)(void))Document_reduce, METH_NOARGS,
+     NULL},
+    {"__setstate__", (PyCFunction)(void (*)(void))Document_setstate, METH_O,
+     NULL},
     {NULL} /* Sentinel */
 };
 
@@ -1009,6 +3210,10 @@ static PyGetSetDef Document_members[] = {
      NULL},
     {"is_thawed", (getter)Document_is_thawed, NULL,
      "Returns whether the Document is thawed/mutable.", NULL},
+    {"is_shared", (getter)Document_is_shared, NULL,
+     "Returns whether the Document uses shared memory in place, rather "
+     "than its own copy.",
+     NULL},
     {NULL} /* Sentinel */
 };
 
@@ -1024,6 +3229,8 @@ PyTypeObject DocumentType = {
     .tp_new = Document_new,
     .tp_init = (initproc)Document_init,
     .tp_dealloc = (destructor)Document_dealloc,
+    .tp_hash = (hashfunc)Document_hash,
+    .tp_richcompare = (richcmpfunc)Document_richcompare,
     .tp_getset = Document_members,
     .tp_as_mapping = &Document_mapping_methods,
     .tp_methods = Document_methods};
@@ -3,6 +3,7 @@
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <stdbool.h>
 
 #include "yyjson.h"
 
@@ -19,8 +20,41 @@ typedef struct {
   yyjson_alc* alc;
   /** default callback for serializing unknown types. */
   PyObject* default_func;
+  /** Keeps the shared memory i_doc is in mapped, if it's used in place. */
+  PyObject* shared;
+  /**
+   * How many callers are holding pointers into the document while calling
+   * Python code. It can't be frozen or thawed until this is back to 0.
+   */
+  Py_ssize_t busy;
 } DocumentObject;
 
 extern PyTypeObject DocumentType;
 
+/**
+ * Wrap doc in a new Document that takes ownership of it. doc is freed on
+ * failure.
+ */
+PyObject* document_from_doc(yyjson_doc* doc);
+
+/**
+ * Convert the given UTF-8 string into a Python unicode object.
+ */
+PyObject* unicode_from_str(const char* src, size_t len);
+
+/**
+ * Recursively convert the given value into an equivalent high-level Python
+ * object.
+ */
+PyObject* element_to_primitive(yyjson_val* val);
+
+/**
+ * Patch a Document with a Document or a compiled Patch, as
+ * Document.patch() does. Returns a new reference to the patched Document.
+ */
+PyObject* document_patch(
+    DocumentObject* self, PyObject* patch, PyObject* pointer,
+    bool use_merge_patch, bool inplace
+);
+
 #endif
\ No newline at end of file
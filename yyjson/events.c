@@ -0,0 +1,944 @@
+#include "events.h"
+
+#include <string.h>
+
+#include "document.h"
+#include "memory.h"
+#include "value.h"
+
+/**
+ * The names of events, interned once.
+ */
+typedef enum {
+  EV_START_MAP,
+  EV_MAP_KEY,
+  EV_END_MAP,
+  EV_START_ARRAY,
+  EV_END_ARRAY,
+  EV_STRING,
+  EV_NUMBER,
+  EV_BOOLEAN,
+  EV_NULL,
+  EV_COUNT,
+} EventName;
+
+static const char *event_names[EV_COUNT] = {
+    "start_map",   "map_key", "end_map", "start_array", "end_array",
+    "string",      "number",  "boolean", "null",
+};
+static PyObject *event_strs[EV_COUNT] = {NULL};
+
+/**
+ * Make an event, stealing the reference to value.
+ */
+static PyObject *ev_event(EventName name, PyObject *value) {
+  if (!value) return NULL;
+  PyObject *event = PyTuple_Pack(2, event_strs[name], value);
+  Py_DECREF(value);
+  return event;
+}
+
+/**
+ * Make an event for a constant like None.
+ */
+static PyObject *ev_const(EventName name, PyObject *value) {
+  return PyTuple_Pack(2, event_strs[name], value);
+}
+
+/**
+ * Raise a ValueError for the scanner's error, with its position in the
+ * whole input.
+ */
+static int ev_error(EventIterObject *self) {
+  PyErr_Format(
+      PyExc_ValueError, "%s at position %zu",
+      self->sc.err ? self->sc.err : "invalid JSON",
+      self->consumed + self->sc.err_pos
+  );
+  return -1;
+}
+
+static int ev_fail(EventIterObject *self, const char *msg) {
+  scan_fail(&self->sc, msg);
+  return ev_error(self);
+}
+
+/**
+ * Read the next chunk from the source into the window, dropping the bytes
+ * before the scanner's position.
+ */
+static bool ev_refill(EventIterObject *self) {
+  Scanner *sc = &self->sc;
+  Py_buffer view;
+  const char *data;
+  Py_ssize_t data_len;
+
+  if (!self->read) {
+    self->eof = true;
+    return true;
+  }
+
+  // Read at least as much as is kept, so a token larger than a chunk is
+  // completed in a logarithmic number of reads rather than rescanned on
+  // every chunk.
+  Py_ssize_t want = self->chunk_size;
+  if ((size_t)want < (size_t)(sc->end - sc->cur)) {
+    want = (Py_ssize_t)(sc->end - sc->cur);
+  }
+
+  PyObject *chunk = PyObject_CallFunction(self->read, "n", want);
+  if (!chunk) return false;
+
+  if (PyUnicode_Check(chunk)) {
+    data = PyUnicode_AsUTF8AndSize(chunk, &data_len);
+    if (!data) {
+      Py_DECREF(chunk);
+      return false;
+    }
+    view.obj = NULL;
+  } else if (PyObject_GetBuffer(chunk, &view, PyBUF_SIMPLE) == 0) {
+    data = view.buf;
+    data_len = view.len;
+  } else {
+    Py_DECREF(chunk);
+    PyErr_SetString(
+        PyExc_TypeError, "read() must return a str or a bytes-like object."
+    );
+    return false;
+  }
+
+  if (data_len == 0) {
+    self->eof = true;
+  } else {
+    size_t keep = (size_t)(sc->end - sc->cur);
+    size_t needed = keep + (size_t)data_len;
+
+    self->consumed += (size_t)(sc->cur - sc->start);
+    memmove(self->buf, sc->cur, keep);
+
+    if (needed > self->cap) {
+      size_t cap = self->cap * 2 > needed ? self->cap * 2 : needed;
+      char *buf = PyMem_Realloc(self->buf, cap);
+      if (!buf) {
+        if (view.obj) PyBuffer_Release(&view);
+        Py_DECREF(chunk);
+        PyErr_NoMemory();
+        return false;
+      }
+      self->buf = buf;
+      self->cap = cap;
+    }
+
+    memcpy(self->buf + keep, data, data_len);
+    sc->start = self->buf;
+    sc->cur = self->buf;
+    sc->end = self->buf + needed;
+  }
+
+  if (view.obj) PyBuffer_Release(&view);
+  Py_DECREF(chunk);
+  return true;
+}
+
+/**
+ * Skip whitespace, and comments if ALLOW_COMMENTS is set. Returns 1 if
+ * there's a token at the scanner's position, 0 if more input is needed
+ * to tell, or -1 on error.
+ */
+static int ev_ws(EventIterObject *self) {
+  Scanner *sc = &self->sc;
+
+  while (sc->cur < sc->end) {
+    switch (*sc->cur) {
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        sc->cur++;
+        continue;
+      case '/': {
+        if (!(sc->flags & YYJSON_READ_ALLOW_COMMENTS)) return 1;
+        if (sc->cur + 1 >= sc->end) return self->eof ? 1 : 0;
+
+        const char *close = NULL;
+        if (sc->cur[1] == '/') {
+          close = memchr(sc->cur + 2, '\n', sc->end - sc->cur - 2);
+          if (!close && !self->eof) return 0;
+          sc->cur = close ? close + 1 : sc->end;
+          continue;
+        }
+        if (sc->cur[1] != '*') return 1;
+
+        for (const char *p = sc->cur + 2; p + 1 < sc->end; p++) {
+          if (p[0] == '*' && p[1] == '/') {
+            close = p;
+            break;
+          }
+        }
+        if (!close) {
+          if (!self->eof) return 0;
+          return ev_fail(self, "unclosed multiline comment");
+        }
+        sc->cur = close + 2;
+        continue;
+      }
+      default:
+        return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Read the string at the scanner's position, unescaping it with yyjson's
+ * string reader if it needs to be. Strings with control characters or
+ * invalid UTF-8 also go through yyjson, so they're rejected the same way
+ * a Document rejects them.
+ */
+static int ev_string(EventIterObject *self, PyObject **result) {
+  Scanner *sc = &self->sc;
+  const char *start = sc->cur;
+  const char *str;
+  size_t len;
+  bool escaped, plain;
+
+  if (!scan_string(sc, &str, &len, &escaped)) {
+    if (self->eof) return ev_error(self);
+    sc->err = NULL;
+    return 0;
+  }
+
+  if (!escaped && str_check(str, len, &plain) && plain) {
+    *result = PyUnicode_DecodeUTF8(str, len, NULL);
+    return *result ? 1 : -1;
+  }
+
+  yyjson_read_err err;
+  yyjson_doc *unescaped = yyjson_read_opts(
+      (char *)start, len + 2, sc->flags, &PyMem_Allocator, &err
+  );
+  if (!unescaped) {
+    sc->cur = start + err.pos;
+    return ev_fail(self, err.msg);
+  }
+
+  yyjson_val *root = yyjson_doc_get_root(unescaped);
+  *result =
+      PyUnicode_DecodeUTF8(yyjson_get_str(root), yyjson_get_len(root), NULL);
+  yyjson_doc_free(unescaped);
+  return *result ? 1 : -1;
+}
+
+/**
+ * Read the number or literal at the scanner's position with yyjson's number
+ * reader, once a delimiter shows it's complete.
+ */
+static int ev_scalar(EventIterObject *self, PyObject **event) {
+  Scanner *sc = &self->sc;
+  const char *p = sc->cur;
+
+  while (p < sc->end) {
+    char c = *p;
+    if (c == ',' || c == ']' || c == '}' || c == ' ' || c == '\t' ||
+        c == '\n' || c == '\r' || c == '/' || c == ':' || c == '"' ||
+        c == '[' || c == '{') {
+      break;
+    }
+    p++;
+  }
+  if (p == sc->end && !self->eof) return 0;
+
+  size_t len = (size_t)(p - sc->cur);
+  if (len == 0) return ev_fail(self, "unexpected character");
+
+  if (len == 4 && memcmp(sc->cur, "true", 4) == 0) {
+    sc->cur = p;
+    *event = ev_const(EV_BOOLEAN, Py_True);
+    return *event ? 1 : -1;
+  }
+  if (len == 5 && memcmp(sc->cur, "false", 5) == 0) {
+    sc->cur = p;
+    *event = ev_const(EV_BOOLEAN, Py_False);
+    return *event ? 1 : -1;
+  }
+  if (len == 4 && memcmp(sc->cur, "null", 4) == 0) {
+    sc->cur = p;
+    *event = ev_const(EV_NULL, Py_None);
+    return *event ? 1 : -1;
+  }
+
+  // yyjson_read_number() needs a NUL after the number, and may write into
+  // it when reading raw numbers, so it's given a copy.
+  char small[64];
+  char *copy = len < sizeof(small) ? small : PyMem_Malloc(len + 1);
+  if (!copy) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  memcpy(copy, sc->cur, len);
+  copy[len] = '\0';
+
+  yyjson_val val;
+  yyjson_read_err err;
+  const char *end =
+      yyjson_read_number(copy, &val, sc->flags, &PyMem_Allocator, &err);
+  if (!end || end != copy + len) {
+    if (copy != small) PyMem_Free(copy);
+    // Anything left starting like true, false or null is a broken literal
+    // rather than a number.
+    char c = *sc->cur;
+    if (c == 't' || c == 'f' || c == 'n') {
+      return ev_fail(self, "invalid literal");
+    }
+    if (end) err.pos = (size_t)(end - copy);
+    sc->cur += err.pos;
+    return ev_fail(self, end ? "unexpected character" : err.msg);
+  }
+
+  *event = ev_event(EV_NUMBER, element_to_primitive(&val));
+  if (copy != small) PyMem_Free(copy);
+  sc->cur = p;
+  return *event ? 1 : -1;
+}
+
+/**
+ * Enter a container, or leave the innermost one.
+ */
+static int ev_push(EventIterObject *self, char close) {
+  if (self->depth == self->stack_cap) {
+    Py_ssize_t cap = self->stack_cap ? self->stack_cap * 2 : 32;
+    char *stack = PyMem_Realloc(self->stack, cap);
+    if (!stack) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    self->stack = stack;
+    self->stack_cap = cap;
+  }
+  self->stack[self->depth++] = close;
+  self->sc.cur++;
+  return 1;
+}
+
+static int ev_pop(EventIterObject *self, PyObject **event) {
+  char close = self->stack[--self->depth];
+  self->sc.cur++;
+  self->expect = self->depth ? EV_COMMA_OR_END : EV_DONE;
+  *event = ev_const(close == '}' ? EV_END_MAP : EV_END_ARRAY, Py_None);
+  return *event ? 1 : -1;
+}
+
+/**
+ * Produce the next event. Returns 1 with the event, 2 at the end of the
+ * document, 0 if more input is needed (with the state unchanged), or -1 on
+ * error.
+ */
+static int ev_step(EventIterObject *self, PyObject **event) {
+  Scanner *sc = &self->sc;
+  bool trailing = sc->flags & YYJSON_READ_ALLOW_TRAILING_COMMAS;
+  PyObject *str;
+  int r;
+
+  for (;;) {
+    r = ev_ws(self);
+    if (r == 0 && self->eof && self->expect == EV_DONE) return 2;
+    if (r <= 0) return r;
+
+    char c = *sc->cur;
+    char top = self->depth ? self->stack[self->depth - 1] : 0;
+
+    switch (self->expect) {
+      case EV_DONE:
+        if (sc->flags & YYJSON_READ_STOP_WHEN_DONE) return 2;
+        return ev_fail(self, "unexpected content after document");
+      case EV_COLON:
+        if (c != ':') {
+          return ev_fail(self, "expected a colon after object key");
+        }
+        sc->cur++;
+        self->expect = EV_VALUE;
+        continue;
+      case EV_COMMA_OR_END:
+        if (c == ',') {
+          sc->cur++;
+          self->expect = top == '}' ? EV_KEY : EV_ITEM;
+          continue;
+        }
+        if (c == top) return ev_pop(self, event);
+        return ev_fail(
+            self, top == '}' ? "expected a comma or the end of the object"
+                             : "expected a comma or the end of the array"
+        );
+      case EV_KEY_OR_END:
+      case EV_KEY:
+        if (c == '}' && (self->expect == EV_KEY_OR_END || trailing)) {
+          return ev_pop(self, event);
+        }
+        if (c != '"') {
+          return ev_fail(self, "expected a string for object key");
+        }
+        r = ev_string(self, &str);
+        if (r <= 0) return r;
+        self->expect = EV_COLON;
+        *event = ev_event(EV_MAP_KEY, str);
+        return *event ? 1 : -1;
+      case EV_ITEM_OR_END:
+      case EV_ITEM:
+        if (c == ']' && (self->expect == EV_ITEM_OR_END || trailing)) {
+          return ev_pop(self, event);
+        }
+        self->expect = EV_VALUE;
+        continue;
+      case EV_VALUE:
+        break;
+    }
+
+    // A value, after which the container it's in continues.
+    EventExpect after = self->depth ? EV_COMMA_OR_END : EV_DONE;
+    switch (c) {
+      case '{':
+        if (ev_push(self, '}') < 0) return -1;
+        self->expect = EV_KEY_OR_END;
+        *event = ev_const(EV_START_MAP, Py_None);
+        return *event ? 1 : -1;
+      case '[':
+        if (ev_push(self, ']') < 0) return -1;
+        self->expect = EV_ITEM_OR_END;
+        *event = ev_const(EV_START_ARRAY, Py_None);
+        return *event ? 1 : -1;
+      case '"':
+        r = ev_string(self, &str);
+        if (r <= 0) return r;
+        self->expect = after;
+        *event = ev_event(EV_STRING, str);
+        return *event ? 1 : -1;
+      default:
+        r = ev_scalar(self, event);
+        if (r == 1) self->expect = after;
+        return r;
+    }
+  }
+}
+
+static PyObject *EventIter_next(EventIterObject *self) {
+  PyObject *event = NULL;
+
+  if (!self->sc.start && !self->read) {
+    PyErr_SetString(PyExc_ValueError, "The parser was not initialized.");
+    return NULL;
+  }
+
+  for (;;) {
+    int r = ev_step(self, &event);
+    if (r == 1) return event;
+    if (r == 2 || r < 0) return NULL;
+
+    if (self->eof) {
+      if (self->depth == 0 && self->expect == EV_VALUE) {
+        ev_fail(self, "input data is empty");
+      } else {
+        ev_fail(self, "unexpected end of data");
+      }
+      return NULL;
+    }
+    if (!ev_refill(self)) return NULL;
+  }
+}
+
+static int EventIter_init(
+    EventIterObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"source", "flags", "chunk_size", NULL};
+  PyObject *source;
+  yyjson_read_flag r_flag = 0;
+  Py_ssize_t chunk_size = 65536;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O|$In", kwlist, &source, &r_flag, &chunk_size
+      )) {
+    return -1;
+  }
+
+  if (chunk_size <= 0) {
+    PyErr_SetString(PyExc_ValueError, "chunk_size must be positive.");
+    return -1;
+  }
+
+  if (self->read || self->view.obj || self->source) {
+    PyErr_SetString(PyExc_ValueError, "The parser is already initialized.");
+    return -1;
+  }
+
+  if (!event_strs[0]) {
+    for (int i = 0; i < EV_COUNT; i++) {
+      event_strs[i] = PyUnicode_InternFromString(event_names[i]);
+      if (!event_strs[i]) return -1;
+    }
+  }
+
+  scanner_init(&self->sc, NULL, 0, r_flag);
+  self->chunk_size = chunk_size;
+  self->expect = EV_VALUE;
+
+  if (PyUnicode_Check(source)) {
+    Py_ssize_t len;
+    const char *buf = PyUnicode_AsUTF8AndSize(source, &len);
+    if (!buf) return -1;
+    Py_INCREF(source);
+    self->source = source;
+    scanner_init(&self->sc, buf, len, r_flag);
+    self->eof = true;
+  } else if (PyObject_CheckBuffer(source)) {
+    if (PyObject_GetBuffer(source, &self->view, PyBUF_SIMPLE) < 0) return -1;
+    scanner_init(&self->sc, self->view.buf, self->view.len, r_flag);
+    self->eof = true;
+  } else {
+    self->read = PyObject_GetAttrString(source, "read");
+    if (!self->read) {
+      PyErr_Clear();
+      PyErr_SetString(
+          PyExc_TypeError,
+          "source must be a str, a bytes-like object or a file object."
+      );
+      return -1;
+    }
+    self->buf = PyMem_Malloc(chunk_size);
+    if (!self->buf) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    self->cap = (size_t)chunk_size;
+    scanner_init(&self->sc, self->buf, 0, r_flag);
+  }
+
+  return 0;
+}
+
+static void EventIter_dealloc(EventIterObject *self) {
+  if (self->view.obj) PyBuffer_Release(&self->view);
+  Py_XDECREF(self->source);
+  Py_XDECREF(self->read);
+  PyMem_Free(self->buf);
+  PyMem_Free(self->stack);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *EventIter_get_depth(EventIterObject *self, void *closure) {
+  return PyLong_FromSsize_t(self->depth);
+}
+
+static PyObject *EventIter_get_position(EventIterObject *self, void *closure) {
+  return PyLong_FromSize_t(
+      self->consumed + (size_t)(self->sc.cur - self->sc.start)
+  );
+}
+
+static PyGetSetDef EventIter_members[] = {
+    {"depth", (getter)EventIter_get_depth, NULL,
+     "The number of containers the parser is inside of.", NULL},
+    {"position", (getter)EventIter_get_position, NULL,
+     "The byte offset of the parser in the input.", NULL},
+    {NULL} /* Sentinel */
+};
+
+PyDoc_STRVAR(
+    EventIter_doc,
+    "Iterates over the ``(event, value)`` tuples of a JSON document.\n"
+    "\n"
+    "See :func:`yyjson.iter_events`, which also accepts a ``Path``.\n"
+);
+
+PyTypeObject EventIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.EventIter",
+    .tp_doc = EventIter_doc,
+    .tp_basicsize = sizeof(EventIterObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)EventIter_init,
+    .tp_dealloc = (destructor)EventIter_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)EventIter_next,
+    .tp_getset = EventIter_members};
+
+/*=============================================================================
+ * ArrayStream
+ *===========================================================================*/
+
+/**
+ * Where the parser is within a container being stepped through.
+ */
+typedef struct {
+  /** The closing bracket of the container. */
+  char close;
+  /** Whether no items of the container have been visited yet. */
+  bool first;
+  /** Set when the end of the container is reached instead of an item. */
+  bool end;
+  /** For objects, the key to match, and whether the member's key did. */
+  const char *key;
+  size_t key_len;
+  bool match;
+} EventItem;
+
+/**
+ * Run step until it no longer needs more input, reading it as needed. step
+ * must leave the parser unchanged when it returns 0.
+ */
+static int ev_run(
+    EventIterObject *self, int (*step)(EventIterObject *, void *), void *arg
+) {
+  for (;;) {
+    int r = step(self, arg);
+    if (r != 0) return r;
+    if (self->eof) return ev_fail(self, "unexpected end of data");
+    if (!ev_refill(self)) return -1;
+  }
+}
+
+/**
+ * Move past the value at the scanner's position without parsing it, which
+ * needs all of it to be in the window.
+ */
+static int ev_skip_value(EventIterObject *self) {
+  Scanner *sc = &self->sc;
+  const char *start = sc->cur;
+  char c = *start;
+
+  if (c == '[' || c == '{' || c == '"') {
+    // Containers and strings only fail to skip when they run past the end
+    // of the window.
+    if (!scan_skip(sc)) {
+      if (self->eof) return ev_error(self);
+      sc->cur = start;
+      sc->err = NULL;
+      return 0;
+    }
+    return 1;
+  }
+
+  const char *p = start;
+  while (p < sc->end) {
+    c = *p;
+    if (c == ',' || c == ']' || c == '}' || c == ' ' || c == '\t' ||
+        c == '\n' || c == '\r' || c == '/' || c == ':') {
+      break;
+    }
+    p++;
+  }
+  if (p == sc->end && !self->eof) return 0;
+  if (p == start) return ev_fail(self, "unexpected character");
+  sc->cur = p;
+  return 1;
+}
+
+static int ev_skip(EventIterObject *self, void *unused) {
+  int r = ev_ws(self);
+  if (r <= 0) return r;
+  return ev_skip_value(self);
+}
+
+/**
+ * Parse the value at the scanner's position with yyjson, once all of it is
+ * in the window.
+ */
+static int ev_read(EventIterObject *self, void *doc) {
+  Scanner *sc = &self->sc;
+  int r = ev_ws(self);
+  if (r <= 0) return r;
+
+  const char *start = sc->cur;
+  r = ev_skip_value(self);
+  if (r <= 0) return r;
+
+  yyjson_read_err err;
+  *(yyjson_doc **)doc = yyjson_read_opts(
+      (char *)start, (size_t)(sc->cur - start),
+      sc->flags & ~YYJSON_READ_STOP_WHEN_DONE, &PyMem_Allocator, &err
+  );
+  if (!*(yyjson_doc **)doc) {
+    sc->cur = start + err.pos;
+    return ev_fail(self, err.msg);
+  }
+  return 1;
+}
+
+/**
+ * Enter the array or object at the scanner's position, setting close to
+ * its closing bracket.
+ */
+static int ev_open(EventIterObject *self, void *close) {
+  int r = ev_ws(self);
+  if (r <= 0) return r;
+
+  char c = *self->sc.cur;
+  if (c != '[' && c != '{') {
+    *(char *)close = 0;
+    return 1;
+  }
+  self->sc.cur++;
+  *(char *)close = c == '[' ? ']' : '}';
+  return 1;
+}
+
+/**
+ * Whether the key of a member, scanned at key_start, is the one wanted.
+ */
+static int ev_key_matches(
+    EventIterObject *self, EventItem *item, const char *key_start,
+    const char *str, size_t len, bool escaped
+) {
+  bool plain;
+  if (!escaped && str_check(str, len, &plain) && plain) {
+    return len == item->key_len && memcmp(str, item->key, len) == 0;
+  }
+
+  // Keys rarely contain escapes, or anything invalid, so let yyjson handle
+  // them.
+  yyjson_read_err err;
+  yyjson_doc *unescaped =
+      yyjson_read_opts((char *)key_start, len + 2, 0, &PyMem_Allocator, &err);
+  if (!unescaped) {
+    self->sc.cur = key_start + err.pos;
+    return ev_fail(self, err.msg);
+  }
+  yyjson_val *root = yyjson_doc_get_root(unescaped);
+  int match = yyjson_get_len(root) == item->key_len &&
+              memcmp(yyjson_get_str(root), item->key, item->key_len) == 0;
+  yyjson_doc_free(unescaped);
+  return match;
+}
+
+/**
+ * Move to the next item of a container, consuming the comma before it and,
+ * for objects, its key and colon.
+ */
+static int ev_next_item(EventIterObject *self, void *arg) {
+  EventItem *item = arg;
+  Scanner *sc = &self->sc;
+  int r = ev_ws(self);
+  if (r <= 0) return r;
+
+  const char *start = sc->cur;
+
+  if (*sc->cur == item->close) {
+    sc->cur++;
+    item->end = true;
+    return 1;
+  }
+
+  if (!item->first) {
+    if (*sc->cur != ',') {
+      return ev_fail(
+          self, item->close == '}'
+                    ? "expected a comma or the end of the object"
+                    : "expected a comma or the end of the array"
+      );
+    }
+    sc->cur++;
+    r = ev_ws(self);
+    if (r == 0 && !self->eof) sc->cur = start;
+    if (r <= 0) return r;
+
+    if (*sc->cur == item->close) {
+      if (!(sc->flags & YYJSON_READ_ALLOW_TRAILING_COMMAS)) {
+        return ev_fail(self, "trailing comma is not allowed");
+      }
+      sc->cur++;
+      item->end = true;
+      return 1;
+    }
+  }
+
+  if (item->close == '}') {
+    const char *key_start = sc->cur;
+    const char *str;
+    size_t len;
+    bool escaped;
+
+    if (*sc->cur != '"') {
+      return ev_fail(self, "expected a string for object key");
+    }
+    if (!scan_string(sc, &str, &len, &escaped)) {
+      if (self->eof) return ev_error(self);
+      sc->err = NULL;
+      sc->cur = start;
+      return 0;
+    }
+
+    r = ev_ws(self);
+    if (r == 0 && !self->eof) sc->cur = start;
+    if (r <= 0) return r;
+    if (*sc->cur != ':') {
+      return ev_fail(self, "expected a colon after object key");
+    }
+
+    int match = ev_key_matches(self, item, key_start, str, len, escaped);
+    if (match < 0) return -1;
+    item->match = match;
+    sc->cur++;
+  }
+
+  item->first = false;
+  return 1;
+}
+
+static bool array_stream_not_found(ArrayStreamObject *self) {
+  PyErr_Format(
+      PyExc_ValueError, "no value found for the JSON pointer %R",
+      self->pointer->source
+  );
+  return false;
+}
+
+/**
+ * Follow the pointer to the array, skipping everything before it, and
+ * enter it.
+ */
+static bool array_stream_find(ArrayStreamObject *self) {
+  EventIterObject *parser = self->parser;
+  PointerObject *pointer = self->pointer;
+  char close;
+
+  for (Py_ssize_t i = 0; i < pointer->num_tokens; i++) {
+    const PointerToken *token = &pointer->tokens[i];
+
+    if (ev_run(parser, ev_open, &close) < 0) return false;
+    if (!close) return array_stream_not_found(self);
+    if (close == ']' &&
+        (token->idx == POINTER_IDX_NONE || token->idx == POINTER_IDX_END)) {
+      return array_stream_not_found(self);
+    }
+
+    EventItem item = {close, true, false, token->key, token->key_len, false};
+    for (size_t idx = 0;; idx++) {
+      if (ev_run(parser, ev_next_item, &item) < 0) return false;
+      if (item.end) return array_stream_not_found(self);
+      if (close == '}' ? item.match : idx == token->idx) break;
+      if (ev_run(parser, ev_skip, NULL) < 0) return false;
+    }
+  }
+
+  if (ev_run(parser, ev_open, &close) < 0) return false;
+  if (close != ']') {
+    PyErr_SetString(PyExc_TypeError, "The value is not an array.");
+    return false;
+  }
+  return true;
+}
+
+static PyObject *ArrayStream_next(ArrayStreamObject *self) {
+  EventIterObject *parser = self->parser;
+  yyjson_doc *doc;
+
+  if (!parser) {
+    PyErr_SetString(PyExc_ValueError, "The stream was not initialized.");
+    return NULL;
+  }
+  if (self->done) return NULL;
+
+  if (!self->started) {
+    if (!array_stream_find(self)) {
+      self->done = true;
+      return NULL;
+    }
+    self->started = true;
+    self->first = true;
+  }
+
+  EventItem item = {']', self->first, false, NULL, 0, false};
+  if (ev_run(parser, ev_next_item, &item) < 0 || item.end ||
+      ev_run(parser, ev_read, &doc) < 0) {
+    self->done = true;
+    return NULL;
+  }
+  self->first = false;
+
+  if (self->as_documents) {
+    return document_from_doc(doc);
+  }
+
+  PyObject *result = element_to_primitive(yyjson_doc_get_root(doc));
+  yyjson_doc_free(doc);
+  return result;
+}
+
+static int ArrayStream_init(
+    ArrayStreamObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {
+      "source", "pointer", "flags", "chunk_size", "as_documents", NULL};
+  PyObject *source;
+  PyObject *pointer = NULL;
+  unsigned int r_flag = 0;
+  Py_ssize_t chunk_size = 65536;
+  int as_documents = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O|O&$Inp", kwlist, &source, pointer_converter,
+          &pointer, &r_flag, &chunk_size, &as_documents
+      )) {
+    return -1;
+  }
+
+  if (!pointer) {
+    PyObject *empty = PyUnicode_FromString("");
+    pointer = empty ? (PyObject *)pointer_compile(empty) : NULL;
+    Py_XDECREF(empty);
+  } else if (Pointer_Check(pointer)) {
+    Py_INCREF(pointer);
+  } else {
+    pointer = (PyObject *)pointer_compile(pointer);
+  }
+  if (!pointer) return -1;
+
+  PyObject *parser = NULL;
+  PyObject *parser_args = Py_BuildValue("(O)", source);
+  PyObject *parser_kwds = Py_BuildValue(
+      "{s:I,s:n}", "flags", r_flag, "chunk_size", chunk_size
+  );
+  if (parser_args && parser_kwds) {
+    parser =
+        PyObject_Call((PyObject *)&EventIterType, parser_args, parser_kwds);
+  }
+  Py_XDECREF(parser_args);
+  Py_XDECREF(parser_kwds);
+  if (!parser) {
+    Py_DECREF(pointer);
+    return -1;
+  }
+
+  Py_XSETREF(self->parser, (EventIterObject *)parser);
+  Py_XSETREF(self->pointer, (PointerObject *)pointer);
+  self->as_documents = as_documents;
+  self->started = false;
+  self->first = true;
+  self->done = false;
+  return 0;
+}
+
+static void ArrayStream_dealloc(ArrayStreamObject *self) {
+  Py_XDECREF(self->parser);
+  Py_XDECREF(self->pointer);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyDoc_STRVAR(
+    ArrayStream_doc,
+    "Iterates over the elements of an array in a JSON document, parsing\n"
+    "each on its own.\n"
+    "\n"
+    "See :func:`yyjson.iter_array`, which also accepts a ``Path``.\n"
+);
+
+PyTypeObject ArrayStreamType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.ArrayStream",
+    .tp_doc = ArrayStream_doc,
+    .tp_basicsize = sizeof(ArrayStreamObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)ArrayStream_init,
+    .tp_dealloc = (destructor)ArrayStream_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)ArrayStream_next};
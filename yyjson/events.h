@@ -0,0 +1,84 @@
+#ifndef PY_YYJSON_EVENTS_H
+#define PY_YYJSON_EVENTS_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "pointer.h"
+#include "scan.h"
+#include "yyjson.h"
+
+/**
+ * What the event parser expects next.
+ */
+typedef enum {
+  EV_VALUE,
+  /** The first member of an object, or its end. */
+  EV_KEY_OR_END,
+  /** A member of an object after a comma. */
+  EV_KEY,
+  EV_COLON,
+  /** The first element of an array, or its end. */
+  EV_ITEM_OR_END,
+  /** An element of an array after a comma. */
+  EV_ITEM,
+  EV_COMMA_OR_END,
+  /** Nothing, the document is complete. */
+  EV_DONE,
+} EventExpect;
+
+/**
+ * A pull parser yielding (event, value) tuples for JSON read in bounded
+ * chunks, without building a document.
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The read() method of the source, or NULL if it's a buffer. */
+      PyObject* read;
+  /** The str being scanned, which owns its UTF-8 form. */
+  PyObject* source;
+  /** The buffer being scanned, if the source is a bytes-like object. */
+  Py_buffer view;
+  /** The window of input read so far but not yet consumed. */
+  char* buf;
+  size_t cap;
+  /** The scanner over the window, or over the whole buffer. */
+  Scanner sc;
+  /** The number of bytes dropped from the front of the window so far. */
+  size_t consumed;
+  /** Whether the whole input has been read. */
+  bool eof;
+  /** The number of bytes to read at a time. */
+  Py_ssize_t chunk_size;
+  /** The closing bracket of each container being parsed, innermost last. */
+  char* stack;
+  Py_ssize_t depth;
+  Py_ssize_t stack_cap;
+  EventExpect expect;
+} EventIterObject;
+
+/**
+ * Streams the elements of one array, found by a JSON pointer, parsing each
+ * on its own.
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The parser reading the input, which owns the window. */
+      EventIterObject* parser;
+  /** The pointer to the array, resolved on the first step. */
+  PointerObject* pointer;
+  /** Whether elements are returned as Documents instead of objects. */
+  bool as_documents;
+  /** Whether the parser is inside the array. */
+  bool started;
+  /** Whether no elements of the array have been read yet. */
+  bool first;
+  /** Whether the end of the array was reached. */
+  bool done;
+} ArrayStreamObject;
+
+extern PyTypeObject EventIterType;
+extern PyTypeObject ArrayStreamType;
+
+#endif
@@ -0,0 +1,479 @@
+#include "incremental.h"
+
+#include <string.h>
+
+#include "document.h"
+#include "memory.h"
+
+/**
+ * The number of unscanned bytes above which feed() releases the GIL while
+ * scanning and parsing them.
+ */
+#define INCR_NOGIL_MIN (64 * 1024)
+
+/**
+ * Whether c can continue a bare number or literal at the top level, such
+ * as 12 or true. Anything else ends it.
+ */
+static inline bool incr_is_scalar_char(char c) {
+  switch (c) {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+    case ',':
+    case ':':
+    case '"':
+    case '/':
+      return false;
+    default:
+      return true;
+  }
+}
+
+static inline void incr_begin(
+    IncrementalParserObject *self, size_t pos, bool scalar
+) {
+  if (self->in_value) return;
+  self->in_value = true;
+  self->start = pos;
+  self->scalar = scalar;
+}
+
+/**
+ * Parse the document from start up to end, adding it to docs. This doesn't
+ * touch any Python objects, so it can run without the GIL.
+ */
+static bool incr_emit(IncrementalParserObject *self, size_t end) {
+  size_t start = self->start;
+
+  self->in_value = false;
+  self->scalar = false;
+  self->depth = 0;
+
+  if (self->n_docs == self->docs_cap) {
+    size_t cap = self->docs_cap ? self->docs_cap * 2 : 16;
+    yyjson_doc **docs =
+        PyMem_RawRealloc(self->docs, cap * sizeof(yyjson_doc *));
+    if (!docs) {
+      self->err.code = YYJSON_READ_ERROR_MEMORY_ALLOCATION;
+      self->err.msg = "memory allocation failed";
+      self->err_pos = self->consumed + start;
+      return false;
+    }
+    self->docs = docs;
+    self->docs_cap = cap;
+  }
+
+  yyjson_doc *doc = yyjson_read_opts(
+      self->buf + start, end - start, self->flags, &PyMem_RawAllocator,
+      &self->err
+  );
+  if (!doc) {
+    self->err_pos = self->consumed + start + self->err.pos;
+    return false;
+  }
+
+  self->docs[self->n_docs++] = doc;
+  return true;
+}
+
+/**
+ * Move the documents parsed by the last scan into the ready list, raising
+ * the scan's error if it failed.
+ */
+static bool incr_collect(IncrementalParserObject *self, bool ok) {
+  bool wrapped = true;
+
+  for (size_t i = 0; i < self->n_docs; i++) {
+    if (!wrapped) {
+      yyjson_doc_free(self->docs[i]);
+      continue;
+    }
+    PyObject *document = document_from_doc(self->docs[i]);
+    if (!document || PyList_Append(self->ready, document) < 0) {
+      wrapped = false;
+    }
+    Py_XDECREF(document);
+  }
+  self->n_docs = 0;
+
+  if (!wrapped) return false;
+
+  if (!ok) {
+    if (self->err.code == YYJSON_READ_ERROR_MEMORY_ALLOCATION) {
+      PyErr_NoMemory();
+    } else {
+      PyErr_Format(
+          PyExc_ValueError, "%s at position %zu", self->err.msg, self->err_pos
+      );
+    }
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Scan the bytes that arrived since the last call, parsing each document
+ * as soon as its last byte is seen.
+ */
+static bool incr_scan(IncrementalParserObject *self) {
+  const char *buf = self->buf;
+  size_t len = self->len;
+  size_t i = self->scanned;
+
+  while (i < len) {
+    char c = buf[i];
+
+    switch (self->state) {
+      case INCR_STRING:
+        while (i < len && buf[i] != '"' && buf[i] != '\\') i++;
+        if (i == len) continue;
+        if (buf[i++] == '\\') {
+          self->state = INCR_STRING_ESCAPE;
+          continue;
+        }
+        self->state = INCR_NORMAL;
+        if (self->depth == 0 && !incr_emit(self, i)) goto fail;
+        continue;
+      case INCR_STRING_ESCAPE:
+        self->state = INCR_STRING;
+        i++;
+        continue;
+      case INCR_SLASH:
+        if (c == '/' || c == '*') {
+          self->state = c == '/' ? INCR_LINE_COMMENT : INCR_BLOCK_COMMENT;
+          i++;
+          continue;
+        }
+        // Not a comment, so leave the stray '/' for yyjson to report.
+        self->state = INCR_NORMAL;
+        incr_begin(self, i - 1, true);
+        continue;
+      case INCR_LINE_COMMENT:
+        if (c == '\n') self->state = INCR_NORMAL;
+        i++;
+        continue;
+      case INCR_BLOCK_COMMENT:
+        if (c == '*') self->state = INCR_BLOCK_COMMENT_STAR;
+        i++;
+        continue;
+      case INCR_BLOCK_COMMENT_STAR:
+        if (c == '/') {
+          self->state = INCR_NORMAL;
+        } else if (c != '*') {
+          self->state = INCR_BLOCK_COMMENT;
+        }
+        i++;
+        continue;
+      case INCR_NORMAL:
+        break;
+    }
+
+    if (self->in_value && self->scalar) {
+      // Scalars only end at the next delimiter, which is then scanned
+      // again on its own.
+      if (incr_is_scalar_char(c)) {
+        i++;
+      } else if (!incr_emit(self, i)) {
+        goto fail;
+      }
+      continue;
+    }
+
+    switch (c) {
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+        i++;
+        break;
+      case '"':
+        incr_begin(self, i++, false);
+        self->state = INCR_STRING;
+        break;
+      case '[':
+      case '{':
+        incr_begin(self, i++, false);
+        self->depth++;
+        break;
+      case ']':
+      case '}':
+        if (!self->in_value) {
+          // A stray closing bracket, which yyjson reports.
+          incr_begin(self, i++, false);
+          if (!incr_emit(self, i)) goto fail;
+          break;
+        }
+        i++;
+        if (--self->depth == 0 && !incr_emit(self, i)) goto fail;
+        break;
+      case '/':
+        if (self->flags & YYJSON_READ_ALLOW_COMMENTS) {
+          self->state = INCR_SLASH;
+          i++;
+          break;
+        }
+        // fall through
+      default:
+        incr_begin(self, i++, true);
+        break;
+    }
+  }
+
+  self->scanned = i;
+  return true;
+
+fail:
+  self->scanned = i;
+  return false;
+}
+
+/**
+ * Drop the bytes before the document being received, which will never be
+ * looked at again.
+ */
+static void incr_compact(IncrementalParserObject *self) {
+  size_t keep = self->scanned;
+  if (self->in_value) {
+    keep = self->start;
+  } else if (self->state == INCR_SLASH) {
+    keep = self->scanned - 1;
+  }
+
+  if (keep == 0) return;
+
+  memmove(self->buf, self->buf + keep, self->len - keep);
+  self->len -= keep;
+  self->scanned -= keep;
+  self->start = self->in_value ? self->start - keep : 0;
+  self->consumed += keep;
+}
+
+/**
+ * Returns the documents completed so far and starts a new list for them.
+ */
+static PyObject *incr_take_ready(IncrementalParserObject *self) {
+  PyObject *fresh = PyList_New(0);
+  if (!fresh) return NULL;
+
+  PyObject *ready = self->ready;
+  self->ready = fresh;
+  return ready;
+}
+
+static int IncrementalParser_init(
+    IncrementalParserObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"flags", NULL};
+  yyjson_read_flag r_flag = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$I", kwlist, &r_flag)) {
+    return -1;
+  }
+
+  if (self->busy) {
+    PyErr_SetString(PyExc_ValueError, "The parser is being fed.");
+    return -1;
+  }
+
+  PyObject *ready = PyList_New(0);
+  if (!ready) return -1;
+  Py_XSETREF(self->ready, ready);
+
+  // Documents are always parsed one at a time, from their exact span.
+  self->flags = r_flag & ~YYJSON_READ_STOP_WHEN_DONE;
+  self->len = 0;
+  self->scanned = 0;
+  self->consumed = 0;
+  self->state = INCR_NORMAL;
+  self->depth = 0;
+  self->in_value = false;
+  self->start = 0;
+  self->scalar = false;
+  self->closed = false;
+  return 0;
+}
+
+static void IncrementalParser_dealloc(IncrementalParserObject *self) {
+  PyMem_Free(self->buf);
+  PyMem_RawFree(self->docs);
+  Py_XDECREF(self->ready);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static bool incr_ensure_open(IncrementalParserObject *self) {
+  if (!self->ready) {
+    PyErr_SetString(PyExc_ValueError, "The parser was not initialized.");
+    return false;
+  }
+  if (self->closed) {
+    PyErr_SetString(PyExc_ValueError, "The parser is closed.");
+    return false;
+  }
+  if (self->busy) {
+    PyErr_SetString(
+        PyExc_ValueError, "The parser is already being fed by another thread."
+    );
+    return false;
+  }
+  return true;
+}
+
+PyDoc_STRVAR(
+    IncrementalParser_feed_doc,
+    "Add the next chunk of JSON text, returning every document it\n"
+    "completed.\n"
+    "\n"
+    "Chunks may split the text anywhere, even inside a string or a\n"
+    "multi-byte character. Only the new bytes are scanned, and each\n"
+    "document is parsed once, as soon as its last byte arrives. Numbers\n"
+    "and literals at the top level, like ``12``, are only complete once a\n"
+    "delimiter follows them or :meth:`close` is called.\n"
+    "\n"
+    "Large chunks are scanned and parsed without holding the GIL, so other\n"
+    "threads keep running while a worker thread feeds the parser.\n"
+    "\n"
+    "If a document is invalid, it's discarded and a ``ValueError`` is\n"
+    "raised. Feeding may continue after it, and documents completed by the\n"
+    "same chunk before the invalid one are returned by the next call.\n"
+    "\n"
+    ":param chunk: The next part of the input.\n"
+    ":type chunk: ``bytes``, ``bytearray``, ``memoryview`` or ``str``\n"
+    ":returns: A list of :class:`Document`.\n"
+);
+static PyObject *IncrementalParser_feed(
+    IncrementalParserObject *self, PyObject *chunk
+) {
+  Py_buffer view = {0};
+  const char *data;
+  Py_ssize_t data_len;
+
+  if (!incr_ensure_open(self)) return NULL;
+
+  if (PyUnicode_Check(chunk)) {
+    data = PyUnicode_AsUTF8AndSize(chunk, &data_len);
+    if (!data) return NULL;
+  } else if (PyObject_GetBuffer(chunk, &view, PyBUF_SIMPLE) == 0) {
+    data = view.buf;
+    data_len = view.len;
+  } else {
+    PyErr_Clear();
+    PyErr_SetString(
+        PyExc_TypeError, "chunk must be a str or a bytes-like object."
+    );
+    return NULL;
+  }
+
+  if (self->len + (size_t)data_len > self->cap) {
+    size_t cap = self->cap ? self->cap * 2 : 4096;
+    if (cap < self->len + (size_t)data_len) cap = self->len + data_len;
+    char *buf = PyMem_Realloc(self->buf, cap);
+    if (!buf) {
+      PyBuffer_Release(&view);
+      return PyErr_NoMemory();
+    }
+    self->buf = buf;
+    self->cap = cap;
+  }
+  memcpy(self->buf + self->len, data, data_len);
+  self->len += data_len;
+  PyBuffer_Release(&view);
+
+  bool ok;
+  if (self->len - self->scanned >= INCR_NOGIL_MIN) {
+    self->busy = true;
+    Py_BEGIN_ALLOW_THREADS
+    ok = incr_scan(self);
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+  } else {
+    ok = incr_scan(self);
+  }
+  incr_compact(self);
+  if (!incr_collect(self, ok)) return NULL;
+
+  return incr_take_ready(self);
+}
+
+PyDoc_STRVAR(
+    IncrementalParser_close_doc,
+    "Signal the end of the input, returning the documents it completed.\n"
+    "\n"
+    "This completes a trailing number or literal at the top level. The\n"
+    "parser can't be fed afterwards.\n"
+    "\n"
+    ":raises ValueError: If the input ended partway through a document.\n"
+    ":returns: A list of :class:`Document`.\n"
+);
+static PyObject *IncrementalParser_close(
+    IncrementalParserObject *self, PyObject *unused
+) {
+  if (!incr_ensure_open(self)) return NULL;
+  self->closed = true;
+
+  if (self->state == INCR_SLASH) {
+    // A lone '/', which yyjson reports.
+    incr_begin(self, self->len - 1, true);
+  } else if (!self->in_value && (self->state == INCR_BLOCK_COMMENT ||
+                                  self->state == INCR_BLOCK_COMMENT_STAR)) {
+    PyErr_Format(
+        PyExc_ValueError, "unclosed multiline comment at position %zu",
+        self->consumed + self->len
+    );
+    return NULL;
+  }
+
+  // Whatever the document is, yyjson reports why it's incomplete.
+  bool ok = !self->in_value || incr_emit(self, self->len);
+  if (!incr_collect(self, ok)) return NULL;
+
+  return incr_take_ready(self);
+}
+
+static PyMethodDef IncrementalParser_methods[] = {
+    {"feed", (PyCFunction)IncrementalParser_feed, METH_O,
+     IncrementalParser_feed_doc},
+    {"close", (PyCFunction)IncrementalParser_close, METH_NOARGS,
+     IncrementalParser_close_doc},
+    {NULL} /* Sentinel */
+};
+
+PyDoc_STRVAR(
+    IncrementalParser_doc,
+    "Parses JSON text that arrives in chunks, such as from a socket or a\n"
+    "pipe, into a :class:`Document` for every complete document.\n"
+    "\n"
+    "The input may be any number of documents, one after another, like\n"
+    "NDJSON or concatenated JSON. Where the scanner was is kept between\n"
+    "chunks, so bytes are never scanned twice, and the bytes of completed\n"
+    "documents are released. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> parser = IncrementalParser()\n"
+    "    >>> [doc.as_obj for doc in parser.feed(b'{\"id\": 1}\\n{\"id\"')]\n"
+    "    [{'id': 1}]\n"
+    "    >>> [doc.as_obj for doc in parser.feed(b': 2}\\n3')]\n"
+    "    [{'id': 2}]\n"
+    "    >>> [doc.as_obj for doc in parser.close()]\n"
+    "    [3]\n"
+    "\n"
+    ":param flags: Flags that modify the parsing behaviour of each document.\n"
+    ":type flags: :class:`ReaderFlags`, optional\n"
+);
+
+PyTypeObject IncrementalParserType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.IncrementalParser",
+    .tp_doc = IncrementalParser_doc,
+    .tp_basicsize = sizeof(IncrementalParserObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)IncrementalParser_init,
+    .tp_dealloc = (destructor)IncrementalParser_dealloc,
+    .tp_methods = IncrementalParser_methods};
@@ -0,0 +1,67 @@
+#ifndef PY_YYJSON_INCREMENTAL_H
+#define PY_YYJSON_INCREMENTAL_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+/**
+ * Where the boundary scanner is within the JSON text, kept between feeds so
+ * that no byte is scanned twice.
+ */
+typedef enum {
+  INCR_NORMAL,
+  INCR_STRING,
+  INCR_STRING_ESCAPE,
+  /** After a '/', which may start a comment. */
+  INCR_SLASH,
+  INCR_LINE_COMMENT,
+  INCR_BLOCK_COMMENT,
+  /** After a '*' in a block comment, which may end it. */
+  INCR_BLOCK_COMMENT_STAR,
+} IncrState;
+
+/**
+ * Splits JSON text arriving in arbitrary chunks into documents.
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The reader flags documents are parsed with. */
+      yyjson_read_flag flags;
+  /** The bytes of the document being received, and any after it. */
+  char* buf;
+  size_t len;
+  size_t cap;
+  /** The number of bytes of buf that have been scanned. */
+  size_t scanned;
+  /** The number of bytes dropped from the front of buf so far. */
+  size_t consumed;
+  /** The state of the scanner at buf + scanned. */
+  IncrState state;
+  /** The number of containers the scanner is inside of. */
+  Py_ssize_t depth;
+  /** Whether a document has started, at buf + start. */
+  bool in_value;
+  size_t start;
+  /** Whether the document is a bare number or literal, like 12 or true. */
+  bool scalar;
+  /** Documents parsed by the current scan, allocated without the GIL. */
+  yyjson_doc** docs;
+  size_t n_docs;
+  size_t docs_cap;
+  /** Why the current scan failed, and where in the whole input. */
+  yyjson_read_err err;
+  size_t err_pos;
+  /** Documents completed but not yet returned, due to a later error. */
+  PyObject* ready;
+  /** Whether feed() is running, possibly without the GIL. */
+  bool busy;
+  /** Whether close() was called. */
+  bool closed;
+} IncrementalParserObject;
+
+extern PyTypeObject IncrementalParserType;
+
+#endif
@@ -0,0 +1,1600 @@
+#include "jsonpath.h"
+
+/** The largest integer allowed in a JSONPath index or slice (I-JSON). */
+#define JP_MAX_INT 9007199254740991LL
+
+typedef enum {
+  JP_SEL_NAME,
+  JP_SEL_WILDCARD,
+  JP_SEL_INDEX,
+  JP_SEL_SLICE,
+  JP_SEL_FILTER
+} JPSelectorKind;
+
+typedef enum {
+  JP_EXPR_OR,
+  JP_EXPR_AND,
+  JP_EXPR_NOT,
+  JP_EXPR_CMP,
+  JP_EXPR_QUERY,
+  JP_EXPR_FUNC,
+  JP_EXPR_LITERAL
+} JPExprKind;
+
+typedef enum {
+  JP_CMP_EQ,
+  JP_CMP_NE,
+  JP_CMP_LT,
+  JP_CMP_LE,
+  JP_CMP_GT,
+  JP_CMP_GE
+} JPCmpOp;
+
+typedef enum {
+  JP_FN_LENGTH,
+  JP_FN_COUNT,
+  JP_FN_VALUE,
+  JP_FN_MATCH,
+  JP_FN_SEARCH
+} JPFunc;
+
+/**
+ * The result of evaluating a comparable. Scalars are unpacked, arrays and
+ * objects are kept as a reference to their node.
+ */
+typedef enum {
+  JP_NOTHING,
+  JP_NULL,
+  JP_TRUE,
+  JP_FALSE,
+  JP_INT,
+  JP_REAL,
+  JP_STR,
+  JP_NODE
+} JPValueKind;
+
+typedef struct {
+  JPValueKind kind;
+  int64_t i;
+  double d;
+  const char *str;
+  size_t len;
+  void *node;
+} JPValue;
+
+typedef struct JPExpr JPExpr;
+
+typedef struct {
+  JPSelectorKind kind;
+  /** JP_SEL_NAME: the unescaped member name. */
+  const char *name;
+  size_t name_len;
+  /** JP_SEL_INDEX: the index, JP_SEL_SLICE: start, end and step. */
+  int64_t index;
+  int64_t end;
+  int64_t step;
+  bool has_start;
+  bool has_end;
+  /** JP_SEL_FILTER: the logical expression. */
+  JPExpr *filter;
+} JPSelector;
+
+typedef struct {
+  bool descendant;
+  JPSelector *selectors;
+  Py_ssize_t num_selectors;
+} JPSegment;
+
+struct JPQuery {
+  /** Whether the query starts at the current node (@) or the root ($). */
+  bool relative;
+  /** Whether the query can select at most one node. */
+  bool singular;
+  JPSegment *segments;
+  Py_ssize_t num_segments;
+};
+
+struct JPExpr {
+  JPExprKind kind;
+  /** JP_EXPR_OR, JP_EXPR_AND, JP_EXPR_CMP operands, JP_EXPR_NOT operand. */
+  JPExpr *lhs;
+  JPExpr *rhs;
+  JPCmpOp op;
+  /** JP_EXPR_QUERY */
+  JPQuery *query;
+  /** JP_EXPR_FUNC */
+  JPFunc func;
+  JPExpr *args[2];
+  /** JP_EXPR_LITERAL */
+  JPValue literal;
+};
+
+typedef struct {
+  JSONPathObject *self;
+  const char *start;
+  const char *cur;
+  const char *end;
+} JPParser;
+
+typedef struct {
+  bool mut;
+  void *root;
+} JPContext;
+
+/**
+ * A single arena allocation, followed by its (suitably aligned) data.
+ */
+typedef union JPArenaBlock {
+  union JPArenaBlock *next;
+  double _align_d;
+  long long _align_ll;
+  void *_align_p;
+} JPArenaBlock;
+
+static PyObject *re_fullmatch = NULL;
+static PyObject *re_search = NULL;
+static PyObject *re_error = NULL;
+
+static JPExpr *jp_parse_or(JPParser *p);
+static int jp_test(JPContext *ctx, JPExpr *e, void *current);
+
+/*==============================================================================
+ * Compilation
+ *============================================================================*/
+
+static void *jp_alloc(JSONPathObject *self, size_t size) {
+  JPArenaBlock *block = PyMem_Calloc(1, sizeof(JPArenaBlock) + size);
+  if (!block) {
+    PyErr_NoMemory();
+    return NULL;
+  }
+  block->next = self->arena;
+  self->arena = block;
+  return block + 1;
+}
+
+/**
+ * Grow an arena-allocated array to hold at least one more element.
+ */
+static bool jp_grow(
+    JSONPathObject *self, void **items, Py_ssize_t len, Py_ssize_t *cap,
+    size_t size
+) {
+  if (len < *cap) return true;
+
+  Py_ssize_t new_cap = *cap ? *cap * 2 : 4;
+  void *new_items = jp_alloc(self, size * new_cap);
+  if (!new_items) return false;
+
+  if (len) memcpy(new_items, *items, size * len);
+  *items = new_items;
+  *cap = new_cap;
+  return true;
+}
+
+static void *jp_error(JPParser *p, const char *msg) {
+  if (!PyErr_Occurred()) {
+    PyErr_Format(
+        PyExc_ValueError, "Invalid JSONPath at position %zd: %s",
+        (Py_ssize_t)(p->cur - p->start), msg
+    );
+  }
+  return NULL;
+}
+
+static inline bool jp_peek(JPParser *p, char c) {
+  return p->cur < p->end && *p->cur == c;
+}
+
+static inline bool jp_match(JPParser *p, const char *lit) {
+  size_t len = strlen(lit);
+  if ((size_t)(p->end - p->cur) >= len && memcmp(p->cur, lit, len) == 0) {
+    p->cur += len;
+    return true;
+  }
+  return false;
+}
+
+static inline void jp_skip_space(JPParser *p) {
+  while (p->cur < p->end &&
+         (*p->cur == ' ' || *p->cur == '\t' || *p->cur == '\n' ||
+          *p->cur == '\r')) {
+    p->cur++;
+  }
+}
+
+static inline bool jp_is_digit(JPParser *p) {
+  return p->cur < p->end && *p->cur >= '0' && *p->cur <= '9';
+}
+
+static inline bool jp_is_name_first(char c) {
+  unsigned char u = (unsigned char)c;
+  return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_' ||
+         u >= 0x80;
+}
+
+static inline bool jp_is_name_char(char c) {
+  return jp_is_name_first(c) || (c >= '0' && c <= '9');
+}
+
+static inline bool jp_is_function_char(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool jp_parse_hex4(JPParser *p, uint32_t *out) {
+  uint32_t value = 0;
+
+  if (p->end - p->cur < 4) {
+    jp_error(p, "truncated unicode escape");
+    return false;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    char c = *p->cur++;
+    value <<= 4;
+    if (c >= '0' && c <= '9') {
+      value |= (uint32_t)(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      value |= (uint32_t)(c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'F') {
+      value |= (uint32_t)(c - 'A' + 10);
+    } else {
+      p->cur--;
+      jp_error(p, "invalid unicode escape");
+      return false;
+    }
+  }
+
+  *out = value;
+  return true;
+}
+
+/**
+ * Parse a single or double quoted string literal, unescaping it into the
+ * arena as UTF-8.
+ */
+static bool jp_parse_string(JPParser *p, const char **out, size_t *out_len) {
+  char quote = *p->cur++;
+  char *buf = jp_alloc(p->self, (size_t)(p->end - p->cur) + 1);
+  char *dst = buf;
+
+  if (!buf) return false;
+
+  while (p->cur < p->end) {
+    char c = *p->cur;
+
+    if (c == quote) {
+      p->cur++;
+      *out = buf;
+      *out_len = (size_t)(dst - buf);
+      return true;
+    }
+
+    if ((unsigned char)c < 0x20) {
+      jp_error(p, "unescaped control character in string");
+      return false;
+    }
+
+    if (c != '\\') {
+      *dst++ = c;
+      p->cur++;
+      continue;
+    }
+
+    if (++p->cur >= p->end) break;
+
+    switch (*p->cur++) {
+      case 'b': *dst++ = '\b'; break;
+      case 'f': *dst++ = '\f'; break;
+      case 'n': *dst++ = '\n'; break;
+      case 'r': *dst++ = '\r'; break;
+      case 't': *dst++ = '\t'; break;
+      case '/': *dst++ = '/'; break;
+      case '\\': *dst++ = '\\'; break;
+      case '\'':
+        if (quote != '\'') goto invalid;
+        *dst++ = '\'';
+        break;
+      case '"':
+        if (quote != '"') goto invalid;
+        *dst++ = '"';
+        break;
+      case 'u': {
+        uint32_t cp;
+        if (!jp_parse_hex4(p, &cp)) return false;
+
+        if (cp >= 0xDC00 && cp <= 0xDFFF) {
+          jp_error(p, "unpaired low surrogate in string");
+          return false;
+        }
+
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+          uint32_t low;
+          if (!jp_match(p, "\\u") || !jp_parse_hex4(p, &low) ||
+              low < 0xDC00 || low > 0xDFFF) {
+            jp_error(p, "unpaired high surrogate in string");
+            return false;
+          }
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        // The escape is always at least as long as its UTF-8 encoding, so
+        // this can never overrun the buffer.
+        if (cp < 0x80) {
+          *dst++ = (char)cp;
+        } else if (cp < 0x800) {
+          *dst++ = (char)(0xC0 | (cp >> 6));
+          *dst++ = (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+          *dst++ = (char)(0xE0 | (cp >> 12));
+          *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+          *dst++ = (char)(0x80 | (cp & 0x3F));
+        } else {
+          *dst++ = (char)(0xF0 | (cp >> 18));
+          *dst++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+          *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+          *dst++ = (char)(0x80 | (cp & 0x3F));
+        }
+        break;
+      }
+      default:
+      invalid:
+        p->cur--;
+        jp_error(p, "invalid escape in string");
+        return false;
+    }
+  }
+
+  jp_error(p, "unterminated string");
+  return false;
+}
+
+/**
+ * Parse an integer as used by index and slice selectors.
+ */
+static bool jp_parse_int(JPParser *p, int64_t *out) {
+  bool negative = jp_match(p, "-");
+  int64_t value = 0;
+
+  if (!jp_is_digit(p)) {
+    jp_error(p, "expected an integer");
+    return false;
+  }
+
+  if (*p->cur == '0') {
+    p->cur++;
+    if (negative || jp_is_digit(p)) {
+      jp_error(p, "invalid integer");
+      return false;
+    }
+    *out = 0;
+    return true;
+  }
+
+  while (jp_is_digit(p)) {
+    value = value * 10 + (*p->cur++ - '0');
+    if (value > JP_MAX_INT) {
+      jp_error(p, "integer out of range");
+      return false;
+    }
+  }
+
+  *out = negative ? -value : value;
+  return true;
+}
+
+/**
+ * Parse a number literal, as used in filter expressions.
+ */
+static bool jp_parse_number(JPParser *p, JPValue *out) {
+  const char *start = p->cur;
+  bool is_int = true;
+
+  jp_match(p, "-");
+
+  if (!jp_is_digit(p)) {
+    jp_error(p, "expected a number");
+    return false;
+  }
+
+  if (*p->cur == '0') {
+    p->cur++;
+    if (jp_is_digit(p)) {
+      jp_error(p, "leading zeros are not allowed");
+      return false;
+    }
+  } else {
+    while (jp_is_digit(p)) p->cur++;
+  }
+
+  if (jp_match(p, ".")) {
+    is_int = false;
+    if (!jp_is_digit(p)) {
+      jp_error(p, "expected a digit");
+      return false;
+    }
+    while (jp_is_digit(p)) p->cur++;
+  }
+
+  if (jp_match(p, "e") || jp_match(p, "E")) {
+    is_int = false;
+    if (!jp_match(p, "+")) jp_match(p, "-");
+    if (!jp_is_digit(p)) {
+      jp_error(p, "expected a digit");
+      return false;
+    }
+    while (jp_is_digit(p)) p->cur++;
+  }
+
+  size_t len = (size_t)(p->cur - start);
+
+  if (is_int && len <= 18) {
+    int64_t value = 0;
+    for (const char *c = start + (*start == '-'); c < p->cur; c++) {
+      value = value * 10 + (*c - '0');
+    }
+    out->kind = JP_INT;
+    out->i = *start == '-' ? -value : value;
+    return true;
+  }
+
+  char *buf = jp_alloc(p->self, len + 1);
+  if (!buf) return false;
+  memcpy(buf, start, len);
+
+  double value = PyOS_string_to_double(buf, NULL, NULL);
+  if (value == -1.0 && PyErr_Occurred()) return false;
+
+  out->kind = JP_REAL;
+  out->d = value;
+  return true;
+}
+
+static bool jp_parse_selector(JPParser *p, JPSelector *sel) {
+  if (p->cur >= p->end) {
+    jp_error(p, "expected a selector");
+    return false;
+  }
+
+  char c = *p->cur;
+
+  if (c == '\'' || c == '"') {
+    sel->kind = JP_SEL_NAME;
+    return jp_parse_string(p, &sel->name, &sel->name_len);
+  }
+
+  if (c == '*') {
+    p->cur++;
+    sel->kind = JP_SEL_WILDCARD;
+    return true;
+  }
+
+  if (c == '?') {
+    p->cur++;
+    jp_skip_space(p);
+    sel->kind = JP_SEL_FILTER;
+    sel->filter = jp_parse_or(p);
+    return sel->filter != NULL;
+  }
+
+  if (c != '-' && c != ':' && !jp_is_digit(p)) {
+    jp_error(p, "expected a selector");
+    return false;
+  }
+
+  if (c != ':') {
+    if (!jp_parse_int(p, &sel->index)) return false;
+    sel->has_start = true;
+    jp_skip_space(p);
+  }
+
+  if (!jp_match(p, ":")) {
+    sel->kind = JP_SEL_INDEX;
+    return true;
+  }
+
+  sel->kind = JP_SEL_SLICE;
+  sel->step = 1;
+
+  jp_skip_space(p);
+  if (jp_peek(p, '-') || jp_is_digit(p)) {
+    if (!jp_parse_int(p, &sel->end)) return false;
+    sel->has_end = true;
+    jp_skip_space(p);
+  }
+
+  if (jp_match(p, ":")) {
+    jp_skip_space(p);
+    if (jp_peek(p, '-') || jp_is_digit(p)) {
+      if (!jp_parse_int(p, &sel->step)) return false;
+    }
+  }
+
+  return true;
+}
+
+static bool jp_add_selector(
+    JPParser *p, JPSegment *seg, Py_ssize_t *cap, JPSelector **sel
+) {
+  if (!jp_grow(
+          p->self, (void **)&seg->selectors, seg->num_selectors, cap,
+          sizeof(JPSelector)
+      )) {
+    return false;
+  }
+  *sel = &seg->selectors[seg->num_selectors++];
+  return true;
+}
+
+/**
+ * Parse a dot-notation member name or wildcard following "." or "..".
+ */
+static bool jp_parse_shorthand(JPParser *p, JPSegment *seg) {
+  Py_ssize_t cap = 0;
+  JPSelector *sel;
+
+  if (!jp_add_selector(p, seg, &cap, &sel)) return false;
+
+  if (jp_match(p, "*")) {
+    sel->kind = JP_SEL_WILDCARD;
+    return true;
+  }
+
+  if (p->cur >= p->end || !jp_is_name_first(*p->cur)) {
+    jp_error(p, "expected a member name or wildcard");
+    return false;
+  }
+
+  sel->kind = JP_SEL_NAME;
+  sel->name = p->cur;
+  while (p->cur < p->end && jp_is_name_char(*p->cur)) p->cur++;
+  sel->name_len = (size_t)(p->cur - sel->name);
+  return true;
+}
+
+static bool jp_parse_bracketed(JPParser *p, JPSegment *seg) {
+  Py_ssize_t cap = 0;
+  JPSelector *sel;
+
+  p->cur++;  // '['
+  jp_skip_space(p);
+
+  while (true) {
+    if (!jp_add_selector(p, seg, &cap, &sel)) return false;
+    if (!jp_parse_selector(p, sel)) return false;
+
+    jp_skip_space(p);
+    if (jp_match(p, "]")) return true;
+    if (!jp_match(p, ",")) {
+      jp_error(p, "expected ',' or ']'");
+      return false;
+    }
+    jp_skip_space(p);
+  }
+}
+
+static bool jp_parse_segment(JPParser *p, JPSegment *seg) {
+  if (jp_match(p, "..")) {
+    seg->descendant = true;
+    if (jp_peek(p, '[')) return jp_parse_bracketed(p, seg);
+    return jp_parse_shorthand(p, seg);
+  }
+
+  if (jp_match(p, ".")) {
+    return jp_parse_shorthand(p, seg);
+  }
+
+  return jp_parse_bracketed(p, seg);
+}
+
+/**
+ * Parse a query starting with "$" or "@".
+ */
+static JPQuery *jp_parse_query(JPParser *p) {
+  JPQuery *q = jp_alloc(p->self, sizeof(JPQuery));
+  Py_ssize_t cap = 0;
+
+  if (!q) return NULL;
+
+  q->relative = *p->cur++ == '@';
+  q->singular = true;
+
+  while (true) {
+    const char *save = p->cur;
+    jp_skip_space(p);
+
+    if (!jp_peek(p, '.') && !jp_peek(p, '[')) {
+      p->cur = save;
+      return q;
+    }
+
+    if (!jp_grow(
+            p->self, (void **)&q->segments, q->num_segments, &cap,
+            sizeof(JPSegment)
+        )) {
+      return NULL;
+    }
+
+    JPSegment *seg = &q->segments[q->num_segments++];
+    if (!jp_parse_segment(p, seg)) return NULL;
+
+    if (seg->descendant || seg->num_selectors != 1 ||
+        (seg->selectors[0].kind != JP_SEL_NAME &&
+         seg->selectors[0].kind != JP_SEL_INDEX)) {
+      q->singular = false;
+    }
+  }
+}
+
+static JPExpr *jp_new_expr(JPParser *p, JPExprKind kind) {
+  JPExpr *e = jp_alloc(p->self, sizeof(JPExpr));
+  if (e) e->kind = kind;
+  return e;
+}
+
+/**
+ * Whether the expression produces a single value that can be compared or
+ * passed to a function expecting a value.
+ */
+static bool jp_is_value_expr(JPExpr *e) {
+  switch (e->kind) {
+    case JP_EXPR_LITERAL:
+      return true;
+    case JP_EXPR_QUERY:
+      return e->query->singular;
+    case JP_EXPR_FUNC:
+      return e->func == JP_FN_LENGTH || e->func == JP_FN_COUNT ||
+             e->func == JP_FN_VALUE;
+    default:
+      return false;
+  }
+}
+
+static JPExpr *jp_parse_comparable(JPParser *p);
+
+static JPExpr *jp_parse_function(JPParser *p) {
+  static const struct {
+    const char *name;
+    JPFunc func;
+    int num_args;
+  } functions[] = {
+      {"length", JP_FN_LENGTH, 1}, {"count", JP_FN_COUNT, 1},
+      {"value", JP_FN_VALUE, 1},   {"match", JP_FN_MATCH, 2},
+      {"search", JP_FN_SEARCH, 2},
+  };
+
+  const char *name = p->cur;
+  while (p->cur < p->end && jp_is_function_char(*p->cur)) p->cur++;
+  size_t name_len = (size_t)(p->cur - name);
+
+  JPExpr *e = jp_new_expr(p, JP_EXPR_FUNC);
+  int num_args = -1;
+  if (!e) return NULL;
+
+  for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+    if (strlen(functions[i].name) == name_len &&
+        memcmp(functions[i].name, name, name_len) == 0) {
+      e->func = functions[i].func;
+      num_args = functions[i].num_args;
+      break;
+    }
+  }
+
+  if (num_args < 0) {
+    p->cur = name;
+    return jp_error(p, "unknown function");
+  }
+
+  if (!jp_match(p, "(")) return jp_error(p, "expected '('");
+
+  for (int i = 0; i < num_args; i++) {
+    jp_skip_space(p);
+    if (i > 0) {
+      if (!jp_match(p, ",")) return jp_error(p, "expected ','");
+      jp_skip_space(p);
+    }
+
+    const char *arg_start = p->cur;
+    e->args[i] = jp_parse_comparable(p);
+    if (!e->args[i]) return NULL;
+
+    bool nodes_arg = e->func == JP_FN_COUNT || e->func == JP_FN_VALUE;
+    bool well_typed = nodes_arg ? e->args[i]->kind == JP_EXPR_QUERY
+                                : jp_is_value_expr(e->args[i]);
+    if (!well_typed) {
+      p->cur = arg_start;
+      return jp_error(
+          p, nodes_arg ? "function argument must be a query"
+                       : "function argument must be a single value"
+      );
+    }
+  }
+
+  jp_skip_space(p);
+  if (!jp_match(p, ")")) return jp_error(p, "expected ')'");
+  return e;
+}
+
+/**
+ * Parse a literal, query or function call.
+ */
+static JPExpr *jp_parse_comparable(JPParser *p) {
+  JPExpr *e;
+
+  if (p->cur >= p->end) return jp_error(p, "unexpected end of expression");
+
+  char c = *p->cur;
+
+  if (c == '$' || c == '@') {
+    e = jp_new_expr(p, JP_EXPR_QUERY);
+    if (!e || !(e->query = jp_parse_query(p))) return NULL;
+    return e;
+  }
+
+  if (c == '\'' || c == '"') {
+    e = jp_new_expr(p, JP_EXPR_LITERAL);
+    if (!e) return NULL;
+    e->literal.kind = JP_STR;
+    if (!jp_parse_string(p, &e->literal.str, &e->literal.len)) return NULL;
+    return e;
+  }
+
+  if (c == '-' || jp_is_digit(p)) {
+    e = jp_new_expr(p, JP_EXPR_LITERAL);
+    if (!e || !jp_parse_number(p, &e->literal)) return NULL;
+    return e;
+  }
+
+  static const struct {
+    const char *name;
+    JPValueKind kind;
+  } keywords[] = {
+      {"true", JP_TRUE}, {"false", JP_FALSE}, {"null", JP_NULL}};
+
+  for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+    const char *save = p->cur;
+    if (jp_match(p, keywords[i].name)) {
+      if (p->cur < p->end && jp_is_function_char(*p->cur)) {
+        p->cur = save;
+        continue;
+      }
+      e = jp_new_expr(p, JP_EXPR_LITERAL);
+      if (!e) return NULL;
+      e->literal.kind = keywords[i].kind;
+      return e;
+    }
+  }
+
+  if (c >= 'a' && c <= 'z') {
+    return jp_parse_function(p);
+  }
+
+  return jp_error(p, "expected a literal, query or function");
+}
+
+static bool jp_parse_cmp_op(JPParser *p, JPCmpOp *op) {
+  if (jp_match(p, "==")) {
+    *op = JP_CMP_EQ;
+  } else if (jp_match(p, "!=")) {
+    *op = JP_CMP_NE;
+  } else if (jp_match(p, "<=")) {
+    *op = JP_CMP_LE;
+  } else if (jp_match(p, ">=")) {
+    *op = JP_CMP_GE;
+  } else if (jp_match(p, "<")) {
+    *op = JP_CMP_LT;
+  } else if (jp_match(p, ">")) {
+    *op = JP_CMP_GT;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static JPExpr *jp_parse_paren(JPParser *p) {
+  p->cur++;  // '('
+  jp_skip_space(p);
+
+  JPExpr *e = jp_parse_or(p);
+  if (!e) return NULL;
+
+  jp_skip_space(p);
+  if (!jp_match(p, ")")) return jp_error(p, "expected ')'");
+  return e;
+}
+
+/**
+ * Whether the expression can be used on its own as a filter test.
+ */
+static bool jp_is_test_expr(JPExpr *e) {
+  return e->kind == JP_EXPR_QUERY ||
+         (e->kind == JP_EXPR_FUNC &&
+          (e->func == JP_FN_MATCH || e->func == JP_FN_SEARCH));
+}
+
+static JPExpr *jp_parse_basic(JPParser *p) {
+  const char *start = p->cur;
+
+  if (jp_match(p, "!")) {
+    JPExpr *e = jp_new_expr(p, JP_EXPR_NOT);
+    if (!e) return NULL;
+
+    jp_skip_space(p);
+    start = p->cur;
+
+    if (jp_peek(p, '(')) {
+      e->lhs = jp_parse_paren(p);
+    } else {
+      e->lhs = jp_parse_comparable(p);
+      if (e->lhs && !jp_is_test_expr(e->lhs)) {
+        p->cur = start;
+        return jp_error(p, "expected a query or logical function");
+      }
+    }
+
+    return e->lhs ? e : NULL;
+  }
+
+  if (jp_peek(p, '(')) {
+    return jp_parse_paren(p);
+  }
+
+  JPExpr *lhs = jp_parse_comparable(p);
+  if (!lhs) return NULL;
+
+  const char *save = p->cur;
+  JPCmpOp op;
+  jp_skip_space(p);
+
+  if (!jp_parse_cmp_op(p, &op)) {
+    p->cur = save;
+    if (!jp_is_test_expr(lhs)) {
+      p->cur = start;
+      return jp_error(p, "expected a comparison or test");
+    }
+    return lhs;
+  }
+
+  if (!jp_is_value_expr(lhs)) {
+    p->cur = start;
+    return jp_error(p, "only single values can be compared");
+  }
+
+  jp_skip_space(p);
+  start = p->cur;
+
+  JPExpr *rhs = jp_parse_comparable(p);
+  if (!rhs) return NULL;
+
+  if (!jp_is_value_expr(rhs)) {
+    p->cur = start;
+    return jp_error(p, "only single values can be compared");
+  }
+
+  JPExpr *e = jp_new_expr(p, JP_EXPR_CMP);
+  if (!e) return NULL;
+  e->op = op;
+  e->lhs = lhs;
+  e->rhs = rhs;
+  return e;
+}
+
+static JPExpr *jp_parse_binary(
+    JPParser *p, const char *op, JPExprKind kind, JPExpr *(*operand)(JPParser *)
+) {
+  JPExpr *lhs = operand(p);
+  if (!lhs) return NULL;
+
+  while (true) {
+    const char *save = p->cur;
+    jp_skip_space(p);
+
+    if (!jp_match(p, op)) {
+      p->cur = save;
+      return lhs;
+    }
+
+    jp_skip_space(p);
+    JPExpr *rhs = operand(p);
+    if (!rhs) return NULL;
+
+    JPExpr *e = jp_new_expr(p, kind);
+    if (!e) return NULL;
+    e->lhs = lhs;
+    e->rhs = rhs;
+    lhs = e;
+  }
+}
+
+static JPExpr *jp_parse_and(JPParser *p) {
+  return jp_parse_binary(p, "&&", JP_EXPR_AND, jp_parse_basic);
+}
+
+static JPExpr *jp_parse_or(JPParser *p) {
+  return jp_parse_binary(p, "||", JP_EXPR_OR, jp_parse_and);
+}
+
+JSONPathObject *jsonpath_compile(PyObject *source) {
+  Py_ssize_t len;
+  const char *str = PyUnicode_AsUTF8AndSize(source, &len);
+  if (!str) {
+    return NULL;
+  }
+
+  JSONPathObject *self =
+      (JSONPathObject *)JSONPathType.tp_alloc(&JSONPathType, 0);
+  if (!self) {
+    return NULL;
+  }
+
+  Py_INCREF(source);
+  self->source = source;
+
+  // Member names from shorthand selectors point directly into the query, so
+  // keep our own copy rather than relying on the str's UTF-8 cache.
+  char *copy = jp_alloc(self, (size_t)len + 1);
+  if (!copy) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  memcpy(copy, str, len);
+
+  JPParser p = {self, copy, copy, copy + len};
+
+  if (!jp_peek(&p, '$')) {
+    jp_error(&p, "query must start with '$'");
+    Py_DECREF(self);
+    return NULL;
+  }
+
+  self->query = jp_parse_query(&p);
+  if (self->query && p.cur != p.end) {
+    jp_error(&p, "unexpected character");
+  }
+
+  if (PyErr_Occurred()) {
+    Py_DECREF(self);
+    return NULL;
+  }
+
+  return self;
+}
+
+/*==============================================================================
+ * Evaluation
+ *============================================================================*/
+
+static int jp_push(JPNodeList *list, void *node) {
+  if (list->len == list->cap) {
+    Py_ssize_t cap = list->cap ? list->cap * 2 : 8;
+    void **items = PyMem_Realloc(list->items, sizeof(void *) * cap);
+    if (!items) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    list->items = items;
+    list->cap = cap;
+  }
+  list->items[list->len++] = node;
+  return 0;
+}
+
+void jsonpath_nodelist_free(JPNodeList *list) {
+  PyMem_Free(list->items);
+  memset(list, 0, sizeof(*list));
+}
+
+/**
+ * Append the children of an array or object to out. If with_keys is true,
+ * each object member is appended as its key followed by its value.
+ */
+static int jp_children(
+    JPContext *ctx, void *val, bool with_keys, JPNodeList *out
+) {
+  yyjson_type type = unsafe_yyjson_get_type(val);
+
+  if (ctx->mut) {
+    if (type == YYJSON_TYPE_ARR) {
+      yyjson_mut_arr_iter iter;
+      yyjson_mut_val *child;
+      yyjson_mut_arr_iter_init(val, &iter);
+      while ((child = yyjson_mut_arr_iter_next(&iter))) {
+        if (jp_push(out, child) < 0) return -1;
+      }
+    } else if (type == YYJSON_TYPE_OBJ) {
+      yyjson_mut_obj_iter iter;
+      yyjson_mut_val *key;
+      yyjson_mut_obj_iter_init(val, &iter);
+      while ((key = yyjson_mut_obj_iter_next(&iter))) {
+        if (with_keys && jp_push(out, key) < 0) return -1;
+        if (jp_push(out, yyjson_mut_obj_iter_get_val(key)) < 0) return -1;
+      }
+    }
+  } else {
+    if (type == YYJSON_TYPE_ARR) {
+      yyjson_arr_iter iter;
+      yyjson_val *child;
+      yyjson_arr_iter_init(val, &iter);
+      while ((child = yyjson_arr_iter_next(&iter))) {
+        if (jp_push(out, child) < 0) return -1;
+      }
+    } else if (type == YYJSON_TYPE_OBJ) {
+      yyjson_obj_iter iter;
+      yyjson_val *key;
+      yyjson_obj_iter_init(val, &iter);
+      while ((key = yyjson_obj_iter_next(&iter))) {
+        if (with_keys && jp_push(out, key) < 0) return -1;
+        if (jp_push(out, yyjson_obj_iter_get_val(key)) < 0) return -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static void *jp_member(JPContext *ctx, void *val, const char *key, size_t len) {
+  if (unsafe_yyjson_get_type(val) != YYJSON_TYPE_OBJ) return NULL;
+  if (ctx->mut) return yyjson_mut_obj_getn(val, key, len);
+  return yyjson_obj_getn(val, key, len);
+}
+
+static void *jp_element(JPContext *ctx, void *val, int64_t idx) {
+  if (unsafe_yyjson_get_type(val) != YYJSON_TYPE_ARR) return NULL;
+
+  int64_t len = (int64_t)unsafe_yyjson_get_len(val);
+  if (idx < 0) idx += len;
+  if (idx < 0 || idx >= len) return NULL;
+
+  if (ctx->mut) return yyjson_mut_arr_get(val, (size_t)idx);
+  return yyjson_arr_get(val, (size_t)idx);
+}
+
+static void jp_value_from_node(void *node, JPValue *out) {
+  memset(out, 0, sizeof(*out));
+
+  switch (unsafe_yyjson_get_type(node)) {
+    case YYJSON_TYPE_NULL:
+      out->kind = JP_NULL;
+      break;
+    case YYJSON_TYPE_BOOL:
+      out->kind = unsafe_yyjson_get_bool(node) ? JP_TRUE : JP_FALSE;
+      break;
+    case YYJSON_TYPE_NUM:
+      switch (unsafe_yyjson_get_subtype(node)) {
+        case YYJSON_SUBTYPE_UINT:
+          if (unsafe_yyjson_get_uint(node) <= INT64_MAX) {
+            out->kind = JP_INT;
+            out->i = (int64_t)unsafe_yyjson_get_uint(node);
+          } else {
+            out->kind = JP_REAL;
+            out->d = (double)unsafe_yyjson_get_uint(node);
+          }
+          break;
+        case YYJSON_SUBTYPE_SINT:
+          out->kind = JP_INT;
+          out->i = unsafe_yyjson_get_sint(node);
+          break;
+        default:
+          out->kind = JP_REAL;
+          out->d = unsafe_yyjson_get_real(node);
+          break;
+      }
+      break;
+    case YYJSON_TYPE_RAW:
+      // Raw numbers are only compared approximately, as doubles.
+      out->kind = JP_REAL;
+      out->d = PyOS_string_to_double(unsafe_yyjson_get_raw(node), NULL, NULL);
+      if (PyErr_Occurred()) {
+        PyErr_Clear();
+        out->kind = JP_NOTHING;
+      }
+      break;
+    case YYJSON_TYPE_STR:
+      out->kind = JP_STR;
+      out->str = unsafe_yyjson_get_str(node);
+      out->len = unsafe_yyjson_get_len(node);
+      break;
+    default:
+      out->kind = JP_NODE;
+      out->node = node;
+      break;
+  }
+}
+
+static int jp_nodes_equal(JPContext *ctx, void *a, void *b);
+
+static inline bool jp_is_number(const JPValue *v) {
+  return v->kind == JP_INT || v->kind == JP_REAL;
+}
+
+static int jp_values_equal(JPContext *ctx, JPValue *a, JPValue *b) {
+  if (jp_is_number(a) && jp_is_number(b)) {
+    if (a->kind == JP_INT && b->kind == JP_INT) return a->i == b->i;
+    double l = a->kind == JP_INT ? (double)a->i : a->d;
+    double r = b->kind == JP_INT ? (double)b->i : b->d;
+    return l == r;
+  }
+
+  if (a->kind != b->kind) return 0;
+
+  switch (a->kind) {
+    case JP_STR:
+      return a->len == b->len && memcmp(a->str, b->str, a->len) == 0;
+    case JP_NODE:
+      return jp_nodes_equal(ctx, a->node, b->node);
+    default:
+      return 1;
+  }
+}
+
+static bool jp_values_less(JPValue *a, JPValue *b) {
+  if (jp_is_number(a) && jp_is_number(b)) {
+    if (a->kind == JP_INT && b->kind == JP_INT) return a->i < b->i;
+    double l = a->kind == JP_INT ? (double)a->i : a->d;
+    double r = b->kind == JP_INT ? (double)b->i : b->d;
+    return l < r;
+  }
+
+  if (a->kind == JP_STR && b->kind == JP_STR) {
+    size_t len = a->len < b->len ? a->len : b->len;
+    int r = memcmp(a->str, b->str, len);
+    return r < 0 || (r == 0 && a->len < b->len);
+  }
+
+  return false;
+}
+
+/**
+ * Deep equality between two nodes of the same document, comparing numbers
+ * by value (so 1 == 1.0).
+ */
+static int jp_nodes_equal(JPContext *ctx, void *a, void *b) {
+  JPValue va, vb;
+  jp_value_from_node(a, &va);
+  jp_value_from_node(b, &vb);
+
+  if (va.kind != JP_NODE || vb.kind != JP_NODE) {
+    return jp_values_equal(ctx, &va, &vb);
+  }
+
+  yyjson_type type = unsafe_yyjson_get_type(a);
+  if (type != unsafe_yyjson_get_type(b) ||
+      unsafe_yyjson_get_len(a) != unsafe_yyjson_get_len(b)) {
+    return 0;
+  }
+
+  JPNodeList lhs = {0}, rhs = {0};
+  int result = 1;
+
+  if (type == YYJSON_TYPE_ARR) {
+    if (jp_children(ctx, a, false, &lhs) < 0 ||
+        jp_children(ctx, b, false, &rhs) < 0) {
+      result = -1;
+      goto done;
+    }
+    for (Py_ssize_t i = 0; i < lhs.len && result == 1; i++) {
+      result = jp_nodes_equal(ctx, lhs.items[i], rhs.items[i]);
+    }
+  } else {
+    if (jp_children(ctx, a, true, &lhs) < 0) {
+      result = -1;
+      goto done;
+    }
+    for (Py_ssize_t i = 0; i < lhs.len && result == 1; i += 2) {
+      void *other = jp_member(
+          ctx, b, unsafe_yyjson_get_str(lhs.items[i]),
+          unsafe_yyjson_get_len(lhs.items[i])
+      );
+      result = other ? jp_nodes_equal(ctx, lhs.items[i + 1], other) : 0;
+    }
+  }
+
+done:
+  jsonpath_nodelist_free(&lhs);
+  jsonpath_nodelist_free(&rhs);
+  return result;
+}
+
+static int jp_apply_query(
+    JPContext *ctx, JPQuery *q, void *current, JPNodeList *out
+);
+
+/**
+ * Evaluate a singular query, returning the selected node or NULL.
+ */
+static void *jp_singular(JPContext *ctx, JPQuery *q, void *current) {
+  void *node = q->relative ? current : ctx->root;
+
+  for (Py_ssize_t i = 0; i < q->num_segments && node; i++) {
+    JPSelector *sel = &q->segments[i].selectors[0];
+    if (sel->kind == JP_SEL_NAME) {
+      node = jp_member(ctx, node, sel->name, sel->name_len);
+    } else {
+      node = jp_element(ctx, node, sel->index);
+    }
+  }
+
+  return node;
+}
+
+/**
+ * Call re.fullmatch or re.search for the match() and search() functions.
+ */
+static int jp_regex(JPFunc func, JPValue *value, JPValue *pattern) {
+  if (value->kind != JP_STR || pattern->kind != JP_STR) return 0;
+
+  if (!re_fullmatch) {
+    PyObject *re = PyImport_ImportModule("re");
+    if (!re) return -1;
+    re_fullmatch = PyObject_GetAttrString(re, "fullmatch");
+    re_search = PyObject_GetAttrString(re, "search");
+    re_error = PyObject_GetAttrString(re, "error");
+    Py_DECREF(re);
+    if (!re_fullmatch || !re_search || !re_error) {
+      Py_CLEAR(re_fullmatch);
+      Py_CLEAR(re_search);
+      Py_CLEAR(re_error);
+      return -1;
+    }
+  }
+
+  PyObject *py_pattern = PyUnicode_DecodeUTF8(pattern->str, pattern->len, NULL);
+  PyObject *py_value = PyUnicode_DecodeUTF8(value->str, value->len, NULL);
+  PyObject *match = NULL;
+  int result = -1;
+
+  if (py_pattern && py_value) {
+    match = PyObject_CallFunctionObjArgs(
+        func == JP_FN_MATCH ? re_fullmatch : re_search, py_pattern, py_value,
+        NULL
+    );
+    if (match) {
+      result = match != Py_None;
+    } else if (PyErr_ExceptionMatches(re_error)) {
+      // An invalid pattern never matches.
+      PyErr_Clear();
+      result = 0;
+    }
+  }
+
+  Py_XDECREF(match);
+  Py_XDECREF(py_pattern);
+  Py_XDECREF(py_value);
+  return result;
+}
+
+static int jp_value(JPContext *ctx, JPExpr *e, void *current, JPValue *out) {
+  memset(out, 0, sizeof(*out));
+
+  if (e->kind == JP_EXPR_LITERAL) {
+    *out = e->literal;
+    return 0;
+  }
+
+  if (e->kind == JP_EXPR_QUERY) {
+    void *node = jp_singular(ctx, e->query, current);
+    if (node) jp_value_from_node(node, out);
+    return 0;
+  }
+
+  switch (e->func) {
+    case JP_FN_LENGTH: {
+      JPValue arg;
+      if (jp_value(ctx, e->args[0], current, &arg) < 0) return -1;
+
+      if (arg.kind == JP_STR) {
+        out->kind = JP_INT;
+        for (size_t i = 0; i < arg.len; i++) {
+          if (((unsigned char)arg.str[i] & 0xC0) != 0x80) out->i++;
+        }
+      } else if (arg.kind == JP_NODE) {
+        out->kind = JP_INT;
+        out->i = (int64_t)unsafe_yyjson_get_len(arg.node);
+      }
+      return 0;
+    }
+    case JP_FN_COUNT:
+    case JP_FN_VALUE: {
+      JPNodeList nodes = {0};
+      if (jp_apply_query(ctx, e->args[0]->query, current, &nodes) < 0) {
+        jsonpath_nodelist_free(&nodes);
+        return -1;
+      }
+
+      if (e->func == JP_FN_COUNT) {
+        out->kind = JP_INT;
+        out->i = nodes.len;
+      } else if (nodes.len == 1) {
+        jp_value_from_node(nodes.items[0], out);
+      }
+
+      jsonpath_nodelist_free(&nodes);
+      return 0;
+    }
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Evaluate a logical expression, returning 1 if it is true, 0 if it is
+ * false, and -1 on error.
+ */
+static int jp_test(JPContext *ctx, JPExpr *e, void *current) {
+  int r;
+
+  switch (e->kind) {
+    case JP_EXPR_OR:
+      r = jp_test(ctx, e->lhs, current);
+      return r != 0 ? r : jp_test(ctx, e->rhs, current);
+    case JP_EXPR_AND:
+      r = jp_test(ctx, e->lhs, current);
+      return r != 1 ? r : jp_test(ctx, e->rhs, current);
+    case JP_EXPR_NOT:
+      r = jp_test(ctx, e->lhs, current);
+      return r < 0 ? r : !r;
+    case JP_EXPR_QUERY: {
+      if (e->query->singular) {
+        return jp_singular(ctx, e->query, current) != NULL;
+      }
+
+      JPNodeList nodes = {0};
+      r = jp_apply_query(ctx, e->query, current, &nodes);
+      if (r == 0) r = nodes.len > 0;
+      jsonpath_nodelist_free(&nodes);
+      return r;
+    }
+    case JP_EXPR_FUNC: {
+      JPValue value, pattern;
+      if (jp_value(ctx, e->args[0], current, &value) < 0 ||
+          jp_value(ctx, e->args[1], current, &pattern) < 0) {
+        return -1;
+      }
+      return jp_regex(e->func, &value, &pattern);
+    }
+    case JP_EXPR_CMP: {
+      JPValue lhs, rhs;
+      if (jp_value(ctx, e->lhs, current, &lhs) < 0 ||
+          jp_value(ctx, e->rhs, current, &rhs) < 0) {
+        return -1;
+      }
+
+      switch (e->op) {
+        case JP_CMP_EQ:
+          return jp_values_equal(ctx, &lhs, &rhs);
+        case JP_CMP_NE:
+          r = jp_values_equal(ctx, &lhs, &rhs);
+          return r < 0 ? r : !r;
+        case JP_CMP_LT:
+          return jp_values_less(&lhs, &rhs);
+        case JP_CMP_GT:
+          return jp_values_less(&rhs, &lhs);
+        case JP_CMP_LE:
+          if (jp_values_less(&lhs, &rhs)) return 1;
+          return jp_values_equal(ctx, &lhs, &rhs);
+        case JP_CMP_GE:
+          if (jp_values_less(&rhs, &lhs)) return 1;
+          return jp_values_equal(ctx, &lhs, &rhs);
+      }
+      return 0;
+    }
+    default:
+      return 0;
+  }
+}
+
+static int jp_select_slice(
+    JPContext *ctx, JPSelector *sel, void *node, JPNodeList *out
+) {
+  if (sel->step == 0 || unsafe_yyjson_get_type(node) != YYJSON_TYPE_ARR) {
+    return 0;
+  }
+
+  int64_t len = (int64_t)unsafe_yyjson_get_len(node);
+  int64_t step = sel->step;
+  int64_t start = sel->has_start ? sel->index : (step > 0 ? 0 : len - 1);
+  int64_t end = sel->has_end ? sel->end : (step > 0 ? len : -len - 1);
+
+  if (start < 0) start += len;
+  if (end < 0) end += len;
+
+  JPNodeList children = {0};
+  if (jp_children(ctx, node, false, &children) < 0) {
+    jsonpath_nodelist_free(&children);
+    return -1;
+  }
+
+  int r = 0;
+
+  if (step > 0) {
+    int64_t lower = start < 0 ? 0 : (start > len ? len : start);
+    int64_t upper = end < 0 ? 0 : (end > len ? len : end);
+    for (int64_t i = lower; i < upper && r == 0; i += step) {
+      r = jp_push(out, children.items[i]);
+    }
+  } else {
+    int64_t upper = start < -1 ? -1 : (start > len - 1 ? len - 1 : start);
+    int64_t lower = end < -1 ? -1 : (end > len - 1 ? len - 1 : end);
+    for (int64_t i = upper; lower < i && r == 0; i += step) {
+      r = jp_push(out, children.items[i]);
+    }
+  }
+
+  jsonpath_nodelist_free(&children);
+  return r;
+}
+
+static int jp_select(
+    JPContext *ctx, JPSelector *sel, void *node, JPNodeList *out
+) {
+  void *child;
+
+  switch (sel->kind) {
+    case JP_SEL_NAME:
+      child = jp_member(ctx, node, sel->name, sel->name_len);
+      return child ? jp_push(out, child) : 0;
+    case JP_SEL_INDEX:
+      child = jp_element(ctx, node, sel->index);
+      return child ? jp_push(out, child) : 0;
+    case JP_SEL_WILDCARD:
+      return jp_children(ctx, node, false, out);
+    case JP_SEL_SLICE:
+      return jp_select_slice(ctx, sel, node, out);
+    case JP_SEL_FILTER: {
+      JPNodeList children = {0};
+      int r = jp_children(ctx, node, false, &children);
+
+      for (Py_ssize_t i = 0; i < children.len && r == 0; i++) {
+        r = jp_test(ctx, sel->filter, children.items[i]);
+        if (r == 1) r = jp_push(out, children.items[i]);
+      }
+
+      jsonpath_nodelist_free(&children);
+      return r;
+    }
+  }
+
+  return 0;
+}
+
+static int jp_apply_segment(
+    JPContext *ctx, JPSegment *seg, void *node, JPNodeList *out
+) {
+  for (Py_ssize_t i = 0; i < seg->num_selectors; i++) {
+    if (jp_select(ctx, &seg->selectors[i], node, out) < 0) return -1;
+  }
+
+  if (!seg->descendant) {
+    return 0;
+  }
+
+  JPNodeList children = {0};
+  int r = jp_children(ctx, node, false, &children);
+
+  for (Py_ssize_t i = 0; i < children.len && r == 0; i++) {
+    r = jp_apply_segment(ctx, seg, children.items[i], out);
+  }
+
+  jsonpath_nodelist_free(&children);
+  return r;
+}
+
+static int jp_apply_query(
+    JPContext *ctx, JPQuery *q, void *current, JPNodeList *out
+) {
+  JPNodeList input = {0};
+
+  if (jp_push(&input, q->relative ? current : ctx->root) < 0) return -1;
+
+  for (Py_ssize_t i = 0; i < q->num_segments && input.len; i++) {
+    JPNodeList output = {0};
+
+    for (Py_ssize_t n = 0; n < input.len; n++) {
+      if (jp_apply_segment(ctx, &q->segments[i], input.items[n], &output) <
+          0) {
+        jsonpath_nodelist_free(&output);
+        jsonpath_nodelist_free(&input);
+        return -1;
+      }
+    }
+
+    jsonpath_nodelist_free(&input);
+    input = output;
+  }
+
+  for (Py_ssize_t n = 0; n < input.len; n++) {
+    if (jp_push(out, input.items[n]) < 0) {
+      jsonpath_nodelist_free(&input);
+      return -1;
+    }
+  }
+
+  jsonpath_nodelist_free(&input);
+  return 0;
+}
+
+int jsonpath_eval(JSONPathObject *self, void *root, bool mut, JPNodeList *out) {
+  JPContext ctx = {mut, root};
+
+  if (!root) {
+    return 0;
+  }
+
+  return jp_apply_query(&ctx, self->query, root, out);
+}
+
+/*==============================================================================
+ * Python type
+ *============================================================================*/
+
+static void JSONPath_dealloc(JSONPathObject *self) {
+  JPArenaBlock *block = self->arena;
+  while (block) {
+    JPArenaBlock *next = block->next;
+    PyMem_Free(block);
+    block = next;
+  }
+  Py_XDECREF(self->source);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *JSONPath_new(
+    PyTypeObject *type, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"query", NULL};
+  PyObject *source;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "U", kwlist, &source)) {
+    return NULL;
+  }
+
+  return (PyObject *)jsonpath_compile(source);
+}
+
+static PyObject *JSONPath_str(JSONPathObject *self) {
+  Py_INCREF(self->source);
+  return self->source;
+}
+
+static PyObject *JSONPath_repr(JSONPathObject *self) {
+  return PyUnicode_FromFormat("JSONPath(%R)", self->source);
+}
+
+PyDoc_STRVAR(
+    JSONPath_doc,
+    "A compiled JSONPath query (RFC 9535).\n"
+    "\n"
+    "Supports member names, wildcards, recursive descent, array indices and\n"
+    "slices, unions, and filter expressions including the standard\n"
+    "``length()``, ``count()``, ``value()``, ``match()`` and ``search()``\n"
+    "functions. Pass it to :meth:`Document.query` to evaluate it. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> cheap = JSONPath('$.store.book[?@.price < 10].title')\n"
+    "    >>> doc = Document({'store': {'book': [\n"
+    "    ...     {'title': 'Sayings', 'price': 8.95},\n"
+    "    ...     {'title': 'Sword', 'price': 12.99},\n"
+    "    ... ]}})\n"
+    "    >>> doc.query(cheap)\n"
+    "    ['Sayings']\n"
+    "\n"
+    ".. note::\n"
+    "\n"
+    "    ``match()`` and ``search()`` use Python's :mod:`re` module to\n"
+    "    evaluate their patterns.\n"
+    "\n"
+    ":param query: The JSONPath query to compile.\n"
+    ":type query: ``str``"
+);
+
+PyTypeObject JSONPathType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.JSONPath",
+    .tp_doc = JSONPath_doc,
+    .tp_basicsize = sizeof(JSONPathObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = JSONPath_new,
+    .tp_dealloc = (destructor)JSONPath_dealloc,
+    .tp_str = (reprfunc)JSONPath_str,
+    .tp_repr = (reprfunc)JSONPath_repr};
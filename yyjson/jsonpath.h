@@ -0,0 +1,56 @@
+#ifndef PY_YYJSON_JSONPATH_H
+#define PY_YYJSON_JSONPATH_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+typedef struct JPQuery JPQuery;
+
+/**
+ * Represents a compiled JSONPath query (RFC 9535).
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The original query, as a str. */
+      PyObject* source;
+  /** The compiled query. */
+  JPQuery* query;
+  /** Every allocation made while compiling, freed all at once. */
+  void* arena;
+} JSONPathObject;
+
+/**
+ * A list of nodes (yyjson_val or yyjson_mut_val) selected by a query.
+ */
+typedef struct {
+  void** items;
+  Py_ssize_t len;
+  Py_ssize_t cap;
+} JPNodeList;
+
+extern PyTypeObject JSONPathType;
+
+#define JSONPath_Check(op) PyObject_TypeCheck(op, &JSONPathType)
+
+/**
+ * Compile the given JSONPath query str, raising a ValueError if it is
+ * invalid.
+ */
+JSONPathObject* jsonpath_compile(PyObject* source);
+
+/**
+ * Evaluate a compiled query against root, which is a yyjson_mut_val if mut
+ * is true and a yyjson_val otherwise. The selected nodes are appended to
+ * out in document order. Returns -1 with an exception set on failure.
+ */
+int jsonpath_eval(JSONPathObject* self, void* root, bool mut, JPNodeList* out);
+
+/**
+ * Release the memory held by a JPNodeList.
+ */
+void jsonpath_nodelist_free(JPNodeList* list);
+
+#endif
@@ -12,3 +12,17 @@ void* py_realloc(void* ctx, void* ptr, size_t old_size, size_t size) {
 void py_free(void* ctx, void* ptr) { PyMem_Free(ptr); }
 
 yyjson_alc PyMem_Allocator = {py_malloc, py_realloc, py_free, NULL};
+
+/** wrapper to use PyMem_RawMalloc with yyjson's allocator. **/
+void* py_raw_malloc(void* ctx, size_t size) { return PyMem_RawMalloc(size); }
+
+/** wrapper to use PyMem_RawRealloc with yyjson's allocator. **/
+void* py_raw_realloc(void* ctx, void* ptr, size_t old_size, size_t size) {
+  return PyMem_RawRealloc(ptr, size);
+}
+
+/** wrapper to use PyMem_RawFree with yyjson's allocator. **/
+void py_raw_free(void* ctx, void* ptr) { PyMem_RawFree(ptr); }
+
+yyjson_alc PyMem_RawAllocator = {py_raw_malloc, py_raw_realloc, py_raw_free,
+                                 NULL};
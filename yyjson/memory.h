@@ -17,4 +17,19 @@ void py_free(void* ctx, void* ptr);
 
 extern yyjson_alc PyMem_Allocator;
 
+/** wrapper to use PyMem_RawMalloc with yyjson's allocator. **/
+void* py_raw_malloc(void* ctx, size_t size);
+
+/** wrapper to use PyMem_RawRealloc with yyjson's allocator. **/
+void* py_raw_realloc(void* ctx, void* ptr, size_t old_size, size_t size);
+
+/** wrapper to use PyMem_RawFree with yyjson's allocator. **/
+void py_raw_free(void* ctx, void* ptr);
+
+/**
+ * Allocates with the PyMem_Raw* functions, which unlike PyMem_Allocator can
+ * be used without holding the GIL.
+ */
+extern yyjson_alc PyMem_RawAllocator;
+
 #endif
@@ -0,0 +1,237 @@
+#include "numarray.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "value.h"
+
+/**
+ * The array.array typecodes that can be packed into.
+ */
+typedef struct {
+  char code;
+  /** The size of an item, in bytes. */
+  size_t size;
+  /** Whether items are floating point, otherwise they're integers. */
+  bool real;
+  /** The range of items, for integer typecodes. */
+  long long min;
+  unsigned long long max;
+} NumArrayType;
+
+static const NumArrayType numarray_types[] = {
+    {'b', sizeof(signed char), false, SCHAR_MIN, SCHAR_MAX},
+    {'B', sizeof(unsigned char), false, 0, UCHAR_MAX},
+    {'h', sizeof(short), false, SHRT_MIN, SHRT_MAX},
+    {'H', sizeof(unsigned short), false, 0, USHRT_MAX},
+    {'i', sizeof(int), false, INT_MIN, INT_MAX},
+    {'I', sizeof(unsigned int), false, 0, UINT_MAX},
+    {'l', sizeof(long), false, LONG_MIN, LONG_MAX},
+    {'L', sizeof(unsigned long), false, 0, ULONG_MAX},
+    {'q', sizeof(long long), false, LLONG_MIN, LLONG_MAX},
+    {'Q', sizeof(unsigned long long), false, 0, ULLONG_MAX},
+    {'f', sizeof(float), true, 0, 0},
+    {'d', sizeof(double), true, 0, 0},
+};
+
+static PyObject *array_class = NULL;
+
+/**
+ * Convert a raw number, read with NUMBERS_AS_RAW or BIGNUM_AS_RAW, into a
+ * double or a 64-bit integer. This is the slow path, so it goes through
+ * Python's own parsers.
+ */
+static bool numarray_raw(
+    void *val, const NumArrayType *type, double *d, long long *s,
+    unsigned long long *u, bool *negative
+) {
+  PyObject *str = PyUnicode_FromStringAndSize(
+      unsafe_yyjson_get_raw(val), unsafe_yyjson_get_len(val)
+  );
+  if (!str) return false;
+
+  if (type->real) {
+    PyObject *num = PyFloat_FromString(str);
+    Py_DECREF(str);
+    if (!num) return false;
+    *d = PyFloat_AsDouble(num);
+    Py_DECREF(num);
+    return true;
+  }
+
+  PyObject *num = PyLong_FromUnicodeObject(str, 10);
+  Py_DECREF(str);
+  if (!num) {
+    // Such as 1.5, which isn't an integer.
+    PyErr_Clear();
+    PyErr_SetString(PyExc_TypeError, "expected an integer");
+    return false;
+  }
+
+  PyObject *zero = PyLong_FromLong(0);
+  *negative = zero && PyObject_RichCompareBool(num, zero, Py_LT) == 1;
+  Py_XDECREF(zero);
+  if (*negative) {
+    *s = PyLong_AsLongLong(num);
+  } else {
+    *u = PyLong_AsUnsignedLongLong(num);
+  }
+  Py_DECREF(num);
+  return !PyErr_Occurred();
+}
+
+/**
+ * Store the number val at dst, converted to type.
+ */
+static bool numarray_store(void *val, const NumArrayType *type, char *dst) {
+  double d = 0;
+  long long s = 0;
+  unsigned long long u = 0;
+  bool negative = false;
+
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NUM:
+      switch (unsafe_yyjson_get_subtype(val)) {
+        case YYJSON_SUBTYPE_UINT:
+          u = unsafe_yyjson_get_uint(val);
+          d = (double)u;
+          break;
+        case YYJSON_SUBTYPE_SINT:
+          s = unsafe_yyjson_get_sint(val);
+          u = (unsigned long long)s;
+          negative = s < 0;
+          d = (double)s;
+          break;
+        default:
+          if (!type->real) {
+            PyErr_SetString(PyExc_TypeError, "expected an integer");
+            return false;
+          }
+          d = unsafe_yyjson_get_real(val);
+          break;
+      }
+      break;
+    case YYJSON_TYPE_RAW:
+      if (!numarray_raw(val, type, &d, &s, &u, &negative)) return false;
+      break;
+    default:
+      PyErr_SetString(PyExc_TypeError, "expected a number");
+      return false;
+  }
+
+  if (type->real) {
+    if (type->size == sizeof(float)) {
+      float f = (float)d;
+      memcpy(dst, &f, sizeof(f));
+    } else {
+      memcpy(dst, &d, sizeof(d));
+    }
+    return true;
+  }
+
+  if (negative) u = (unsigned long long)s;
+
+  if (negative ? s < type->min : u > type->max) {
+    PyErr_Format(
+        PyExc_OverflowError, "integer out of range for typecode '%c'",
+        type->code
+    );
+    return false;
+  }
+
+  // Two's complement truncation leaves exactly the value in range.
+  switch (type->size) {
+    case 1: {
+      uint8_t v = (uint8_t)u;
+      memcpy(dst, &v, 1);
+      break;
+    }
+    case 2: {
+      uint16_t v = (uint16_t)u;
+      memcpy(dst, &v, 2);
+      break;
+    }
+    case 4: {
+      uint32_t v = (uint32_t)u;
+      memcpy(dst, &v, 4);
+      break;
+    }
+    default: {
+      uint64_t v = (uint64_t)u;
+      memcpy(dst, &v, 8);
+      break;
+    }
+  }
+  return true;
+}
+
+PyObject *numarray_pack(void *arr, bool mut, int typecode) {
+  const NumArrayType *type = NULL;
+
+  for (size_t i = 0; i < sizeof(numarray_types) / sizeof(numarray_types[0]);
+       i++) {
+    if (numarray_types[i].code == typecode) {
+      type = &numarray_types[i];
+      break;
+    }
+  }
+
+  if (!type) {
+    PyErr_Format(PyExc_ValueError, "Unsupported typecode '%c'.", typecode);
+    return NULL;
+  }
+
+  if (!arr || unsafe_yyjson_get_type(arr) != YYJSON_TYPE_ARR) {
+    PyErr_SetString(PyExc_TypeError, "The value is not an array.");
+    return NULL;
+  }
+
+  if (!array_class) {
+    PyObject *module = PyImport_ImportModule("array");
+    if (!module) return NULL;
+    array_class = PyObject_GetAttrString(module, "array");
+    Py_DECREF(module);
+    if (!array_class) return NULL;
+  }
+
+  size_t len = unsafe_yyjson_get_len(arr);
+  char *buf = PyMem_Malloc(len ? len * type->size : 1);
+  if (!buf) return PyErr_NoMemory();
+
+  ValIter iter;
+  void *item;
+  size_t idx = 0;
+  val_iter_init(&iter, arr, mut);
+  while ((item = val_iter_next(&iter))) {
+    if (!numarray_store(item, type, buf + idx * type->size)) {
+      // Add the index to the message of the error.
+      PyObject *exc_type, *exc_value, *tb;
+      PyErr_Fetch(&exc_type, &exc_value, &tb);
+      PyErr_NormalizeException(&exc_type, &exc_value, &tb);
+      PyErr_Format(exc_type, "%S at index %zu", exc_value, idx);
+      Py_DECREF(exc_type);
+      Py_XDECREF(exc_value);
+      Py_XDECREF(tb);
+      PyMem_Free(buf);
+      return NULL;
+    }
+    idx++;
+  }
+
+  PyObject *result = PyObject_CallFunction(array_class, "C", typecode);
+  PyObject *view = result ? PyMemoryView_FromMemory(
+                                buf, (Py_ssize_t)(len * type->size), PyBUF_READ
+                            )
+                          : NULL;
+  PyObject *ok =
+      view ? PyObject_CallMethod(result, "frombytes", "O", view) : NULL;
+
+  Py_XDECREF(view);
+  PyMem_Free(buf);
+  if (!ok) {
+    Py_XDECREF(result);
+    return NULL;
+  }
+  Py_DECREF(ok);
+  return result;
+}
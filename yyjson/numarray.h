@@ -0,0 +1,17 @@
+#ifndef PY_YYJSON_NUMARRAY_H
+#define PY_YYJSON_NUMARRAY_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+/**
+ * Pack an array of numbers, which may be either a yyjson_val or a
+ * yyjson_mut_val, into a new array.array with the given typecode without
+ * creating a Python object per element.
+ */
+PyObject* numarray_pack(void* arr, bool mut, int typecode);
+
+#endif
@@ -0,0 +1,1085 @@
+#include "patch.h"
+
+#include "document.h"
+#include "memory.h"
+#include "value.h"
+
+static PatchOpKind patch_op_kind(void *op) {
+  static const struct {
+    const char *name;
+    PatchOpKind kind;
+  } ops[] = {
+      {"add", PATCH_OP_ADD},   {"remove", PATCH_OP_REMOVE},
+      {"replace", PATCH_OP_REPLACE}, {"move", PATCH_OP_MOVE},
+      {"copy", PATCH_OP_COPY}, {"test", PATCH_OP_TEST},
+  };
+
+  for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+    if (unsafe_yyjson_equals_str(op, ops[i].name)) return ops[i].kind;
+  }
+
+  return PATCH_OP_NONE;
+}
+
+/**
+ * Replace the whole target value.
+ */
+static void target_replace(
+    yyjson_mut_doc *doc, PatchTarget *target, yyjson_mut_val *val
+) {
+  if (target->ctx.ctn) {
+    yyjson_ptr_ctx_replace(&target->ctx, val);
+  } else {
+    yyjson_mut_doc_set_root(doc, val);
+  }
+  target->val = val;
+}
+
+static yyjson_mut_val *path_get(
+    PatchTarget *target, PatchPath *path, yyjson_ptr_err *err
+) {
+  if (path->len == 0) {
+    return target->val;
+  }
+
+  if (path->compiled) {
+    return pointer_mut_get(path->compiled, target->val, NULL, err);
+  }
+
+  return yyjson_mut_ptr_getx(target->val, path->str, path->len, NULL, err);
+}
+
+/**
+ * Find the value a path should be applied to and the escaped remainder,
+ * for use with the yyjson_mut_ptr_*x() functions. A compiled path has its
+ * parent resolved up front, so only its last token is parsed again.
+ */
+static bool path_split(
+    PatchTarget *target, PatchPath *path, yyjson_mut_val **base,
+    const char **str, size_t *len, yyjson_ptr_err *err
+) {
+  *base = target->val;
+  *str = path->str;
+  *len = path->len;
+
+  if (!path->compiled || path->compiled->num_tokens < 2) {
+    return true;
+  }
+
+  *base = pointer_mut_get_parent(path->compiled, target->val);
+  if (!*base) {
+    err->code = YYJSON_PTR_ERR_RESOLVE;
+    err->msg = "JSON pointer cannot be resolved";
+    err->pos = 0;
+    return false;
+  }
+
+  const PointerToken *last =
+      &path->compiled->tokens[path->compiled->num_tokens - 1];
+  *str = last->raw;
+  *len = last->raw_len;
+  return true;
+}
+
+static bool path_add(
+    yyjson_mut_doc *doc, PatchTarget *target, PatchPath *path,
+    yyjson_mut_val *val, yyjson_ptr_err *err
+) {
+  yyjson_mut_val *base;
+  const char *str;
+  size_t len;
+
+  if (path->len == 0) {
+    target_replace(doc, target, val);
+    return true;
+  }
+
+  return path_split(target, path, &base, &str, &len, err) &&
+         yyjson_mut_ptr_addx(base, str, len, val, doc, false, NULL, err);
+}
+
+static yyjson_mut_val *path_remove(
+    PatchTarget *target, PatchPath *path, yyjson_ptr_err *err
+) {
+  yyjson_mut_val *base;
+  const char *str;
+  size_t len;
+
+  if (!path_split(target, path, &base, &str, &len, err)) {
+    return NULL;
+  }
+
+  return yyjson_mut_ptr_removex(base, str, len, NULL, err);
+}
+
+static bool path_replace(
+    yyjson_mut_doc *doc, PatchTarget *target, PatchPath *path,
+    yyjson_mut_val *val, yyjson_ptr_err *err
+) {
+  yyjson_mut_val *base;
+  const char *str;
+  size_t len;
+
+  if (path->len == 0) {
+    target_replace(doc, target, val);
+    return true;
+  }
+
+  return path_split(target, path, &base, &str, &len, err) &&
+         yyjson_mut_ptr_replacex(base, str, len, val, NULL, err);
+}
+
+#define return_err(_code, _msg)              \
+  do {                                       \
+    err->code = YYJSON_PATCH_ERROR_##_code; \
+    err->msg = _msg;                         \
+    return false;                            \
+  } while (false)
+
+/**
+ * Decode and validate a single operation object, which is either a
+ * yyjson_val or a yyjson_mut_val (if mut is true). The decoded op refers
+ * to memory owned by the operation object.
+ */
+static bool patch_decode_op(
+    void *op_obj, bool mut, PatchOp *op, yyjson_patch_err *err
+) {
+  void *member;
+
+  memset(op, 0, sizeof(*op));
+
+  if (!val_is_obj(op_obj)) {
+    return_err(INVALID_OPERATION, "JSON patch operation is not object");
+  }
+
+  member = val_obj_getn(op_obj, mut, "op", 2);
+  if (!member) return_err(MISSING_KEY, "missing key `op`");
+  if (!val_is_str(member)) return_err(INVALID_MEMBER, "invalid member `op`");
+  op->kind = patch_op_kind(member);
+  if (op->kind == PATCH_OP_NONE) {
+    return_err(INVALID_MEMBER, "unsupported `op`");
+  }
+
+  member = val_obj_getn(op_obj, mut, "path", 4);
+  if (!member) return_err(MISSING_KEY, "missing key `path`");
+  if (!val_is_str(member)) return_err(INVALID_MEMBER, "invalid member `path`");
+  op->path.str = unsafe_yyjson_get_str(member);
+  op->path.len = unsafe_yyjson_get_len(member);
+
+  switch (op->kind) {
+    case PATCH_OP_ADD:
+    case PATCH_OP_REPLACE:
+    case PATCH_OP_TEST:
+      op->value = val_obj_getn(op_obj, mut, "value", 5);
+      if (!op->value) return_err(MISSING_KEY, "missing key `value`");
+      break;
+    case PATCH_OP_MOVE:
+    case PATCH_OP_COPY:
+      member = val_obj_getn(op_obj, mut, "from", 4);
+      if (!member) return_err(MISSING_KEY, "missing key `from`");
+      if (!val_is_str(member)) {
+        return_err(INVALID_MEMBER, "invalid member `from`");
+      }
+      op->from.str = unsafe_yyjson_get_str(member);
+      op->from.len = unsafe_yyjson_get_len(member);
+      break;
+    default:
+      break;
+  }
+
+  return true;
+}
+
+/**
+ * Execute a single decoded operation. The op's value is a yyjson_val or a
+ * yyjson_mut_val (if value_mut is true).
+ */
+static bool patch_exec_op(
+    yyjson_mut_doc *doc, PatchTarget *target, PatchOp *op, bool value_mut,
+    yyjson_patch_err *err
+) {
+  yyjson_mut_val *val;
+
+  switch (op->kind) {
+    case PATCH_OP_ADD:
+      val = patch_val_copy(doc, op->value, value_mut);
+      if (!val) return_err(MEMORY_ALLOCATION, "failed to copy value");
+      if (!path_add(doc, target, &op->path, val, &err->ptr)) {
+        return_err(POINTER, "failed to add `path`");
+      }
+      break;
+    case PATCH_OP_REMOVE:
+      if (!path_remove(target, &op->path, &err->ptr)) {
+        return_err(POINTER, "failed to remove `path`");
+      }
+      break;
+    case PATCH_OP_REPLACE:
+      val = patch_val_copy(doc, op->value, value_mut);
+      if (!val) return_err(MEMORY_ALLOCATION, "failed to copy value");
+      if (!path_replace(doc, target, &op->path, val, &err->ptr)) {
+        return_err(POINTER, "failed to replace `path`");
+      }
+      break;
+    case PATCH_OP_MOVE: {
+      const char *from = op->from.str, *path = op->path.str;
+      size_t from_len = op->from.len, path_len = op->path.len;
+
+      // Moving a value onto itself changes nothing, but `from` must still
+      // exist.
+      if (from_len == path_len && memcmp(from, path, path_len) == 0) {
+        if (!path_get(target, &op->from, &err->ptr)) {
+          return_err(POINTER, "failed to remove `from`");
+        }
+        break;
+      }
+      if (path_len > from_len && memcmp(from, path, from_len) == 0 &&
+          path[from_len] == '/') {
+        return_err(POINTER, "cannot move `from` into one of its children");
+      }
+      val = path_remove(target, &op->from, &err->ptr);
+      if (!val) return_err(POINTER, "failed to remove `from`");
+      if (!path_add(doc, target, &op->path, val, &err->ptr)) {
+        return_err(POINTER, "failed to add `path`");
+      }
+      break;
+    }
+    case PATCH_OP_COPY:
+      val = path_get(target, &op->from, &err->ptr);
+      if (!val) return_err(POINTER, "failed to get `from`");
+      val = yyjson_mut_val_mut_copy(doc, val);
+      if (!val) return_err(MEMORY_ALLOCATION, "failed to copy value");
+      if (!path_add(doc, target, &op->path, val, &err->ptr)) {
+        return_err(POINTER, "failed to add `path`");
+      }
+      break;
+    case PATCH_OP_TEST:
+      val = path_get(target, &op->path, &err->ptr);
+      if (!val) return_err(POINTER, "failed to get `path`");
+      if (!val_equals(val, true, op->value, value_mut)) {
+        return_err(EQUAL, "failed to test equal");
+      }
+      break;
+    default:
+      return_err(INVALID_MEMBER, "unsupported `op`");
+  }
+
+  return true;
+}
+
+bool patch_apply(
+    yyjson_mut_doc *doc, PatchTarget *target, void *patch, bool patch_mut,
+    yyjson_patch_err *err
+) {
+  ValIter iter;
+  void *op_obj;
+  PatchOp op;
+
+  memset(err, 0, sizeof(*err));
+
+  if (unsafe_yyjson_get_type(patch) != YYJSON_TYPE_ARR) {
+    return_err(INVALID_PARAMETER, "input patch is not array");
+  }
+
+  val_iter_init(&iter, patch, patch_mut);
+
+  for (size_t idx = 0; (op_obj = val_iter_next(&iter)); idx++) {
+    err->idx = idx;
+    if (!patch_decode_op(op_obj, patch_mut, &op, err) ||
+        !patch_exec_op(doc, target, &op, patch_mut, err)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool patch_program_apply(
+    PatchObject *self, yyjson_mut_doc *doc, PatchTarget *target,
+    yyjson_patch_err *err
+) {
+  memset(err, 0, sizeof(*err));
+
+  for (Py_ssize_t i = 0; i < self->num_ops; i++) {
+    err->idx = (size_t)i;
+    if (!patch_exec_op(doc, target, &self->ops[i], true, err)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#undef return_err
+
+static bool merge_into(
+    yyjson_mut_doc *doc, yyjson_mut_val *target, void *patch, bool patch_mut
+);
+
+/**
+ * Build the value a merge patch produces where there was nothing before,
+ * which is the patch itself minus any null members.
+ */
+static yyjson_mut_val *merge_new(
+    yyjson_mut_doc *doc, void *patch, bool patch_mut
+) {
+  if (!val_is_obj(patch)) {
+    return patch_val_copy(doc, patch, patch_mut);
+  }
+
+  yyjson_mut_val *obj = yyjson_mut_obj(doc);
+  if (!obj || !merge_into(doc, obj, patch, patch_mut)) {
+    return NULL;
+  }
+
+  return obj;
+}
+
+/**
+ * Merge the patch object into the target object, in place.
+ */
+static bool merge_into(
+    yyjson_mut_doc *doc, yyjson_mut_val *target, void *patch, bool patch_mut
+) {
+  ValIter iter;
+  void *key;
+
+  val_iter_init(&iter, patch, patch_mut);
+
+  while ((key = val_iter_next(&iter))) {
+    const char *str = unsafe_yyjson_get_str(key);
+    size_t len = unsafe_yyjson_get_len(key);
+    void *value = val_key_value(key, patch_mut);
+
+    if (unsafe_yyjson_get_type(value) == YYJSON_TYPE_NULL) {
+      yyjson_mut_obj_remove_keyn(target, str, len);
+      continue;
+    }
+
+    yyjson_mut_obj_iter target_iter;
+    yyjson_mut_val *target_key;
+    yyjson_mut_obj_iter_init(target, &target_iter);
+    while ((target_key = yyjson_mut_obj_iter_next(&target_iter))) {
+      if (unsafe_yyjson_equals_strn(target_key, str, len)) break;
+    }
+
+    if (target_key) {
+      yyjson_mut_val *existing = target_key->next;
+
+      if (val_is_obj(value) && yyjson_mut_is_obj(existing)) {
+        if (!merge_into(doc, existing, value, patch_mut)) return false;
+        continue;
+      }
+
+      yyjson_mut_val *val = merge_new(doc, value, patch_mut);
+      if (!val) return false;
+
+      // Swap the value in place, keeping the member's position.
+      val->next = existing->next;
+      target_key->next = val;
+    } else {
+      yyjson_mut_val *val = merge_new(doc, value, patch_mut);
+      yyjson_mut_val *new_key = yyjson_mut_strncpy(doc, str, len);
+      if (!val || !new_key || !yyjson_mut_obj_add(target, new_key, val)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool merge_patch_apply(
+    yyjson_mut_doc *doc, PatchTarget *target, void *patch, bool patch_mut
+) {
+  if (!val_is_obj(patch)) {
+    yyjson_mut_val *val = patch_val_copy(doc, patch, patch_mut);
+    if (!val) return false;
+    target_replace(doc, target, val);
+    return true;
+  }
+
+  if (!yyjson_mut_is_obj(target->val)) {
+    yyjson_mut_val *obj = yyjson_mut_obj(doc);
+    if (!obj) return false;
+    target_replace(doc, target, obj);
+  }
+
+  return merge_into(doc, target->val, patch, patch_mut);
+}
+
+/*==============================================================================
+ * Diff
+ *============================================================================*/
+
+/**
+ * The largest LCS table (in cells) we'll build when diffing arrays. Arrays
+ * with a larger changed region are compared position by position instead.
+ */
+#define DIFF_MAX_LCS_CELLS ((size_t)1 << 22)
+
+/**
+ * State for generating a JSON Patch, with the escaped JSON pointer to the
+ * value currently being compared.
+ */
+typedef struct {
+  yyjson_mut_doc *doc;
+  yyjson_mut_val *ops;
+  bool src_mut;
+  bool dst_mut;
+  char *path;
+  size_t path_len;
+  size_t path_cap;
+} DiffState;
+
+static bool diff_vals(DiffState *st, void *src, void *dst);
+
+/**
+ * Append a reference token to the current path, escaping it as needed.
+ */
+static bool diff_path_push(DiffState *st, const char *token, size_t len) {
+  size_t need = st->path_len + 1 + len * 2;
+
+  if (need > st->path_cap) {
+    size_t cap = st->path_cap ? st->path_cap : 64;
+    while (cap < need) cap *= 2;
+    char *path = PyMem_Realloc(st->path, cap);
+    if (!path) return false;
+    st->path = path;
+    st->path_cap = cap;
+  }
+
+  st->path[st->path_len++] = '/';
+  for (size_t i = 0; i < len; i++) {
+    if (token[i] == '~') {
+      st->path[st->path_len++] = '~';
+      st->path[st->path_len++] = '0';
+    } else if (token[i] == '/') {
+      st->path[st->path_len++] = '~';
+      st->path[st->path_len++] = '1';
+    } else {
+      st->path[st->path_len++] = token[i];
+    }
+  }
+  return true;
+}
+
+static bool diff_path_push_idx(DiffState *st, size_t idx) {
+  char buf[24];
+  int len = snprintf(buf, sizeof(buf), "%zu", idx);
+  return diff_path_push(st, buf, (size_t)len);
+}
+
+/**
+ * Append an operation at the current path. val is copied from the
+ * destination, and may be NULL for remove.
+ */
+static bool diff_emit(DiffState *st, const char *op, void *val) {
+  yyjson_mut_val *obj = yyjson_mut_obj(st->doc);
+  if (!obj) return false;
+
+  if (!yyjson_mut_obj_add_str(st->doc, obj, "op", op) ||
+      !yyjson_mut_obj_add_strncpy(
+          st->doc, obj, "path", st->path ? st->path : "", st->path_len
+      )) {
+    return false;
+  }
+
+  if (val) {
+    yyjson_mut_val *copy = patch_val_copy(st->doc, val, st->dst_mut);
+    if (!copy || !yyjson_mut_obj_add_val(st->doc, obj, "value", copy)) {
+      return false;
+    }
+  }
+
+  return yyjson_mut_arr_append(st->ops, obj);
+}
+
+static bool diff_objs(DiffState *st, void *src, void *dst) {
+  size_t base = st->path_len;
+  ValIter iter;
+  void *key;
+
+  val_iter_init(&iter, src, st->src_mut);
+  while ((key = val_iter_next(&iter))) {
+    const char *str = unsafe_yyjson_get_str(key);
+    size_t len = unsafe_yyjson_get_len(key);
+    void *other = val_obj_getn(dst, st->dst_mut, str, len);
+
+    if (!diff_path_push(st, str, len)) return false;
+    if (other) {
+      if (!diff_vals(st, val_key_value(key, st->src_mut), other)) return false;
+    } else if (!diff_emit(st, "remove", NULL)) {
+      return false;
+    }
+    st->path_len = base;
+  }
+
+  val_iter_init(&iter, dst, st->dst_mut);
+  while ((key = val_iter_next(&iter))) {
+    const char *str = unsafe_yyjson_get_str(key);
+    size_t len = unsafe_yyjson_get_len(key);
+
+    if (val_obj_getn(src, st->src_mut, str, len)) continue;
+
+    if (!diff_path_push(st, str, len) ||
+        !diff_emit(st, "add", val_key_value(key, st->dst_mut))) {
+      return false;
+    }
+    st->path_len = base;
+  }
+
+  return true;
+}
+
+/**
+ * Collect the elements of an array, so they can be accessed by index
+ * regardless of representation.
+ */
+static void **diff_arr_items(void *arr, bool mut, size_t *len) {
+  ValIter iter;
+  void *val;
+  size_t i = 0;
+
+  *len = unsafe_yyjson_get_len(arr);
+  void **items = PyMem_Malloc(sizeof(void *) * (*len ? *len : 1));
+  if (!items) return NULL;
+
+  val_iter_init(&iter, arr, mut);
+  while ((val = val_iter_next(&iter))) items[i++] = val;
+  return items;
+}
+
+/**
+ * Emit the operations turning a run of removed source elements and inserted
+ * destination elements into each other, starting at *idx of the array
+ * being patched. Removals and insertions are paired up and diffed in place
+ * where possible.
+ */
+static bool diff_arr_run(
+    DiffState *st, void **src, size_t src_len, void **dst, size_t dst_len,
+    size_t *idx
+) {
+  size_t base = st->path_len;
+  size_t i = 0;
+
+  for (; i < src_len && i < dst_len; i++, (*idx)++) {
+    if (!diff_path_push_idx(st, *idx) || !diff_vals(st, src[i], dst[i])) {
+      return false;
+    }
+    st->path_len = base;
+  }
+
+  for (size_t j = i; j < src_len; j++) {
+    if (!diff_path_push_idx(st, *idx) || !diff_emit(st, "remove", NULL)) {
+      return false;
+    }
+    st->path_len = base;
+  }
+
+  for (size_t j = i; j < dst_len; j++, (*idx)++) {
+    if (!diff_path_push_idx(st, *idx) || !diff_emit(st, "add", dst[j])) {
+      return false;
+    }
+    st->path_len = base;
+  }
+
+  return true;
+}
+
+/**
+ * Diff two arrays. The common prefix and suffix are skipped, and the rest
+ * is aligned using the longest common subsequence of equal elements when
+ * it's small enough, or position by position otherwise.
+ */
+static bool diff_arrs(DiffState *st, void *src, void *dst) {
+  size_t src_len, dst_len;
+  void **a = diff_arr_items(src, st->src_mut, &src_len);
+  void **b = diff_arr_items(dst, st->dst_mut, &dst_len);
+  uint32_t *table = NULL;
+  bool ok = false;
+
+  if (!a || !b) goto done;
+
+  size_t pre = 0;
+  while (pre < src_len && pre < dst_len &&
+         val_equals(a[pre], st->src_mut, b[pre], st->dst_mut)) {
+    pre++;
+  }
+
+  size_t suf = 0;
+  while (suf < src_len - pre && suf < dst_len - pre &&
+         val_equals(
+             a[src_len - suf - 1], st->src_mut, b[dst_len - suf - 1],
+             st->dst_mut
+         )) {
+    suf++;
+  }
+
+  void **as = a + pre, **bs = b + pre;
+  size_t n = src_len - pre - suf, m = dst_len - pre - suf;
+  size_t idx = pre;
+
+  if (n == 0 || m == 0 || (n + 1) > DIFF_MAX_LCS_CELLS / (m + 1)) {
+    ok = diff_arr_run(st, as, n, bs, m, &idx);
+    goto done;
+  }
+
+  // table[i * (m + 1) + j] is the length of the LCS of as[i:] and bs[j:].
+  table = PyMem_Calloc((n + 1) * (m + 1), sizeof(uint32_t));
+  if (!table) goto done;
+
+#define LCS(i, j) table[(i) * (m + 1) + (j)]
+  for (size_t i = n; i-- > 0;) {
+    for (size_t j = m; j-- > 0;) {
+      if (val_equals(as[i], st->src_mut, bs[j], st->dst_mut)) {
+        LCS(i, j) = LCS(i + 1, j + 1) + 1;
+      } else {
+        LCS(i, j) = LCS(i + 1, j) > LCS(i, j + 1) ? LCS(i + 1, j)
+                                                   : LCS(i, j + 1);
+      }
+    }
+  }
+
+  // Walk the table, emitting the runs between each pair of equal elements.
+  size_t i = 0, j = 0, ri = 0, rj = 0;
+  while (i < n && j < m) {
+    if (LCS(i, j) == LCS(i + 1, j + 1) + 1 &&
+        val_equals(as[i], st->src_mut, bs[j], st->dst_mut)) {
+      if (!diff_arr_run(st, as + ri, i - ri, bs + rj, j - rj, &idx)) {
+        goto done;
+      }
+      i++, j++, idx++;
+      ri = i, rj = j;
+    } else if (LCS(i + 1, j) >= LCS(i, j + 1)) {
+      i++;
+    } else {
+      j++;
+    }
+  }
+#undef LCS
+
+  ok = diff_arr_run(st, as + ri, n - ri, bs + rj, m - rj, &idx);
+
+done:
+  PyMem_Free(table);
+  PyMem_Free(a);
+  PyMem_Free(b);
+  return ok;
+}
+
+static bool diff_vals(DiffState *st, void *src, void *dst) {
+  if (val_equals(src, st->src_mut, dst, st->dst_mut)) {
+    return true;
+  }
+
+  yyjson_type type = unsafe_yyjson_get_type(src);
+  if (type == unsafe_yyjson_get_type(dst)) {
+    if (type == YYJSON_TYPE_OBJ) return diff_objs(st, src, dst);
+    if (type == YYJSON_TYPE_ARR) return diff_arrs(st, src, dst);
+  }
+
+  return diff_emit(st, "replace", dst);
+}
+
+yyjson_mut_val *patch_diff(
+    yyjson_mut_doc *doc, void *src, bool src_mut, void *dst, bool dst_mut
+) {
+  DiffState st = {
+      .doc = doc,
+      .ops = yyjson_mut_arr(doc),
+      .src_mut = src_mut,
+      .dst_mut = dst_mut,
+  };
+
+  if (!st.ops) return NULL;
+
+  bool ok = diff_vals(&st, src, dst);
+  PyMem_Free(st.path);
+  return ok ? st.ops : NULL;
+}
+
+/**
+ * Whether val would lose anything when used as a merge patch value, which
+ * is the case if it's null or an object with a null member at any depth.
+ * Arrays are copied as-is, so nulls inside them are fine.
+ */
+static bool merge_diff_has_null(void *val, bool mut) {
+  yyjson_type type = unsafe_yyjson_get_type(val);
+
+  if (type == YYJSON_TYPE_NULL) return true;
+  if (type != YYJSON_TYPE_OBJ) return false;
+
+  ValIter iter;
+  void *key;
+  val_iter_init(&iter, val, mut);
+  while ((key = val_iter_next(&iter))) {
+    if (merge_diff_has_null(val_key_value(key, mut), mut)) return true;
+  }
+  return false;
+}
+
+/**
+ * Copy a value from the destination to be used as-is in the merge patch.
+ */
+static yyjson_mut_val *merge_diff_copy(
+    yyjson_mut_doc *doc, void *dst, bool dst_mut, const char **err
+) {
+  if (merge_diff_has_null(dst, dst_mut)) {
+    *err = "null object members cannot be represented in a merge patch";
+    return NULL;
+  }
+  return patch_val_copy(doc, dst, dst_mut);
+}
+
+static yyjson_mut_val *merge_diff_vals(
+    yyjson_mut_doc *doc, void *src, bool src_mut, void *dst, bool dst_mut,
+    const char **err
+) {
+  if (!val_is_obj(src) || !val_is_obj(dst)) {
+    // A null at the root replaces the whole document, which is fine.
+    if (unsafe_yyjson_get_type(dst) == YYJSON_TYPE_NULL) {
+      return yyjson_mut_null(doc);
+    }
+    return merge_diff_copy(doc, dst, dst_mut, err);
+  }
+
+  yyjson_mut_val *obj = yyjson_mut_obj(doc);
+  if (!obj) return NULL;
+
+  ValIter iter;
+  void *key;
+
+  val_iter_init(&iter, src, src_mut);
+  while ((key = val_iter_next(&iter))) {
+    const char *str = unsafe_yyjson_get_str(key);
+    size_t len = unsafe_yyjson_get_len(key);
+
+    if (val_obj_getn(dst, dst_mut, str, len)) continue;
+
+    yyjson_mut_val *new_key = yyjson_mut_strncpy(doc, str, len);
+    yyjson_mut_val *val = yyjson_mut_null(doc);
+    if (!new_key || !val || !yyjson_mut_obj_add(obj, new_key, val)) {
+      return NULL;
+    }
+  }
+
+  val_iter_init(&iter, dst, dst_mut);
+  while ((key = val_iter_next(&iter))) {
+    const char *str = unsafe_yyjson_get_str(key);
+    size_t len = unsafe_yyjson_get_len(key);
+    void *value = val_key_value(key, dst_mut);
+    void *existing = val_obj_getn(src, src_mut, str, len);
+    yyjson_mut_val *val;
+
+    if (!existing) {
+      val = merge_diff_copy(doc, value, dst_mut, err);
+    } else if (val_equals(existing, src_mut, value, dst_mut)) {
+      continue;
+    } else if (val_is_obj(existing) && val_is_obj(value)) {
+      val = merge_diff_vals(doc, existing, src_mut, value, dst_mut, err);
+    } else {
+      val = merge_diff_copy(doc, value, dst_mut, err);
+    }
+
+    yyjson_mut_val *new_key = val ? yyjson_mut_strncpy(doc, str, len) : NULL;
+    if (!new_key || !yyjson_mut_obj_add(obj, new_key, val)) {
+      return NULL;
+    }
+  }
+
+  return obj;
+}
+
+yyjson_mut_val *merge_patch_diff(
+    yyjson_mut_doc *doc, void *src, bool src_mut, void *dst, bool dst_mut,
+    const char **err
+) {
+  *err = NULL;
+
+  // An empty patch only leaves objects alone, anything else is replaced
+  // by the patch itself.
+  if (val_is_obj(src) && val_is_obj(dst) &&
+      val_equals(src, src_mut, dst, dst_mut)) {
+    return yyjson_mut_obj(doc);
+  }
+
+  return merge_diff_vals(doc, src, src_mut, dst, dst_mut, err);
+}
+
+/*==============================================================================
+ * Python type
+ *============================================================================*/
+
+static void Patch_dealloc(PatchObject *self) {
+  for (Py_ssize_t i = 0; i < self->num_ops; i++) {
+    Py_XDECREF(self->ops[i].path.compiled);
+    Py_XDECREF(self->ops[i].from.compiled);
+  }
+  PyMem_Free(self->ops);
+  if (self->doc) yyjson_mut_doc_free(self->doc);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/**
+ * Compile the escaped pointer in path, pointing path at the compiled copy.
+ */
+static bool patch_compile_path(PatchPath *path) {
+  PyObject *source = PyUnicode_DecodeUTF8(path->str, path->len, NULL);
+  if (!source) {
+    return false;
+  }
+
+  path->compiled = pointer_compile(source);
+  Py_DECREF(source);
+  if (!path->compiled) {
+    return false;
+  }
+
+  path->str = path->compiled->buffer;
+  path->len = path->compiled->raw_len;
+  return true;
+}
+
+static PyObject *Patch_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+  static char *kwlist[] = {"patch", NULL};
+  PyObject *patch = NULL;
+  DocumentObject *source;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &patch)) {
+    return NULL;
+  }
+
+  if (PyObject_IsInstance(patch, (PyObject *)&DocumentType)) {
+    Py_INCREF(patch);
+    source = (DocumentObject *)patch;
+  } else {
+    source = (DocumentObject *)PyObject_CallOneArg(
+        (PyObject *)&DocumentType, patch
+    );
+    if (!source) {
+      return NULL;
+    }
+  }
+
+  PatchObject *self = (PatchObject *)type->tp_alloc(type, 0);
+  if (!self) {
+    Py_DECREF(source);
+    return NULL;
+  }
+
+  bool mut = source->m_doc != NULL;
+  void *root = mut ? (void *)yyjson_mut_doc_get_root(source->m_doc)
+                   : (void *)yyjson_doc_get_root(source->i_doc);
+
+  if (!root || unsafe_yyjson_get_type(root) != YYJSON_TYPE_ARR) {
+    PyErr_SetString(PyExc_ValueError, "input patch is not array");
+    goto error;
+  }
+
+  self->doc = yyjson_mut_doc_new(&PyMem_Allocator);
+  self->ops = PyMem_Calloc(
+      unsafe_yyjson_get_len(root) ? unsafe_yyjson_get_len(root) : 1,
+      sizeof(PatchOp)
+  );
+  if (!self->doc || !self->ops) {
+    PyErr_NoMemory();
+    goto error;
+  }
+
+  ValIter iter;
+  void *op_obj;
+  val_iter_init(&iter, root, mut);
+
+  while ((op_obj = val_iter_next(&iter))) {
+    PatchOp *op = &self->ops[self->num_ops];
+    yyjson_patch_err err;
+
+    if (!patch_decode_op(op_obj, mut, op, &err)) {
+      PyErr_Format(
+          PyExc_ValueError, "Invalid patch operation %zd: %s", self->num_ops,
+          err.msg
+      );
+      goto error;
+    }
+
+    // Count the op now so its pointers are released if compiling fails.
+    self->num_ops++;
+
+    if (op->value) {
+      op->value = patch_val_copy(self->doc, op->value, mut);
+      if (!op->value) {
+        PyErr_NoMemory();
+        goto error;
+      }
+    }
+
+    if (!patch_compile_path(&op->path) ||
+        (op->from.str && !patch_compile_path(&op->from))) {
+      goto error;
+    }
+  }
+
+  Py_DECREF(source);
+  return (PyObject *)self;
+
+error:
+  Py_DECREF(source);
+  Py_DECREF(self);
+  return NULL;
+}
+
+static Py_ssize_t Patch_length(PatchObject *self) { return self->num_ops; }
+
+PyDoc_STRVAR(
+    Patch_apply_doc,
+    "Apply this patch to a ``Document``.\n"
+    "\n"
+    "Equivalent to ``document.patch(self, ...)``.\n"
+    "\n"
+    ":param document: The ``Document`` to patch.\n"
+    ":type document: ``Document``\n"
+    ":param at_pointer: The (optional) JSON Pointer (RFC 6901) to patch at,\n"
+    "                   instead of patching the entire document.\n"
+    ":type at_pointer: ``str`` or :class:`Pointer`\n"
+    ":param inplace: Whether to modify ``document`` instead of returning a\n"
+    "                new ``Document``.\n"
+    ":returns: The patched ``Document``."
+);
+static PyObject *Patch_apply(
+    PatchObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"document", "at_pointer", "inplace", NULL};
+  PyObject *document = NULL;
+  PyObject *pointer = NULL;
+  int inplace = false;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O!|$O&p", kwlist, &DocumentType, &document,
+          pointer_converter, &pointer, &inplace
+      )) {
+    return NULL;
+  }
+
+  return document_patch(
+      (DocumentObject *)document, (PyObject *)self, pointer, false, inplace
+  );
+}
+
+PyDoc_STRVAR(
+    Patch_patch_many_doc,
+    "Apply this patch to each ``Document`` in ``documents``.\n"
+    "\n"
+    "Stops at the first ``Document`` that cannot be patched. When patching\n"
+    "in place, the ``Document`` objects before it will have already been\n"
+    "modified.\n"
+    "\n"
+    ":param documents: The ``Document`` objects to patch.\n"
+    ":type documents: iterable of ``Document``\n"
+    ":param at_pointer: The (optional) JSON Pointer (RFC 6901) to patch at,\n"
+    "                   instead of patching each entire document.\n"
+    ":type at_pointer: ``str`` or :class:`Pointer`\n"
+    ":param inplace: Whether to modify each ``Document`` instead of\n"
+    "                returning new ones.\n"
+    ":returns: The patched ``Document`` objects, in the same order.\n"
+    ":rtype: ``list``"
+);
+static PyObject *Patch_patch_many(
+    PatchObject *self, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"documents", "at_pointer", "inplace", NULL};
+  PyObject *documents = NULL;
+  PyObject *pointer = NULL;
+  int inplace = false;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwds, "O|$O&p", kwlist, &documents, pointer_converter,
+          &pointer, &inplace
+      )) {
+    return NULL;
+  }
+
+  PyObject *seq = PySequence_Fast(documents, "documents must be iterable");
+  if (!seq) {
+    return NULL;
+  }
+
+  Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+  PyObject *result = PyList_New(len);
+  if (!result) {
+    Py_DECREF(seq);
+    return NULL;
+  }
+
+  for (Py_ssize_t i = 0; i < len; i++) {
+    PyObject *document = PySequence_Fast_GET_ITEM(seq, i);
+    PyObject *patched;
+
+    if (!PyObject_TypeCheck(document, &DocumentType)) {
+      PyErr_Format(
+          PyExc_TypeError, "Expected a Document, got %.200s",
+          Py_TYPE(document)->tp_name
+      );
+      patched = NULL;
+    } else {
+      patched = document_patch(
+          (DocumentObject *)document, (PyObject *)self, pointer, false,
+          inplace
+      );
+    }
+
+    if (!patched) {
+      Py_DECREF(result);
+      Py_DECREF(seq);
+      return NULL;
+    }
+
+    PyList_SET_ITEM(result, i, patched);
+  }
+
+  Py_DECREF(seq);
+  return result;
+}
+
+static PyMethodDef Patch_methods[] = {
+    {"apply", (PyCFunction)(void (*)(void))Patch_apply,
+     METH_VARARGS | METH_KEYWORDS, Patch_apply_doc},
+    {"patch_many", (PyCFunction)(void (*)(void))Patch_patch_many,
+     METH_VARARGS | METH_KEYWORDS, Patch_patch_many_doc},
+    {NULL} /* Sentinel */
+};
+
+static PySequenceMethods Patch_sequence_methods = {
+    .sq_length = (lenfunc)Patch_length};
+
+PyDoc_STRVAR(
+    Patch_doc,
+    "A validated, compiled JSON Patch (RFC 6902).\n"
+    "\n"
+    "The operations are checked and their pointers are compiled once, so the\n"
+    "same patch can be applied cheaply to any number of documents. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> rename = Patch([\n"
+    "    ...     {'op': 'move', 'from': '/name', 'path': '/user/name'},\n"
+    "    ... ])\n"
+    "    >>> docs = [Document({'name': 'Harry', 'user': {}})]\n"
+    "    >>> [doc.as_obj for doc in rename.patch_many(docs)]\n"
+    "    [{'user': {'name': 'Harry'}}]\n"
+    "\n"
+    "A ``Patch`` can also be passed to :meth:`Document.patch`.\n"
+    "\n"
+    ":param patch: The JSON Patch, as a ``Document`` or list of operations.\n"
+    ":type patch: ``Document`` or ``list``"
+);
+
+PyTypeObject PatchType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.Patch",
+    .tp_doc = Patch_doc,
+    .tp_basicsize = sizeof(PatchObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = Patch_new,
+    .tp_dealloc = (destructor)Patch_dealloc,
+    .tp_methods = Patch_methods,
+    .tp_as_sequence = &Patch_sequence_methods};
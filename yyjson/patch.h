@@ -0,0 +1,135 @@
+#ifndef PY_YYJSON_PATCH_H
+#define PY_YYJSON_PATCH_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "pointer.h"
+#include "yyjson.h"
+
+typedef enum {
+  PATCH_OP_NONE,
+  PATCH_OP_ADD,
+  PATCH_OP_REMOVE,
+  PATCH_OP_REPLACE,
+  PATCH_OP_MOVE,
+  PATCH_OP_COPY,
+  PATCH_OP_TEST
+} PatchOpKind;
+
+/**
+ * The value being patched in place, and where it lives in its document so
+ * that it can be replaced as a whole.
+ */
+typedef struct {
+  /** The value being patched. */
+  yyjson_mut_val* val;
+  /** The location of val, as filled in by a pointer lookup. If ctx.ctn is
+   * NULL, val is the root of the document. */
+  yyjson_ptr_ctx ctx;
+} PatchTarget;
+
+/**
+ * The path or from member of a patch operation.
+ */
+typedef struct {
+  /** The escaped JSON pointer (not NUL-terminated). */
+  const char* str;
+  /** The length of the escaped JSON pointer. */
+  size_t len;
+  /** The compiled pointer, or NULL to resolve str each time. */
+  PointerObject* compiled;
+} PatchPath;
+
+/**
+ * A single, decoded JSON Patch operation.
+ */
+typedef struct {
+  PatchOpKind kind;
+  PatchPath path;
+  /** Only used by move and copy. */
+  PatchPath from;
+  /** Only used by add, replace and test. */
+  void* value;
+} PatchOp;
+
+/**
+ * Represents a validated, compiled JSON Patch (RFC 6902).
+ */
+typedef struct {
+  PyObject_HEAD
+      /** Holds the value of every operation. */
+      yyjson_mut_doc* doc;
+  /** The compiled operations, with their values in doc. */
+  PatchOp* ops;
+  /** The number of operations. */
+  Py_ssize_t num_ops;
+} PatchObject;
+
+extern PyTypeObject PatchType;
+
+#define Patch_Check(op) PyObject_TypeCheck(op, &PatchType)
+
+/**
+ * Apply a JSON Patch (RFC 6902) in place to target, which must belong to
+ * doc. The patch is either a yyjson_val or a yyjson_mut_val (if patch_mut
+ * is true) and is never modified. Values from the patch are copied into doc.
+ *
+ * Operations are applied one at a time, so if one fails the operations
+ * before it remain applied.
+ */
+bool patch_apply(
+    yyjson_mut_doc* doc, PatchTarget* target, void* patch, bool patch_mut,
+    yyjson_patch_err* err
+);
+
+/**
+ * Apply a compiled Patch in place to target, which must belong to doc, with
+ * the same semantics as patch_apply().
+ */
+bool patch_program_apply(
+    PatchObject* self, yyjson_mut_doc* doc, PatchTarget* target,
+    yyjson_patch_err* err
+);
+
+/**
+ * Apply a JSON Merge Patch (RFC 7386) in place to target, which must belong
+ * to doc. The patch is either a yyjson_val or a yyjson_mut_val (if
+ * patch_mut is true) and is never modified.
+ */
+bool merge_patch_apply(
+    yyjson_mut_doc* doc, PatchTarget* target, void* patch, bool patch_mut
+);
+
+/**
+ * Generate a JSON Patch (RFC 6902) that turns src into dst, each either a
+ * yyjson_val or a yyjson_mut_val (if src_mut or dst_mut is true). Returns
+ * an array of operations allocated in doc, or NULL if allocation failed.
+ */
+yyjson_mut_val* patch_diff(
+    yyjson_mut_doc* doc, void* src, bool src_mut, void* dst, bool dst_mut
+);
+
+/**
+ * Generate a JSON Merge Patch (RFC 7386) that turns src into dst, each
+ * either a yyjson_val or a yyjson_mut_val (if src_mut or dst_mut is true).
+ * Returns the patch allocated in doc, or NULL with err set if dst can't be
+ * reached with a merge patch, or NULL with err unset if allocation failed.
+ */
+yyjson_mut_val* merge_patch_diff(
+    yyjson_mut_doc* doc, void* src, bool src_mut, void* dst, bool dst_mut,
+    const char** err
+);
+
+/**
+ * Copy a yyjson_val or yyjson_mut_val (if mut is true) into doc.
+ */
+static inline yyjson_mut_val* patch_val_copy(
+    yyjson_mut_doc* doc, void* val, bool mut
+) {
+  if (mut) return yyjson_mut_val_mut_copy(doc, (yyjson_mut_val*)val);
+  return yyjson_val_mut_copy(doc, (yyjson_val*)val);
+}
+
+#endif
@@ -0,0 +1,451 @@
+#include "pointer.h"
+
+#define POINTER_MAX_IDX (((size_t)-3) / 10)
+
+#define pointer_set_err(_code, _msg, _pos) \
+  do {                                     \
+    if (err) {                             \
+      err->code = YYJSON_PTR_ERR_##_code;  \
+      err->msg = _msg;                     \
+      err->pos = (size_t)(_pos);           \
+    }                                      \
+  } while (0)
+
+/**
+ * Convert an unescaped token into an array index, following the same rules
+ * as yyjson: no leading zeros, and "-" refers to the end of the array.
+ */
+static size_t token_to_idx(const char *cur, size_t len) {
+  size_t num = 0;
+
+  if (len == 0) return POINTER_IDX_NONE;
+  if (len == 1 && *cur == '-') return POINTER_IDX_END;
+  if (*cur == '0') return len == 1 ? 0 : POINTER_IDX_NONE;
+
+  for (const char *end = cur + len; cur < end; cur++) {
+    if (*cur < '0' || *cur > '9' || num > POINTER_MAX_IDX) {
+      return POINTER_IDX_NONE;
+    }
+    num = num * 10 + (size_t)(*cur - '0');
+  }
+  return num;
+}
+
+PointerObject *pointer_compile(PyObject *source) {
+  Py_ssize_t len;
+  const char *str = PyUnicode_AsUTF8AndSize(source, &len);
+  if (!str) {
+    return NULL;
+  }
+
+  if (len > 0 && *str != '/') {
+    PyErr_SetString(PyExc_ValueError, "no prefix '/'");
+    return NULL;
+  }
+
+  PointerObject *self =
+      (PointerObject *)PointerType.tp_alloc(&PointerType, 0);
+  if (!self) {
+    return NULL;
+  }
+
+  Py_INCREF(source);
+  self->source = source;
+  self->raw_len = (size_t)len;
+
+  for (Py_ssize_t i = 0; i < len; i++) {
+    if (str[i] == '/') self->num_tokens++;
+  }
+
+  // The escaped pointer is kept so it can be handed to yyjson's own
+  // pointer API, followed by the unescaped tokens which are never longer
+  // than their escaped forms.
+  self->buffer = PyMem_Malloc(len * 2 + 1);
+  self->tokens = PyMem_Malloc(sizeof(PointerToken) * (self->num_tokens + 1));
+  if (!self->buffer || !self->tokens) {
+    Py_DECREF(self);
+    PyErr_NoMemory();
+    return NULL;
+  }
+
+  memcpy(self->buffer, str, len);
+  self->buffer[len] = '\0';
+
+  const char *cur = self->buffer;
+  const char *end = self->buffer + len;
+  char *dst = self->buffer + len + 1;
+
+  for (Py_ssize_t i = 0; i < self->num_tokens; i++) {
+    PointerToken *tok = &self->tokens[i];
+    tok->raw = cur;
+    tok->key = dst;
+
+    for (cur++; cur < end && *cur != '/'; cur++) {
+      if (*cur != '~') {
+        *dst++ = *cur;
+      } else if (cur + 1 < end && (cur[1] == '0' || cur[1] == '1')) {
+        *dst++ = *++cur == '0' ? '~' : '/';
+      } else {
+        PyErr_Format(
+            PyExc_ValueError, "invalid escaped character at position %zd",
+            (Py_ssize_t)(cur - self->buffer)
+        );
+        Py_DECREF(self);
+        return NULL;
+      }
+    }
+
+    tok->raw_len = (size_t)(cur - tok->raw);
+    tok->key_len = (size_t)(dst - tok->key);
+    tok->idx = token_to_idx(tok->key, tok->key_len);
+  }
+
+  return self;
+}
+
+int pointer_converter(PyObject *arg, void *addr) {
+  if (arg == Py_None || PyUnicode_Check(arg) || Pointer_Check(arg)) {
+    *(PyObject **)addr = arg == Py_None ? NULL : arg;
+    return 1;
+  }
+
+  PyErr_Format(
+      PyExc_TypeError, "JSON pointer must be a str or Pointer, not '%s'",
+      Py_TYPE(arg)->tp_name
+  );
+  return 0;
+}
+
+int pointer_trie_build(PointerTrie *trie, PyObject *pointers) {
+  memset(trie, 0, sizeof(*trie));
+
+  PyObject *seq = PySequence_Fast(pointers, "pointers must be iterable");
+  if (!seq) {
+    return -1;
+  }
+
+  Py_ssize_t num_pointers = PySequence_Fast_GET_SIZE(seq);
+  Py_ssize_t max_nodes = 1;
+
+  trie->pointers = PyMem_Calloc(num_pointers + 1, sizeof(PointerObject *));
+  trie->next_target = PyMem_Malloc(sizeof(Py_ssize_t) * (num_pointers + 1));
+  if (!trie->pointers || !trie->next_target) {
+    PyErr_NoMemory();
+    goto error;
+  }
+
+  for (Py_ssize_t i = 0; i < num_pointers; i++) {
+    PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+    PyObject *pointer = NULL;
+
+    if (!pointer_converter(item, &pointer)) {
+      goto error;
+    }
+
+    if (!pointer) {
+      PyErr_SetString(PyExc_TypeError, "JSON pointer must be a str or Pointer");
+      goto error;
+    }
+
+    if (Pointer_Check(pointer)) {
+      Py_INCREF(pointer);
+      trie->pointers[i] = (PointerObject *)pointer;
+    } else {
+      trie->pointers[i] = pointer_compile(pointer);
+      if (!trie->pointers[i]) {
+        goto error;
+      }
+    }
+
+    trie->num_pointers++;
+    max_nodes += trie->pointers[i]->num_tokens;
+  }
+
+  trie->nodes = PyMem_Malloc(sizeof(PointerTrieNode) * max_nodes);
+  if (!trie->nodes) {
+    PyErr_NoMemory();
+    goto error;
+  }
+
+  trie->nodes[0] = (PointerTrieNode){NULL, -1, -1, -1};
+  trie->num_nodes = 1;
+
+  for (Py_ssize_t i = 0; i < num_pointers; i++) {
+    PointerObject *pointer = trie->pointers[i];
+    Py_ssize_t node = 0;
+
+    for (Py_ssize_t t = 0; t < pointer->num_tokens; t++) {
+      const PointerToken *tok = &pointer->tokens[t];
+      Py_ssize_t child = trie->nodes[node].child;
+
+      while (child != -1) {
+        const PointerToken *other = trie->nodes[child].token;
+        if (other->key_len == tok->key_len &&
+            memcmp(other->key, tok->key, tok->key_len) == 0) {
+          break;
+        }
+        child = trie->nodes[child].sibling;
+      }
+
+      if (child == -1) {
+        child = trie->num_nodes++;
+        trie->nodes[child] =
+            (PointerTrieNode){tok, -1, trie->nodes[node].child, -1};
+        trie->nodes[node].child = child;
+      }
+
+      node = child;
+    }
+
+    trie->next_target[i] = trie->nodes[node].target;
+    trie->nodes[node].target = i;
+  }
+
+  Py_DECREF(seq);
+  return 0;
+
+error:
+  Py_DECREF(seq);
+  pointer_trie_free(trie);
+  return -1;
+}
+
+void pointer_trie_free(PointerTrie *trie) {
+  for (Py_ssize_t i = 0; i < trie->num_pointers; i++) {
+    Py_XDECREF(trie->pointers[i]);
+  }
+  PyMem_Free(trie->pointers);
+  PyMem_Free(trie->next_target);
+  PyMem_Free(trie->nodes);
+  memset(trie, 0, sizeof(*trie));
+}
+
+yyjson_val *pointer_get(
+    PointerObject *self, yyjson_val *root, yyjson_ptr_err *err
+) {
+  pointer_set_err(NONE, NULL, 0);
+
+  if (yyjson_unlikely(!root)) {
+    pointer_set_err(NULL_ROOT, "document's root is NULL", 0);
+    return NULL;
+  }
+
+  yyjson_val *val = root;
+  for (Py_ssize_t i = 0; i < self->num_tokens; i++) {
+    val = pointer_token_get(&self->tokens[i], val);
+    if (!val) {
+      pointer_set_err(
+          RESOLVE, "JSON pointer cannot be resolved",
+          self->tokens[i].raw - self->buffer + 1
+      );
+      return NULL;
+    }
+  }
+
+  return val;
+}
+
+yyjson_mut_val *pointer_mut_get_parent(
+    PointerObject *self, yyjson_mut_val *root
+) {
+  if (self->num_tokens == 0) {
+    return NULL;
+  }
+
+  yyjson_mut_val *val = root;
+  for (Py_ssize_t i = 0; val && i < self->num_tokens - 1; i++) {
+    val = pointer_token_mut_get(&self->tokens[i], val);
+  }
+
+  return yyjson_mut_is_ctn(val) ? val : NULL;
+}
+
+yyjson_mut_val *pointer_mut_get(
+    PointerObject *self, yyjson_mut_val *root, yyjson_ptr_ctx *ctx,
+    yyjson_ptr_err *err
+) {
+  pointer_set_err(NONE, NULL, 0);
+  if (ctx) memset(ctx, 0, sizeof(*ctx));
+
+  if (yyjson_unlikely(!root)) {
+    pointer_set_err(NULL_ROOT, "document's root is NULL", 0);
+    return NULL;
+  }
+
+  yyjson_mut_val *val = root;
+  Py_ssize_t last = self->num_tokens - 1;
+
+  // Walk everything but the final token directly, and only track the
+  // sibling context needed by yyjson_ptr_ctx_* for the final token.
+  for (Py_ssize_t i = 0; i < last; i++) {
+    val = pointer_token_mut_get(&self->tokens[i], val);
+    if (!val) {
+      pointer_set_err(
+          RESOLVE, "JSON pointer cannot be resolved",
+          self->tokens[i].raw - self->buffer + 1
+      );
+      return NULL;
+    }
+  }
+
+  if (last < 0) {
+    return val;
+  }
+
+  const PointerToken *tok = &self->tokens[last];
+  yyjson_mut_val *ctn = val, *pre = NULL;
+  size_t num = yyjson_mut_get_len(ctn);
+  val = NULL;
+
+  if (yyjson_mut_is_obj(ctn)) {
+    yyjson_mut_val *pre_key = (yyjson_mut_val *)ctn->uni.ptr, *key;
+    for (; num > 0; num--, pre_key = key) {
+      key = pre_key->next->next;
+      if (unsafe_yyjson_equals_strn(key, tok->key, tok->key_len)) {
+        pre = pre_key;
+        val = key->next;
+        break;
+      }
+    }
+    if (ctx) {
+      ctx->ctn = ctn;
+      ctx->pre = pre;
+    }
+  } else if (yyjson_mut_is_arr(ctn)) {
+    bool is_last = tok->idx == num || tok->idx == POINTER_IDX_END;
+    if (tok->idx < num) {
+      pre = (yyjson_mut_val *)ctn->uni.ptr;
+      for (size_t idx = tok->idx; idx > 0; idx--) pre = pre->next;
+      val = pre->next;
+    }
+    if (ctx && (val || is_last)) {
+      ctx->ctn = ctn;
+      ctx->pre = pre;
+    }
+  }
+
+  if (!val) {
+    pointer_set_err(
+        RESOLVE, "JSON pointer cannot be resolved",
+        tok->raw - self->buffer + 1
+    );
+  }
+
+  return val;
+}
+
+static void Pointer_dealloc(PointerObject *self) {
+  Py_XDECREF(self->source);
+  PyMem_Free(self->buffer);
+  PyMem_Free(self->tokens);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Pointer_new(
+    PyTypeObject *type, PyObject *args, PyObject *kwds
+) {
+  static char *kwlist[] = {"pointer", NULL};
+  PyObject *source;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "U", kwlist, &source)) {
+    return NULL;
+  }
+
+  return (PyObject *)pointer_compile(source);
+}
+
+static PyObject *Pointer_str(PointerObject *self) {
+  Py_INCREF(self->source);
+  return self->source;
+}
+
+static PyObject *Pointer_repr(PointerObject *self) {
+  return PyUnicode_FromFormat("Pointer(%R)", self->source);
+}
+
+static Py_hash_t Pointer_hash(PointerObject *self) {
+  return PyObject_Hash(self->source);
+}
+
+static PyObject *Pointer_richcompare(
+    PointerObject *self, PyObject *other, int op
+) {
+  if (!Pointer_Check(other) || (op != Py_EQ && op != Py_NE)) {
+    Py_RETURN_NOTIMPLEMENTED;
+  }
+
+  return PyObject_RichCompare(
+      self->source, ((PointerObject *)other)->source, op
+  );
+}
+
+static Py_ssize_t Pointer_length(PointerObject *self) {
+  return self->num_tokens;
+}
+
+/**
+ * The unescaped reference tokens, as a tuple of str.
+ */
+static PyObject *Pointer_tokens(PointerObject *self, void *closure) {
+  PyObject *result = PyTuple_New(self->num_tokens);
+  if (!result) {
+    return NULL;
+  }
+
+  for (Py_ssize_t i = 0; i < self->num_tokens; i++) {
+    PyObject *token = PyUnicode_DecodeUTF8(
+        self->tokens[i].key, self->tokens[i].key_len, NULL
+    );
+    if (!token) {
+      Py_DECREF(result);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(result, i, token);
+  }
+
+  return result;
+}
+
+PyDoc_STRVAR(
+    Pointer_doc,
+    "A compiled JSON pointer (RFC 6901).\n"
+    "\n"
+    "The pointer is split into its reference tokens, unescaped, and any\n"
+    "array indices are parsed once when the ``Pointer`` is created. It can\n"
+    "then be used anywhere a JSON pointer ``str`` is accepted, and is much\n"
+    "faster when the same pointer is evaluated against many documents. Ex:\n"
+    "\n"
+    ".. doctest::\n"
+    "\n"
+    "    >>> name = Pointer('/users/0/name')\n"
+    "    >>> doc = Document({'users': [{'name': 'Harry'}]})\n"
+    "    >>> doc.get_pointer(name)\n"
+    "    'Harry'\n"
+    "\n"
+    ":param pointer: The JSON pointer to compile.\n"
+    ":type pointer: ``str``"
+);
+
+static PyGetSetDef Pointer_members[] = {
+    {"tokens", (getter)Pointer_tokens, NULL,
+     "The unescaped reference tokens of the pointer.", NULL},
+    {NULL} /* Sentinel */
+};
+
+static PySequenceMethods Pointer_sequence_methods = {
+    .sq_length = (lenfunc)Pointer_length};
+
+PyTypeObject PointerType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cyyjson.Pointer",
+    .tp_doc = Pointer_doc,
+    .tp_basicsize = sizeof(PointerObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = Pointer_new,
+    .tp_dealloc = (destructor)Pointer_dealloc,
+    .tp_str = (reprfunc)Pointer_str,
+    .tp_repr = (reprfunc)Pointer_repr,
+    .tp_hash = (hashfunc)Pointer_hash,
+    .tp_richcompare = (richcmpfunc)Pointer_richcompare,
+    .tp_getset = Pointer_members,
+    .tp_as_sequence = &Pointer_sequence_methods};
@@ -0,0 +1,167 @@
+#ifndef PY_YYJSON_POINTER_H
+#define PY_YYJSON_POINTER_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "yyjson.h"
+
+/** Token is not a valid array index. */
+#define POINTER_IDX_NONE ((size_t)-2)
+/** Token is "-", the (nonexistent) element after the last array element. */
+#define POINTER_IDX_END ((size_t)-1)
+
+/**
+ * A single, pre-split reference token of a JSON pointer.
+ */
+typedef struct {
+  /** The unescaped token (not NUL-terminated). */
+  const char *key;
+  /** The length of the unescaped token. */
+  size_t key_len;
+  /** The escaped token as it appears in the pointer, including its '/'. */
+  const char *raw;
+  /** The length of the escaped token, including its '/'. */
+  size_t raw_len;
+  /** The pre-parsed array index, or one of the POINTER_IDX_* constants. */
+  size_t idx;
+} PointerToken;
+
+/**
+ * Represents a compiled JSON pointer (RFC 6901).
+ */
+typedef struct {
+  PyObject_HEAD
+      /** The original pointer, as a str. */
+      PyObject* source;
+  /** The escaped pointer as UTF-8, followed by the unescaped tokens. */
+  char* buffer;
+  /** The length of the escaped pointer in buffer. */
+  size_t raw_len;
+  /** The pre-split reference tokens. */
+  PointerToken* tokens;
+  /** The number of reference tokens, 0 for the whole document. */
+  Py_ssize_t num_tokens;
+} PointerObject;
+
+/**
+ * A node in a PointerTrie. Pointers sharing a prefix share nodes, so the
+ * prefix only needs to be resolved once.
+ */
+typedef struct {
+  /** The token leading to this node, NULL for the root. */
+  const PointerToken* token;
+  /** Index of the first child node, or -1. */
+  Py_ssize_t child;
+  /** Index of the next sibling node, or -1. */
+  Py_ssize_t sibling;
+  /** Index of the first pointer ending at this node, or -1. */
+  Py_ssize_t target;
+} PointerTrieNode;
+
+/**
+ * A set of compiled pointers merged into a prefix tree. Node 0 is always
+ * the root (the whole document).
+ */
+typedef struct {
+  /** The compiled pointers, in the order they were given. */
+  PointerObject** pointers;
+  /** The number of compiled pointers. */
+  Py_ssize_t num_pointers;
+  /** For each pointer, the next pointer ending at the same node, or -1. */
+  Py_ssize_t* next_target;
+  /** The trie nodes. */
+  PointerTrieNode* nodes;
+  /** The number of trie nodes in use. */
+  Py_ssize_t num_nodes;
+} PointerTrie;
+
+extern PyTypeObject PointerType;
+
+#define Pointer_Check(op) PyObject_TypeCheck(op, &PointerType)
+
+/**
+ * Compile the given JSON pointer str, raising a ValueError if it is
+ * invalid.
+ */
+PointerObject* pointer_compile(PyObject* source);
+
+/**
+ * "O&" converter accepting a str or a Pointer (or None, which is left as
+ * NULL) for use with PyArg_Parse*.
+ */
+int pointer_converter(PyObject* arg, void* addr);
+
+/**
+ * Build a PointerTrie from a sequence of str or Pointer objects. Returns -1
+ * with an exception set on failure.
+ */
+int pointer_trie_build(PointerTrie* trie, PyObject* pointers);
+
+/**
+ * Release everything held by a PointerTrie.
+ */
+void pointer_trie_free(PointerTrie* trie);
+
+/**
+ * Resolve a compiled pointer against an immutable value.
+ */
+yyjson_val* pointer_get(
+    PointerObject* self, yyjson_val* root, yyjson_ptr_err* err
+);
+
+/**
+ * Resolve a compiled pointer against a mutable value. If ctx is given, it
+ * is filled in the same way yyjson_mut_ptr_getx() does.
+ */
+yyjson_mut_val* pointer_mut_get(
+    PointerObject* self, yyjson_mut_val* root, yyjson_ptr_ctx* ctx,
+    yyjson_ptr_err* err
+);
+
+/**
+ * Resolve all but the last token of a compiled pointer against a mutable
+ * value, returning the container the last token refers into. Returns NULL
+ * if it does not exist, or if the pointer has no tokens.
+ */
+yyjson_mut_val* pointer_mut_get_parent(
+    PointerObject* self, yyjson_mut_val* root
+);
+
+/**
+ * Look up a single token in an immutable container, returning NULL if it
+ * does not exist.
+ */
+static inline yyjson_val* pointer_token_get(
+    const PointerToken* tok, yyjson_val* ctn
+) {
+  switch (yyjson_get_type(ctn)) {
+    case YYJSON_TYPE_OBJ:
+      return yyjson_obj_getn(ctn, tok->key, tok->key_len);
+    case YYJSON_TYPE_ARR:
+      if (tok->idx >= POINTER_IDX_NONE) return NULL;
+      return yyjson_arr_get(ctn, tok->idx);
+    default:
+      return NULL;
+  }
+}
+
+/**
+ * Look up a single token in a mutable container, returning NULL if it
+ * does not exist.
+ */
+static inline yyjson_mut_val* pointer_token_mut_get(
+    const PointerToken* tok, yyjson_mut_val* ctn
+) {
+  switch (yyjson_mut_get_type(ctn)) {
+    case YYJSON_TYPE_OBJ:
+      return yyjson_mut_obj_getn(ctn, tok->key, tok->key_len);
+    case YYJSON_TYPE_ARR:
+      if (tok->idx >= POINTER_IDX_NONE) return NULL;
+      return yyjson_mut_arr_get(ctn, tok->idx);
+    default:
+      return NULL;
+  }
+}
+
+#endif
@@ -0,0 +1,395 @@
+#include "scan.h"
+
+#include <string.h>
+
+#include "memory.h"
+
+bool scan_fail(Scanner *sc, const char *msg) {
+  if (!sc->err) {
+    sc->err = msg;
+    sc->err_pos = (size_t)(sc->cur - sc->start);
+  }
+  return false;
+}
+
+bool scan_ws(Scanner *sc) {
+  while (sc->cur < sc->end) {
+    switch (*sc->cur) {
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        sc->cur++;
+        continue;
+      case '/':
+        if (!(sc->flags & YYJSON_READ_ALLOW_COMMENTS) ||
+            sc->cur + 1 >= sc->end) {
+          return true;
+        }
+        if (sc->cur[1] == '/') {
+          while (sc->cur < sc->end && *sc->cur != '\n') sc->cur++;
+          continue;
+        }
+        if (sc->cur[1] == '*') {
+          const char *close = NULL;
+          for (const char *p = sc->cur + 2; p + 1 < sc->end; p++) {
+            if (p[0] == '*' && p[1] == '/') {
+              close = p;
+              break;
+            }
+          }
+          if (!close) return scan_fail(sc, "unclosed multiline comment");
+          sc->cur = close + 2;
+          continue;
+        }
+        return true;
+      default:
+        return true;
+    }
+  }
+  return true;
+}
+
+bool scan_string(Scanner *sc, const char **str, size_t *len, bool *escaped) {
+  bool has_escape = false;
+
+  if (scan_peek(sc) != '"') {
+    return scan_fail(sc, "expected a string");
+  }
+
+  const char *p = sc->cur + 1;
+  while (p < sc->end) {
+    const char *quote = memchr(p, '"', sc->end - p);
+    const char *slash = memchr(p, '\\', (quote ? quote : sc->end) - p);
+
+    if (!quote) break;
+
+    if (!slash) {
+      if (str) *str = sc->cur + 1;
+      if (len) *len = (size_t)(quote - sc->cur - 1);
+      if (escaped) *escaped = has_escape;
+      sc->cur = quote + 1;
+      return true;
+    }
+
+    // Skip the escaped character, which might be the quote we found.
+    has_escape = true;
+    p = slash + 2;
+  }
+
+  return scan_fail(sc, "unclosed string");
+}
+
+/**
+ * Skip a number, literal or other unquoted scalar.
+ */
+static bool scan_skip_scalar(Scanner *sc) {
+  const char *p = sc->cur;
+
+  while (p < sc->end) {
+    char c = *p;
+    if (c == ',' || c == ']' || c == '}' || c == ' ' || c == '\t' ||
+        c == '\n' || c == '\r' || c == '/' || c == ':') {
+      break;
+    }
+    p++;
+  }
+
+  if (p == sc->cur) {
+    return scan_fail(sc, "unexpected character");
+  }
+
+  sc->cur = p;
+  return true;
+}
+
+bool scan_skip(Scanner *sc) {
+  char c = scan_peek(sc);
+
+  if (c == '"') {
+    return scan_string(sc, NULL, NULL, NULL);
+  }
+
+  if (c != '[' && c != '{') {
+    return scan_skip_scalar(sc);
+  }
+
+  // Containers are skipped by matching brackets, only stepping over
+  // strings and comments so brackets inside them aren't counted.
+  static const bool structural[256] = {
+      ['"'] = true, ['/'] = true, ['['] = true,
+      [']'] = true, ['{'] = true, ['}'] = true,
+  };
+  size_t depth = 0;
+  while (sc->cur < sc->end) {
+    while (!structural[(unsigned char)*sc->cur]) {
+      if (++sc->cur == sc->end) return scan_fail(sc, "unexpected end of data");
+    }
+
+    switch (*sc->cur) {
+      case '"':
+        if (!scan_string(sc, NULL, NULL, NULL)) return false;
+        continue;
+      case '/':
+        if (!scan_ws(sc)) return false;
+        if (scan_peek(sc) == '/') sc->cur++;
+        continue;
+      case '[':
+      case '{':
+        depth++;
+        break;
+      case ']':
+      case '}':
+        if (--depth == 0) {
+          sc->cur++;
+          return true;
+        }
+        break;
+    }
+    sc->cur++;
+  }
+
+  return scan_fail(sc, "unexpected end of data");
+}
+
+bool scan_container_begin(Scanner *sc, char open) {
+  if (scan_peek(sc) != open) {
+    return scan_fail(
+        sc, open == '[' ? "expected an array" : "expected an object"
+    );
+  }
+  sc->cur++;
+  return true;
+}
+
+int scan_container_next(Scanner *sc, char close, bool *first) {
+  if (!scan_ws(sc)) return -1;
+
+  if (scan_peek(sc) == close) {
+    sc->cur++;
+    return 0;
+  }
+
+  if (!*first) {
+    if (scan_peek(sc) != ',') {
+      scan_fail(
+          sc, close == ']' ? "expected a comma or a closing bracket"
+                           : "expected a comma or a closing brace"
+      );
+      return -1;
+    }
+    sc->cur++;
+    if (!scan_ws(sc)) return -1;
+
+    if (scan_peek(sc) == close) {
+      if (!(sc->flags & YYJSON_READ_ALLOW_TRAILING_COMMAS)) {
+        scan_fail(sc, "trailing comma is not allowed");
+        return -1;
+      }
+      sc->cur++;
+      return 0;
+    }
+  }
+
+  if (sc->cur >= sc->end) {
+    scan_fail(sc, "unexpected end of data");
+    return -1;
+  }
+
+  *first = false;
+  return 1;
+}
+
+bool scan_key(Scanner *sc, const char **str, size_t *len, bool *escaped) {
+  if (!scan_string(sc, str, len, escaped) || !scan_ws(sc)) {
+    return false;
+  }
+  if (scan_peek(sc) != ':') {
+    return scan_fail(sc, "expected a colon after object key");
+  }
+  sc->cur++;
+  return scan_ws(sc);
+}
+
+/**
+ * Parse the value between start and the current position with yyjson, and
+ * copy it into doc.
+ */
+static yyjson_mut_val *scan_read_span(
+    Scanner *sc, const char *start, yyjson_mut_doc *doc
+) {
+  yyjson_read_err err;
+  yyjson_doc *span = yyjson_read_opts(
+      (char *)start, (size_t)(sc->cur - start),
+      sc->flags & ~YYJSON_READ_STOP_WHEN_DONE, &PyMem_Allocator, &err
+  );
+
+  if (!span) {
+    sc->cur = start;
+    scan_fail(sc, err.msg);
+    sc->err_pos += err.pos;
+    return NULL;
+  }
+
+  yyjson_mut_val *val = yyjson_val_mut_copy(doc, yyjson_doc_get_root(span));
+  yyjson_doc_free(span);
+  if (!val) scan_fail(sc, "memory allocation failed");
+  return val;
+}
+
+/**
+ * Find the child of node whose token matches an object key, which is
+ * still escaped if escaped is true.
+ */
+static Py_ssize_t scan_match_key(
+    Scanner *sc, PointerTrie *trie, Py_ssize_t node, const char *key,
+    size_t len, bool escaped, bool *ok
+) {
+  yyjson_doc *unescaped = NULL;
+
+  *ok = true;
+
+  if (escaped) {
+    // Keys rarely contain escapes, so let yyjson handle them, quotes
+    // included.
+    yyjson_read_err err;
+    unescaped = yyjson_read_opts(
+        (char *)key - 1, len + 2, 0, &PyMem_Allocator, &err
+    );
+    if (!unescaped) {
+      *ok = scan_fail(sc, err.msg);
+      return -1;
+    }
+    key = yyjson_get_str(yyjson_doc_get_root(unescaped));
+    len = yyjson_get_len(yyjson_doc_get_root(unescaped));
+  }
+
+  Py_ssize_t child = trie->nodes[node].child;
+  for (; child != -1; child = trie->nodes[child].sibling) {
+    const PointerToken *tok = trie->nodes[child].token;
+    if (tok->key_len == len && memcmp(tok->key, key, len) == 0) break;
+  }
+
+  yyjson_doc_free(unescaped);
+  return child;
+}
+
+static Py_ssize_t scan_match_idx(
+    PointerTrie *trie, Py_ssize_t node, size_t idx
+) {
+  Py_ssize_t child = trie->nodes[node].child;
+  for (; child != -1; child = trie->nodes[child].sibling) {
+    if (trie->nodes[child].token->idx == idx) break;
+  }
+  return child;
+}
+
+static bool scan_select_obj(
+    Scanner *sc, PointerTrie *trie, Py_ssize_t node, yyjson_mut_doc *doc,
+    yyjson_mut_val **val
+) {
+  bool first = true;
+  int more;
+
+  *val = yyjson_mut_obj(doc);
+  if (!*val) return scan_fail(sc, "memory allocation failed");
+
+  if (!scan_container_begin(sc, '{')) return false;
+  while ((more = scan_container_next(sc, '}', &first)) == 1) {
+    const char *key;
+    size_t len;
+    bool escaped, ok;
+
+    const char *key_start = sc->cur;
+    if (!scan_key(sc, &key, &len, &escaped)) return false;
+
+    Py_ssize_t child = scan_match_key(sc, trie, node, key, len, escaped, &ok);
+    if (!ok) return false;
+
+    if (child == -1) {
+      if (!scan_skip(sc)) return false;
+      continue;
+    }
+
+    yyjson_mut_val *member;
+    if (!scan_select(sc, trie, child, doc, &member)) return false;
+    if (!member) continue;
+
+    // Copy the key as it was written, letting yyjson unescape it.
+    Scanner key_sc = *sc;
+    key_sc.cur = key_start + len + 2;
+    yyjson_mut_val *new_key =
+        escaped ? scan_read_span(&key_sc, key_start, doc)
+                : yyjson_mut_strncpy(doc, key, len);
+    if (!new_key || !yyjson_mut_obj_add(*val, new_key, member)) {
+      return scan_fail(sc, "memory allocation failed");
+    }
+  }
+
+  return more == 0;
+}
+
+static bool scan_select_arr(
+    Scanner *sc, PointerTrie *trie, Py_ssize_t node, yyjson_mut_doc *doc,
+    yyjson_mut_val **val
+) {
+  bool first = true;
+  size_t idx = 0, filled = 0;
+  int more;
+
+  *val = yyjson_mut_arr(doc);
+  if (!*val) return scan_fail(sc, "memory allocation failed");
+
+  if (!scan_container_begin(sc, '[')) return false;
+  for (; (more = scan_container_next(sc, ']', &first)) == 1; idx++) {
+    Py_ssize_t child = scan_match_idx(trie, node, idx);
+
+    if (child == -1) {
+      if (!scan_skip(sc)) return false;
+      continue;
+    }
+
+    yyjson_mut_val *item;
+    if (!scan_select(sc, trie, child, doc, &item)) return false;
+    if (!item) continue;
+
+    // Keep the selected element at the same index.
+    for (; filled < idx; filled++) {
+      if (!yyjson_mut_arr_add_null(doc, *val)) {
+        return scan_fail(sc, "memory allocation failed");
+      }
+    }
+    if (!yyjson_mut_arr_append(*val, item)) {
+      return scan_fail(sc, "memory allocation failed");
+    }
+    filled++;
+  }
+
+  return more == 0;
+}
+
+bool scan_select(
+    Scanner *sc, PointerTrie *trie, Py_ssize_t node, yyjson_mut_doc *doc,
+    yyjson_mut_val **val
+) {
+  const char *start = sc->cur;
+
+  *val = NULL;
+
+  if (trie->nodes[node].target != -1) {
+    // The whole value is selected.
+    if (!scan_skip(sc)) return false;
+    *val = scan_read_span(sc, start, doc);
+    return *val != NULL;
+  }
+
+  switch (scan_peek(sc)) {
+    case '{':
+      return scan_select_obj(sc, trie, node, doc, val);
+    case '[':
+      return scan_select_arr(sc, trie, node, doc, val);
+    default:
+      // Nothing below a scalar can be selected.
+      return scan_skip(sc);
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef PY_YYJSON_SCAN_H
+#define PY_YYJSON_SCAN_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "pointer.h"
+#include "yyjson.h"
+
+/**
+ * A forward-only structural scanner over JSON text. It finds the bounds of
+ * values without building a document, so uninteresting values can be
+ * skipped without being validated or unescaped beyond matching their
+ * brackets and quotes.
+ */
+typedef struct {
+  /** The start of the input, used to report error positions. */
+  const char* start;
+  /** The current position in the input. */
+  const char* cur;
+  /** The end of the input. */
+  const char* end;
+  /** The reader flags, of which comments and trailing commas apply. */
+  yyjson_read_flag flags;
+  /** The error message, if scanning failed. */
+  const char* err;
+  /** The position of the error in the input. */
+  size_t err_pos;
+} Scanner;
+
+static inline void scanner_init(
+    Scanner* sc, const char* buf, size_t len, yyjson_read_flag flags
+) {
+  sc->start = buf;
+  sc->cur = buf;
+  sc->end = buf + len;
+  sc->flags = flags;
+  sc->err = NULL;
+  sc->err_pos = 0;
+}
+
+/**
+ * Returns the character at the current position, or 0 at the end of the
+ * input.
+ */
+static inline char scan_peek(Scanner* sc) {
+  return sc->cur < sc->end ? *sc->cur : 0;
+}
+
+/**
+ * Record an error at the current position. Always returns false.
+ */
+bool scan_fail(Scanner* sc, const char* msg);
+
+/**
+ * Skip whitespace, and comments if ALLOW_COMMENTS is set.
+ */
+bool scan_ws(Scanner* sc);
+
+/**
+ * Scan the string starting at the current position, setting str and len to
+ * its still-escaped content (without quotes). If escaped is given, it's set
+ * to whether the string contains any escape sequences.
+ */
+bool scan_string(Scanner* sc, const char** str, size_t* len, bool* escaped);
+
+/**
+ * Skip the value starting at the current position.
+ */
+bool scan_skip(Scanner* sc);
+
+/**
+ * Consume the opening bracket of an array or object at the current
+ * position.
+ */
+bool scan_container_begin(Scanner* sc, char open);
+
+/**
+ * Move to the next element of an array or member of an object, consuming
+ * the separating comma. first must be true for the first call on a
+ * container. Returns 1 if there is another item at the current position,
+ * 0 (after consuming the closing bracket) if there are no more, or -1 on
+ * error.
+ */
+int scan_container_next(Scanner* sc, char close, bool* first);
+
+/**
+ * Scan an object member's key and the following colon, leaving the
+ * scanner at its value.
+ */
+bool scan_key(Scanner* sc, const char** str, size_t* len, bool* escaped);
+
+/**
+ * Read the value starting at the current position and copy only the parts
+ * of it selected by trie into doc, skipping everything else. Unselected
+ * array elements before a selected one are replaced by nulls so that
+ * indexes are preserved. A container on a selected path is always copied,
+ * if only as an empty {} or [] when nothing in it matched, while val is
+ * set to NULL for a scalar with a path continuing below it.
+ */
+bool scan_select(
+    Scanner* sc, PointerTrie* trie, Py_ssize_t node, yyjson_mut_doc* doc,
+    yyjson_mut_val** val
+);
+
+#endif
@@ -0,0 +1,311 @@
+#include "shared.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "snapshot.h"
+
+/** multiprocessing.shared_memory.SharedMemory, imported on first use. */
+static PyObject *shared_memory_cls = NULL;
+
+/**
+ * Weak references to the segments created by this process, by name.
+ * Children started with fork() inherit these along with the mappings, at
+ * the same addresses.
+ */
+static PyObject *shared_created = NULL;
+
+static PyObject *shared_memory_class(void) {
+  if (yyjson_unlikely(shared_memory_cls == NULL)) {
+    PyObject *module = PyImport_ImportModule("multiprocessing.shared_memory");
+    if (!module) return NULL;
+    shared_memory_cls = PyObject_GetAttrString(module, "SharedMemory");
+    Py_DECREF(module);
+  }
+  return shared_memory_cls;
+}
+
+static void shared_error(const char *err) {
+  if (err) {
+    PyErr_SetString(PyExc_ValueError, err);
+  } else {
+    PyErr_NoMemory();
+  }
+}
+
+/**
+ * Call the given method of shm without arguments, keeping any exception
+ * that's already set.
+ */
+static int shared_call(PyObject *shm, const char *method) {
+  PyObject *type, *value, *traceback;
+  PyErr_Fetch(&type, &value, &traceback);
+
+  PyObject *result = PyObject_CallMethod(shm, method, NULL);
+  Py_XDECREF(result);
+
+  if (type) {
+    PyErr_Restore(type, value, traceback);
+    return -1;
+  }
+  return result ? 0 : -1;
+}
+
+PyObject *shared_create(yyjson_doc *doc, PyObject *name) {
+  PyObject *cls = shared_memory_class();
+  if (!cls) return NULL;
+
+  PyObject *args = PyTuple_New(0);
+  PyObject *kwargs = Py_BuildValue(
+      "{s:O,s:O,s:n}", "name", name, "create", Py_True, "size",
+      (Py_ssize_t)snapshot_size(doc)
+  );
+  PyObject *shm = args && kwargs ? PyObject_Call(cls, args, kwargs) : NULL;
+  Py_XDECREF(args);
+  Py_XDECREF(kwargs);
+  if (!shm) return NULL;
+
+  // The segment may be larger than asked for, but never smaller.
+  Py_buffer view;
+  PyObject *buf = PyObject_GetAttrString(shm, "buf");
+  if (!buf || PyObject_GetBuffer(buf, &view, PyBUF_WRITABLE) < 0) {
+    Py_XDECREF(buf);
+    goto fail;
+  }
+  Py_DECREF(buf);
+  snapshot_write(doc, view.buf, true);
+  PyBuffer_Release(&view);
+
+  if (!shared_created) {
+    shared_created = PyDict_New();
+    if (!shared_created) goto fail;
+  }
+  PyObject *shm_name = PyObject_GetAttrString(shm, "name");
+  PyObject *ref = shm_name ? PyWeakref_NewRef(shm, NULL) : NULL;
+  int r = ref ? PyDict_SetItem(shared_created, shm_name, ref) : -1;
+  Py_XDECREF(shm_name);
+  Py_XDECREF(ref);
+  if (r < 0) goto fail;
+
+  return shm;
+
+fail:
+  shared_call(shm, "close");
+  shared_call(shm, "unlink");
+  Py_DECREF(shm);
+  return NULL;
+}
+
+/**
+ * Use the segment of shm in place, if it's mapped where its snapshot was
+ * written. Returns NULL without an exception if it isn't.
+ */
+static yyjson_doc *shared_use_buffer(
+    PyObject *shm, const yyjson_alc *alc, PyObject **owner
+) {
+  PyObject *buf = PyObject_GetAttrString(shm, "buf");
+  if (!buf || buf == Py_None) {
+    // The segment was closed.
+    Py_XDECREF(buf);
+    return NULL;
+  }
+
+  // A view of the buffer stops the segment from being closed while the
+  // document uses it.
+  PyObject *view = PyMemoryView_FromObject(buf);
+  Py_DECREF(buf);
+  if (!view) return NULL;
+
+  Py_buffer *mem = PyMemoryView_GET_BUFFER(view);
+  size_t len = snapshot_length(mem->buf, (size_t)mem->len);
+  if (!len || !snapshot_in_place(mem->buf, len)) {
+    Py_DECREF(view);
+    return NULL;
+  }
+
+  const char *err;
+  yyjson_doc *doc = snapshot_attach(mem->buf, len, alc, &err);
+  if (!doc) {
+    Py_DECREF(view);
+    shared_error(err);
+    return NULL;
+  }
+
+  *owner = view;
+  return doc;
+}
+
+#ifndef _WIN32
+static void shared_unmap(PyObject *capsule) {
+  void *addr = PyCapsule_GetPointer(capsule, "cyyjson.shared");
+  munmap(addr, (size_t)(uintptr_t)PyCapsule_GetContext(capsule));
+}
+
+/**
+ * Open the segment named name read-only, as SharedMemory does but without
+ * registering it with the resource tracker. A process with a tracker of its
+ * own would unlink the segment when it exits, and one sharing the tracker
+ * of the segment's creator would forget the creator's registration.
+ */
+static int shared_open(PyObject *name) {
+  PyObject *posixshmem = PyImport_ImportModule("_posixshmem");
+  if (!posixshmem) return -1;
+
+  PyObject *path = PyUnicode_FromFormat("/%U", name);
+  PyObject *fd_obj =
+      path ? PyObject_CallMethod(
+                 posixshmem, "shm_open", "Oii", path, O_RDONLY, 0600
+             )
+           : NULL;
+  Py_DECREF(posixshmem);
+  Py_XDECREF(path);
+  if (!fd_obj) return -1;
+
+  int fd = PyLong_AsLong(fd_obj);
+  Py_DECREF(fd_obj);
+  return fd;
+}
+
+/**
+ * Load the document in the segment open as fd, mapping it at the address
+ * it was written for if that's free.
+ */
+static yyjson_doc *shared_attach_fd(
+    int fd, const yyjson_alc *alc, PyObject **owner
+) {
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    PyErr_SetFromErrno(PyExc_OSError);
+    return NULL;
+  }
+  size_t size = (size_t)st.st_size;
+  if (!size) {
+    PyErr_SetString(PyExc_ValueError, "not a snapshot");
+    return NULL;
+  }
+
+  char *addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    PyErr_SetFromErrno(PyExc_OSError);
+    return NULL;
+  }
+
+  size_t len = snapshot_length(addr, size);
+  if (!len) {
+    munmap(addr, size);
+    PyErr_SetString(PyExc_ValueError, "not a snapshot");
+    return NULL;
+  }
+
+  SnapshotHeader header;
+  memcpy(&header, addr, sizeof(header));
+  char *want = (char *)(uintptr_t)header.base;
+  if (header.base && addr != want) {
+    // Without MAP_FIXED this is only a hint, which is taken whenever nothing
+    // else is mapped there.
+    char *moved = mmap(want, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (moved == want) {
+      munmap(addr, size);
+      addr = moved;
+    } else if (moved != MAP_FAILED) {
+      munmap(moved, size);
+    }
+  }
+
+  const char *err;
+  yyjson_doc *doc;
+
+  if (addr != want) {
+    // The segment can't be used in place here, so load a copy.
+    doc = snapshot_read(addr, len, alc, &err);
+    munmap(addr, size);
+    if (!doc) shared_error(err);
+    return doc;
+  }
+
+  PyObject *capsule = PyCapsule_New(addr, "cyyjson.shared", shared_unmap);
+  if (!capsule) {
+    munmap(addr, size);
+    return NULL;
+  }
+  PyCapsule_SetContext(capsule, (void *)(uintptr_t)size);
+
+  doc = snapshot_attach(addr, len, alc, &err);
+  if (!doc) {
+    Py_DECREF(capsule);
+    shared_error(err);
+    return NULL;
+  }
+
+  *owner = capsule;
+  return doc;
+}
+#else
+/**
+ * Load a copy of the document in the segment named name.
+ */
+static yyjson_doc *shared_attach_copy(PyObject *name, const yyjson_alc *alc) {
+  PyObject *cls = shared_memory_class();
+  if (!cls) return NULL;
+
+  PyObject *shm = PyObject_CallOneArg(cls, name);
+  if (!shm) return NULL;
+
+  yyjson_doc *doc = NULL;
+  Py_buffer view;
+  PyObject *buf = PyObject_GetAttrString(shm, "buf");
+  if (buf && PyObject_GetBuffer(buf, &view, PyBUF_SIMPLE) == 0) {
+    const char *err = "not a snapshot";
+    size_t len = snapshot_length(view.buf, (size_t)view.len);
+    doc = len ? snapshot_read(view.buf, len, alc, &err) : NULL;
+    if (!doc) shared_error(err);
+    PyBuffer_Release(&view);
+  }
+  Py_XDECREF(buf);
+
+  if (shared_call(shm, "close") < 0 && doc) {
+    yyjson_doc_free(doc);
+    doc = NULL;
+  }
+  Py_DECREF(shm);
+  return doc;
+}
+#endif
+
+yyjson_doc *shared_attach(
+    PyObject *name, const yyjson_alc *alc, PyObject **owner
+) {
+  yyjson_doc *doc = NULL;
+  *owner = NULL;
+
+  // A segment created by this process, or by the one it was forked from,
+  // is already mapped where it was written.
+  PyObject *ref =
+      shared_created ? PyDict_GetItemWithError(shared_created, name) : NULL;
+  if (ref) {
+    PyObject *created = PyObject_CallNoArgs(ref);
+    if (!created) return NULL;
+    if (created != Py_None) {
+      doc = shared_use_buffer(created, alc, owner);
+    }
+    Py_DECREF(created);
+  }
+  if (doc || PyErr_Occurred()) return doc;
+
+#ifndef _WIN32
+  int fd = shared_open(name);
+  if (fd < 0) return NULL;
+  doc = shared_attach_fd(fd, alc, owner);
+  close(fd);
+  return doc;
+#else
+  return shared_attach_copy(name, alc);
+#endif
+}
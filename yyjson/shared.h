@@ -0,0 +1,29 @@
+#ifndef PY_YYJSON_SHARED_H
+#define PY_YYJSON_SHARED_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "yyjson.h"
+
+/**
+ * Write a snapshot of doc in place into a new
+ * multiprocessing.shared_memory.SharedMemory named name, or with a random
+ * name if name is None, and return it.
+ */
+PyObject* shared_create(yyjson_doc* doc, PyObject* name);
+
+/**
+ * Load the document in the shared memory segment named name, using it in
+ * place when it can be seen at the address it was written at, and copying
+ * it otherwise.
+ *
+ * Returns NULL and sets an exception on failure. If the segment is used in
+ * place, owner is set to a new reference that keeps it mapped and must
+ * outlive the document, otherwise it's set to NULL.
+ */
+yyjson_doc* shared_attach(
+    PyObject* name, const yyjson_alc* alc, PyObject** owner
+);
+
+#endif
@@ -0,0 +1,376 @@
+#include "snapshot.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "value.h"
+
+static const char SNAPSHOT_MAGIC[8] = "yyjsnap";
+
+/**
+ * Where a container's children end while checking a snapshot, and how many
+ * of them are left to check.
+ */
+typedef struct {
+  size_t end;
+  uint64_t remaining;
+  bool obj;
+} SnapshotFrame;
+
+/**
+ * Returns the number of values in the tree rooted at root, which are laid
+ * out contiguously.
+ */
+static inline size_t snapshot_num_vals(yyjson_val *root) {
+  return (size_t)(unsafe_yyjson_get_next(root) - root);
+}
+
+static inline bool snapshot_has_str(yyjson_val *val) {
+  yyjson_type type = unsafe_yyjson_get_type(val);
+  return type == YYJSON_TYPE_STR || type == YYJSON_TYPE_RAW;
+}
+
+size_t snapshot_size(yyjson_doc *doc) {
+  yyjson_val *root = yyjson_doc_get_root(doc);
+  size_t num_vals = snapshot_num_vals(root);
+  size_t size = sizeof(SnapshotHeader) + num_vals * sizeof(yyjson_val);
+
+  for (size_t i = 0; i < num_vals; i++) {
+    if (snapshot_has_str(root + i)) {
+      size += unsafe_yyjson_get_len(root + i) + 1;
+    }
+  }
+  return size;
+}
+
+void snapshot_write(yyjson_doc *doc, char *buf, bool in_place) {
+  yyjson_val *root = yyjson_doc_get_root(doc);
+  size_t num_vals = snapshot_num_vals(root);
+  yyjson_val *vals = (yyjson_val *)(void *)(buf + sizeof(SnapshotHeader));
+  char *strs = (char *)(vals + num_vals);
+  uint64_t str_base = in_place ? (uint64_t)(uintptr_t)strs : 0;
+  size_t str_len = 0;
+
+  memcpy(vals, root, num_vals * sizeof(yyjson_val));
+  for (size_t i = 0; i < num_vals; i++) {
+    if (!snapshot_has_str(vals + i)) continue;
+
+    size_t len = unsafe_yyjson_get_len(vals + i);
+    memcpy(strs + str_len, vals[i].uni.str, len);
+    strs[str_len + len] = '\0';
+    vals[i].uni.u64 = str_base + str_len;
+    str_len += len + 1;
+  }
+
+  SnapshotHeader header = {
+      .version = SNAPSHOT_VERSION,
+      .byte_order = SNAPSHOT_BYTE_ORDER,
+      .num_vals = num_vals,
+      .str_len = str_len,
+      .base = in_place ? (uint64_t)(uintptr_t)buf : 0,
+  };
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  memcpy(buf, &header, sizeof(header));
+}
+
+/**
+ * Check a value of the snapshot and, unless it's being used in place, point
+ * its string, if it has one, into strs.
+ */
+static bool snapshot_fix_val(
+    yyjson_val *val, char *strs, uint64_t str_len, uint64_t str_base,
+    bool in_place, const char **err
+) {
+  yyjson_subtype subtype = unsafe_yyjson_get_subtype(val);
+
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      if (subtype != YYJSON_SUBTYPE_NONE) break;
+      return true;
+    case YYJSON_TYPE_BOOL:
+      if (subtype != YYJSON_SUBTYPE_TRUE && subtype != YYJSON_SUBTYPE_FALSE) {
+        break;
+      }
+      return true;
+    case YYJSON_TYPE_NUM:
+      if (subtype != YYJSON_SUBTYPE_UINT && subtype != YYJSON_SUBTYPE_SINT &&
+          subtype != YYJSON_SUBTYPE_REAL) {
+        break;
+      }
+      return true;
+    case YYJSON_TYPE_STR:
+    case YYJSON_TYPE_RAW: {
+      uint64_t len = val->tag >> YYJSON_TAG_BIT;
+      uint64_t ofs = val->uni.u64 - str_base;
+      bool noesc;
+
+      if (ofs >= str_len || len >= str_len - ofs || strs[ofs + len] != '\0') {
+        *err = "snapshot string is out of bounds";
+        return false;
+      }
+      if (!str_check(strs + ofs, (size_t)len, &noesc)) {
+        *err = "snapshot string is not valid UTF-8";
+        return false;
+      }
+      // Raw values are written out verbatim, so they must be exactly one
+      // number for the Document to stay valid JSON.
+      if (unsafe_yyjson_get_type(val) == YYJSON_TYPE_RAW) {
+        yyjson_val num;
+        const char *end = yyjson_read_number(
+            strs + ofs, &num,
+            YYJSON_READ_NUMBER_AS_RAW | YYJSON_READ_ALLOW_INF_AND_NAN, NULL,
+            NULL
+        );
+        if (end != strs + ofs + len) {
+          *err = "snapshot raw value is not a number";
+          return false;
+        }
+      }
+      // Only trust the writer's hint that nothing needs escaping when it's
+      // true.
+      if (!noesc && subtype == YYJSON_SUBTYPE_NOESC) {
+        if (in_place) {
+          *err = "snapshot string is wrongly marked as needing no escaping";
+          return false;
+        }
+        val->tag &= ~(uint64_t)YYJSON_SUBTYPE_MASK;
+      }
+      if (!in_place) val->uni.str = strs + ofs;
+      return true;
+    }
+    default:
+      break;
+  }
+
+  *err = "snapshot has a value of an unknown type";
+  return false;
+}
+
+/**
+ * Check that the values of a snapshot form exactly one tree, with object
+ * keys that are strings, fixing up string pointers along the way unless
+ * it's being used in place.
+ */
+static bool snapshot_fix(
+    yyjson_val *vals, size_t num_vals, char *strs, uint64_t str_len,
+    uint64_t str_base, bool in_place, const yyjson_alc *alc, const char **err
+) {
+  SnapshotFrame *stack = NULL;
+  size_t depth = 0;
+  size_t stack_cap = 0;
+  bool ok = false;
+
+  for (size_t i = 0; i < num_vals; i++) {
+    yyjson_val *val = vals + i;
+    size_t parent_end = num_vals;
+    bool is_key = false;
+
+    if (depth) {
+      SnapshotFrame *parent = &stack[depth - 1];
+      if (!parent->remaining) {
+        *err = "snapshot container has too many values";
+        goto done;
+      }
+      is_key = parent->obj && parent->remaining % 2 == 0;
+      parent->remaining--;
+      parent_end = parent->end;
+    } else if (i) {
+      *err = "snapshot has values after the root";
+      goto done;
+    }
+
+    if (is_key && !unsafe_yyjson_is_str(val)) {
+      *err = "snapshot object key is not a string";
+      goto done;
+    }
+
+    if (unsafe_yyjson_is_ctn(val)) {
+      uint64_t len = val->tag >> YYJSON_TAG_BIT;
+      bool obj = unsafe_yyjson_is_obj(val);
+      size_t ofs = val->uni.ofs;
+      size_t count = ofs / sizeof(yyjson_val);
+
+      if (ofs % sizeof(yyjson_val) || !count || count > parent_end - i ||
+          (!depth && count != num_vals) || len > (uint64_t)count ||
+          (obj && len * 2 > (uint64_t)count)) {
+        *err = "snapshot container is out of bounds";
+        goto done;
+      }
+
+      uint64_t children = obj ? len * 2 : len;
+      if (count == 1) {
+        if (children) {
+          *err = "snapshot container has too few values";
+          goto done;
+        }
+      } else {
+        if (depth == stack_cap) {
+          size_t cap = stack_cap ? stack_cap * 2 : 32;
+          SnapshotFrame *grown = alc->realloc(
+              alc->ctx, stack, stack_cap * sizeof(*stack), cap * sizeof(*stack)
+          );
+          if (!grown) goto done;
+          stack = grown;
+          stack_cap = cap;
+        }
+        stack[depth++] = (SnapshotFrame){i + count, children, obj};
+        continue;
+      }
+    } else if (!snapshot_fix_val(
+                   val, strs, str_len, str_base, in_place, err
+               )) {
+      goto done;
+    }
+
+    while (depth && stack[depth - 1].end == i + 1) {
+      if (stack[depth - 1].remaining) {
+        *err = "snapshot container has too few values";
+        goto done;
+      }
+      depth--;
+    }
+  }
+
+  ok = true;
+
+done:
+  if (stack) alc->free(alc->ctx, stack);
+  return ok;
+}
+
+/**
+ * Read and check the header of the snapshot in buf.
+ */
+static bool snapshot_header(
+    const char *buf, size_t len, SnapshotHeader *header, const char **err
+) {
+  if (len < sizeof(*header)) {
+    *err = "snapshot is truncated";
+    return false;
+  }
+  memcpy(header, buf, sizeof(*header));
+
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+    *err = "not a snapshot";
+    return false;
+  }
+  if (header->version != SNAPSHOT_VERSION) {
+    *err = "unsupported snapshot version";
+    return false;
+  }
+  if (header->byte_order != SNAPSHOT_BYTE_ORDER) {
+    *err = "snapshot was taken on a machine with a different byte order";
+    return false;
+  }
+
+  size_t body = len - sizeof(*header);
+  if (!header->num_vals || header->num_vals > body / sizeof(yyjson_val) ||
+      header->str_len != body - header->num_vals * sizeof(yyjson_val)) {
+    *err = "snapshot is truncated";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Returns the address strings are offset from in the values of a snapshot.
+ */
+static inline uint64_t snapshot_str_base(const SnapshotHeader *header) {
+  if (!header->base) return 0;
+  return header->base + sizeof(*header) +
+         header->num_vals * sizeof(yyjson_val);
+}
+
+yyjson_doc *snapshot_read(
+    const char *buf, size_t len, const yyjson_alc *alc, const char **err
+) {
+  SnapshotHeader header;
+
+  *err = NULL;
+  if (!snapshot_header(buf, len, &header, err)) return NULL;
+
+  // The document, its values and its strings share one allocation, laid
+  // out like yyjson_mut_val_imut_copy() does.
+  size_t body = len - sizeof(header);
+  size_t hdr_size = (sizeof(yyjson_doc) + sizeof(yyjson_val) - 1) /
+                    sizeof(yyjson_val) * sizeof(yyjson_val);
+  yyjson_doc *doc = alc->malloc(alc->ctx, hdr_size + body);
+  if (!doc) return NULL;
+
+  memset(doc, 0, sizeof(yyjson_doc));
+  yyjson_val *vals = (yyjson_val *)(void *)((char *)doc + hdr_size);
+  char *strs = (char *)(vals + header.num_vals);
+  memcpy(vals, buf + sizeof(header), body);
+
+  doc->root = vals;
+  doc->alc = *alc;
+  doc->val_read = (size_t)header.num_vals;
+  doc->dat_read = (size_t)header.str_len + 1;
+
+  if (!snapshot_fix(
+          vals, (size_t)header.num_vals, strs, header.str_len,
+          snapshot_str_base(&header), false, alc, err
+      )) {
+    alc->free(alc->ctx, doc);
+    return NULL;
+  }
+  return doc;
+}
+
+size_t snapshot_length(const char *buf, size_t len) {
+  SnapshotHeader header;
+
+  if (len < sizeof(header)) return 0;
+  memcpy(&header, buf, sizeof(header));
+
+  size_t body = len - sizeof(header);
+  if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+      header.num_vals > body / sizeof(yyjson_val) ||
+      header.str_len > body - header.num_vals * sizeof(yyjson_val)) {
+    return 0;
+  }
+  return sizeof(header) + (size_t)header.num_vals * sizeof(yyjson_val) +
+         (size_t)header.str_len;
+}
+
+bool snapshot_in_place(const char *buf, size_t len) {
+  SnapshotHeader header;
+  const char *err;
+
+  return snapshot_header(buf, len, &header, &err) &&
+         header.base == (uint64_t)(uintptr_t)buf;
+}
+
+yyjson_doc *snapshot_attach(
+    const char *buf, size_t len, const yyjson_alc *alc, const char **err
+) {
+  SnapshotHeader header;
+
+  *err = NULL;
+  if (!snapshot_header(buf, len, &header, err)) return NULL;
+  if (header.base != (uint64_t)(uintptr_t)buf) {
+    *err = "snapshot was not written for use at this address";
+    return NULL;
+  }
+
+  yyjson_val *vals = (yyjson_val *)(void *)(buf + sizeof(header));
+  char *strs = (char *)(vals + header.num_vals);
+  if (!snapshot_fix(
+          vals, (size_t)header.num_vals, strs, header.str_len,
+          snapshot_str_base(&header), true, alc, err
+      )) {
+    return NULL;
+  }
+
+  // Only the document itself is allocated. Its str_pool stays NULL, so
+  // freeing it leaves buf alone.
+  yyjson_doc *doc = alc->malloc(alc->ctx, sizeof(yyjson_doc));
+  if (!doc) return NULL;
+
+  memset(doc, 0, sizeof(yyjson_doc));
+  doc->root = vals;
+  doc->alc = *alc;
+  doc->val_read = (size_t)header.num_vals;
+  doc->dat_read = (size_t)header.str_len + 1;
+  return doc;
+}
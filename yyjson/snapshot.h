@@ -0,0 +1,91 @@
+#ifndef PY_YYJSON_SNAPSHOT_H
+#define PY_YYJSON_SNAPSHOT_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yyjson.h"
+
+/**
+ * The version of the snapshot layout, bumped whenever it changes.
+ */
+#define SNAPSHOT_VERSION 1
+
+/**
+ * The start of a snapshot of an immutable document.
+ *
+ * It's followed by the document's values exactly as yyjson lays them out,
+ * except that the string of each string or raw value is replaced by its
+ * offset into the string data, and then by the string data itself, with
+ * every string NUL-terminated. Containers already locate their children by
+ * offset, so a snapshot doesn't depend on where it's loaded.
+ *
+ * A snapshot written in place holds the addresses its strings are at
+ * instead, so a process that sees it at the same address can use it
+ * without copying or changing it.
+ *
+ * Numbers are stored in native byte order, and snapshots from a machine
+ * with the other byte order are rejected.
+ */
+typedef struct {
+  /** "yyjsnap\0". */
+  char magic[8];
+  uint32_t version;
+  /** SNAPSHOT_BYTE_ORDER as written by the machine that took it. */
+  uint32_t byte_order;
+  /** The number of values. */
+  uint64_t num_vals;
+  /** The number of bytes of string data. */
+  uint64_t str_len;
+  /** The address of the snapshot if it was written in place, else 0. */
+  uint64_t base;
+} SnapshotHeader;
+
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+/**
+ * Returns the size of the snapshot of doc, in bytes.
+ */
+size_t snapshot_size(yyjson_doc* doc);
+
+/**
+ * Write the snapshot of doc into buf, which must hold snapshot_size(doc)
+ * bytes, and be aligned like a pointer if in_place is true. Doesn't need
+ * the GIL.
+ */
+void snapshot_write(yyjson_doc* doc, char* buf, bool in_place);
+
+/**
+ * Load a document from the snapshot in buf, checking that every value and
+ * string in it is valid. Doesn't need the GIL if alc doesn't.
+ *
+ * Returns NULL and sets err if the snapshot is invalid. A NULL return with
+ * err unset means allocation failed.
+ */
+yyjson_doc* snapshot_read(
+    const char* buf, size_t len, const yyjson_alc* alc, const char** err
+);
+
+/**
+ * Returns the length of the snapshot at the start of buf, which may be
+ * followed by other data, or 0 if there isn't one that fits in len bytes.
+ */
+size_t snapshot_length(const char* buf, size_t len);
+
+/**
+ * Returns whether buf holds a snapshot written in place at its address.
+ */
+bool snapshot_in_place(const char* buf, size_t len);
+
+/**
+ * Load a document that uses the snapshot in buf directly, which must have
+ * been written in place at that address, after checking it like
+ * snapshot_read() does. buf isn't modified, and must outlive the document.
+ */
+yyjson_doc* snapshot_attach(
+    const char* buf, size_t len, const yyjson_alc* alc, const char** err
+);
+
+#endif
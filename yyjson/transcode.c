@@ -0,0 +1,1261 @@
+#include "transcode.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "value.h"
+
+/*=============================================================================
+ * Writing
+ *===========================================================================*/
+
+/**
+ * A growable output buffer.
+ */
+typedef struct {
+  char *buf;
+  size_t len;
+  size_t cap;
+  const char *err;
+} BinWriter;
+
+static bool bw_reserve(BinWriter *w, size_t extra) {
+  if (w->len + extra <= w->cap) {
+    return true;
+  }
+
+  size_t cap = w->cap ? w->cap : 256;
+  while (cap < w->len + extra) cap *= 2;
+
+  char *buf = PyMem_RawRealloc(w->buf, cap);
+  if (!buf) return false;
+  w->buf = buf;
+  w->cap = cap;
+  return true;
+}
+
+static inline bool bw_write(BinWriter *w, const char *data, size_t len) {
+  if (!bw_reserve(w, len)) return false;
+  memcpy(w->buf + w->len, data, len);
+  w->len += len;
+  return true;
+}
+
+/**
+ * Write a byte followed by the low size bytes of arg, big-endian.
+ */
+static inline bool bw_head(BinWriter *w, uint8_t head, uint64_t arg, int size) {
+  if (!bw_reserve(w, 1 + size)) return false;
+  w->buf[w->len++] = (char)head;
+  for (int i = size - 1; i >= 0; i--) {
+    w->buf[w->len++] = (char)(arg >> (i * 8));
+  }
+  return true;
+}
+
+static inline uint64_t bw_real_bits(double num) {
+  uint64_t bits;
+  memcpy(&bits, &num, sizeof(bits));
+  return bits;
+}
+
+/**
+ * Read a raw number the way it would be read without NUMBERS_AS_RAW, since
+ * binary formats have nothing equivalent. Integers too large for 64 bits
+ * become reals.
+ */
+static bool bw_raw_to_num(BinWriter *w, void *raw, yyjson_val *num) {
+  if (!yyjson_read_number(
+          unsafe_yyjson_get_raw(raw), num, YYJSON_READ_ALLOW_INF_AND_NAN,
+          NULL, NULL
+      )) {
+    w->err = "raw value is not a number";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Write val with write_val, which writes a single value or the head of a
+ * container, and then the children of each container after its head.
+ */
+static bool bw_walk_mut(
+    BinWriter *w, yyjson_mut_val *val, bool (*write_val)(BinWriter *, void *)
+) {
+  if (!write_val(w, val)) return false;
+  if (!unsafe_yyjson_is_ctn(val)) return true;
+
+  ValIter iter;
+  void *child;
+  val_iter_init(&iter, val, true);
+  while ((child = val_iter_next(&iter))) {
+    if (!bw_walk_mut(w, child, write_val)) return false;
+    if (iter.obj && !bw_walk_mut(w, val_key_value(child, true), write_val)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Write val with write_val, as bw_walk_mut() does, into a new buffer.
+ */
+static char *bw_run(
+    void *val, bool mut, bool (*write_val)(BinWriter *, void *), size_t *len,
+    const char **err
+) {
+  BinWriter w = {0};
+  bool ok = true;
+
+  *err = NULL;
+
+  if (mut) {
+    ok = bw_walk_mut(&w, val, write_val);
+  } else {
+    // Immutable values are laid out in the order they're written, with
+    // each container's head before its children.
+    yyjson_val *end = unsafe_yyjson_get_next((yyjson_val *)val);
+    for (yyjson_val *cur = val; ok && cur < end; cur++) {
+      ok = write_val(&w, cur);
+    }
+  }
+
+  if (!ok) {
+    *err = w.err;
+    PyMem_RawFree(w.buf);
+    return NULL;
+  }
+
+  *len = w.len;
+  return w.buf;
+}
+
+/*=============================================================================
+ * Reading
+ *===========================================================================*/
+
+/**
+ * A container being read. Definite-length containers end after remaining
+ * more children, and indefinite-length ones at a break. Object members
+ * count as two children, the key and the value.
+ */
+typedef struct {
+  size_t val;
+  uint64_t remaining;
+  uint64_t count;
+  bool obj;
+  bool indefinite;
+} BinFrame;
+
+/**
+ * Reads a binary format into an immutable document in two passes over the
+ * input: the first checks it and counts the values and string bytes it
+ * needs, and the second, with vals set, fills them in.
+ */
+typedef struct {
+  const uint8_t *start;
+  const uint8_t *cur;
+  const uint8_t *end;
+  /** The start of the item being read, where errors are reported. */
+  const uint8_t *item;
+  const char *err;
+  /** The values and strings being filled in, or NULL while counting. */
+  yyjson_val *vals;
+  char *strs;
+  size_t num_vals;
+  size_t str_len;
+  /**
+   * What the first pass counted. The input may be a mutable buffer that
+   * changes between passes, so the second never trusts it to match.
+   */
+  size_t max_vals;
+  size_t max_str_len;
+  BinFrame *stack;
+  size_t depth;
+  size_t stack_cap;
+  /** Room for building raw numbers. */
+  char *scratch;
+  size_t scratch_cap;
+} BinReader;
+
+static inline bool br_fail(BinReader *r, const char *msg) {
+  r->err = msg;
+  return false;
+}
+
+static inline bool br_need(BinReader *r, size_t n) {
+  if ((size_t)(r->end - r->cur) < n) {
+    return br_fail(r, "unexpected end of data");
+  }
+  return true;
+}
+
+static inline bool br_changed(BinReader *r) {
+  return br_fail(r, "data changed while it was being read");
+}
+
+/**
+ * Read an n byte big-endian unsigned integer.
+ */
+static inline bool br_uint_be(BinReader *r, int n, uint64_t *out) {
+  if (!br_need(r, n)) return false;
+  uint64_t v = 0;
+  for (int i = 0; i < n; i++) {
+    v = (v << 8) | r->cur[i];
+  }
+  r->cur += n;
+  *out = v;
+  return true;
+}
+
+/**
+ * Add a value, checking that it's a string if it's in the place of an
+ * object key, and return it for filling in, or NULL while counting.
+ */
+static yyjson_val *br_add(BinReader *r, uint64_t tag, bool *ok) {
+  if (r->depth) {
+    BinFrame *parent = &r->stack[r->depth - 1];
+    if (parent->obj && parent->count % 2 == 0 &&
+        (tag & YYJSON_TYPE_MASK) != YYJSON_TYPE_STR) {
+      *ok = br_fail(r, "object keys must be strings");
+      return NULL;
+    }
+    parent->count++;
+    if (!parent->indefinite) parent->remaining--;
+  }
+
+  if (r->vals && r->num_vals == r->max_vals) {
+    *ok = br_changed(r);
+    return NULL;
+  }
+
+  *ok = true;
+  yyjson_val *val = r->vals ? r->vals + r->num_vals : NULL;
+  if (val) val->tag = tag;
+  r->num_vals++;
+  return val;
+}
+
+/**
+ * Close the innermost container.
+ */
+static inline void br_pop(BinReader *r) {
+  BinFrame *frame = &r->stack[--r->depth];
+  if (r->vals) {
+    yyjson_val *val = &r->vals[frame->val];
+    uint64_t len = frame->obj ? frame->count / 2 : frame->count;
+    val->tag = (len << YYJSON_TAG_BIT) | unsafe_yyjson_get_type(val);
+    val->uni.ofs = (r->num_vals - frame->val) * sizeof(yyjson_val);
+  }
+}
+
+/**
+ * Close every definite-length container whose last child was just added.
+ */
+static inline void br_close(BinReader *r) {
+  while (r->depth && !r->stack[r->depth - 1].indefinite &&
+         !r->stack[r->depth - 1].remaining) {
+    br_pop(r);
+  }
+}
+
+static bool br_null(BinReader *r) {
+  bool ok;
+  br_add(r, YYJSON_TYPE_NULL | YYJSON_SUBTYPE_NONE, &ok);
+  br_close(r);
+  return ok;
+}
+
+static bool br_bool(BinReader *r, bool value) {
+  bool ok;
+  br_add(
+      r,
+      YYJSON_TYPE_BOOL | (value ? YYJSON_SUBTYPE_TRUE : YYJSON_SUBTYPE_FALSE),
+      &ok
+  );
+  br_close(r);
+  return ok;
+}
+
+static bool br_uint(BinReader *r, uint64_t num) {
+  bool ok;
+  yyjson_val *val = br_add(r, YYJSON_TYPE_NUM | YYJSON_SUBTYPE_UINT, &ok);
+  if (val) val->uni.u64 = num;
+  br_close(r);
+  return ok;
+}
+
+static bool br_sint(BinReader *r, int64_t num) {
+  // Non-negative integers are unsigned, like yyjson reads them from JSON.
+  if (num >= 0) return br_uint(r, (uint64_t)num);
+
+  bool ok;
+  yyjson_val *val = br_add(r, YYJSON_TYPE_NUM | YYJSON_SUBTYPE_SINT, &ok);
+  if (val) val->uni.i64 = num;
+  br_close(r);
+  return ok;
+}
+
+static bool br_real(BinReader *r, double num) {
+  bool ok;
+  yyjson_val *val = br_add(r, YYJSON_TYPE_NUM | YYJSON_SUBTYPE_REAL, &ok);
+  if (val) val->uni.f64 = num;
+  br_close(r);
+  return ok;
+}
+
+/**
+ * Add a string or raw value of len bytes, and return where its bytes go,
+ * or NULL while counting or if ok is set to false. The value isn't closed.
+ */
+static char *br_add_str(
+    BinReader *r, yyjson_type type, uint64_t len, bool *ok
+) {
+  yyjson_val *val = br_add(r, (len << YYJSON_TAG_BIT) | type, ok);
+  if (!*ok) return NULL;
+
+  if (len >= SIZE_MAX - r->str_len) {
+    *ok = br_fail(r, "unexpected end of data");
+    return NULL;
+  }
+
+  char *dst = NULL;
+  if (val) {
+    if (r->str_len + len + 1 > r->max_str_len) {
+      *ok = br_changed(r);
+      return NULL;
+    }
+    dst = r->strs + r->str_len;
+    dst[len] = '\0';
+    val->uni.str = dst;
+  }
+  r->str_len += len + 1;
+  return dst;
+}
+
+/**
+ * Add a string of len bytes read from the input.
+ */
+static bool br_str(BinReader *r, uint64_t len) {
+  bool ok, noesc;
+
+  if (!br_need(r, len)) return false;
+  const char *str = (const char *)r->cur;
+  r->cur += len;
+
+  // Strings are only checked while counting.
+  if (!r->vals && !str_check(str, (size_t)len, &noesc)) {
+    return br_fail(r, "string is not valid UTF-8");
+  }
+
+  char *dst = br_add_str(r, YYJSON_TYPE_STR, len, &ok);
+  if (!ok) return false;
+  if (dst) memcpy(dst, str, len);
+
+  br_close(r);
+  return true;
+}
+
+/**
+ * Add a raw number.
+ */
+static bool br_raw(BinReader *r, const char *str, size_t len) {
+  bool ok;
+
+  char *dst = br_add_str(r, YYJSON_TYPE_RAW, len, &ok);
+  if (!ok) return false;
+  if (dst) memcpy(dst, str, len);
+
+  br_close(r);
+  return true;
+}
+
+/**
+ * Open an array, or an object of len members. Indefinite-length containers
+ * ignore len, and must be closed with br_break().
+ */
+static bool br_ctn(BinReader *r, bool obj, uint64_t len, bool indefinite) {
+  bool ok;
+  size_t index = r->num_vals;
+  yyjson_type type = obj ? YYJSON_TYPE_OBJ : YYJSON_TYPE_ARR;
+
+  if (indefinite) len = 0;
+  if (obj && len > UINT64_MAX / 2) {
+    return br_fail(r, "unexpected end of data");
+  }
+
+  br_add(r, (len << YYJSON_TAG_BIT) | type, &ok);
+  if (!ok) return false;
+
+  if (r->depth == r->stack_cap) {
+    size_t cap = r->stack_cap ? r->stack_cap * 2 : 32;
+    BinFrame *stack = PyMem_RawRealloc(r->stack, cap * sizeof(*stack));
+    if (!stack) return false;
+    r->stack = stack;
+    r->stack_cap = cap;
+  }
+  r->stack[r->depth++] =
+      (BinFrame){index, obj ? len * 2 : len, 0, obj, indefinite};
+
+  br_close(r);
+  return true;
+}
+
+/**
+ * Close the innermost container, which must have an indefinite length.
+ */
+static bool br_break(BinReader *r) {
+  if (!r->depth || !r->stack[r->depth - 1].indefinite) {
+    return br_fail(r, "unexpected break");
+  }
+
+  BinFrame *frame = &r->stack[r->depth - 1];
+  if (frame->obj && frame->count % 2) {
+    return br_fail(r, "object key without a value");
+  }
+
+  br_pop(r);
+  br_close(r);
+  return true;
+}
+
+/**
+ * Make sure the scratch space holds at least size bytes.
+ */
+static bool br_scratch(BinReader *r, size_t size) {
+  if (size <= r->scratch_cap) return true;
+
+  char *scratch = PyMem_RawRealloc(r->scratch, size);
+  if (!scratch) return false;
+  r->scratch = scratch;
+  r->scratch_cap = size;
+  return true;
+}
+
+/**
+ * Read one complete value with read_item, which reads a single item such as
+ * a number or the start of a container, into a new document. Allocation
+ * failures return NULL without setting err.
+ */
+static yyjson_doc *br_read(
+    const char *buf, size_t len, const yyjson_alc *alc,
+    bool (*read_item)(BinReader *), const char **err, size_t *err_pos
+) {
+  BinReader r = {0};
+  yyjson_doc *doc = NULL;
+
+  r.start = (const uint8_t *)buf;
+  r.end = r.start + len;
+
+  for (int pass = 0; pass < 2; pass++) {
+    r.cur = r.start;
+    r.num_vals = 0;
+    r.str_len = 0;
+    r.depth = 0;
+
+    do {
+      r.item = r.cur;
+      if (!read_item(&r)) goto fail;
+    } while (r.depth);
+
+    if (r.cur != r.end) {
+      r.item = r.cur;
+      br_fail(&r, "unexpected data after the value");
+      goto fail;
+    }
+
+    if (pass == 0) {
+      // Laid out like yyjson_mut_val_imut_copy() does, with the strings
+      // after the values in the same allocation.
+      size_t hdr_size = (sizeof(yyjson_doc) + sizeof(yyjson_val) - 1) /
+                        sizeof(yyjson_val) * sizeof(yyjson_val);
+      doc = alc->malloc(
+          alc->ctx, hdr_size + r.num_vals * sizeof(yyjson_val) + r.str_len
+      );
+      if (!doc) goto fail;
+
+      memset(doc, 0, sizeof(yyjson_doc));
+      r.vals = (yyjson_val *)(void *)((char *)doc + hdr_size);
+      r.strs = (char *)(r.vals + r.num_vals);
+      r.max_vals = r.num_vals;
+      r.max_str_len = r.str_len;
+      doc->root = r.vals;
+      doc->alc = *alc;
+      doc->val_read = r.num_vals;
+      doc->dat_read = len;
+    } else if (r.num_vals != r.max_vals) {
+      br_changed(&r);
+      goto fail;
+    }
+  }
+
+  PyMem_RawFree(r.stack);
+  PyMem_RawFree(r.scratch);
+  return doc;
+
+fail:
+  *err = r.err;
+  *err_pos = (size_t)(r.item - r.start);
+  if (doc) alc->free(alc->ctx, doc);
+  PyMem_RawFree(r.stack);
+  PyMem_RawFree(r.scratch);
+  return NULL;
+}
+
+/*=============================================================================
+ * MessagePack
+ *===========================================================================*/
+
+static bool mp_write_uint(BinWriter *w, uint64_t num) {
+  if (num <= 0x7f) return bw_head(w, (uint8_t)num, 0, 0);
+  if (num <= UINT8_MAX) return bw_head(w, 0xcc, num, 1);
+  if (num <= UINT16_MAX) return bw_head(w, 0xcd, num, 2);
+  if (num <= UINT32_MAX) return bw_head(w, 0xce, num, 4);
+  return bw_head(w, 0xcf, num, 8);
+}
+
+static bool mp_write_sint(BinWriter *w, int64_t num) {
+  if (num >= 0) return mp_write_uint(w, (uint64_t)num);
+  if (num >= -32) return bw_head(w, (uint8_t)num, 0, 0);
+  if (num >= INT8_MIN) return bw_head(w, 0xd0, (uint64_t)num, 1);
+  if (num >= INT16_MIN) return bw_head(w, 0xd1, (uint64_t)num, 2);
+  if (num >= INT32_MIN) return bw_head(w, 0xd2, (uint64_t)num, 4);
+  return bw_head(w, 0xd3, (uint64_t)num, 8);
+}
+
+static bool mp_write_num(BinWriter *w, void *num) {
+  switch (unsafe_yyjson_get_subtype(num)) {
+    case YYJSON_SUBTYPE_UINT:
+      return mp_write_uint(w, unsafe_yyjson_get_uint(num));
+    case YYJSON_SUBTYPE_SINT:
+      return mp_write_sint(w, unsafe_yyjson_get_sint(num));
+    default:
+      return bw_head(w, 0xcb, bw_real_bits(unsafe_yyjson_get_real(num)), 8);
+  }
+}
+
+/**
+ * Write the head of a string, array or map of len bytes or items, using
+ * the fix form up to fix_max, then the 8 (if there is one), 16 and 32-bit
+ * forms.
+ */
+static bool mp_write_len(
+    BinWriter *w, size_t len, uint8_t fix, size_t fix_max, uint8_t head8,
+    uint8_t head16
+) {
+  if (len <= fix_max) return bw_head(w, fix | (uint8_t)len, 0, 0);
+  if (head8 && len <= UINT8_MAX) return bw_head(w, head8, len, 1);
+  if (len <= UINT16_MAX) return bw_head(w, head16, len, 2);
+  if ((uint64_t)len <= UINT32_MAX) return bw_head(w, head16 + 1, len, 4);
+  w->err = "value is too long for MessagePack";
+  return false;
+}
+
+/**
+ * Write a single value, or the head of a container, whose children must
+ * follow.
+ */
+static bool mp_write_val(BinWriter *w, void *val) {
+  yyjson_val num;
+
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return bw_head(w, 0xc0, 0, 0);
+    case YYJSON_TYPE_BOOL:
+      return bw_head(w, unsafe_yyjson_get_bool(val) ? 0xc3 : 0xc2, 0, 0);
+    case YYJSON_TYPE_NUM:
+      return mp_write_num(w, val);
+    case YYJSON_TYPE_RAW:
+      return bw_raw_to_num(w, val, &num) && mp_write_num(w, &num);
+    case YYJSON_TYPE_STR: {
+      size_t len = unsafe_yyjson_get_len(val);
+      return mp_write_len(w, len, 0xa0, 31, 0xd9, 0xda) &&
+             bw_write(w, unsafe_yyjson_get_str(val), len);
+    }
+    case YYJSON_TYPE_ARR:
+      return mp_write_len(w, unsafe_yyjson_get_len(val), 0x90, 15, 0, 0xdc);
+    case YYJSON_TYPE_OBJ:
+      return mp_write_len(w, unsafe_yyjson_get_len(val), 0x80, 15, 0, 0xde);
+    default:
+      w->err = "unknown value type";
+      return false;
+  }
+}
+
+char *msgpack_write(void *val, bool mut, size_t *len, const char **err) {
+  return bw_run(val, mut, mp_write_val, len, err);
+}
+
+static bool mp_read_item(BinReader *r) {
+  uint64_t arg;
+
+  if (!br_need(r, 1)) return false;
+  uint8_t head = *r->cur++;
+
+  if (head <= 0x7f) return br_uint(r, head);
+  if (head >= 0xe0) return br_sint(r, (int8_t)head);
+  if (head <= 0x8f) return br_ctn(r, true, head & 0x0f, false);
+  if (head <= 0x9f) return br_ctn(r, false, head & 0x0f, false);
+  if (head <= 0xbf) return br_str(r, head & 0x1f);
+
+  switch (head) {
+    case 0xc0:
+      return br_null(r);
+    case 0xc2:
+    case 0xc3:
+      return br_bool(r, head == 0xc3);
+    case 0xca: {
+      uint32_t bits;
+      float num;
+      if (!br_uint_be(r, 4, &arg)) return false;
+      bits = (uint32_t)arg;
+      memcpy(&num, &bits, sizeof(num));
+      return br_real(r, num);
+    }
+    case 0xcb: {
+      double num;
+      if (!br_uint_be(r, 8, &arg)) return false;
+      memcpy(&num, &arg, sizeof(num));
+      return br_real(r, num);
+    }
+    case 0xcc:
+    case 0xcd:
+    case 0xce:
+    case 0xcf:
+      return br_uint_be(r, 1 << (head - 0xcc), &arg) && br_uint(r, arg);
+    case 0xd0:
+      return br_uint_be(r, 1, &arg) && br_sint(r, (int8_t)arg);
+    case 0xd1:
+      return br_uint_be(r, 2, &arg) && br_sint(r, (int16_t)arg);
+    case 0xd2:
+      return br_uint_be(r, 4, &arg) && br_sint(r, (int32_t)arg);
+    case 0xd3:
+      return br_uint_be(r, 8, &arg) && br_sint(r, (int64_t)arg);
+    case 0xd9:
+    case 0xda:
+    case 0xdb:
+      return br_uint_be(r, 1 << (head - 0xd9), &arg) && br_str(r, arg);
+    case 0xdc:
+    case 0xdd:
+      return br_uint_be(r, head == 0xdc ? 2 : 4, &arg) &&
+             br_ctn(r, false, arg, false);
+    case 0xde:
+    case 0xdf:
+      return br_uint_be(r, head == 0xde ? 2 : 4, &arg) &&
+             br_ctn(r, true, arg, false);
+    case 0xc4:
+    case 0xc5:
+    case 0xc6:
+      return br_fail(r, "binary data can't be represented as JSON");
+    case 0xc1:
+      return br_fail(r, "invalid type");
+    default:
+      return br_fail(r, "extension types can't be represented as JSON");
+  }
+}
+
+yyjson_doc *msgpack_read(
+    const char *buf, size_t len, const yyjson_alc *alc, const char **err,
+    size_t *err_pos
+) {
+  *err = NULL;
+  return br_read(buf, len, alc, mp_read_item, err, err_pos);
+}
+
+/*=============================================================================
+ * CBOR
+ *===========================================================================*/
+
+/**
+ * The most bytes a bignum, and the most digits a raw number, may have.
+ * Converting between the two is quadratic in their length.
+ */
+#define CBOR_BIGNUM_MAX 4096
+#define CBOR_DIGITS_MAX 9864
+
+enum {
+  CBOR_UINT = 0,
+  CBOR_NEGINT = 1,
+  CBOR_BYTES = 2,
+  CBOR_TEXT = 3,
+  CBOR_ARRAY = 4,
+  CBOR_MAP = 5,
+  CBOR_TAG = 6,
+  CBOR_SIMPLE = 7,
+};
+
+enum {
+  CBOR_TAG_BIGNUM = 2,
+  CBOR_TAG_NEG_BIGNUM = 3,
+  CBOR_TAG_DECIMAL = 4,
+};
+
+/**
+ * Multiply the little-endian base 2^32 number in limbs by mul and add add,
+ * growing it by a limb if it carries.
+ */
+static void cbor_limbs_mul_add(
+    uint32_t *limbs, size_t *n, uint32_t mul, uint32_t add
+) {
+  uint64_t carry = add;
+  for (size_t i = 0; i < *n; i++) {
+    uint64_t cur = (uint64_t)limbs[i] * mul + carry;
+    limbs[i] = (uint32_t)cur;
+    carry = cur >> 32;
+  }
+  if (carry) limbs[(*n)++] = (uint32_t)carry;
+}
+
+/**
+ * Divide the little-endian base 2^32 number in limbs by div, dropping
+ * leading zero limbs, and return the remainder.
+ */
+static uint32_t cbor_limbs_div(uint32_t *limbs, size_t *n, uint32_t div) {
+  uint64_t rem = 0;
+  for (size_t i = *n; i-- > 0;) {
+    uint64_t cur = (rem << 32) | limbs[i];
+    limbs[i] = (uint32_t)(cur / div);
+    rem = cur % div;
+  }
+  while (*n && !limbs[*n - 1]) (*n)--;
+  return (uint32_t)rem;
+}
+
+/*-----------------------------------------------------------------------------
+ * Writing
+ *---------------------------------------------------------------------------*/
+
+static inline bool cbor_write_head(BinWriter *w, int major, uint64_t arg) {
+  uint8_t mt = (uint8_t)(major << 5);
+  if (arg < 24) return bw_head(w, mt | (uint8_t)arg, 0, 0);
+  if (arg <= UINT8_MAX) return bw_head(w, mt | 24, arg, 1);
+  if (arg <= UINT16_MAX) return bw_head(w, mt | 25, arg, 2);
+  if (arg <= UINT32_MAX) return bw_head(w, mt | 26, arg, 4);
+  return bw_head(w, mt | 27, arg, 8);
+}
+
+static bool cbor_write_sint(BinWriter *w, int64_t num) {
+  if (num >= 0) return cbor_write_head(w, CBOR_UINT, (uint64_t)num);
+  // -1 - num, without overflowing on INT64_MIN.
+  return cbor_write_head(w, CBOR_NEGINT, ~(uint64_t)num);
+}
+
+static bool cbor_write_num(BinWriter *w, void *num) {
+  switch (unsafe_yyjson_get_subtype(num)) {
+    case YYJSON_SUBTYPE_UINT:
+      return cbor_write_head(w, CBOR_UINT, unsafe_yyjson_get_uint(num));
+    case YYJSON_SUBTYPE_SINT:
+      return cbor_write_sint(w, unsafe_yyjson_get_sint(num));
+    default:
+      return bw_head(w, 0xfb, bw_real_bits(unsafe_yyjson_get_real(num)), 8);
+  }
+}
+
+/**
+ * Write the integer whose digits are the decimal digits in str, skipping
+ * any '.', as an integer if it fits in 64 bits and as a bignum otherwise.
+ */
+static bool cbor_write_digits(
+    BinWriter *w, const char *str, size_t len, size_t num_digits, bool neg
+) {
+  // Each limb holds at least nine more digits.
+  size_t cap = num_digits / 9 + 2, n = 0;
+  uint32_t *limbs = PyMem_RawMalloc(cap * sizeof(uint32_t));
+  if (!limbs) return false;
+
+  uint32_t group = 0, mul = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (str[i] == '.') continue;
+    group = group * 10 + (uint32_t)(str[i] - '0');
+    mul *= 10;
+    if (mul == 1000000000) {
+      cbor_limbs_mul_add(limbs, &n, mul, group);
+      group = 0;
+      mul = 1;
+    }
+  }
+  if (mul > 1) cbor_limbs_mul_add(limbs, &n, mul, group);
+  while (n && !limbs[n - 1]) n--;
+
+  // Negative integers are written as -1 - n, and there's no negative zero.
+  neg = neg && n;
+  if (neg) {
+    for (size_t i = 0; limbs[i]-- == 0; i++) {
+    }
+    while (n && !limbs[n - 1]) n--;
+  }
+
+  bool ok;
+  if (n <= 2) {
+    uint64_t num = n ? limbs[0] : 0;
+    if (n == 2) num |= (uint64_t)limbs[1] << 32;
+    ok = cbor_write_head(w, neg ? CBOR_NEGINT : CBOR_UINT, num);
+  } else {
+    size_t num_bytes = (n - 1) * 4;
+    for (uint32_t top = limbs[n - 1]; top; top >>= 8) num_bytes++;
+    ok = cbor_write_head(
+             w, CBOR_TAG, neg ? CBOR_TAG_NEG_BIGNUM : CBOR_TAG_BIGNUM
+         ) &&
+         cbor_write_head(w, CBOR_BYTES, num_bytes) && bw_reserve(w, num_bytes);
+    if (ok) {
+      for (size_t i = num_bytes; i-- > 0;) {
+        w->buf[w->len++] = (char)(limbs[i / 4] >> ((i % 4) * 8));
+      }
+    }
+  }
+
+  PyMem_RawFree(limbs);
+  return ok;
+}
+
+/**
+ * Write a raw number exactly, as an integer or bignum if it has no fraction
+ * or exponent, and as a decimal fraction otherwise. Raw values that aren't
+ * plain decimal numbers, such as NaN, are written as reals.
+ */
+static bool cbor_write_raw(BinWriter *w, void *val) {
+  const char *str = unsafe_yyjson_get_raw(val);
+  const char *cur = str;
+  bool neg = *cur == '-';
+  if (neg) cur++;
+
+  const char *digits = cur;
+  size_t num_digits = 0, frac_digits = 0;
+  while (*cur >= '0' && *cur <= '9') cur++, num_digits++;
+  if (*cur == '.') {
+    cur++;
+    while (*cur >= '0' && *cur <= '9') cur++, frac_digits++;
+  }
+  const char *digits_end = cur;
+
+  int64_t exp = 0;
+  bool exp_neg = false, plain = num_digits > 0;
+  if (*cur == 'e' || *cur == 'E') {
+    cur++;
+    if (*cur == '-' || *cur == '+') exp_neg = *cur++ == '-';
+    plain = plain && *cur >= '0' && *cur <= '9';
+    while (*cur >= '0' && *cur <= '9') {
+      if (exp > (INT64_MAX - 9) / 10) {
+        w->err = "number is too large for CBOR";
+        return false;
+      }
+      exp = exp * 10 + (*cur++ - '0');
+    }
+  }
+
+  if (!plain || *cur) {
+    yyjson_val num;
+    return bw_raw_to_num(w, val, &num) && cbor_write_num(w, &num);
+  }
+
+  if (exp_neg) exp = -exp;
+  exp -= (int64_t)frac_digits;
+
+  // Leading zeros don't count towards the limit.
+  while (digits < digits_end && (*digits == '0' || *digits == '.')) digits++;
+  size_t sig_digits = (size_t)(digits_end - digits);
+  if (memchr(digits, '.', sig_digits)) sig_digits--;
+  if (sig_digits > CBOR_DIGITS_MAX) {
+    w->err = "number is too large for CBOR";
+    return false;
+  }
+
+  if (exp != 0 &&
+      !(cbor_write_head(w, CBOR_TAG, CBOR_TAG_DECIMAL) &&
+        cbor_write_head(w, CBOR_ARRAY, 2) && cbor_write_sint(w, exp))) {
+    return false;
+  }
+  return cbor_write_digits(
+      w, digits, (size_t)(digits_end - digits), sig_digits, neg
+  );
+}
+
+/**
+ * Write a single value, or the head of a container, whose children must
+ * follow.
+ */
+static bool cbor_write_val(BinWriter *w, void *val) {
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return bw_head(w, 0xf6, 0, 0);
+    case YYJSON_TYPE_BOOL:
+      return bw_head(w, unsafe_yyjson_get_bool(val) ? 0xf5 : 0xf4, 0, 0);
+    case YYJSON_TYPE_NUM:
+      return cbor_write_num(w, val);
+    case YYJSON_TYPE_RAW:
+      return cbor_write_raw(w, val);
+    case YYJSON_TYPE_STR: {
+      size_t len = unsafe_yyjson_get_len(val);
+      return cbor_write_head(w, CBOR_TEXT, len) &&
+             bw_write(w, unsafe_yyjson_get_str(val), len);
+    }
+    case YYJSON_TYPE_ARR:
+      return cbor_write_head(w, CBOR_ARRAY, unsafe_yyjson_get_len(val));
+    case YYJSON_TYPE_OBJ:
+      return cbor_write_head(w, CBOR_MAP, unsafe_yyjson_get_len(val));
+    default:
+      w->err = "unknown value type";
+      return false;
+  }
+}
+
+char *cbor_write(void *val, bool mut, size_t *len, const char **err) {
+  return bw_run(val, mut, cbor_write_val, len, err);
+}
+
+/*-----------------------------------------------------------------------------
+ * Reading
+ *---------------------------------------------------------------------------*/
+
+/**
+ * An integer read from CBOR, which is -1 - its magnitude if neg is set.
+ * The magnitude is num, or the big-endian bytes of a bignum too large for
+ * it.
+ */
+typedef struct {
+  bool neg;
+  uint64_t num;
+  const uint8_t *bytes;
+  size_t num_bytes;
+} CborInt;
+
+/**
+ * Read the argument that follows a head with additional information ai,
+ * which mustn't be an indefinite length.
+ */
+static bool cbor_read_arg(BinReader *r, uint8_t ai, uint64_t *arg) {
+  if (ai < 24) {
+    *arg = ai;
+    return true;
+  }
+  if (ai <= 27) return br_uint_be(r, 1 << (ai - 24), arg);
+  return br_fail(r, "invalid additional information");
+}
+
+/**
+ * Write the decimal digits of v into the scratch space, leaving room for an
+ * exponent after them, and set len to their length.
+ */
+static bool cbor_int_digits(BinReader *r, CborInt *v, size_t *len) {
+  uint8_t num_be[8];
+  const uint8_t *bytes = v->bytes;
+  size_t num_bytes = v->num_bytes;
+
+  if (!bytes) {
+    for (int i = 0; i < 8; i++) num_be[i] = (uint8_t)(v->num >> (56 - i * 8));
+    bytes = num_be;
+    num_bytes = 8;
+  }
+
+  // Room for the magnitude, plus one for -1 - n, and then for its digits
+  // in groups of nine, which each hold nearly 30 bits.
+  size_t cap = num_bytes / 4 + 2;
+  uint32_t *limbs = PyMem_RawCalloc(cap * 3, sizeof(uint32_t));
+  if (!limbs) return false;
+  uint32_t *groups = limbs + cap;
+
+  for (size_t i = 0; i < num_bytes; i++) {
+    size_t bit = (num_bytes - 1 - i) * 8;
+    limbs[bit / 32] |= (uint32_t)bytes[i] << (bit % 32);
+  }
+  size_t n = cap;
+  while (n && !limbs[n - 1]) n--;
+  if (v->neg) cbor_limbs_mul_add(limbs, &n, 1, 1);
+
+  size_t num_groups = 0;
+  while (n) groups[num_groups++] = cbor_limbs_div(limbs, &n, 1000000000);
+
+  if (!br_scratch(r, num_groups * 9 + 48)) {
+    PyMem_RawFree(limbs);
+    return false;
+  }
+
+  char *p = r->scratch;
+  if (v->neg) *p++ = '-';
+  if (!num_groups) {
+    *p++ = '0';
+  } else {
+    p += sprintf(p, "%u", (unsigned)groups[--num_groups]);
+    while (num_groups) p += sprintf(p, "%09u", (unsigned)groups[--num_groups]);
+  }
+
+  PyMem_RawFree(limbs);
+  *len = (size_t)(p - r->scratch);
+  return true;
+}
+
+/**
+ * Read the content of a bignum, whose tag has been read.
+ */
+static bool cbor_read_bignum(BinReader *r, bool neg, CborInt *v) {
+  uint64_t len;
+
+  if (!br_need(r, 1)) return false;
+  uint8_t head = *r->cur++;
+  if (head >> 5 != CBOR_BYTES || (head & 0x1f) == 31) {
+    return br_fail(r, "bignums must be definite-length byte strings");
+  }
+  if (!cbor_read_arg(r, head & 0x1f, &len) || !br_need(r, len)) return false;
+  if (len > CBOR_BIGNUM_MAX) {
+    return br_fail(r, "bignum is too large");
+  }
+
+  const uint8_t *bytes = r->cur;
+  r->cur += len;
+  while (len && !*bytes) bytes++, len--;
+
+  *v = (CborInt){neg, 0, NULL, 0};
+  if (len > 8) {
+    v->bytes = bytes;
+    v->num_bytes = (size_t)len;
+  } else {
+    for (size_t i = 0; i < len; i++) v->num = (v->num << 8) | bytes[i];
+  }
+  return true;
+}
+
+/**
+ * Read an integer or bignum.
+ */
+static bool cbor_read_int(BinReader *r, CborInt *v) {
+  uint64_t arg;
+
+  if (!br_need(r, 1)) return false;
+  uint8_t head = *r->cur++;
+  int major = head >> 5;
+  if ((head & 0x1f) == 31 || !cbor_read_arg(r, head & 0x1f, &arg)) {
+    return br_fail(r, "invalid decimal fraction");
+  }
+
+  if (major == CBOR_UINT || major == CBOR_NEGINT) {
+    *v = (CborInt){major == CBOR_NEGINT, arg, NULL, 0};
+    return true;
+  }
+  if (major == CBOR_TAG &&
+      (arg == CBOR_TAG_BIGNUM || arg == CBOR_TAG_NEG_BIGNUM)) {
+    return cbor_read_bignum(r, arg == CBOR_TAG_NEG_BIGNUM, v);
+  }
+  return br_fail(r, "invalid decimal fraction");
+}
+
+/**
+ * Add an integer, as a raw number if it doesn't fit in 64 bits, like
+ * BIG_NUMBERS_AS_DECIMAL reads it from JSON.
+ */
+static bool cbor_add_int(BinReader *r, CborInt *v) {
+  size_t len;
+
+  if (!v->bytes && !v->neg) return br_uint(r, v->num);
+  if (!v->bytes && v->num <= INT64_MAX) {
+    return br_sint(r, -1 - (int64_t)v->num);
+  }
+  return cbor_int_digits(r, v, &len) && br_raw(r, r->scratch, len);
+}
+
+/**
+ * Read the content of a decimal fraction, whose tag has been read, as a raw
+ * number.
+ */
+static bool cbor_read_decimal(BinReader *r) {
+  uint64_t len;
+  CborInt exp, mantissa;
+
+  if (!br_need(r, 1)) return false;
+  uint8_t head = *r->cur++;
+  if (head >> 5 != CBOR_ARRAY || (head & 0x1f) == 31 ||
+      !cbor_read_arg(r, head & 0x1f, &len) || len != 2) {
+    return br_fail(r, "invalid decimal fraction");
+  }
+
+  if (!cbor_read_int(r, &exp) || !cbor_read_int(r, &mantissa)) return false;
+  if (exp.bytes || exp.num > INT64_MAX) {
+    return br_fail(r, "decimal fraction exponent is too large");
+  }
+
+  size_t digits;
+  if (!cbor_int_digits(r, &mantissa, &digits)) return false;
+  if (exp.num || exp.neg) {
+    int64_t e = exp.neg ? -1 - (int64_t)exp.num : (int64_t)exp.num;
+    digits += (size_t)sprintf(r->scratch + digits, "e%lld", (long long)e);
+  }
+  return br_raw(r, r->scratch, digits);
+}
+
+/**
+ * Measure the text string made of the chunks that follow an
+ * indefinite-length head, or copy it into dst, which holds len bytes.
+ */
+static bool cbor_text_chunks(BinReader *r, char *dst, uint64_t *len) {
+  bool noesc;
+  uint64_t total = 0, chunk;
+
+  for (;;) {
+    if (!br_need(r, 1)) return false;
+    uint8_t head = *r->cur++;
+    if (head == 0xff) break;
+
+    if (head >> 5 != CBOR_TEXT || (head & 0x1f) == 31) {
+      return br_fail(r, "invalid string chunk");
+    }
+    if (!cbor_read_arg(r, head & 0x1f, &chunk) || !br_need(r, chunk)) {
+      return false;
+    }
+
+    if (!dst) {
+      // Each chunk must be valid UTF-8 on its own.
+      if (!str_check((const char *)r->cur, (size_t)chunk, &noesc)) {
+        return br_fail(r, "string is not valid UTF-8");
+      }
+    } else if (chunk > *len - total) {
+      return br_changed(r);
+    } else {
+      memcpy(dst + total, r->cur, chunk);
+    }
+
+    r->cur += chunk;
+    total += chunk;
+  }
+
+  if (dst && total != *len) return br_changed(r);
+  *len = total;
+  return true;
+}
+
+/**
+ * Add an indefinite-length text string, whose head has been read.
+ */
+static bool cbor_read_text(BinReader *r) {
+  bool ok;
+  uint64_t len;
+
+  const uint8_t *start = r->cur;
+  if (!cbor_text_chunks(r, NULL, &len)) return false;
+
+  char *dst = br_add_str(r, YYJSON_TYPE_STR, len, &ok);
+  if (!ok) return false;
+  if (dst) {
+    r->cur = start;
+    if (!cbor_text_chunks(r, dst, &len)) return false;
+  }
+
+  br_close(r);
+  return true;
+}
+
+static double cbor_half(uint16_t half) {
+  int exp = (half >> 10) & 0x1f;
+  int mantissa = half & 0x3ff;
+  double num;
+
+  if (exp == 0) {
+    num = ldexp(mantissa, -24);
+  } else if (exp != 31) {
+    num = ldexp(mantissa + 1024, exp - 25);
+  } else {
+    num = mantissa ? NAN : INFINITY;
+  }
+  return half & 0x8000 ? -num : num;
+}
+
+/**
+ * Read a simple value or float, whose head had additional information ai.
+ */
+static bool cbor_read_simple(BinReader *r, uint8_t ai) {
+  uint64_t arg;
+
+  switch (ai) {
+    case 20:
+    case 21:
+      return br_bool(r, ai == 21);
+    case 22:
+    case 23:
+      // undefined is the closest JSON has to null.
+      return br_null(r);
+    case 25:
+      return br_uint_be(r, 2, &arg) && br_real(r, cbor_half((uint16_t)arg));
+    case 26: {
+      uint32_t bits;
+      float num;
+      if (!br_uint_be(r, 4, &arg)) return false;
+      bits = (uint32_t)arg;
+      memcpy(&num, &bits, sizeof(num));
+      return br_real(r, num);
+    }
+    case 27: {
+      double num;
+      if (!br_uint_be(r, 8, &arg)) return false;
+      memcpy(&num, &arg, sizeof(num));
+      return br_real(r, num);
+    }
+    case 28:
+    case 29:
+    case 30:
+      return br_fail(r, "invalid additional information");
+    default:
+      return br_fail(r, "simple values can't be represented as JSON");
+  }
+}
+
+static bool cbor_read_item(BinReader *r) {
+  uint64_t arg;
+  CborInt v;
+
+  for (;;) {
+    if (!br_need(r, 1)) return false;
+    uint8_t head = *r->cur++;
+    int major = head >> 5;
+    uint8_t ai = head & 0x1f;
+
+    if (head == 0xff) return br_break(r);
+    if (major == CBOR_SIMPLE) return cbor_read_simple(r, ai);
+    if (major == CBOR_BYTES) {
+      return br_fail(r, "byte strings can't be represented as JSON");
+    }
+
+    if (ai == 31) {
+      switch (major) {
+        case CBOR_TEXT:
+          return cbor_read_text(r);
+        case CBOR_ARRAY:
+        case CBOR_MAP:
+          return br_ctn(r, major == CBOR_MAP, 0, true);
+        default:
+          return br_fail(r, "invalid additional information");
+      }
+    }
+
+    if (!cbor_read_arg(r, ai, &arg)) return false;
+
+    switch (major) {
+      case CBOR_UINT:
+        return br_uint(r, arg);
+      case CBOR_NEGINT:
+        v = (CborInt){true, arg, NULL, 0};
+        return cbor_add_int(r, &v);
+      case CBOR_TEXT:
+        return br_str(r, arg);
+      case CBOR_ARRAY:
+      case CBOR_MAP:
+        return br_ctn(r, major == CBOR_MAP, arg, false);
+      default:
+        if (arg == CBOR_TAG_BIGNUM || arg == CBOR_TAG_NEG_BIGNUM) {
+          return cbor_read_bignum(r, arg == CBOR_TAG_NEG_BIGNUM, &v) &&
+                 cbor_add_int(r, &v);
+        }
+        if (arg == CBOR_TAG_DECIMAL) return cbor_read_decimal(r);
+        // Other tags have no equivalent in JSON, so only their content is
+        // kept, as RFC 8949 suggests.
+        continue;
+    }
+  }
+}
+
+yyjson_doc *cbor_read(
+    const char *buf, size_t len, const yyjson_alc *alc, const char **err,
+    size_t *err_pos
+) {
+  *err = NULL;
+  return br_read(buf, len, alc, cbor_read_item, err, err_pos);
+}
@@ -0,0 +1,60 @@
+#ifndef PY_YYJSON_TRANSCODE_H
+#define PY_YYJSON_TRANSCODE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+/*
+ * Transcoding between documents and binary formats, directly from and to
+ * yyjson values without creating Python objects. None of these need the
+ * GIL: output is allocated with PyMem_RawMalloc, and documents with the
+ * given allocator.
+ */
+
+/**
+ * The size of input above which documents are read without holding the
+ * GIL.
+ */
+#define TRANSCODE_NOGIL_MIN (64 * 1024)
+
+/**
+ * Serialize a yyjson_val or yyjson_mut_val (if mut is true) as
+ * MessagePack.
+ *
+ * Returns a buffer allocated with PyMem_RawMalloc and sets len, or returns
+ * NULL and sets err. A NULL return with err unset means allocation failed.
+ */
+char* msgpack_write(void* val, bool mut, size_t* len, const char** err);
+
+/**
+ * Read one MessagePack value from buf into a new immutable document.
+ *
+ * Returns NULL and sets err and err_pos if buf isn't a single value that
+ * can be represented as JSON. A NULL return with err unset means
+ * allocation failed.
+ */
+yyjson_doc* msgpack_read(
+    const char* buf, size_t len, const yyjson_alc* alc, const char** err,
+    size_t* err_pos
+);
+
+/**
+ * Serialize a yyjson_val or yyjson_mut_val (if mut is true) as CBOR
+ * (RFC 8949), like msgpack_write(). Raw numbers are written exactly, as
+ * bignums and decimal fractions where needed.
+ */
+char* cbor_write(void* val, bool mut, size_t* len, const char** err);
+
+/**
+ * Read one CBOR data item from buf into a new immutable document, like
+ * msgpack_read(). Bignums and decimal fractions become raw numbers.
+ */
+yyjson_doc* cbor_read(
+    const char* buf, size_t len, const yyjson_alc* alc, const char** err,
+    size_t* err_pos
+);
+
+#endif
@@ -0,0 +1,301 @@
+#include "value.h"
+
+#include <string.h>
+
+static double num_as_double(void *val) {
+  switch (unsafe_yyjson_get_subtype(val)) {
+    case YYJSON_SUBTYPE_UINT:
+      return (double)unsafe_yyjson_get_uint(val);
+    case YYJSON_SUBTYPE_SINT:
+      return (double)unsafe_yyjson_get_sint(val);
+    default:
+      return unsafe_yyjson_get_real(val);
+  }
+}
+
+/**
+ * Compare two numbers by value, so 1 == 1.0 as RFC 6902 requires.
+ */
+static bool num_equals(void *lhs, void *rhs) {
+  yyjson_subtype ls = unsafe_yyjson_get_subtype(lhs);
+  yyjson_subtype rs = unsafe_yyjson_get_subtype(rhs);
+
+  if (ls != YYJSON_SUBTYPE_REAL && rs != YYJSON_SUBTYPE_REAL) {
+    uint64_t l = unsafe_yyjson_get_uint(lhs);
+    uint64_t r = unsafe_yyjson_get_uint(rhs);
+    if (ls == rs) return l == r;
+    // One is signed and one is unsigned, so they can only be equal if the
+    // signed one isn't negative.
+    int64_t s = (int64_t)(ls == YYJSON_SUBTYPE_SINT ? l : r);
+    return s >= 0 && l == r;
+  }
+
+  return num_as_double(lhs) == num_as_double(rhs);
+}
+
+/**
+ * Read a number, or a raw number from NUMBERS_AS_RAW or
+ * BIG_NUMBERS_AS_DECIMAL, into num so it can be compared by value. Raw
+ * numbers too large for 64 bits are read as doubles, the same way
+ * canonical.c writes them. Returns false if a raw value isn't a number.
+ */
+static bool val_as_num(void *val, yyjson_val *num) {
+  if (unsafe_yyjson_get_type(val) == YYJSON_TYPE_NUM) {
+    num->tag = ((yyjson_val *)val)->tag;
+    num->uni = ((yyjson_val *)val)->uni;
+    return true;
+  }
+
+  // yyjson_read_number() needs a NUL after the number, so it's given a
+  // copy.
+  size_t len = unsafe_yyjson_get_len(val);
+  char small[64];
+  char *copy = len < sizeof(small) ? small : PyMem_Malloc(len + 1);
+  if (!copy) return false;
+  memcpy(copy, unsafe_yyjson_get_str(val), len);
+  copy[len] = '\0';
+
+  const char *end = yyjson_read_number(
+      copy, num, YYJSON_READ_ALLOW_INF_AND_NAN, NULL, NULL
+  );
+  bool ok = end && end == copy + len;
+  if (copy != small) PyMem_Free(copy);
+  return ok;
+}
+
+static inline bool is_num_or_raw(yyjson_type type) {
+  return type == YYJSON_TYPE_NUM || type == YYJSON_TYPE_RAW;
+}
+
+static bool str_equals(void *lhs, void *rhs) {
+  return unsafe_yyjson_get_len(lhs) == unsafe_yyjson_get_len(rhs) &&
+         memcmp(
+             unsafe_yyjson_get_str(lhs), unsafe_yyjson_get_str(rhs),
+             unsafe_yyjson_get_len(lhs)
+         ) == 0;
+}
+
+bool val_equals(void *lhs, bool lhs_mut, void *rhs, bool rhs_mut) {
+  yyjson_type type = unsafe_yyjson_get_type(lhs);
+  yyjson_type rhs_type = unsafe_yyjson_get_type(rhs);
+
+  // Raw numbers compare by value with each other and with parsed numbers,
+  // falling back to their text if either isn't a number.
+  if ((type == YYJSON_TYPE_RAW || rhs_type == YYJSON_TYPE_RAW) &&
+      is_num_or_raw(type) && is_num_or_raw(rhs_type)) {
+    if (type == rhs_type && str_equals(lhs, rhs)) return true;
+
+    yyjson_val l, r;
+    if (!val_as_num(lhs, &l) || !val_as_num(rhs, &r)) return false;
+    return num_equals(&l, &r);
+  }
+
+  if (type != rhs_type) {
+    return false;
+  }
+
+  switch (type) {
+    case YYJSON_TYPE_NULL:
+      return true;
+    case YYJSON_TYPE_BOOL:
+      return unsafe_yyjson_get_bool(lhs) == unsafe_yyjson_get_bool(rhs);
+    case YYJSON_TYPE_NUM:
+      return num_equals(lhs, rhs);
+    case YYJSON_TYPE_STR:
+      return str_equals(lhs, rhs);
+    case YYJSON_TYPE_ARR: {
+      if (unsafe_yyjson_get_len(lhs) != unsafe_yyjson_get_len(rhs)) {
+        return false;
+      }
+
+      ValIter l, r;
+      void *a, *b;
+      val_iter_init(&l, lhs, lhs_mut);
+      val_iter_init(&r, rhs, rhs_mut);
+      while ((a = val_iter_next(&l)) && (b = val_iter_next(&r))) {
+        if (!val_equals(a, lhs_mut, b, rhs_mut)) return false;
+      }
+      return true;
+    }
+    case YYJSON_TYPE_OBJ: {
+      if (unsafe_yyjson_get_len(lhs) != unsafe_yyjson_get_len(rhs)) {
+        return false;
+      }
+
+      ValIter r;
+      void *key;
+      val_iter_init(&r, rhs, rhs_mut);
+      while ((key = val_iter_next(&r))) {
+        void *a = val_obj_getn(
+            lhs, lhs_mut, unsafe_yyjson_get_str(key),
+            unsafe_yyjson_get_len(key)
+        );
+        if (!a || !val_equals(a, lhs_mut, val_key_value(key, rhs_mut), rhs_mut)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/*==============================================================================
+ * Hashing
+ *============================================================================*/
+
+#define HASH_P 0x9e3779b97f4a7c15ULL
+
+#define HASH_TAG_NULL 0x6e756c6cULL
+#define HASH_TAG_BOOL 0x626f6f6cULL
+#define HASH_TAG_NUM 0x6e756d00ULL
+#define HASH_TAG_STR 0x73747200ULL
+#define HASH_TAG_RAW 0x72617700ULL
+#define HASH_TAG_ARR 0x61727200ULL
+#define HASH_TAG_OBJ 0x6f626a00ULL
+
+static inline uint64_t hash_fmix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+static inline uint64_t hash_combine(uint64_t h, uint64_t v) {
+  return hash_fmix(h ^ (v + HASH_P + (h << 6) + (h >> 2)));
+}
+
+static inline uint64_t hash_read64(const char *p) {
+  uint64_t k;
+  memcpy(&k, p, sizeof(k));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  k = __builtin_bswap64(k);
+#endif
+  return k;
+}
+
+static uint64_t hash_bytes(uint64_t seed, const char *str, size_t len) {
+  uint64_t h = seed ^ ((uint64_t)len * HASH_P);
+  size_t i = 0;
+
+  for (; i + 8 <= len; i += 8) {
+    h = hash_combine(h, hash_read64(str + i));
+  }
+
+  uint64_t tail = 0;
+  for (size_t j = 0; i < len; i++, j += 8) {
+    tail |= (uint64_t)(unsigned char)str[i] << j;
+  }
+
+  return hash_combine(h, tail);
+}
+
+uint64_t val_hash(void *val, bool mut, uint64_t seed) {
+  switch (unsafe_yyjson_get_type(val)) {
+    case YYJSON_TYPE_NULL:
+      return hash_fmix(seed ^ HASH_TAG_NULL);
+    case YYJSON_TYPE_BOOL:
+      return hash_fmix(seed ^ (HASH_TAG_BOOL + unsafe_yyjson_get_bool(val)));
+    case YYJSON_TYPE_NUM:
+    case YYJSON_TYPE_RAW: {
+      // Numbers, raw ones included, are hashed by their value as a double,
+      // since that's how val_equals() compares integers and reals. Raw
+      // values that aren't numbers only equal the same text.
+      yyjson_val num;
+      if (!val_as_num(val, &num)) {
+        return hash_bytes(
+            seed ^ HASH_TAG_RAW, unsafe_yyjson_get_str(val),
+            unsafe_yyjson_get_len(val)
+        );
+      }
+      double d = num_as_double(&num);
+      uint64_t bits;
+      if (d == 0) d = 0;
+      memcpy(&bits, &d, sizeof(bits));
+      return hash_combine(seed ^ HASH_TAG_NUM, bits);
+    }
+    case YYJSON_TYPE_STR:
+      return hash_bytes(
+          seed ^ HASH_TAG_STR, unsafe_yyjson_get_str(val),
+          unsafe_yyjson_get_len(val)
+      );
+    case YYJSON_TYPE_ARR: {
+      uint64_t h = seed ^ HASH_TAG_ARR;
+      ValIter iter;
+      void *item;
+      val_iter_init(&iter, val, mut);
+      while ((item = val_iter_next(&iter))) {
+        h = hash_combine(h, val_hash(item, mut, seed));
+      }
+      return hash_combine(h, unsafe_yyjson_get_len(val));
+    }
+    case YYJSON_TYPE_OBJ: {
+      // Members are summed, so the order they appear in doesn't matter.
+      uint64_t sum = 0;
+      ValIter iter;
+      void *key;
+      val_iter_init(&iter, val, mut);
+      while ((key = val_iter_next(&iter))) {
+        sum += hash_combine(
+            hash_bytes(
+                seed ^ HASH_TAG_STR, unsafe_yyjson_get_str(key),
+                unsafe_yyjson_get_len(key)
+            ),
+            val_hash(val_key_value(key, mut), mut, seed)
+        );
+      }
+      return hash_combine(
+          hash_combine(seed ^ HASH_TAG_OBJ, sum), unsafe_yyjson_get_len(val)
+      );
+    }
+    default:
+      return hash_fmix(seed);
+  }
+}
+
+bool str_check(const char *str, size_t len, bool *noesc) {
+  const unsigned char *p = (const unsigned char *)str;
+  const unsigned char *end = p + len;
+  bool plain = true;
+
+  while (p < end) {
+    unsigned char c = *p;
+    if (c < 0x80) {
+      if (c < 0x20 || c == '"' || c == '\\') plain = false;
+      p++;
+      continue;
+    }
+
+    size_t n;
+    uint32_t cp;
+    if (c >= 0xC2 && c <= 0xDF) {
+      n = 2;
+      cp = c & 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+      n = 3;
+      cp = c & 0x0F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+      n = 4;
+      cp = c & 0x07;
+    } else {
+      return false;
+    }
+    if ((size_t)(end - p) < n) return false;
+    for (size_t i = 1; i < n; i++) {
+      if ((p[i] & 0xC0) != 0x80) return false;
+      cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    // Reject overlong forms, surrogates, and anything past U+10FFFF.
+    if ((n == 3 && cp < 0x800) || (n == 4 && cp < 0x10000) ||
+        (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+      return false;
+    }
+    p += n;
+  }
+
+  *noesc = plain;
+  return true;
+}
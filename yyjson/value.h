@@ -0,0 +1,102 @@
+#ifndef PY_YYJSON_VALUE_H
+#define PY_YYJSON_VALUE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "yyjson.h"
+
+/*
+ * Helpers for reading values that may be either a yyjson_val or a
+ * yyjson_mut_val, so algorithms can work on documents in whichever form
+ * they're already in without freezing or thawing them.
+ */
+
+/**
+ * Iterates over the children of an array or object that may be either a
+ * yyjson_val or a yyjson_mut_val. Objects yield their keys.
+ */
+typedef struct {
+  bool mut;
+  bool obj;
+  union {
+    yyjson_arr_iter arr;
+    yyjson_obj_iter obj;
+    yyjson_mut_arr_iter mut_arr;
+    yyjson_mut_obj_iter mut_obj;
+  } u;
+} ValIter;
+
+static inline void val_iter_init(ValIter* iter, void* ctn, bool mut) {
+  iter->mut = mut;
+  iter->obj = unsafe_yyjson_get_type(ctn) == YYJSON_TYPE_OBJ;
+
+  if (mut) {
+    if (iter->obj) {
+      yyjson_mut_obj_iter_init(ctn, &iter->u.mut_obj);
+    } else {
+      yyjson_mut_arr_iter_init(ctn, &iter->u.mut_arr);
+    }
+  } else {
+    if (iter->obj) {
+      yyjson_obj_iter_init(ctn, &iter->u.obj);
+    } else {
+      yyjson_arr_iter_init(ctn, &iter->u.arr);
+    }
+  }
+}
+
+static inline void* val_iter_next(ValIter* iter) {
+  if (iter->mut) {
+    if (iter->obj) return yyjson_mut_obj_iter_next(&iter->u.mut_obj);
+    return yyjson_mut_arr_iter_next(&iter->u.mut_arr);
+  }
+  if (iter->obj) return yyjson_obj_iter_next(&iter->u.obj);
+  return yyjson_arr_iter_next(&iter->u.arr);
+}
+
+/**
+ * Returns the value for an object key yielded by val_iter_next().
+ */
+static inline void* val_key_value(void* key, bool mut) {
+  if (mut) return ((yyjson_mut_val*)key)->next;
+  return (yyjson_val*)key + 1;
+}
+
+static inline void* val_obj_getn(
+    void* obj, bool mut, const char* key, size_t len
+) {
+  if (mut) return yyjson_mut_obj_getn(obj, key, len);
+  return yyjson_obj_getn(obj, key, len);
+}
+
+static inline bool val_is_obj(void* val) {
+  return unsafe_yyjson_get_type(val) == YYJSON_TYPE_OBJ;
+}
+
+static inline bool val_is_str(void* val) {
+  return val && unsafe_yyjson_get_type(val) == YYJSON_TYPE_STR;
+}
+
+/**
+ * Deep equality between two values of either representation. Numbers are
+ * compared by value, so 1 == 1.0 as RFC 6902 requires, raw numbers
+ * included, and object members are compared regardless of their order.
+ */
+bool val_equals(void* lhs, bool lhs_mut, void* rhs, bool rhs_mut);
+
+/**
+ * Hash a value of either representation, consistently with val_equals():
+ * object member order is ignored and numbers are hashed by value. The
+ * result is stable across runs and platforms for a given seed.
+ */
+uint64_t val_hash(void* val, bool mut, uint64_t seed);
+
+/**
+ * Check that str is valid UTF-8, and set noesc to whether it can be written
+ * as JSON without escaping anything.
+ */
+bool str_check(const char* str, size_t len, bool* noesc);
+
+#endif